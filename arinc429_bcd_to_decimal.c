@@ -3,6 +3,15 @@
 
 #include "simstruc.h"
 #include <stdio.h>
+#include "arinc429_bcd.h"
+#include "arinc429_stats.h"
+#include "arinc429_trace.h"
+
+/* IWork: trace block id (only with -DARINC429_TRACE=1), then stats block id
+ * (only with -DARINC429_STATS=1) */
+#define IWORK_TRACE_ID 0
+#define IWORK_STATS_ID ARINC429_TRACE
+#define NUM_IWORK      (ARINC429_TRACE + ARINC429_STATS)
 
 /* Function: mdlInitializeSizes ===============================================
  * Abstract:
@@ -34,9 +43,9 @@ static void mdlInitializeSizes(SimStruct *S)
     /* Set sample times */
     ssSetNumSampleTimes(S, 1);
 
-    /* No work vectors needed */
+    /* Work vectors: only the trace and stats block ids */
     ssSetNumRWork(S, 0);
-    ssSetNumIWork(S, 0);
+    ssSetNumIWork(S, NUM_IWORK);
     ssSetNumPWork(S, 0);
     ssSetNumModes(S, 0);
     ssSetNumNonsampledZCs(S, 0);
@@ -62,6 +71,32 @@ static void mdlInitializeSampleTimes(SimStruct *S)
     ssSetModelReferenceSampleTimeDefaultInheritance(S);
 }
 
+#if ARINC429_TRACE || ARINC429_STATS
+#define MDL_START
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Register the block with the trace ring and the step statistics under
+ *    its path.
+ */
+static void mdlStart(SimStruct *S)
+{
+#if ARINC429_TRACE
+    ssGetIWork(S)[IWORK_TRACE_ID] = arinc429_trace_register(ssGetPath(S));
+#endif
+#if ARINC429_STATS
+    ssGetIWork(S)[IWORK_STATS_ID] = arinc429_stats_register(ssGetPath(S));
+#endif
+}
+#endif
+
+#if ARINC429_TRACE
+/* Trace sink: one formatted record per console line */
+static void trace_print(const char *line, void *ctx)
+{
+    ssPrintf("%s\n", line);
+}
+#endif
+
 /* Function: mdlOutputs =======================================================
  * Abstract:
  *    Decode ARINC 429 BCD data according to the standard specification.
@@ -70,60 +105,46 @@ static void mdlInitializeSampleTimes(SimStruct *S)
  */
 static void mdlOutputs(SimStruct *S, int_T tid)
 {
+    ARINC429_STATS_START(t0);
+
     /* Get input and output pointers */
     const uint8_T *u = (const uint8_T*) ssGetInputPortSignal(S, 0);
     real_T *y = (real_T*) ssGetOutputPortSignal(S, 0);
     
+    int bcd[ARINC429_BCD_NUM_DIGITS];
+    
     /* ARINC 429 BCD decoding according to specification */
     /* Note: The index mapping here assumes bit 0 is the MSB as per the specification */
-    
-    /* Extract BCD digits */
-    /* Per the spec: 3-4-4-4-4 pattern from MSB to LSB */
-    
-    /* BCD Character #1 (MSB, 3 bits) */
-    int bcd1 = (u[0] << 2) | (u[1] << 1) | u[2];
-    
-    /* BCD Character #2 (4 bits) */
-    int bcd2 = (u[3] << 3) | (u[4] << 2) | (u[5] << 1) | u[6];
-    
-    /* BCD Character #3 (4 bits) */
-    int bcd3 = (u[7] << 3) | (u[8] << 2) | (u[9] << 1) | u[10];
-    
-    /* BCD Character #4 (4 bits) */
-    int bcd4 = (u[11] << 3) | (u[12] << 2) | (u[13] << 1) | u[14];
-    
-    /* BCD Character #5 (LSB, 4 bits) */
-    int bcd5 = (u[15] << 3) | (u[16] << 2) | (u[17] << 1) | u[18];
-    
-    /* Debug print the extracted BCD digits */
-    #ifdef MATLAB_MEX_FILE
-    ssPrintf("Input bits: ");
-    for (int i = 0; i < 19; i++) {
-        ssPrintf("%d", u[i]);
-    }
-    ssPrintf("\n");
-    
-    ssPrintf("BCD digits (MSB to LSB): %d %d %d %d %d\n", bcd1, bcd2, bcd3, bcd4, bcd5);
-    #endif
-    
-    /* Combine digits to form decimal value */
-    double decimal = bcd5 + bcd4*10 + bcd3*100 + bcd2*1000 + bcd1*10000;
+    double decimal = arinc429_bcd_decode_bits(u, bcd);
     
     /* Set output */
     y[0] = decimal;
     
-    /* Debug print result */
-    #ifdef MATLAB_MEX_FILE
-    ssPrintf("Final decimal value: %f\n", decimal);
-    #endif
+    /* Diagnostics go to the trace ring; compiled out unless ARINC429_TRACE */
+    ARINC429_TRACE_RECORD(ARINC429_TRACE_BCD_DECODE, ssGetIWork(S)[IWORK_TRACE_ID],
+                          ssGetT(S), arinc429_trace_pack_bits(u), bcd, decimal);
+
+    ARINC429_STATS_STOP(ssGetIWork(S)[IWORK_STATS_ID], t0, 1);
 }
 
 /* Function: mdlTerminate =====================================================
  * Abstract:
- *    No termination needed.
+ *    Print the trace records collected during the run (tracing builds only)
+ *    and write the step statistics as JSON (stats builds only).
  */
 static void mdlTerminate(SimStruct *S)
 {
+#if ARINC429_STATS
+    char line[ARINC429_STATS_LINE_LEN];
+
+    arinc429_stats_report(ssGetIWork(S)[IWORK_STATS_ID], line, sizeof(line));
+    ssPrintf("%s\n", line);
+    arinc429_stats_unregister(ssGetIWork(S)[IWORK_STATS_ID]);
+#endif
+#if ARINC429_TRACE
+    arinc429_trace_drain(trace_print, NULL);
+    arinc429_trace_unregister(ssGetIWork(S)[IWORK_TRACE_ID]);
+#endif
 }
 
 /* Required S-function trailer */
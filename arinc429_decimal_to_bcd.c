@@ -3,6 +3,15 @@
 
 #include "simstruc.h"
 #include <stdio.h>
+#include "arinc429_bcd.h"
+#include "arinc429_stats.h"
+#include "arinc429_trace.h"
+
+/* IWork: trace block id (only with -DARINC429_TRACE=1), then stats block id
+ * (only with -DARINC429_STATS=1) */
+#define IWORK_TRACE_ID 0
+#define IWORK_STATS_ID ARINC429_TRACE
+#define NUM_IWORK      (ARINC429_TRACE + ARINC429_STATS)
 
 /* Function: mdlInitializeSizes ===============================================
  * Abstract:
@@ -34,9 +43,9 @@ static void mdlInitializeSizes(SimStruct *S)
     /* Set sample times */
     ssSetNumSampleTimes(S, 1);
 
-    /* No work vectors needed */
+    /* Work vectors: only the trace and stats block ids */
     ssSetNumRWork(S, 0);
-    ssSetNumIWork(S, 0);
+    ssSetNumIWork(S, NUM_IWORK);
     ssSetNumPWork(S, 0);
     ssSetNumModes(S, 0);
     ssSetNumNonsampledZCs(S, 0);
@@ -62,6 +71,32 @@ static void mdlInitializeSampleTimes(SimStruct *S)
     ssSetModelReferenceSampleTimeDefaultInheritance(S);
 }
 
+#if ARINC429_TRACE || ARINC429_STATS
+#define MDL_START
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Register the block with the trace ring and the step statistics under
+ *    its path.
+ */
+static void mdlStart(SimStruct *S)
+{
+#if ARINC429_TRACE
+    ssGetIWork(S)[IWORK_TRACE_ID] = arinc429_trace_register(ssGetPath(S));
+#endif
+#if ARINC429_STATS
+    ssGetIWork(S)[IWORK_STATS_ID] = arinc429_stats_register(ssGetPath(S));
+#endif
+}
+#endif
+
+#if ARINC429_TRACE
+/* Trace sink: one formatted record per console line */
+static void trace_print(const char *line, void *ctx)
+{
+    ssPrintf("%s\n", line);
+}
+#endif
+
 /* Function: mdlOutputs =======================================================
  * Abstract:
  *    Encode decimal value to ARINC 429 BCD data according to the standard specification.
@@ -70,83 +105,46 @@ static void mdlInitializeSampleTimes(SimStruct *S)
  */
 static void mdlOutputs(SimStruct *S, int_T tid)
 {
+    ARINC429_STATS_START(t0);
+
     /* Get input and output pointers */
     const real_T *u = (const real_T*) ssGetInputPortSignal(S, 0);
     uint8_T *y = (uint8_T*) ssGetOutputPortSignal(S, 0);
     
-    /* Get decimal value and ensure it's in valid range (0-99999) */
-    double decimal_value = u[0];
-    if (decimal_value < 0) decimal_value = 0;
-    if (decimal_value > 99999) decimal_value = 99999;
-    
-    /* Extract BCD digits */
-    int bcd1 = (int)(decimal_value / 10000) % 10;    /* 10000's place */
-    int bcd2 = (int)(decimal_value / 1000) % 10;     /* 1000's place */
-    int bcd3 = (int)(decimal_value / 100) % 10;      /* 100's place */
-    int bcd4 = (int)(decimal_value / 10) % 10;       /* 10's place */
-    int bcd5 = (int)(decimal_value) % 10;            /* 1's place */
+    int bcd[ARINC429_BCD_NUM_DIGITS];
     
-    /* Debug print the extracted BCD digits */
-    #ifdef MATLAB_MEX_FILE
-    ssPrintf("Decimal value: %f\n", decimal_value);
-    ssPrintf("BCD digits (MSB to LSB): %d %d %d %d %d\n", bcd1, bcd2, bcd3, bcd4, bcd5);
-    #endif
-    
-    /* Initialize output array to zeros */
-    for (int i = 0; i < 19; i++) {
-        y[i] = 0;
-    }
-    
-    /* Encode BCD Character #1 (MSB, 3 bits) */
-    /* Bits 0-2 */
-    y[0] = (bcd1 >> 2) & 0x01;
-    y[1] = (bcd1 >> 1) & 0x01;
-    y[2] = bcd1 & 0x01;
-    
-    /* Encode BCD Character #2 (4 bits) */
-    /* Bits 3-6 */
-    y[3] = (bcd2 >> 3) & 0x01;
-    y[4] = (bcd2 >> 2) & 0x01;
-    y[5] = (bcd2 >> 1) & 0x01;
-    y[6] = bcd2 & 0x01;
-    
-    /* Encode BCD Character #3 (4 bits) */
-    /* Bits 7-10 */
-    y[7] = (bcd3 >> 3) & 0x01;
-    y[8] = (bcd3 >> 2) & 0x01;
-    y[9] = (bcd3 >> 1) & 0x01;
-    y[10] = bcd3 & 0x01;
-    
-    /* Encode BCD Character #4 (4 bits) */
-    /* Bits 11-14 */
-    y[11] = (bcd4 >> 3) & 0x01;
-    y[12] = (bcd4 >> 2) & 0x01;
-    y[13] = (bcd4 >> 1) & 0x01;
-    y[14] = bcd4 & 0x01;
-    
-    /* Encode BCD Character #5 (LSB, 4 bits) */
-    /* Bits 15-18 */
-    y[15] = (bcd5 >> 3) & 0x01;
-    y[16] = (bcd5 >> 2) & 0x01;
-    y[17] = (bcd5 >> 1) & 0x01;
-    y[18] = bcd5 & 0x01;
+    /* Inputs the encoder clamps (NaN included) */
+    ARINC429_STATS_COUNT(ssGetIWork(S)[IWORK_STATS_ID], ARINC429_STATS_CLAMPED,
+                         !(u[0] >= ARINC429_BCD_MIN_VALUE && u[0] <= ARINC429_BCD_MAX_VALUE));
+
+    /* Encode BCD characters into bits 0-18 (value clamped to 0-99999) */
+    arinc429_bcd_encode_bits(u[0], y, bcd);
     
-    /* Debug print the output bits */
-    #ifdef MATLAB_MEX_FILE
-    ssPrintf("Output bits: ");
-    for (int i = 0; i < 19; i++) {
-        ssPrintf("%d", y[i]);
-    }
-    ssPrintf("\n");
-    #endif
+    /* Diagnostics go to the trace ring; compiled out unless ARINC429_TRACE */
+    ARINC429_TRACE_RECORD(ARINC429_TRACE_BCD_ENCODE, ssGetIWork(S)[IWORK_TRACE_ID],
+                          ssGetT(S), arinc429_trace_pack_bits(y), bcd, u[0]);
+
+    ARINC429_STATS_STOP(ssGetIWork(S)[IWORK_STATS_ID], t0, 1);
 }
 
 /* Function: mdlTerminate =====================================================
  * Abstract:
- *    No termination needed.
+ *    Print the trace records collected during the run (tracing builds only)
+ *    and write the step statistics as JSON (stats builds only).
  */
 static void mdlTerminate(SimStruct *S)
 {
+#if ARINC429_STATS
+    char line[ARINC429_STATS_LINE_LEN];
+
+    arinc429_stats_report(ssGetIWork(S)[IWORK_STATS_ID], line, sizeof(line));
+    ssPrintf("%s\n", line);
+    arinc429_stats_unregister(ssGetIWork(S)[IWORK_STATS_ID]);
+#endif
+#if ARINC429_TRACE
+    arinc429_trace_drain(trace_print, NULL);
+    arinc429_trace_unregister(ssGetIWork(S)[IWORK_TRACE_ID]);
+#endif
 }
 
 /* Required S-function trailer */
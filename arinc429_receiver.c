@@ -0,0 +1,253 @@
+#define S_FUNCTION_NAME  arinc429_receiver
+#define S_FUNCTION_LEVEL 2
+
+#include "simstruc.h"
+#include "arinc429_rx.h"
+
+/* Routes packed ARINC 429 words by label and SDI into last-value mailboxes
+ * (see arinc429_rx.h) and outputs the current value of selected labels.
+ * Any number of words may arrive per step; words for labels that are not
+ * in the definition file are ignored. */
+
+/* Parameters: label definition file (char array), output labels written as
+ * octal digits (e.g. [203 310 312]) and their SDIs (scalar or one per label) */
+#define FILE_PARAM(S)   ssGetSFcnParam(S, 0)
+#define LABELS_PARAM(S) ssGetSFcnParam(S, 1)
+#define SDI_PARAM(S)    ssGetSFcnParam(S, 2)
+#define NUM_PARAMS      3
+
+/* Output ports, one element per selected label */
+#define OUT_VALUE   0
+#define OUT_SSM     1
+#define OUT_STALE   2
+#define NUM_OUTPUTS 3
+
+#define FILE_NAME_LEN 1024
+
+/* PWork: the dispatch table */
+#define PWORK_RX  0
+#define NUM_PWORK 1
+
+/* Octal label from its digits read as a decimal number, -1 if not octal */
+static int octal_label(double digits)
+{
+    int d = (int)digits, label = 0, scale = 1;
+
+    if ((double)d != digits || d < 0 || d > 377) {
+        return -1;
+    }
+    for (; d > 0; d /= 10, scale *= 8) {
+        if (d % 10 > 7) {
+            return -1;
+        }
+        label += (d % 10) * scale;
+    }
+    return label;
+}
+
+#define MDL_CHECK_PARAMETERS
+#if defined(MDL_CHECK_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Function: mdlCheckParameters ===============================================
+ * Abstract:
+ *    The file name must be a non-empty string, the labels octal numbers and
+ *    the SDIs 0-3, either one for all labels or one per label.
+ */
+static void mdlCheckParameters(SimStruct *S)
+{
+    const real_T *labels, *sdi;
+    size_t i, n, m;
+
+    if (!mxIsChar(FILE_PARAM(S)) || mxIsEmpty(FILE_PARAM(S))) {
+        ssSetErrorStatus(S, "Label definition file must be a non-empty string");
+        return;
+    }
+    if (!mxIsDouble(LABELS_PARAM(S)) || mxIsEmpty(LABELS_PARAM(S))) {
+        ssSetErrorStatus(S, "Labels must be a non-empty numeric vector");
+        return;
+    }
+    n = mxGetNumberOfElements(LABELS_PARAM(S));
+    labels = mxGetPr(LABELS_PARAM(S));
+    for (i = 0; i < n; i++) {
+        if (octal_label(labels[i]) < 0) {
+            ssSetErrorStatus(S, "Labels must be octal numbers 0-377");
+            return;
+        }
+    }
+    m = mxGetNumberOfElements(SDI_PARAM(S));
+    if (!mxIsDouble(SDI_PARAM(S)) || (m != 1 && m != n)) {
+        ssSetErrorStatus(S, "SDI must be a scalar or one value per label");
+        return;
+    }
+    sdi = mxGetPr(SDI_PARAM(S));
+    for (i = 0; i < m; i++) {
+        if (sdi[i] < 0.0 || sdi[i] > 3.0 || sdi[i] != (double)(int)sdi[i]) {
+            ssSetErrorStatus(S, "SDI must be 0, 1, 2 or 3");
+            return;
+        }
+    }
+}
+#endif
+
+/* Function: mdlInitializeSizes ===============================================
+ * Abstract:
+ *    The sizes information is used by Simulink to determine the S-function
+ *    block's characteristics (number of inputs, outputs, states, etc.).
+ */
+static void mdlInitializeSizes(SimStruct *S)
+{
+    int i, n;
+
+    /* Set number of expected parameters */
+    ssSetNumSFcnParams(S, NUM_PARAMS);
+#if defined(MATLAB_MEX_FILE)
+    if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
+        return; /* Parameter mismatch reported by Simulink */
+    }
+    mdlCheckParameters(S);
+    if (ssGetErrorStatus(S) != NULL) {
+        return;
+    }
+#endif
+    for (i = 0; i < NUM_PARAMS; i++) {
+        ssSetSFcnParamTunable(S, i, 0);
+    }
+    n = (int)mxGetNumberOfElements(LABELS_PARAM(S));
+
+    /* Set number of input and output ports */
+    if (!ssSetNumInputPorts(S, 1)) return;
+    ssSetInputPortWidth(S, 0, DYNAMICALLY_SIZED);
+    ssSetInputPortDataType(S, 0, SS_UINT32);
+    ssSetInputPortRequiredContiguous(S, 0, true);
+    ssSetInputPortDirectFeedThrough(S, 0, 1);
+
+    if (!ssSetNumOutputPorts(S, NUM_OUTPUTS)) return;
+    ssSetOutputPortWidth(S, OUT_VALUE, n);
+    ssSetOutputPortDataType(S, OUT_VALUE, SS_DOUBLE);
+    ssSetOutputPortWidth(S, OUT_SSM, n);
+    ssSetOutputPortDataType(S, OUT_SSM, SS_UINT8);
+    ssSetOutputPortWidth(S, OUT_STALE, n);
+    ssSetOutputPortDataType(S, OUT_STALE, SS_UINT32);
+
+    /* Set sample times */
+    ssSetNumSampleTimes(S, 1);
+
+    /* Dispatch table in PWork */
+    ssSetNumRWork(S, 0);
+    ssSetNumIWork(S, 0);
+    ssSetNumPWork(S, NUM_PWORK);
+    ssSetNumModes(S, 0);
+    ssSetNumNonsampledZCs(S, 0);
+
+    /* Set options */
+    ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
+}
+
+/* Function: mdlInitializeSampleTimes =========================================
+ * Abstract:
+ *    This function is used to specify the sample time(s) for your
+ *    S-function. You must register the same number of sample times as
+ *    specified in ssSetNumSampleTimes.
+ */
+static void mdlInitializeSampleTimes(SimStruct *S)
+{
+    ssSetSampleTime(S, 0, INHERITED_SAMPLE_TIME);
+    ssSetOffsetTime(S, 0, 0.0);
+    ssSetModelReferenceSampleTimeDefaultInheritance(S);
+}
+
+#define MDL_START
+#if defined(MDL_START)
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Build the dispatch table from the label definition file.
+ */
+static void mdlStart(SimStruct *S)
+{
+    char path[FILE_NAME_LEN];
+    arinc429_rx_t *rx;
+    int bad_line;
+
+    ssGetPWork(S)[PWORK_RX] = NULL;
+
+    if (mxGetString(FILE_PARAM(S), path, sizeof(path)) != 0) {
+        ssSetErrorStatus(S, "Label definition file name too long");
+        return;
+    }
+
+    rx = arinc429_rx_create();
+    if (rx == NULL) {
+        ssSetErrorStatus(S, "Out of memory");
+        return;
+    }
+
+    if (arinc429_rx_load(rx, path, &bad_line) < 0) {
+        arinc429_rx_destroy(rx);
+        ssSetErrorStatus(S, "Cannot read the label definition file");
+        return;
+    }
+    if (bad_line != 0) {
+        ssPrintf("%s: %s:%d: invalid label definition ignored\n", ssGetPath(S), path, bad_line);
+    }
+
+    ssGetPWork(S)[PWORK_RX] = rx;
+}
+#endif
+
+/* Function: mdlOutputs =======================================================
+ * Abstract:
+ *    Dispatch this step's words, then read the selected mailboxes. A label
+ *    that received nothing keeps its last value and its stale count grows.
+ */
+static void mdlOutputs(SimStruct *S, int_T tid)
+{
+    arinc429_rx_t *rx = (arinc429_rx_t *)ssGetPWork(S)[PWORK_RX];
+    const uint32_T *u = (const uint32_T *)ssGetInputPortSignal(S, 0);
+    int_T num_words = ssGetInputPortWidth(S, 0);
+    real_T   *value = (real_T *)ssGetOutputPortSignal(S, OUT_VALUE);
+    uint8_T  *ssm   = (uint8_T *)ssGetOutputPortSignal(S, OUT_SSM);
+    uint32_T *stale = (uint32_T *)ssGetOutputPortSignal(S, OUT_STALE);
+    const real_T *labels = mxGetPr(LABELS_PARAM(S));
+    const real_T *sdi = mxGetPr(SDI_PARAM(S));
+    int_T n = ssGetOutputPortWidth(S, OUT_VALUE);
+    int_T one_sdi = mxGetNumberOfElements(SDI_PARAM(S)) == 1;
+    double t = ssGetT(S);
+    int_T i;
+
+    if (rx == NULL) {
+        return;
+    }
+
+    arinc429_rx_tick(rx);
+    for (i = 0; i < num_words; i++) {
+        arinc429_rx_receive(rx, u[i], t);
+    }
+
+    for (i = 0; i < n; i++) {
+        const arinc429_rx_entry_t *e =
+            arinc429_rx_mailbox(rx, (uint8_t)octal_label(labels[i]), (int)sdi[one_sdi ? 0 : i]);
+        value[i] = e->value;
+        ssm[i] = e->ssm;
+        stale[i] = e->stale;
+    }
+}
+
+/* Function: mdlTerminate =====================================================
+ * Abstract:
+ *    Release the dispatch table.
+ */
+static void mdlTerminate(SimStruct *S)
+{
+    arinc429_rx_t *rx = (arinc429_rx_t *)ssGetPWork(S)[PWORK_RX];
+
+    if (rx != NULL) {
+        arinc429_rx_destroy(rx);
+        ssGetPWork(S)[PWORK_RX] = NULL;
+    }
+}
+
+/* Required S-function trailer */
+#ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
+#include "simulink.c"      /* MEX-file interface mechanism */
+#else
+#include "cg_sfun.h"       /* Code generation registration function */
+#endif
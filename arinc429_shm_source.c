@@ -0,0 +1,290 @@
+#define S_FUNCTION_NAME  arinc429_shm_source
+#define S_FUNCTION_LEVEL 2
+
+#include "simstruc.h"
+#include <math.h>
+#include "arinc429_shm.h"
+
+/* Feeds the model from a live producer through the shared-memory ring of
+ * arinc429_shm.h (a bus capture daemon, an ADS-B decoder or
+ * arinc429_shm_feed) instead of files prepared by data_original.m.
+ *
+ * Words: up to "width" packed words per step, for arinc429_receiver or the
+ * word decoders; unused elements are 0, which the receiver ignores unless
+ * label 000 is defined.
+ * Samples: one flight sample per step on five ports wired like the inputs of
+ * trend_dfa_sfunc_flight, so the DFA window still counts samples; without a
+ * new sample the last one is held.
+ *
+ * Records are read where the producer wrote them and go straight into the
+ * output ports; when the producer keeps up, a step makes no system call. */
+
+/* Parameters: shared-memory name (char array, e.g. '/arinc429'), record kind
+ * (1 = words, 2 = flight samples), words per step (words only), sample time
+ * in seconds and the longest wait for data per step in seconds (0 = never
+ * wait, inf = wait until the producer sends or closes) */
+#define NAME_PARAM(S)    ssGetSFcnParam(S, 0)
+#define KIND_PARAM(S)    ssGetSFcnParam(S, 1)
+#define WIDTH_PARAM(S)   ssGetSFcnParam(S, 2)
+#define TS_PARAM(S)      ssGetSFcnParam(S, 3)
+#define TIMEOUT_PARAM(S) ssGetSFcnParam(S, 4)
+#define NUM_PARAMS       5
+
+/* Output ports. Words: words, count, time. Samples: velocity,
+ * baroaltitude, lat, lon, vertrate, count, time */
+#define OUT_WORDS        0
+#define OUT_COUNT(kind)  ((kind) == ARINC429_SHM_WORDS ? 1 : TREND_DFA_NUM_CHANNELS)
+#define OUT_TIME(kind)   (OUT_COUNT(kind) + 1)
+#define NUM_OUTPUTS(kind) (OUT_COUNT(kind) + 2)
+
+#define NAME_LEN         256
+
+/* RWork: last sample and its time, held between records, then the wait
+ * timeout read at mdlStart */
+#define RWORK_TIME       TREND_DFA_NUM_CHANNELS
+#define RWORK_TIMEOUT    (TREND_DFA_NUM_CHANNELS + 1)
+#define NUM_RWORK        (TREND_DFA_NUM_CHANNELS + 2)
+
+/* IWork: record kind, read at mdlStart */
+#define IWORK_KIND       0
+#define NUM_IWORK        1
+
+/* PWork: the attached ring */
+#define PWORK_SHM        0
+#define NUM_PWORK        1
+
+#define KIND(S) ((int)mxGetScalar(KIND_PARAM(S)))
+
+#define MDL_CHECK_PARAMETERS
+#if defined(MDL_CHECK_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Function: mdlCheckParameters ===============================================
+ * Abstract:
+ *    The name must be a non-empty string, the kind 1 or 2, the width a
+ *    positive integer, the sample time positive and the timeout
+ *    non-negative.
+ */
+static void mdlCheckParameters(SimStruct *S)
+{
+    double width;
+
+    if (!mxIsChar(NAME_PARAM(S)) || mxIsEmpty(NAME_PARAM(S))) {
+        ssSetErrorStatus(S, "Shared-memory name must be a non-empty string");
+        return;
+    }
+    if (!mxIsDouble(KIND_PARAM(S)) || mxGetNumberOfElements(KIND_PARAM(S)) != 1 ||
+        (KIND(S) != ARINC429_SHM_WORDS && KIND(S) != ARINC429_SHM_SAMPLES)) {
+        ssSetErrorStatus(S, "Kind must be 1 (words) or 2 (flight samples)");
+        return;
+    }
+    if (!mxIsDouble(WIDTH_PARAM(S)) || mxGetNumberOfElements(WIDTH_PARAM(S)) != 1 ||
+        (width = mxGetScalar(WIDTH_PARAM(S))) < 1.0 || width != floor(width)) {
+        ssSetErrorStatus(S, "Words per step must be a positive integer");
+        return;
+    }
+    if (!mxIsDouble(TS_PARAM(S)) || mxGetNumberOfElements(TS_PARAM(S)) != 1 ||
+        !(mxGetScalar(TS_PARAM(S)) > 0.0)) {
+        ssSetErrorStatus(S, "Sample time must be a positive scalar");
+        return;
+    }
+    if (!mxIsDouble(TIMEOUT_PARAM(S)) || mxGetNumberOfElements(TIMEOUT_PARAM(S)) != 1 ||
+        !(mxGetScalar(TIMEOUT_PARAM(S)) >= 0.0)) {
+        ssSetErrorStatus(S, "Timeout must be a non-negative scalar (inf waits forever)");
+        return;
+    }
+}
+#endif
+
+/* Function: mdlInitializeSizes ===============================================
+ * Abstract:
+ *    The sizes information is used by Simulink to determine the S-function
+ *    block's characteristics (number of inputs, outputs, states, etc.).
+ */
+static void mdlInitializeSizes(SimStruct *S)
+{
+    int i, kind;
+
+    /* Set number of expected parameters */
+    ssSetNumSFcnParams(S, NUM_PARAMS);
+#if defined(MATLAB_MEX_FILE)
+    if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
+        return; /* Parameter mismatch reported by Simulink */
+    }
+    mdlCheckParameters(S);
+    if (ssGetErrorStatus(S) != NULL) {
+        return;
+    }
+#endif
+    for (i = 0; i < NUM_PARAMS; i++) {
+        ssSetSFcnParamTunable(S, i, 0);
+    }
+    kind = KIND(S);
+
+    /* Set number of input and output ports */
+    if (!ssSetNumInputPorts(S, 0)) return;
+    if (!ssSetNumOutputPorts(S, NUM_OUTPUTS(kind))) return;
+
+    if (kind == ARINC429_SHM_WORDS) {
+        ssSetOutputPortWidth(S, OUT_WORDS, (int_T)mxGetScalar(WIDTH_PARAM(S)));
+        ssSetOutputPortDataType(S, OUT_WORDS, SS_UINT32);
+    } else {
+        for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+            ssSetOutputPortWidth(S, i, 1);
+            ssSetOutputPortDataType(S, i, SS_DOUBLE);
+        }
+    }
+    ssSetOutputPortWidth(S, OUT_COUNT(kind), 1);
+    ssSetOutputPortDataType(S, OUT_COUNT(kind), SS_UINT32);
+    ssSetOutputPortWidth(S, OUT_TIME(kind), 1);
+    ssSetOutputPortDataType(S, OUT_TIME(kind), SS_DOUBLE);
+
+    /* Set sample times */
+    ssSetNumSampleTimes(S, 1);
+
+    /* Held sample and timeout in RWork, kind in IWork, ring in PWork */
+    ssSetNumRWork(S, NUM_RWORK);
+    ssSetNumIWork(S, NUM_IWORK);
+    ssSetNumPWork(S, NUM_PWORK);
+    ssSetNumModes(S, 0);
+    ssSetNumNonsampledZCs(S, 0);
+
+    /* Set options */
+    ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
+}
+
+/* Function: mdlInitializeSampleTimes =========================================
+ * Abstract:
+ *    Discrete at the sample time parameter: with no inputs there is nothing
+ *    to inherit from.
+ */
+static void mdlInitializeSampleTimes(SimStruct *S)
+{
+    ssSetSampleTime(S, 0, mxGetScalar(TS_PARAM(S)));
+    ssSetOffsetTime(S, 0, 0.0);
+    ssSetModelReferenceSampleTimeDefaultInheritance(S);
+}
+
+#define MDL_START
+#if defined(MDL_START)
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Cache the kind and timeout, and attach to the producer's ring; the
+ *    producer must already be running.
+ */
+static void mdlStart(SimStruct *S)
+{
+    char name[NAME_LEN];
+    real_T *held = ssGetRWork(S);
+    arinc429_shm_t *shm;
+    int i;
+
+    ssGetPWork(S)[PWORK_SHM] = NULL;
+    for (i = 0; i < NUM_RWORK; i++) {
+        held[i] = 0.0;
+    }
+    held[RWORK_TIMEOUT] = mxGetScalar(TIMEOUT_PARAM(S));
+    ssGetIWork(S)[IWORK_KIND] = KIND(S);
+
+    if (mxGetString(NAME_PARAM(S), name, sizeof(name)) != 0) {
+        ssSetErrorStatus(S, "Shared-memory name too long");
+        return;
+    }
+
+    shm = arinc429_shm_attach(name, KIND(S));
+    if (shm == NULL) {
+        ssSetErrorStatus(S, "Cannot attach to the shared-memory ring (is the producer running "
+                            "with the same name and record kind?)");
+        return;
+    }
+
+    ssGetPWork(S)[PWORK_SHM] = shm;
+}
+#endif
+
+/* Function: mdlOutputs =======================================================
+ * Abstract:
+ *    Wait for data if a timeout is set, then take this step's records out of
+ *    the ring.
+ */
+static void mdlOutputs(SimStruct *S, int_T tid)
+{
+    arinc429_shm_t *shm = (arinc429_shm_t *)ssGetPWork(S)[PWORK_SHM];
+    const int kind = (int)ssGetIWork(S)[IWORK_KIND];
+    const real_T timeout = ssGetRWork(S)[RWORK_TIMEOUT];
+    uint32_T *count = (uint32_T *)ssGetOutputPortSignal(S, OUT_COUNT(kind));
+    real_T *time = (real_T *)ssGetOutputPortSignal(S, OUT_TIME(kind));
+    real_T *held = ssGetRWork(S);
+    const void *recs;
+    size_t n;
+    int_T i;
+
+    *count = 0;
+    *time = held[RWORK_TIME];
+    if (shm == NULL) {
+        return;
+    }
+
+    if (timeout > 0.0) {
+        arinc429_shm_wait(shm, isinf(timeout) ? -1 : (int64_t)(timeout * 1e9));
+    }
+
+    if (kind == ARINC429_SHM_WORDS) {
+        uint32_T *words = (uint32_T *)ssGetOutputPortSignal(S, OUT_WORDS);
+        int_T width = ssGetOutputPortWidth(S, OUT_WORDS), k = 0;
+
+        /* At most two contiguous runs when the ring wraps */
+        while (k < width && (n = arinc429_shm_peek(shm, &recs, (size_t)(width - k))) > 0) {
+            const arinc429_shm_word_t *w = (const arinc429_shm_word_t *)recs;
+            for (i = 0; i < (int_T)n; i++) {
+                words[k++] = w[i].word;
+            }
+            held[RWORK_TIME] = (real_T)w[n - 1].time_ns * 1e-9;
+            arinc429_shm_release(shm, n);
+        }
+        for (i = k; i < width; i++) {
+            words[i] = 0;
+        }
+        *count = (uint32_T)k;
+    } else {
+        if (arinc429_shm_peek(shm, &recs, 1) == 1) {
+            const arinc429_shm_sample_t *s = (const arinc429_shm_sample_t *)recs;
+            for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+                held[i] = s->input[i];
+            }
+            held[RWORK_TIME] = (real_T)s->time_ns * 1e-9;
+            arinc429_shm_release(shm, 1);
+            *count = 1;
+        }
+        for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+            ((real_T *)ssGetOutputPortSignal(S, i))[0] = held[i];
+        }
+    }
+    *time = held[RWORK_TIME];
+}
+
+/* Function: mdlTerminate =====================================================
+ * Abstract:
+ *    Report the ring counters and detach.
+ */
+static void mdlTerminate(SimStruct *S)
+{
+    arinc429_shm_t *shm = (arinc429_shm_t *)ssGetPWork(S)[PWORK_SHM];
+    arinc429_shm_stats_t st;
+
+    if (shm == NULL) {
+        return;
+    }
+
+    arinc429_shm_stats(shm, &st);
+    ssPrintf("%s: %.0f records read, %.0f left in the ring, %.0f dropped by the producer, "
+             "%.0f waits slept\n", ssGetPath(S), (double)st.tail, (double)(st.head - st.tail),
+             (double)st.dropped, (double)st.sleeps);
+    arinc429_shm_close(shm);
+    ssGetPWork(S)[PWORK_SHM] = NULL;
+}
+
+/* Required S-function trailer */
+#ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
+#include "simulink.c"      /* MEX-file interface mechanism */
+#else
+#include "cg_sfun.h"       /* Code generation registration function */
+#endif
@@ -0,0 +1,119 @@
+#define S_FUNCTION_NAME  arinc429_word_decoder
+#define S_FUNCTION_LEVEL 2
+
+#include "simstruc.h"
+#include "arinc429_bcd.h"
+#include "arinc429_word.h"
+
+/* Output ports */
+#define OUT_VALUE   0
+#define OUT_LABEL   1
+#define OUT_SDI     2
+#define OUT_SSM     3
+#define OUT_STATUS  4
+#define NUM_OUTPUTS 5
+
+/* Function: mdlInitializeSizes ===============================================
+ * Abstract:
+ *    The sizes information is used by Simulink to determine the S-function
+ *    block's characteristics (number of inputs, outputs, states, etc.).
+ */
+static void mdlInitializeSizes(SimStruct *S)
+{
+    /* Set number of expected parameters */
+    ssSetNumSFcnParams(S, 0);
+    if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
+        return; /* Parameter mismatch reported by Simulink */
+    }
+
+    /* Set number of input and output ports */
+    if (!ssSetNumInputPorts(S, 1)) return;
+    if (!ssSetNumOutputPorts(S, NUM_OUTPUTS)) return;
+
+    /* Configure input port - one packed 32-bit ARINC 429 word */
+    ssSetInputPortWidth(S, 0, 1);
+    ssSetInputPortDataType(S, 0, SS_UINT32);
+    ssSetInputPortRequiredContiguous(S, 0, true);
+    ssSetInputPortDirectFeedThrough(S, 0, 1);
+
+    /* Configure output ports - value, octal label, SDI, SSM, status */
+    ssSetOutputPortWidth(S, OUT_VALUE, 1);
+    ssSetOutputPortDataType(S, OUT_VALUE, SS_DOUBLE);
+    ssSetOutputPortWidth(S, OUT_LABEL, 1);
+    ssSetOutputPortDataType(S, OUT_LABEL, SS_UINT8);
+    ssSetOutputPortWidth(S, OUT_SDI, 1);
+    ssSetOutputPortDataType(S, OUT_SDI, SS_UINT8);
+    ssSetOutputPortWidth(S, OUT_SSM, 1);
+    ssSetOutputPortDataType(S, OUT_SSM, SS_UINT8);
+    ssSetOutputPortWidth(S, OUT_STATUS, 1);
+    ssSetOutputPortDataType(S, OUT_STATUS, SS_INT32);
+
+    /* Set sample times */
+    ssSetNumSampleTimes(S, 1);
+
+    /* No work vectors needed */
+    ssSetNumRWork(S, 0);
+    ssSetNumIWork(S, 0);
+    ssSetNumPWork(S, 0);
+    ssSetNumModes(S, 0);
+    ssSetNumNonsampledZCs(S, 0);
+
+    /* Specify the operating point save/restore compliance to be same as a
+     * built-in block */
+    ssSetOperatingPointCompliance(S, USE_DEFAULT_OPERATING_POINT);
+
+    /* Set options */
+    ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
+}
+
+/* Function: mdlInitializeSampleTimes =========================================
+ * Abstract:
+ *    This function is used to specify the sample time(s) for your
+ *    S-function. You must register the same number of sample times as
+ *    specified in ssSetNumSampleTimes.
+ */
+static void mdlInitializeSampleTimes(SimStruct *S)
+{
+    ssSetSampleTime(S, 0, INHERITED_SAMPLE_TIME);
+    ssSetOffsetTime(S, 0, 0.0);
+    ssSetModelReferenceSampleTimeDefaultInheritance(S);
+}
+
+/* Function: mdlOutputs =======================================================
+ * Abstract:
+ *    Split a packed ARINC 429 BCD word with mask/shift extraction. Status is
+ *    0 for a valid word, -1 for a parity error and -2 for a BCD character
+ *    above 9 (see ARINC429_ERR_*). The value is signed by the SSM.
+ */
+static void mdlOutputs(SimStruct *S, int_T tid)
+{
+    /* Get input and output pointers */
+    const uint32_T *u = (const uint32_T*) ssGetInputPortSignal(S, 0);
+    real_T  *value  = (real_T*)  ssGetOutputPortSignal(S, OUT_VALUE);
+    uint8_T *label  = (uint8_T*) ssGetOutputPortSignal(S, OUT_LABEL);
+    uint8_T *sdi    = (uint8_T*) ssGetOutputPortSignal(S, OUT_SDI);
+    uint8_T *ssm    = (uint8_T*) ssGetOutputPortSignal(S, OUT_SSM);
+    int32_T *status = (int32_T*) ssGetOutputPortSignal(S, OUT_STATUS);
+
+    uint32_T word = u[0];
+
+    status[0] = arinc429_bcd_decode_word(word, &value[0]);
+    label[0] = arinc429_word_label(word);
+    sdi[0] = (uint8_T)arinc429_word_sdi(word);
+    ssm[0] = (uint8_T)arinc429_word_ssm(word);
+}
+
+/* Function: mdlTerminate =====================================================
+ * Abstract:
+ *    No termination needed.
+ */
+static void mdlTerminate(SimStruct *S)
+{
+}
+
+/* Required S-function trailer */
+#ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
+#include "simulink.c"      /* MEX-file interface mechanism */
+#else
+#include "cg_sfun.h"       /* Code generation registration function */
+#endif
@@ -0,0 +1,161 @@
+#define S_FUNCTION_NAME  arinc429_word_encoder
+#define S_FUNCTION_LEVEL 2
+
+#include "simstruc.h"
+#include "arinc429_bcd.h"
+#include "arinc429_word.h"
+
+/* Parameters: octal label (as a number, e.g. oct2dec(203)) and SDI (0-3) */
+#define LABEL_PARAM(S) ssGetSFcnParam(S, 0)
+#define SDI_PARAM(S)   ssGetSFcnParam(S, 1)
+#define NUM_PARAMS     2
+
+/* IWork: parameters cached at start so mdlOutputs does not touch mxArrays */
+#define IWORK_LABEL    0
+#define IWORK_SDI      1
+#define NUM_IWORK      2
+
+#define MDL_CHECK_PARAMETERS
+#if defined(MDL_CHECK_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Function: mdlCheckParameters ===============================================
+ * Abstract:
+ *    Validate the label (0-255) and SDI (0-3) dialog parameters.
+ */
+static void mdlCheckParameters(SimStruct *S)
+{
+    double label, sdi;
+
+    if (!mxIsDouble(LABEL_PARAM(S)) || mxGetNumberOfElements(LABEL_PARAM(S)) != 1) {
+        ssSetErrorStatus(S, "Label must be a scalar");
+        return;
+    }
+    if (!mxIsDouble(SDI_PARAM(S)) || mxGetNumberOfElements(SDI_PARAM(S)) != 1) {
+        ssSetErrorStatus(S, "SDI must be a scalar");
+        return;
+    }
+
+    label = mxGetScalar(LABEL_PARAM(S));
+    sdi = mxGetScalar(SDI_PARAM(S));
+    if (label < 0 || label > 255) {
+        ssSetErrorStatus(S, "Label must be in the range 0-255 (octal 000-377)");
+        return;
+    }
+    if (sdi < 0 || sdi > 3) {
+        ssSetErrorStatus(S, "SDI must be in the range 0-3");
+        return;
+    }
+}
+#endif
+
+/* Function: mdlInitializeSizes ===============================================
+ * Abstract:
+ *    The sizes information is used by Simulink to determine the S-function
+ *    block's characteristics (number of inputs, outputs, states, etc.).
+ */
+static void mdlInitializeSizes(SimStruct *S)
+{
+    /* Set number of expected parameters */
+    ssSetNumSFcnParams(S, NUM_PARAMS);
+#if defined(MATLAB_MEX_FILE)
+    if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
+        return; /* Parameter mismatch reported by Simulink */
+    }
+    mdlCheckParameters(S);
+    if (ssGetErrorStatus(S) != NULL) {
+        return;
+    }
+#endif
+    ssSetSFcnParamTunable(S, 0, 0);
+    ssSetSFcnParamTunable(S, 1, 0);
+
+    /* Set number of input and output ports */
+    if (!ssSetNumInputPorts(S, 1)) return;
+    if (!ssSetNumOutputPorts(S, 1)) return;
+
+    /* Configure input port - a single double representing decimal value */
+    ssSetInputPortWidth(S, 0, 1);
+    ssSetInputPortDataType(S, 0, SS_DOUBLE);
+    ssSetInputPortRequiredContiguous(S, 0, true);
+    ssSetInputPortDirectFeedThrough(S, 0, 1);
+
+    /* Configure output port - one packed 32-bit ARINC 429 word */
+    ssSetOutputPortWidth(S, 0, 1);
+    ssSetOutputPortDataType(S, 0, SS_UINT32);
+
+    /* Set sample times */
+    ssSetNumSampleTimes(S, 1);
+
+    /* Label and SDI cached in IWork */
+    ssSetNumRWork(S, 0);
+    ssSetNumIWork(S, NUM_IWORK);
+    ssSetNumPWork(S, 0);
+    ssSetNumModes(S, 0);
+    ssSetNumNonsampledZCs(S, 0);
+
+    /* Specify the operating point save/restore compliance to be same as a
+     * built-in block */
+    ssSetOperatingPointCompliance(S, USE_DEFAULT_OPERATING_POINT);
+
+    /* Set options */
+    ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
+}
+
+/* Function: mdlInitializeSampleTimes =========================================
+ * Abstract:
+ *    This function is used to specify the sample time(s) for your
+ *    S-function. You must register the same number of sample times as
+ *    specified in ssSetNumSampleTimes.
+ */
+static void mdlInitializeSampleTimes(SimStruct *S)
+{
+    ssSetSampleTime(S, 0, INHERITED_SAMPLE_TIME);
+    ssSetOffsetTime(S, 0, 0.0);
+    ssSetModelReferenceSampleTimeDefaultInheritance(S);
+}
+
+#define MDL_START
+#if defined(MDL_START)
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Cache the label and SDI parameters.
+ */
+static void mdlStart(SimStruct *S)
+{
+    int_T *iwork = ssGetIWork(S);
+
+    iwork[IWORK_LABEL] = (int_T)mxGetScalar(LABEL_PARAM(S));
+    iwork[IWORK_SDI] = (int_T)mxGetScalar(SDI_PARAM(S));
+}
+#endif
+
+/* Function: mdlOutputs =======================================================
+ * Abstract:
+ *    Encode a decimal value into a complete ARINC 429 BCD word: label
+ *    (bits 1-8, reversed), SDI (9-10), BCD data (11-29), SSM plus/minus
+ *    (30-31) and odd parity (32).
+ */
+static void mdlOutputs(SimStruct *S, int_T tid)
+{
+    /* Get input and output pointers */
+    const real_T *u = (const real_T*) ssGetInputPortSignal(S, 0);
+    uint32_T *y = (uint32_T*) ssGetOutputPortSignal(S, 0);
+
+    const int_T *iwork = ssGetIWork(S);
+
+    y[0] = arinc429_bcd_encode_word((uint8_T)iwork[IWORK_LABEL], (uint32_T)iwork[IWORK_SDI], u[0]);
+}
+
+/* Function: mdlTerminate =====================================================
+ * Abstract:
+ *    No termination needed.
+ */
+static void mdlTerminate(SimStruct *S)
+{
+}
+
+/* Required S-function trailer */
+#ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
+#include "simulink.c"      /* MEX-file interface mechanism */
+#else
+#include "cg_sfun.h"       /* Code generation registration function */
+#endif
@@ -2,6 +2,12 @@
 #define S_FUNCTION_LEVEL 2
 
 #include "simstruc.h"
+#include "arinc429_label.h"
+#include "arinc429_stats.h"
+
+/* IWork: istatistik blok kimliği (yalnızca -DARINC429_STATS=1 ile) */
+#define IWORK_STATS_ID 0
+#define NUM_IWORK      ARINC429_STATS
 
 /* mdlInitializeSizes: Giriş/Çıkış portlarının tanımı */
 static void mdlInitializeSizes(SimStruct *S)
@@ -16,6 +22,7 @@ static void mdlInitializeSizes(SimStruct *S)
     ssSetOutputPortDataType(S, 0, SS_UINT8);
 
     ssSetNumSampleTimes(S, 1);
+    ssSetNumIWork(S, NUM_IWORK);
 }
 
 /* Zamanlama */
@@ -25,25 +32,42 @@ static void mdlInitializeSampleTimes(SimStruct *S)
     ssSetOffsetTime(S, 0, 0.0);
 }
 
+#if ARINC429_STATS
+#define MDL_START
+/* Bloğu yolu ile istatistik kaydına ekle */
+static void mdlStart(SimStruct *S)
+{
+    ssGetIWork(S)[IWORK_STATS_ID] = arinc429_stats_register(ssGetPath(S));
+}
+#endif
+
 /* Çıkış Hesaplama */
 static void mdlOutputs(SimStruct *S, int_T tid)
 {
+    ARINC429_STATS_START(t0);
     InputUInt8PtrsType uPtrs = (InputUInt8PtrsType)ssGetInputPortSignalPtrs(S, 0);
     uint8_T label = *uPtrs[0];
 
     // ARINC 429 gereği label'ın LSB'si kelimenin MSB'sine gider (ters çevirme)
-    uint8_T label_flipped = 0;
-    for (int i = 0; i < 8; ++i)
-    {
-        label_flipped |= ((label >> i) & 0x01) << (7 - i);
-    }
+    uint8_T label_flipped = arinc429_label_reverse(label);
 
     uint8_T *y = (uint8_T *)ssGetOutputPortSignal(S, 0);
     y[0] = label_flipped;
+
+    ARINC429_STATS_STOP(ssGetIWork(S)[IWORK_STATS_ID], t0, 1);
 }
 
-/* Gerekli diğer fonksiyonlar */
-static void mdlTerminate(SimStruct *S) {}
+/* Gerekli diğer fonksiyonlar: istatistikler açıksa JSON olarak yazılır */
+static void mdlTerminate(SimStruct *S)
+{
+#if ARINC429_STATS
+    char line[ARINC429_STATS_LINE_LEN];
+
+    arinc429_stats_report(ssGetIWork(S)[IWORK_STATS_ID], line, sizeof(line));
+    ssPrintf("%s\n", line);
+    arinc429_stats_unregister(ssGetIWork(S)[IWORK_STATS_ID]);
+#endif
+}
 
 /* S-Function Makrosu */
 #ifdef MATLAB_MEX_FILE
@@ -0,0 +1,106 @@
+function build_sfunctions(trace, sqlite_dir, precision, stats)
+% BUILD_SFUNCTIONS - S-Function'ları libarinc429 çekirdeği ile birlikte derler
+% Derleme mantığı libarinc429/ altında; S-Function'lar sadece ince sarmalayıcıdır.
+%
+% build_sfunctions(true) BCD bloklarını iz (trace) kaydıyla derler: her örnek
+% ikili bir kayıt olarak halka tampona yazılır ve mdlTerminate'te yazdırılır.
+%
+% build_sfunctions(false, sqlite_dir) ayrıca trend_db_sink bloğunu derler;
+% sqlite_dir altında sqlite3.h ve sqlite3 kütüphanesi bulunmalıdır (pthreads gerekir).
+%
+% build_sfunctions(false, '', 'single') trend_dfa_sfunc_flight bloğunu float32,
+% 'fixed' ile Q formatlı sabit noktalı aritmetikle derler (varsayılan 'double').
+% Bu durumda bloğun portları single olur; kod üretiminde de aynı
+% TREND_DFA_SFUNC_PRECISION tanımı kullanılmalıdır.
+%
+% build_sfunctions(false, '', 'double', true) etiket, BCD ve trend DFA bloklarını
+% adım istatistikleriyle derler: her mdlOutputs çağrısının süresi bir gecikme
+% histogramına, DFA durum geçişleri, anomali adımları ve kırpılan kodlayıcı
+% girişleri sayaçlara yazılır. mdlTerminate'te p50/p99/p99.9 özeti yazdırılır ve
+% sonuçlar <blok yolu>.stats.json dosyasına (ARINC429_STATS_DIR ya da geçerli
+% dizin) kaydedilir.
+%
+% trend_decim_sfunc bloğu yüksek hızlı girişleri trend DFA'dan önce alçak geçiren
+% bir süzgeçten geçirip seyreltir: çıkışlar giriş örnekleme süresinin 'ratio'
+% katında üretilir ve DFA bu daha yavaş hızı devralır.
+%
+% Linux ve macOS'ta arinc429_shm_source bloğu da derlenir: canlı bir üreticiden
+% (arinc429_shm_feed, veri yolu yakalayıcı, ADS-B çözücü) paylaşımlı bellek
+% üzerinden kelime ya da uçuş örneği okur.
+
+    if nargin < 1
+        trace = false;
+    end
+    if nargin < 2
+        sqlite_dir = '';
+    end
+    if nargin < 3
+        precision = 'double';
+    end
+    if nargin < 4
+        stats = false;
+    end
+
+    lib_dir = fullfile(fileparts(mfilename('fullpath')), 'libarinc429');
+    inc = ['-I' lib_dir];
+    trace_def = sprintf('-DARINC429_TRACE=%d', trace);
+    stats_def = sprintf('-DARINC429_STATS=%d', stats);
+    precisions = {'double', 'single', 'fixed'};
+    precision = validatestring(precision, precisions, mfilename, 'precision', 3);
+    precision_def = sprintf('-DTREND_DFA_SFUNC_PRECISION=%d', ...
+        find(strcmp(precision, precisions)) - 1);
+
+    % İz ve istatistik kayıtları <stdatomic.h> kullanır; bu kaynaklar yalnızca
+    % ilgili seçenek açıkken bağlanır, böylece varsayılan derleme C11 atomikleri
+    % gerektirmez. MSVC'de atomikler Visual Studio 2022 17.5 ya da daha yeni bir
+    % sürüm ve /experimental:c11atomics bayrağı ister; bayrak aşağıda eklenir.
+    stats_src = {};
+    if stats
+        stats_src = {fullfile(lib_dir, 'arinc429_stats.c')};
+    end
+    trace_src = {};
+    if trace
+        trace_src = {fullfile(lib_dir, 'arinc429_trace.c')};
+    end
+    atomic_flags = {};
+    cc = mex.getCompilerConfigurations('C', 'Selected');
+    if (trace || stats) && ~isempty(cc) && startsWith(cc.ShortName, 'MSVC')
+        atomic_flags = {'COMPFLAGS=$COMPFLAGS /std:c11 /experimental:c11atomics'};
+    end
+
+    mex(inc, atomic_flags{:}, stats_def, 'arinc_label_sfunction.c', ...
+        fullfile(lib_dir, 'arinc429_label.c'), stats_src{:});
+    mex(inc, atomic_flags{:}, trace_def, stats_def, 'arinc429_bcd_to_decimal.c', ...
+        fullfile(lib_dir, 'arinc429_bcd.c'), trace_src{:}, stats_src{:});
+    mex(inc, atomic_flags{:}, trace_def, stats_def, 'arinc429_decimal_to_bcd.c', ...
+        fullfile(lib_dir, 'arinc429_bcd.c'), trace_src{:}, stats_src{:});
+    mex(inc, 'arinc429_word_encoder.c', fullfile(lib_dir, 'arinc429_bcd.c'), ...
+        fullfile(lib_dir, 'arinc429_label.c'));
+    mex(inc, 'arinc429_word_decoder.c', fullfile(lib_dir, 'arinc429_bcd.c'), ...
+        fullfile(lib_dir, 'arinc429_label.c'));
+    mex(inc, atomic_flags{:}, precision_def, stats_def, 'trend_dfa_sfunc_flight.c', ...
+        fullfile(lib_dir, 'trend_dfa.c'), fullfile(lib_dir, 'trend_window.c'), ...
+        fullfile(lib_dir, 'trend_dfa_multi.c'), fullfile(lib_dir, 'trend_dfa_table.c'), ...
+        fullfile(lib_dir, 'trend_dfa_f32.c'), fullfile(lib_dir, 'trend_dfa_q.c'), stats_src{:});
+    mex(inc, 'trend_decim_sfunc.c', fullfile(lib_dir, 'trend_decim.c'));
+    mex(inc, 'flight_rec_writer.c', fullfile(lib_dir, 'flight_rec.c'));
+    mex(inc, 'arinc429_receiver.c', fullfile(lib_dir, 'arinc429_rx.c'), ...
+        fullfile(lib_dir, 'arinc429_bcd.c'), fullfile(lib_dir, 'arinc429_label.c'));
+
+    % Canlı veri köprüsü: POSIX paylaşımlı bellek halkası (Windows'ta yok)
+    if isunix
+        rt = {};
+        if ~ismac
+            rt = {'-lrt'};
+        end
+        mex(inc, rt{:}, 'arinc429_shm_source.c', fullfile(lib_dir, 'arinc429_shm.c'));
+    end
+
+    if ~isempty(sqlite_dir)
+        mex(inc, ['-I' sqlite_dir], ['-L' sqlite_dir], '-lsqlite3', '-lpthread', ...
+            'trend_db_sink.c', fullfile(lib_dir, 'arinc_db_sink.c'), ...
+            fullfile(lib_dir, 'arinc_db.c'));
+    end
+
+    fprintf('S-Function derlemesi tamamlandı.\n');
+end
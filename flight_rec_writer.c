@@ -0,0 +1,203 @@
+#define S_FUNCTION_NAME  flight_rec_writer
+#define S_FUNCTION_LEVEL 2
+
+#include "simstruc.h"
+#include <stdlib.h>
+#include "flight_rec.h"
+
+/* Records the five flight inputs and the trend DFA outputs (wire them from
+ * trend_dfa_sfunc_flight) into a columnar flight_rec file, one row per
+ * sample, stamped with the simulation time. */
+
+/* Parameters: file name (char array) and append flag (0 = overwrite) */
+#define FILE_PARAM(S)   ssGetSFcnParam(S, 0)
+#define APPEND_PARAM(S) ssGetSFcnParam(S, 1)
+#define NUM_PARAMS      2
+
+/* Input ports: velocity, baroaltitude, lat, lon, vertrate, state,
+ * confidence, trends (6) */
+#define IN_STATE        TREND_DFA_NUM_CHANNELS
+#define IN_CONFIDENCE   (IN_STATE + 1)
+#define IN_TRENDS       (IN_STATE + 2)
+#define NUM_INPUTS      (IN_STATE + 3)
+
+#define FILE_NAME_LEN   1024
+
+/* PWork: the open writer */
+#define PWORK_WRITER    0
+#define NUM_PWORK       1
+
+#define MDL_CHECK_PARAMETERS
+#if defined(MDL_CHECK_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Function: mdlCheckParameters ===============================================
+ * Abstract:
+ *    The file name must be a non-empty string, the append flag a scalar.
+ */
+static void mdlCheckParameters(SimStruct *S)
+{
+    if (!mxIsChar(FILE_PARAM(S)) || mxIsEmpty(FILE_PARAM(S))) {
+        ssSetErrorStatus(S, "File name must be a non-empty string");
+        return;
+    }
+    if (!mxIsDouble(APPEND_PARAM(S)) || mxGetNumberOfElements(APPEND_PARAM(S)) != 1) {
+        ssSetErrorStatus(S, "Append flag must be a scalar (0 or 1)");
+        return;
+    }
+}
+#endif
+
+/* Function: mdlInitializeSizes ===============================================
+ * Abstract:
+ *    The sizes information is used by Simulink to determine the S-function
+ *    block's characteristics (number of inputs, outputs, states, etc.).
+ */
+static void mdlInitializeSizes(SimStruct *S)
+{
+    int i;
+
+    /* Set number of expected parameters */
+    ssSetNumSFcnParams(S, NUM_PARAMS);
+#if defined(MATLAB_MEX_FILE)
+    if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
+        return; /* Parameter mismatch reported by Simulink */
+    }
+    mdlCheckParameters(S);
+    if (ssGetErrorStatus(S) != NULL) {
+        return;
+    }
+#endif
+    ssSetSFcnParamTunable(S, 0, 0);
+    ssSetSFcnParamTunable(S, 1, 0);
+
+    /* Set number of input and output ports */
+    if (!ssSetNumInputPorts(S, NUM_INPUTS)) return;
+    if (!ssSetNumOutputPorts(S, 0)) return;
+
+    for (i = 0; i < NUM_INPUTS; i++) {
+        ssSetInputPortWidth(S, i, i == IN_TRENDS ? TREND_DFA_NUM_TRENDS : 1);
+        ssSetInputPortDataType(S, i, SS_DOUBLE);
+        ssSetInputPortRequiredContiguous(S, i, true);
+        ssSetInputPortDirectFeedThrough(S, i, 1);
+    }
+
+    /* Set sample times */
+    ssSetNumSampleTimes(S, 1);
+
+    /* Writer handle in PWork */
+    ssSetNumRWork(S, 0);
+    ssSetNumIWork(S, 0);
+    ssSetNumPWork(S, NUM_PWORK);
+    ssSetNumModes(S, 0);
+    ssSetNumNonsampledZCs(S, 0);
+
+    /* Set options */
+    ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
+}
+
+/* Function: mdlInitializeSampleTimes =========================================
+ * Abstract:
+ *    This function is used to specify the sample time(s) for your
+ *    S-function. You must register the same number of sample times as
+ *    specified in ssSetNumSampleTimes.
+ */
+static void mdlInitializeSampleTimes(SimStruct *S)
+{
+    ssSetSampleTime(S, 0, INHERITED_SAMPLE_TIME);
+    ssSetOffsetTime(S, 0, 0.0);
+    ssSetModelReferenceSampleTimeDefaultInheritance(S);
+}
+
+#define MDL_START
+#if defined(MDL_START)
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Create the recording, or reopen it for appending.
+ */
+static void mdlStart(SimStruct *S)
+{
+    char path[FILE_NAME_LEN];
+    flight_rec_writer_t *w;
+    int rc;
+
+    ssGetPWork(S)[PWORK_WRITER] = NULL;
+
+    if (mxGetString(FILE_PARAM(S), path, sizeof(path)) != 0) {
+        ssSetErrorStatus(S, "File name too long");
+        return;
+    }
+
+    w = (flight_rec_writer_t *)malloc(sizeof(*w));
+    if (w == NULL) {
+        ssSetErrorStatus(S, "Out of memory");
+        return;
+    }
+
+    if (mxGetScalar(APPEND_PARAM(S)) != 0.0) {
+        rc = flight_rec_open_append(w, path);
+    } else {
+        rc = flight_rec_create(w, path, 0);
+    }
+    if (rc != 0) {
+        free(w);
+        ssSetErrorStatus(S, "Cannot open recording file");
+        return;
+    }
+
+    ssGetPWork(S)[PWORK_WRITER] = w;
+}
+#endif
+
+/* Function: mdlOutputs =======================================================
+ * Abstract:
+ *    Append one row stamped with the current simulation time. In a
+ *    continuous context only major time steps are recorded; minor steps are
+ *    solver trial points and may go back in time after a rejected step.
+ */
+static void mdlOutputs(SimStruct *S, int_T tid)
+{
+    flight_rec_writer_t *w = (flight_rec_writer_t *)ssGetPWork(S)[PWORK_WRITER];
+    double input[TREND_DFA_NUM_CHANNELS];
+    trend_dfa_output_t out;
+    const real_T *trends;
+    int i;
+
+    if (w == NULL || !ssIsMajorTimeStep(S)) {
+        return;
+    }
+
+    for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+        input[i] = ((const real_T *)ssGetInputPortSignal(S, i))[0];
+    }
+    out.state = (int)((const real_T *)ssGetInputPortSignal(S, IN_STATE))[0];
+    out.confidence = ((const real_T *)ssGetInputPortSignal(S, IN_CONFIDENCE))[0];
+    trends = (const real_T *)ssGetInputPortSignal(S, IN_TRENDS);
+    for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+        out.trends[i] = trends[i];
+    }
+
+    if (flight_rec_append(w, ssGetT(S), input, &out) != 0) {
+        ssSetErrorStatus(S, "Writing the recording failed");
+    }
+}
+
+/* Function: mdlTerminate =====================================================
+ * Abstract:
+ *    Write the last partial chunk and close the file.
+ */
+static void mdlTerminate(SimStruct *S)
+{
+    flight_rec_writer_t *w = (flight_rec_writer_t *)ssGetPWork(S)[PWORK_WRITER];
+
+    if (w != NULL) {
+        flight_rec_close(w);
+        free(w);
+        ssGetPWork(S)[PWORK_WRITER] = NULL;
+    }
+}
+
+/* Required S-function trailer */
+#ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
+#include "simulink.c"      /* MEX-file interface mechanism */
+#else
+#include "cg_sfun.h"       /* Code generation registration function */
+#endif
@@ -0,0 +1,172 @@
+/* arinc429_bcd.c - ARINC 429 BCD data field codec
+ *
+ * BCD Character 1: 3 bits (0-7)
+ * BCD Characters 2-5: 4 bits each (0-9)
+ */
+
+#include "arinc429_bcd.h"
+#include "arinc429_word.h"
+
+#include <stddef.h>
+
+double arinc429_bcd_decode_bits(const uint8_t *u, int *digits)
+{
+    /* Per the spec: 3-4-4-4-4 pattern from MSB to LSB */
+
+    /* BCD Character #1 (MSB, 3 bits) */
+    int bcd1 = (u[0] << 2) | (u[1] << 1) | u[2];
+
+    /* BCD Character #2 (4 bits) */
+    int bcd2 = (u[3] << 3) | (u[4] << 2) | (u[5] << 1) | u[6];
+
+    /* BCD Character #3 (4 bits) */
+    int bcd3 = (u[7] << 3) | (u[8] << 2) | (u[9] << 1) | u[10];
+
+    /* BCD Character #4 (4 bits) */
+    int bcd4 = (u[11] << 3) | (u[12] << 2) | (u[13] << 1) | u[14];
+
+    /* BCD Character #5 (LSB, 4 bits) */
+    int bcd5 = (u[15] << 3) | (u[16] << 2) | (u[17] << 1) | u[18];
+
+    if (digits != NULL) {
+        digits[0] = bcd1;
+        digits[1] = bcd2;
+        digits[2] = bcd3;
+        digits[3] = bcd4;
+        digits[4] = bcd5;
+    }
+
+    /* Combine digits to form decimal value */
+    return bcd5 + bcd4*10 + bcd3*100 + bcd2*1000 + bcd1*10000;
+}
+
+void arinc429_bcd_encode_bits(double decimal_value, uint8_t *y, int *digits)
+{
+    int bcd1, bcd2, bcd3, bcd4, bcd5;
+
+    /* Ensure value is in valid range (0-99999) */
+    if (decimal_value < ARINC429_BCD_MIN_VALUE) decimal_value = ARINC429_BCD_MIN_VALUE;
+    if (decimal_value > ARINC429_BCD_MAX_VALUE) decimal_value = ARINC429_BCD_MAX_VALUE;
+
+    /* Extract BCD digits */
+    bcd1 = (int)(decimal_value / 10000) % 10;    /* 10000's place */
+    bcd2 = (int)(decimal_value / 1000) % 10;     /* 1000's place */
+    bcd3 = (int)(decimal_value / 100) % 10;      /* 100's place */
+    bcd4 = (int)(decimal_value / 10) % 10;       /* 10's place */
+    bcd5 = (int)(decimal_value) % 10;            /* 1's place */
+
+    if (digits != NULL) {
+        digits[0] = bcd1;
+        digits[1] = bcd2;
+        digits[2] = bcd3;
+        digits[3] = bcd4;
+        digits[4] = bcd5;
+    }
+
+    /* Encode BCD Character #1 (MSB, 3 bits) - bits 0-2 */
+    y[0] = (bcd1 >> 2) & 0x01;
+    y[1] = (bcd1 >> 1) & 0x01;
+    y[2] = bcd1 & 0x01;
+
+    /* Encode BCD Character #2 (4 bits) - bits 3-6 */
+    y[3] = (bcd2 >> 3) & 0x01;
+    y[4] = (bcd2 >> 2) & 0x01;
+    y[5] = (bcd2 >> 1) & 0x01;
+    y[6] = bcd2 & 0x01;
+
+    /* Encode BCD Character #3 (4 bits) - bits 7-10 */
+    y[7] = (bcd3 >> 3) & 0x01;
+    y[8] = (bcd3 >> 2) & 0x01;
+    y[9] = (bcd3 >> 1) & 0x01;
+    y[10] = bcd3 & 0x01;
+
+    /* Encode BCD Character #4 (4 bits) - bits 11-14 */
+    y[11] = (bcd4 >> 3) & 0x01;
+    y[12] = (bcd4 >> 2) & 0x01;
+    y[13] = (bcd4 >> 1) & 0x01;
+    y[14] = bcd4 & 0x01;
+
+    /* Encode BCD Character #5 (LSB, 4 bits) - bits 15-18 */
+    y[15] = (bcd5 >> 3) & 0x01;
+    y[16] = (bcd5 >> 2) & 0x01;
+    y[17] = (bcd5 >> 1) & 0x01;
+    y[18] = bcd5 & 0x01;
+}
+
+int arinc429_bcd_decode_field(uint32_t field, double *value, int *digits)
+{
+    uint32_t bcd1 = (field >> 16) & 0x7u;
+    uint32_t bcd2 = (field >> 12) & 0xFu;
+    uint32_t bcd3 = (field >> 8) & 0xFu;
+    uint32_t bcd4 = (field >> 4) & 0xFu;
+    uint32_t bcd5 = field & 0xFu;
+
+    if (digits != NULL) {
+        digits[0] = (int)bcd1;
+        digits[1] = (int)bcd2;
+        digits[2] = (int)bcd3;
+        digits[3] = (int)bcd4;
+        digits[4] = (int)bcd5;
+    }
+
+    *value = (double)(bcd5 + bcd4*10 + bcd3*100 + bcd2*1000 + bcd1*10000);
+
+    /* Characters 2-5 must be 0-9; character 1 cannot exceed 7 by width */
+    if (bcd2 > 9 || bcd3 > 9 || bcd4 > 9 || bcd5 > 9) {
+        return ARINC429_ERR_BCD_DIGIT;
+    }
+    return ARINC429_OK;
+}
+
+uint32_t arinc429_bcd_encode_field(double decimal_value, int *digits)
+{
+    uint32_t v, bcd1, bcd2, bcd3, bcd4, bcd5;
+
+    /* Negated test so NaN also clamps to 0 */
+    if (!(decimal_value >= ARINC429_BCD_MIN_VALUE)) decimal_value = ARINC429_BCD_MIN_VALUE;
+    if (decimal_value > ARINC429_BCD_FIELD_MAX_VALUE) decimal_value = ARINC429_BCD_FIELD_MAX_VALUE;
+
+    /* Truncating first and dividing as integers gives the same digits as the
+     * double divisions of arinc429_bcd_encode_bits for non-negative values */
+    v = (uint32_t)decimal_value;
+    bcd5 = v % 10; v /= 10;
+    bcd4 = v % 10; v /= 10;
+    bcd3 = v % 10; v /= 10;
+    bcd2 = v % 10; v /= 10;
+    bcd1 = v % 10;
+
+    if (digits != NULL) {
+        digits[0] = (int)bcd1;
+        digits[1] = (int)bcd2;
+        digits[2] = (int)bcd3;
+        digits[3] = (int)bcd4;
+        digits[4] = (int)bcd5;
+    }
+
+    return (bcd1 << 16) | (bcd2 << 12) | (bcd3 << 8) | (bcd4 << 4) | bcd5;
+}
+
+uint32_t arinc429_bcd_encode_word(uint8_t label, uint32_t sdi, double value)
+{
+    uint32_t ssm = ARINC429_SSM_BCD_PLUS;
+
+    if (value < 0.0) {
+        ssm = ARINC429_SSM_BCD_MINUS;
+        value = -value;
+    }
+
+    return arinc429_word_pack(label, sdi, arinc429_bcd_encode_field(value, NULL), ssm);
+}
+
+int arinc429_bcd_decode_word(uint32_t word, double *value)
+{
+    int status = arinc429_bcd_decode_field(arinc429_word_data(word), value, NULL);
+
+    if (arinc429_word_ssm(word) == ARINC429_SSM_BCD_MINUS) {
+        *value = 0.0 - *value;   /* minus zero decodes as +0 */
+    }
+    if (!arinc429_word_parity_ok(word)) {
+        return ARINC429_ERR_PARITY;
+    }
+    return status;
+}
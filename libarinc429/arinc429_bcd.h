@@ -0,0 +1,74 @@
+/* arinc429_bcd.h - ARINC 429 BCD data field codec (3-4-4-4-4 digit layout) */
+
+#ifndef ARINC429_BCD_H
+#define ARINC429_BCD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of data bits in the BCD field (ARINC word bits 11-29) */
+#define ARINC429_BCD_NUM_BITS   19
+#define ARINC429_BCD_NUM_DIGITS 5
+
+/* Encodable range of the 3-4-4-4-4 layout as used by the model. The bit-array
+ * codec clamps to 99999 and keeps only the low 3 bits of character #1, so
+ * 80000-99999 wrap; the packed field/word codec clamps to the real maximum. */
+#define ARINC429_BCD_MIN_VALUE        0.0
+#define ARINC429_BCD_MAX_VALUE        99999.0
+#define ARINC429_BCD_FIELD_MAX_VALUE  79999.0
+
+/* Function: arinc429_bcd_decode_bits =========================================
+ * Abstract:
+ *    Decode a 19-element bit array (one bit per byte, bits[0] is the MSB of
+ *    BCD character #1) into its decimal value. If digits is not NULL the five
+ *    extracted BCD characters are stored there, MSB first.
+ */
+double arinc429_bcd_decode_bits(const uint8_t *bits, int *digits);
+
+/* Function: arinc429_bcd_encode_bits =========================================
+ * Abstract:
+ *    Clamp value to 0-99999 and encode it into a 19-element bit array using
+ *    the same layout arinc429_bcd_decode_bits expects. If digits is not NULL
+ *    the five BCD characters are stored there, MSB first.
+ */
+void arinc429_bcd_encode_bits(double value, uint8_t *bits, int *digits);
+
+/* Function: arinc429_bcd_decode_field =======================================
+ * Abstract:
+ *    Decode the 19-bit data field of a packed word (ARINC bits 11-29, BCD
+ *    character #1 in the top 3 bits) with mask/shift extraction. digits may
+ *    be NULL. Returns ARINC429_ERR_BCD_DIGIT if a character is above 9,
+ *    ARINC429_OK otherwise; *value is written in both cases.
+ */
+int arinc429_bcd_decode_field(uint32_t field, double *value, int *digits);
+
+/* Function: arinc429_bcd_encode_field =======================================
+ * Abstract:
+ *    Clamp value to 0-79999 and return the 19-bit BCD data field.
+ */
+uint32_t arinc429_bcd_encode_field(double value, int *digits);
+
+/* Function: arinc429_bcd_encode_word ========================================
+ * Abstract:
+ *    Build a complete BCD word: label, SDI, |value| clamped to 0-79999 in the
+ *    data field, SSM plus/minus from the sign of value, and odd parity.
+ */
+uint32_t arinc429_bcd_encode_word(uint8_t label, uint32_t sdi, double value);
+
+/* Function: arinc429_bcd_decode_word ========================================
+ * Abstract:
+ *    Decode the data field of a BCD word, negated when the SSM says minus.
+ *    Returns ARINC429_ERR_PARITY on a parity error (checked first), then
+ *    ARINC429_ERR_BCD_DIGIT for an invalid character, else ARINC429_OK.
+ *    Label, SDI and SSM are read with the arinc429_word_* accessors.
+ */
+int arinc429_bcd_decode_word(uint32_t word, double *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_BCD_H */
@@ -0,0 +1,459 @@
+/* arinc429_bcd_batch.c - Batch BCD word encode/decode (scalar, SSE4.1, AVX2)
+ *
+ * Decode converts the five BCD characters to binary in two multiply-add steps
+ * instead of five: adjacent nibbles are first merged into bytes
+ * (lo + 10 * hi), then the three bytes into the value (b0 + 100 * b1 +
+ * 10000 * b2). No byte exceeds 15 * 10 + 15, so nothing carries between them
+ * even for invalid characters. Characters 2-5 are validated at once by adding
+ * 6 to every nibble: any carry out of a nibble means a character above 9.
+ *
+ * Encode divides by 10 with a multiply and shift ((v * 52429) >> 19), which
+ * is exact for the clamped range 0-79999.
+ */
+
+#include "arinc429_bcd_batch.h"
+#include "arinc429_bcd.h"
+#include "arinc429_word.h"
+
+#include <stdatomic.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ARINC429_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define ARINC429_HAVE_X86_SIMD 0
+#endif
+
+#define BCD_NIBBLE_PAIRS   0x0F0F0Fu
+#define BCD_LOW_DIGITS     0xFFFFu     /* characters 2-5 */
+#define BCD_ADD_SIX        0x6666u
+#define BCD_NIBBLE_CARRIES 0x11110u
+#define DIV10_MUL          52429u
+#define DIV10_SHIFT        19
+
+typedef size_t (*decode_fn)(const uint32_t *, double *, int8_t *, size_t);
+typedef void (*encode_fn)(const double *, uint32_t *, size_t, uint32_t);
+
+/* ------------------------------------------------------------------------ */
+/* Scalar kernels (also used for the tails of the vector kernels)           */
+/* ------------------------------------------------------------------------ */
+
+static inline int8_t decode_one(uint32_t w, double *value)
+{
+    uint32_t f = (w >> ARINC429_DATA_SHIFT) & ARINC429_DATA_MASK;
+    uint32_t b = (f & BCD_NIBBLE_PAIRS) + ((f >> 4) & BCD_NIBBLE_PAIRS) * 10u;
+    int32_t v = (int32_t)((b & 0xFFu) + ((b >> 8) & 0xFFu) * 100u + (b >> 16) * 10000u);
+    int32_t neg = -(int32_t)(((w >> ARINC429_SSM_SHIFT) & ARINC429_SSM_MASK) == ARINC429_SSM_BCD_MINUS);
+    uint32_t lo = f & BCD_LOW_DIGITS;
+
+    *value = (double)((v ^ neg) - neg);
+
+    if (!arinc429_word_parity_ok(w)) {
+        return ARINC429_ERR_PARITY;
+    }
+    if ((((lo + BCD_ADD_SIX) ^ lo ^ BCD_ADD_SIX) & BCD_NIBBLE_CARRIES) != 0) {
+        return ARINC429_ERR_BCD_DIGIT;
+    }
+    return ARINC429_OK;
+}
+
+static inline uint32_t encode_one(double value, uint32_t base)
+{
+    uint32_t ssm = 0, v, q1, q2, q3, q4, field, word;
+
+    if (value < 0.0) {
+        ssm = ARINC429_SSM_BCD_MINUS << ARINC429_SSM_SHIFT;
+        value = -value;
+    }
+    if (!(value >= ARINC429_BCD_MIN_VALUE)) value = ARINC429_BCD_MIN_VALUE;
+    if (value > ARINC429_BCD_FIELD_MAX_VALUE) value = ARINC429_BCD_FIELD_MAX_VALUE;
+
+    v = (uint32_t)value;
+    q1 = (v * DIV10_MUL) >> DIV10_SHIFT;
+    q2 = (q1 * DIV10_MUL) >> DIV10_SHIFT;
+    q3 = (q2 * DIV10_MUL) >> DIV10_SHIFT;
+    q4 = (q3 * DIV10_MUL) >> DIV10_SHIFT;
+    field = (q4 << 16) | ((q3 - q4 * 10u) << 12) | ((q2 - q3 * 10u) << 8) |
+            ((q1 - q2 * 10u) << 4) | (v - q1 * 10u);
+
+    word = base | (field << ARINC429_DATA_SHIFT) | ssm;
+    return word | arinc429_parity_bit(word);
+}
+
+static size_t decode_words_scalar(const uint32_t *words, double *values, int8_t *status, size_t n)
+{
+    size_t i, errors = 0;
+
+    for (i = 0; i < n; i++) {
+        int8_t st = decode_one(words[i], &values[i]);
+        errors += (st != ARINC429_OK);
+        if (status != NULL) {
+            status[i] = st;
+        }
+    }
+    return errors;
+}
+
+static void encode_words_scalar(const double *values, uint32_t *words, size_t n, uint32_t base)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        words[i] = encode_one(values[i], base);
+    }
+}
+
+#if ARINC429_HAVE_X86_SIMD
+
+/* ------------------------------------------------------------------------ */
+/* AVX2 kernels: 8 words per iteration                                      */
+/* ------------------------------------------------------------------------ */
+
+__attribute__((target("avx2")))
+static inline __m256i parity_fold_avx2(__m256i w)
+{
+    __m256i p = _mm256_xor_si256(w, _mm256_srli_epi32(w, 16));
+    p = _mm256_xor_si256(p, _mm256_srli_epi32(p, 8));
+    p = _mm256_xor_si256(p, _mm256_srli_epi32(p, 4));
+    p = _mm256_xor_si256(p, _mm256_srli_epi32(p, 2));
+    p = _mm256_xor_si256(p, _mm256_srli_epi32(p, 1));
+    return _mm256_and_si256(p, _mm256_set1_epi32(1));
+}
+
+__attribute__((target("avx2")))
+static size_t decode_words_avx2(const uint32_t *words, double *values, int8_t *status, size_t n)
+{
+    const __m256i data_mask = _mm256_set1_epi32((int)ARINC429_DATA_MASK);
+    const __m256i pairs     = _mm256_set1_epi32((int)BCD_NIBBLE_PAIRS);
+    const __m256i byte_mask = _mm256_set1_epi32(0xFF);
+    const __m256i low_mask  = _mm256_set1_epi32((int)BCD_LOW_DIGITS);
+    const __m256i add_six   = _mm256_set1_epi32((int)BCD_ADD_SIX);
+    const __m256i carries   = _mm256_set1_epi32((int)BCD_NIBBLE_CARRIES);
+    const __m256i ssm_mask  = _mm256_set1_epi32((int)ARINC429_SSM_MASK);
+    const __m256i ssm_minus = _mm256_set1_epi32((int)ARINC429_SSM_BCD_MINUS);
+    const __m256i ten       = _mm256_set1_epi32(10);
+    const __m256i hundred   = _mm256_set1_epi32(100);
+    const __m256i ten_k     = _mm256_set1_epi32(10000);
+    const __m256i zero      = _mm256_setzero_si256();
+    const __m256i err_digit = _mm256_set1_epi32(ARINC429_ERR_BCD_DIGIT);
+    const __m256i err_par   = _mm256_set1_epi32(ARINC429_ERR_PARITY);
+    size_t i, errors = 0;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256i w = _mm256_loadu_si256((const __m256i *)(words + i));
+        __m256i f = _mm256_and_si256(_mm256_srli_epi32(w, ARINC429_DATA_SHIFT), data_mask);
+        __m256i b, v, neg, lo, c, digit_bad, parity_bad, bad;
+
+        /* Nibble pairs to bytes, bytes to binary */
+        b = _mm256_add_epi32(_mm256_and_si256(f, pairs),
+                             _mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(f, 4), pairs), ten));
+        v = _mm256_add_epi32(_mm256_and_si256(b, byte_mask),
+                             _mm256_mullo_epi32(_mm256_and_si256(_mm256_srli_epi32(b, 8), byte_mask), hundred));
+        v = _mm256_add_epi32(v, _mm256_mullo_epi32(_mm256_srli_epi32(b, 16), ten_k));
+
+        /* SSM minus: two's complement negate */
+        neg = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_srli_epi32(w, ARINC429_SSM_SHIFT), ssm_mask), ssm_minus);
+        v = _mm256_sub_epi32(_mm256_xor_si256(v, neg), neg);
+
+        _mm256_storeu_pd(values + i, _mm256_cvtepi32_pd(_mm256_castsi256_si128(v)));
+        _mm256_storeu_pd(values + i + 4, _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)));
+
+        /* Characters 2-5 above 9 carry out of their nibble when 6 is added */
+        lo = _mm256_and_si256(f, low_mask);
+        c = _mm256_and_si256(_mm256_xor_si256(_mm256_xor_si256(_mm256_add_epi32(lo, add_six), lo), add_six), carries);
+        digit_bad = _mm256_xor_si256(_mm256_cmpeq_epi32(c, zero), _mm256_cmpeq_epi32(zero, zero));
+        parity_bad = _mm256_cmpeq_epi32(parity_fold_avx2(w), zero);
+
+        bad = _mm256_or_si256(digit_bad, parity_bad);
+        errors += (size_t)__builtin_popcount((unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(bad)));
+
+        if (status != NULL) {
+            __m256i st = _mm256_blendv_epi8(_mm256_and_si256(digit_bad, err_digit), err_par, parity_bad);
+            __m128i s16 = _mm_packs_epi32(_mm256_castsi256_si128(st), _mm256_extracti128_si256(st, 1));
+            _mm_storel_epi64((__m128i *)(status + i), _mm_packs_epi16(s16, s16));
+        }
+    }
+
+    return errors + decode_words_scalar(words + i, values + i, status ? status + i : NULL, n - i);
+}
+
+/* Four doubles to four int32 lanes: -1 where value < 0, else 0 */
+__attribute__((target("avx2")))
+static inline __m128i negative_lanes_avx2(__m256d a)
+{
+    __m256d lt = _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_LT_OQ);
+    return _mm256_cvttpd_epi32(_mm256_and_pd(lt, _mm256_set1_pd(-1.0)));
+}
+
+/* Four doubles to |value| clamped to 0-79999 (NaN -> 0), truncated */
+__attribute__((target("avx2")))
+static inline __m128i clamp_truncate_avx2(__m256d a)
+{
+    const __m256d sign = _mm256_set1_pd(-0.0);
+    __m256d m = _mm256_andnot_pd(sign, a);
+    m = _mm256_max_pd(m, _mm256_setzero_pd());   /* NaN -> second operand */
+    m = _mm256_min_pd(m, _mm256_set1_pd(ARINC429_BCD_FIELD_MAX_VALUE));
+    return _mm256_cvttpd_epi32(m);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i div10_avx2(__m256i v)
+{
+    return _mm256_srli_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32((int)DIV10_MUL)), DIV10_SHIFT);
+}
+
+__attribute__((target("avx2")))
+static void encode_words_avx2(const double *values, uint32_t *words, size_t n, uint32_t base)
+{
+    const __m256i base_v    = _mm256_set1_epi32((int)base);
+    const __m256i ssm_minus = _mm256_set1_epi32((int)(ARINC429_SSM_BCD_MINUS << ARINC429_SSM_SHIFT));
+    const __m256i ten       = _mm256_set1_epi32(10);
+    const __m256i one       = _mm256_set1_epi32(1);
+    size_t i;
+
+    for (i = 0; i + 8 <= n; i += 8) {
+        __m256d a0 = _mm256_loadu_pd(values + i);
+        __m256d a1 = _mm256_loadu_pd(values + i + 4);
+        __m256i neg = _mm256_inserti128_si256(_mm256_castsi128_si256(negative_lanes_avx2(a0)),
+                                              negative_lanes_avx2(a1), 1);
+        __m256i v   = _mm256_inserti128_si256(_mm256_castsi128_si256(clamp_truncate_avx2(a0)),
+                                              clamp_truncate_avx2(a1), 1);
+        __m256i q1 = div10_avx2(v);
+        __m256i q2 = div10_avx2(q1);
+        __m256i q3 = div10_avx2(q2);
+        __m256i q4 = div10_avx2(q3);
+        __m256i field, word;
+
+        field = _mm256_slli_epi32(q4, 16);
+        field = _mm256_or_si256(field, _mm256_slli_epi32(_mm256_sub_epi32(q3, _mm256_mullo_epi32(q4, ten)), 12));
+        field = _mm256_or_si256(field, _mm256_slli_epi32(_mm256_sub_epi32(q2, _mm256_mullo_epi32(q3, ten)), 8));
+        field = _mm256_or_si256(field, _mm256_slli_epi32(_mm256_sub_epi32(q1, _mm256_mullo_epi32(q2, ten)), 4));
+        field = _mm256_or_si256(field, _mm256_sub_epi32(v, _mm256_mullo_epi32(q1, ten)));
+
+        word = _mm256_or_si256(base_v, _mm256_slli_epi32(field, ARINC429_DATA_SHIFT));
+        word = _mm256_or_si256(word, _mm256_and_si256(neg, ssm_minus));
+
+        /* Set bit 32 when the other 31 bits hold an even number of ones */
+        word = _mm256_or_si256(word, _mm256_slli_epi32(_mm256_xor_si256(parity_fold_avx2(word), one), 31));
+
+        _mm256_storeu_si256((__m256i *)(words + i), word);
+    }
+
+    encode_words_scalar(values + i, words + i, n - i, base);
+}
+
+/* ------------------------------------------------------------------------ */
+/* SSE4.1 kernels: 4 words per iteration                                    */
+/* ------------------------------------------------------------------------ */
+
+__attribute__((target("sse4.1")))
+static inline __m128i parity_fold_sse41(__m128i w)
+{
+    __m128i p = _mm_xor_si128(w, _mm_srli_epi32(w, 16));
+    p = _mm_xor_si128(p, _mm_srli_epi32(p, 8));
+    p = _mm_xor_si128(p, _mm_srli_epi32(p, 4));
+    p = _mm_xor_si128(p, _mm_srli_epi32(p, 2));
+    p = _mm_xor_si128(p, _mm_srli_epi32(p, 1));
+    return _mm_and_si128(p, _mm_set1_epi32(1));
+}
+
+__attribute__((target("sse4.1")))
+static size_t decode_words_sse41(const uint32_t *words, double *values, int8_t *status, size_t n)
+{
+    const __m128i data_mask = _mm_set1_epi32((int)ARINC429_DATA_MASK);
+    const __m128i pairs     = _mm_set1_epi32((int)BCD_NIBBLE_PAIRS);
+    const __m128i byte_mask = _mm_set1_epi32(0xFF);
+    const __m128i low_mask  = _mm_set1_epi32((int)BCD_LOW_DIGITS);
+    const __m128i add_six   = _mm_set1_epi32((int)BCD_ADD_SIX);
+    const __m128i carries   = _mm_set1_epi32((int)BCD_NIBBLE_CARRIES);
+    const __m128i ssm_mask  = _mm_set1_epi32((int)ARINC429_SSM_MASK);
+    const __m128i ssm_minus = _mm_set1_epi32((int)ARINC429_SSM_BCD_MINUS);
+    const __m128i ten       = _mm_set1_epi32(10);
+    const __m128i hundred   = _mm_set1_epi32(100);
+    const __m128i ten_k     = _mm_set1_epi32(10000);
+    const __m128i zero      = _mm_setzero_si128();
+    const __m128i err_digit = _mm_set1_epi32(ARINC429_ERR_BCD_DIGIT);
+    const __m128i err_par   = _mm_set1_epi32(ARINC429_ERR_PARITY);
+    size_t i, errors = 0;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        __m128i w = _mm_loadu_si128((const __m128i *)(words + i));
+        __m128i f = _mm_and_si128(_mm_srli_epi32(w, ARINC429_DATA_SHIFT), data_mask);
+        __m128i b, v, neg, lo, c, digit_bad, parity_bad, bad;
+
+        b = _mm_add_epi32(_mm_and_si128(f, pairs),
+                          _mm_mullo_epi32(_mm_and_si128(_mm_srli_epi32(f, 4), pairs), ten));
+        v = _mm_add_epi32(_mm_and_si128(b, byte_mask),
+                          _mm_mullo_epi32(_mm_and_si128(_mm_srli_epi32(b, 8), byte_mask), hundred));
+        v = _mm_add_epi32(v, _mm_mullo_epi32(_mm_srli_epi32(b, 16), ten_k));
+
+        neg = _mm_cmpeq_epi32(_mm_and_si128(_mm_srli_epi32(w, ARINC429_SSM_SHIFT), ssm_mask), ssm_minus);
+        v = _mm_sub_epi32(_mm_xor_si128(v, neg), neg);
+
+        _mm_storeu_pd(values + i, _mm_cvtepi32_pd(v));
+        _mm_storeu_pd(values + i + 2, _mm_cvtepi32_pd(_mm_unpackhi_epi64(v, v)));
+
+        lo = _mm_and_si128(f, low_mask);
+        c = _mm_and_si128(_mm_xor_si128(_mm_xor_si128(_mm_add_epi32(lo, add_six), lo), add_six), carries);
+        digit_bad = _mm_xor_si128(_mm_cmpeq_epi32(c, zero), _mm_cmpeq_epi32(zero, zero));
+        parity_bad = _mm_cmpeq_epi32(parity_fold_sse41(w), zero);
+
+        bad = _mm_or_si128(digit_bad, parity_bad);
+        errors += (size_t)__builtin_popcount((unsigned)_mm_movemask_ps(_mm_castsi128_ps(bad)));
+
+        if (status != NULL) {
+            __m128i st = _mm_blendv_epi8(_mm_and_si128(digit_bad, err_digit), err_par, parity_bad);
+            __m128i s16 = _mm_packs_epi32(st, st);
+            int32_t packed = _mm_cvtsi128_si32(_mm_packs_epi16(s16, s16));
+            status[i]     = (int8_t)(packed & 0xFF);
+            status[i + 1] = (int8_t)((packed >> 8) & 0xFF);
+            status[i + 2] = (int8_t)((packed >> 16) & 0xFF);
+            status[i + 3] = (int8_t)((packed >> 24) & 0xFF);
+        }
+    }
+
+    return errors + decode_words_scalar(words + i, values + i, status ? status + i : NULL, n - i);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i div10_sse41(__m128i v)
+{
+    return _mm_srli_epi32(_mm_mullo_epi32(v, _mm_set1_epi32((int)DIV10_MUL)), DIV10_SHIFT);
+}
+
+/* Two doubles to |value| clamped to 0-79999 (NaN -> 0), truncated into lanes 0-1 */
+__attribute__((target("sse4.1")))
+static inline __m128i clamp_truncate_sse41(__m128d a)
+{
+    __m128d m = _mm_andnot_pd(_mm_set1_pd(-0.0), a);
+    m = _mm_max_pd(m, _mm_setzero_pd());
+    m = _mm_min_pd(m, _mm_set1_pd(ARINC429_BCD_FIELD_MAX_VALUE));
+    return _mm_cvttpd_epi32(m);
+}
+
+__attribute__((target("sse4.1")))
+static inline __m128i negative_lanes_sse41(__m128d a)
+{
+    __m128d lt = _mm_cmplt_pd(a, _mm_setzero_pd());
+    return _mm_cvttpd_epi32(_mm_and_pd(lt, _mm_set1_pd(-1.0)));
+}
+
+__attribute__((target("sse4.1")))
+static void encode_words_sse41(const double *values, uint32_t *words, size_t n, uint32_t base)
+{
+    const __m128i base_v    = _mm_set1_epi32((int)base);
+    const __m128i ssm_minus = _mm_set1_epi32((int)(ARINC429_SSM_BCD_MINUS << ARINC429_SSM_SHIFT));
+    const __m128i ten       = _mm_set1_epi32(10);
+    const __m128i one       = _mm_set1_epi32(1);
+    size_t i;
+
+    for (i = 0; i + 4 <= n; i += 4) {
+        __m128d a0 = _mm_loadu_pd(values + i);
+        __m128d a1 = _mm_loadu_pd(values + i + 2);
+        __m128i neg = _mm_unpacklo_epi64(negative_lanes_sse41(a0), negative_lanes_sse41(a1));
+        __m128i v   = _mm_unpacklo_epi64(clamp_truncate_sse41(a0), clamp_truncate_sse41(a1));
+        __m128i q1 = div10_sse41(v);
+        __m128i q2 = div10_sse41(q1);
+        __m128i q3 = div10_sse41(q2);
+        __m128i q4 = div10_sse41(q3);
+        __m128i field, word;
+
+        field = _mm_slli_epi32(q4, 16);
+        field = _mm_or_si128(field, _mm_slli_epi32(_mm_sub_epi32(q3, _mm_mullo_epi32(q4, ten)), 12));
+        field = _mm_or_si128(field, _mm_slli_epi32(_mm_sub_epi32(q2, _mm_mullo_epi32(q3, ten)), 8));
+        field = _mm_or_si128(field, _mm_slli_epi32(_mm_sub_epi32(q1, _mm_mullo_epi32(q2, ten)), 4));
+        field = _mm_or_si128(field, _mm_sub_epi32(v, _mm_mullo_epi32(q1, ten)));
+
+        word = _mm_or_si128(base_v, _mm_slli_epi32(field, ARINC429_DATA_SHIFT));
+        word = _mm_or_si128(word, _mm_and_si128(neg, ssm_minus));
+        word = _mm_or_si128(word, _mm_slli_epi32(_mm_xor_si128(parity_fold_sse41(word), one), 31));
+
+        _mm_storeu_si128((__m128i *)(words + i), word);
+    }
+
+    encode_words_scalar(values + i, words + i, n - i, base);
+}
+
+#endif /* ARINC429_HAVE_X86_SIMD */
+
+/* ------------------------------------------------------------------------ */
+/* Runtime dispatch                                                         */
+/* ------------------------------------------------------------------------ */
+
+typedef struct {
+    arinc429_isa_t isa;
+    decode_fn      decode;
+    encode_fn      encode;
+} kernels_t;
+
+static const kernels_t kernels[] = {
+    { ARINC429_ISA_SCALAR, decode_words_scalar, encode_words_scalar },
+#if ARINC429_HAVE_X86_SIMD
+    { ARINC429_ISA_SSE41, decode_words_sse41, encode_words_sse41 },
+    { ARINC429_ISA_AVX2, decode_words_avx2, encode_words_avx2 },
+#endif
+};
+
+/* Published as one pointer so a caller never mixes kernels of two
+ * selections; NULL until the first call or arinc429_bcd_batch_set_isa. */
+static const kernels_t *_Atomic active;
+
+static arinc429_isa_t best_supported_isa(void)
+{
+#if ARINC429_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return ARINC429_ISA_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return ARINC429_ISA_SSE41;
+    }
+#endif
+    return ARINC429_ISA_SCALAR;
+}
+
+arinc429_isa_t arinc429_bcd_batch_set_isa(arinc429_isa_t isa)
+{
+    arinc429_isa_t best = best_supported_isa();
+
+    if (isa > best) {
+        isa = best;
+    }
+    if (isa < ARINC429_ISA_SCALAR) {
+        isa = ARINC429_ISA_SCALAR;
+    }
+
+    atomic_store_explicit(&active, &kernels[isa], memory_order_release);
+    return isa;
+}
+
+static inline const kernels_t *dispatch(void)
+{
+    const kernels_t *k = atomic_load_explicit(&active, memory_order_acquire);
+
+    /* Racing first calls all pick the same kernel, so no lock is needed */
+    if (k == NULL) {
+        arinc429_bcd_batch_set_isa(ARINC429_ISA_AVX2);
+        k = atomic_load_explicit(&active, memory_order_acquire);
+    }
+    return k;
+}
+
+arinc429_isa_t arinc429_bcd_batch_isa(void)
+{
+    return dispatch()->isa;
+}
+
+size_t arinc429_bcd_decode_words(const uint32_t *words, double *values, int8_t *status, size_t n)
+{
+    return dispatch()->decode(words, values, status, n);
+}
+
+void arinc429_bcd_encode_words(const double *values, uint32_t *words, size_t n,
+                               uint8_t label, uint32_t sdi)
+{
+    uint32_t base = (uint32_t)arinc429_label_reverse(label) |
+                    ((sdi & ARINC429_SDI_MASK) << ARINC429_SDI_SHIFT);
+
+    dispatch()->encode(values, words, n, base);
+}
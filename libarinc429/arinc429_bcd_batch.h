@@ -0,0 +1,60 @@
+/* arinc429_bcd_batch.h - Batch BCD word encode/decode for recorded word streams
+ *
+ * Array versions of arinc429_bcd_encode_word/arinc429_bcd_decode_word. On x86-64
+ * the kernels process 8 (AVX2) or 4 (SSE4.1) words per iteration with the
+ * nibble-to-binary conversion, digit validation and parity all done in vector
+ * registers; the best kernel the CPU supports is picked on first use and the
+ * portable scalar kernel is used everywhere else. All kernels produce identical
+ * results, including for the single-word functions.
+ */
+
+#ifndef ARINC429_BCD_BATCH_H
+#define ARINC429_BCD_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ARINC429_ISA_SCALAR = 0,
+    ARINC429_ISA_SSE41  = 1,
+    ARINC429_ISA_AVX2   = 2
+} arinc429_isa_t;
+
+/* Function: arinc429_bcd_decode_words ========================================
+ * Abstract:
+ *    Decode n BCD words into values (signed by the SSM). If status is not
+ *    NULL it receives ARINC429_OK, ARINC429_ERR_PARITY or
+ *    ARINC429_ERR_BCD_DIGIT per word. Returns the number of words with an
+ *    error.
+ */
+size_t arinc429_bcd_decode_words(const uint32_t *words, double *values, int8_t *status, size_t n);
+
+/* Function: arinc429_bcd_encode_words ========================================
+ * Abstract:
+ *    Encode n values into complete BCD words sharing one label and SDI.
+ *    |value| is clamped to 0-79999 (NaN encodes as 0), the sign goes to the SSM.
+ */
+void arinc429_bcd_encode_words(const double *values, uint32_t *words, size_t n,
+                               uint8_t label, uint32_t sdi);
+
+/* Kernel currently in use */
+arinc429_isa_t arinc429_bcd_batch_isa(void);
+
+/* Function: arinc429_bcd_batch_set_isa =======================================
+ * Abstract:
+ *    Select a kernel explicitly (benchmarks, cross-checks). Requests for an
+ *    instruction set the CPU lacks fall back to the best supported one.
+ *    Returns the kernel actually selected. Safe to call while other threads
+ *    encode or decode; each call uses either the old or the new kernel.
+ */
+arinc429_isa_t arinc429_bcd_batch_set_isa(arinc429_isa_t isa);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_BCD_BATCH_H */
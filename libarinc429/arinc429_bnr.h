@@ -0,0 +1,89 @@
+/* arinc429_bnr.h - ARINC 429 BNR (two's complement binary) data field codec
+ *
+ * A BNR value occupies the 19-bit data field as a two's complement number:
+ * ARINC bit 29 is the sign and the significant bits count down from bit 28,
+ * so with n significant bits the LSB is ARINC bit 29 - n and the bits below
+ * it are pad (zero). value = signed field * resolution, where resolution is
+ * the weight of the LSB (e.g. 1 ft, 180/2^20 deg).
+ */
+
+#ifndef ARINC429_BNR_H
+#define ARINC429_BNR_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "arinc429_word.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARINC429_BNR_MAX_BITS 18       /* significant bits, sign excluded */
+
+/* Sign/Status Matrix, BNR data */
+#define ARINC429_SSM_BNR_FAILURE  0x0u /* failure warning */
+#define ARINC429_SSM_BNR_NCD      0x1u /* no computed data */
+#define ARINC429_SSM_BNR_TEST     0x2u /* functional test */
+#define ARINC429_SSM_BNR_NORMAL   0x3u /* normal operation */
+
+/* Function: arinc429_bnr_decode_field ========================================
+ * Abstract:
+ *    Signed value of a 19-bit BNR field with bits significant bits
+ *    (1..ARINC429_BNR_MAX_BITS) and LSB weight resolution.
+ */
+static inline double arinc429_bnr_decode_field(uint32_t field, int bits, double resolution)
+{
+    /* Sign to bit 31, then an arithmetic shift drops the pad bits */
+    int32_t q = (int32_t)(field << 13) >> (31 - bits);
+
+    return (double)q * resolution;
+}
+
+/* Function: arinc429_bnr_encode_field ========================================
+ * Abstract:
+ *    Round value to the nearest multiple of resolution, saturate it to the
+ *    range of bits significant bits and return the 19-bit BNR field. NaN
+ *    encodes as 0.
+ */
+static inline uint32_t arinc429_bnr_encode_field(double value, int bits, double resolution)
+{
+    double q = nearbyint(value / resolution);
+    double max = (double)((1L << bits) - 1);
+    double min = -(double)(1L << bits);
+    int32_t n;
+
+    if (!(q >= min)) {
+        q = (q < min) ? min : 0.0;
+    } else if (q > max) {
+        q = max;
+    }
+    n = (int32_t)q;
+    return ((uint32_t)n << (ARINC429_BNR_MAX_BITS - bits)) & ARINC429_DATA_MASK;
+}
+
+/* Complete BNR word with SSM normal operation */
+static inline uint32_t arinc429_bnr_encode_word(uint8_t label, uint32_t sdi, double value,
+                                                int bits, double resolution)
+{
+    return arinc429_word_pack(label, sdi, arinc429_bnr_encode_field(value, bits, resolution),
+                              ARINC429_SSM_BNR_NORMAL);
+}
+
+/* Function: arinc429_bnr_decode_word =========================================
+ * Abstract:
+ *    Decode the data field of a BNR word. Returns ARINC429_ERR_PARITY on a
+ *    parity error, else ARINC429_OK; *value is written in both cases. The
+ *    SSM is left to the caller (arinc429_word_ssm).
+ */
+static inline int arinc429_bnr_decode_word(uint32_t word, int bits, double resolution, double *value)
+{
+    *value = arinc429_bnr_decode_field(arinc429_word_data(word), bits, resolution);
+    return arinc429_word_parity_ok(word) ? ARINC429_OK : ARINC429_ERR_PARITY;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_BNR_H */
@@ -0,0 +1,177 @@
+/* arinc429_codec.h - Per-label codecs generated from arinc429_label_table.h
+ *
+ * Every X(name, ...) line of ARINC429_LABEL_TABLE expands into
+ *
+ *    arinc429_<name>_label                      enum constant, octal label
+ *    uint32_t arinc429_<name>_encode_field(double value)
+ *    double   arinc429_<name>_decode_field(uint32_t field)
+ *    uint32_t arinc429_<name>_encode(uint32_t sdi, double value)
+ *    int      arinc429_<name>_decode(uint32_t word, double *value)
+ *
+ * with bits, resolution and range as literals, so nothing is looked up at
+ * run time. BNR codecs are branch-free: the engineering range is narrowed to
+ * the field range at compile time, the value is clamped to it, scaled by the
+ * folded reciprocal of the resolution and rounded to nearest even, and the
+ * reversed label is a constant. With SSE2 that is maxsd, minsd, mulsd and
+ * cvtsd2si; elsewhere the clamp is two selects and the rounding uses the
+ * 1.5 * 2^52 trick (no libm call, but do not build with -ffast-math). NaN
+ * encodes as the range minimum. BCD entries reuse the packed BCD codec after
+ * the same clamp and scaling, the sign travelling in the SSM.
+ *
+ * Decoders return ARINC429_ERR_PARITY on a parity error (checked after the
+ * field is decoded), ARINC429_ERR_BCD_DIGIT for an invalid BCD character,
+ * else ARINC429_OK; *value is always written. The label is not checked; the
+ * BNR SSM is left to the caller (arinc429_word_ssm).
+ */
+
+#ifndef ARINC429_CODEC_H
+#define ARINC429_CODEC_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arinc429_bcd.h"
+#include "arinc429_bnr.h"
+#include "arinc429_label_table.h"
+#include "arinc429_word.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARINC429_CODEC_SSE2 1
+#endif
+
+/* Round to nearest even for |x| < 2^51 in the default rounding mode */
+static inline double arinc429_codec_round(double x)
+{
+    return (x + 6755399441055744.0) - 6755399441055744.0;  /* 1.5 * 2^52 */
+}
+
+/* Clamp to [lo, hi]; NaN gives lo. With SSE2 this is maxsd/minsd, which
+ * the compiler cannot turn back into branches around folded constants. */
+static inline double arinc429_codec_clamp(double x, double lo, double hi)
+{
+#if ARINC429_CODEC_SSE2
+    return _mm_cvtsd_f64(_mm_min_sd(_mm_max_sd(_mm_set_sd(x), _mm_set_sd(lo)), _mm_set_sd(hi)));
+#else
+    x = x > lo ? x : lo;
+    return x < hi ? x : hi;
+#endif
+}
+
+/* Nearest integer of x * scale with x clamped to [lo, hi] */
+static inline int32_t arinc429_codec_quantise(double x, double lo, double hi, double scale)
+{
+#if ARINC429_CODEC_SSE2
+    return _mm_cvtsd_si32(_mm_set_sd(arinc429_codec_clamp(x, lo, hi) * scale));
+#else
+    return (int32_t)arinc429_codec_round(arinc429_codec_clamp(x, lo, hi) * scale);
+#endif
+}
+
+/* Bit-reversed octal label as a constant expression */
+#define ARINC429_CODEC_REVERSE_(l)                                                        \
+    ((((l) & 0x01u) << 7) | (((l) & 0x02u) << 5) | (((l) & 0x04u) << 3) |                 \
+     (((l) & 0x08u) << 1) | (((l) & 0x10u) >> 1) | (((l) & 0x20u) >> 3) |                 \
+     (((l) & 0x40u) >> 5) | (((l) & 0x80u) >> 7))
+
+/* Quantised value; the engineering range is narrowed to the field range
+ * [qmin, qmax] * res at compile time, so one clamp covers both */
+#define ARINC429_CODEC_QUANTISE_(value, res, min, max, qmin, qmax)                        \
+    arinc429_codec_quantise((value),                                                       \
+                            (min) > (qmin) * (res) ? (min) : (qmin) * (res),              \
+                            (max) < (qmax) * (res) ? (max) : (qmax) * (res),              \
+                            1.0 / (res))
+
+#define ARINC429_CODEC_BNR_S(name, label, bits, res, min, max)                            \
+    static inline uint32_t arinc429_##name##_encode_field(double value)                   \
+    {                                                                                      \
+        int32_t q = ARINC429_CODEC_QUANTISE_(value, res, min, max,                         \
+                                             -(double)(1L << (bits)),                      \
+                                             (double)((1L << (bits)) - 1));                \
+        return ((uint32_t)q << (ARINC429_BNR_MAX_BITS - (bits))) & ARINC429_DATA_MASK;     \
+    }                                                                                      \
+    static inline double arinc429_##name##_decode_field(uint32_t field)                   \
+    {                                                                                      \
+        return (double)((int32_t)(field << 13) >> (31 - (bits))) * (res);                  \
+    }                                                                                      \
+    ARINC429_CODEC_BNR_WORD_(name, label)
+
+#define ARINC429_CODEC_BNR_U(name, label, bits, res, min, max)                            \
+    static inline uint32_t arinc429_##name##_encode_field(double value)                   \
+    {                                                                                      \
+        int32_t q = ARINC429_CODEC_QUANTISE_(value, res, min, max,                         \
+                                             0.0, (double)((1L << (bits)) - 1));           \
+        return (uint32_t)q << (ARINC429_BNR_MAX_BITS - (bits));                            \
+    }                                                                                      \
+    static inline double arinc429_##name##_decode_field(uint32_t field)                   \
+    {                                                                                      \
+        return (double)((field >> (ARINC429_BNR_MAX_BITS - (bits))) &                      \
+                        ((1u << (bits)) - 1u)) * (res);                                    \
+    }                                                                                      \
+    ARINC429_CODEC_BNR_WORD_(name, label)
+
+#define ARINC429_CODEC_BNR_WORD_(name, label)                                             \
+    static inline uint32_t arinc429_##name##_encode(uint32_t sdi, double value)           \
+    {                                                                                      \
+        uint32_t word = ARINC429_CODEC_REVERSE_(label)                                    \
+                      | ((sdi & ARINC429_SDI_MASK) << ARINC429_SDI_SHIFT)                  \
+                      | (arinc429_##name##_encode_field(value) << ARINC429_DATA_SHIFT)     \
+                      | (ARINC429_SSM_BNR_NORMAL << ARINC429_SSM_SHIFT);                   \
+        return word | arinc429_parity_bit(word);                                           \
+    }                                                                                      \
+    static inline int arinc429_##name##_decode(uint32_t word, double *value)              \
+    {                                                                                      \
+        *value = arinc429_##name##_decode_field(arinc429_word_data(word));                 \
+        return arinc429_word_parity_ok(word) ? ARINC429_OK : ARINC429_ERR_PARITY;          \
+    }
+
+/* BCD magnitude in digits; the sign is not part of the field */
+#define ARINC429_CODEC_BCD_S(name, label, bits, res, min, max)                            \
+    static inline uint32_t arinc429_##name##_encode_field(double value)                   \
+    {                                                                                      \
+        return arinc429_bcd_encode_field(                                                 \
+            arinc429_codec_round(fabs(arinc429_codec_clamp(value, (min), (max))) *          \
+                                 (1.0 / (res))),                                           \
+            NULL);                                                                         \
+    }                                                                                      \
+    static inline double arinc429_##name##_decode_field(uint32_t field)                   \
+    {                                                                                      \
+        double value;                                                                      \
+        arinc429_bcd_decode_field(field, &value, NULL);                                    \
+        return value * (res);                                                              \
+    }                                                                                      \
+    static inline uint32_t arinc429_##name##_encode(uint32_t sdi, double value)           \
+    {                                                                                      \
+        return arinc429_bcd_encode_word((label), sdi,                                      \
+            arinc429_codec_round(arinc429_codec_clamp(value, (min), (max)) * (1.0 / (res)))); \
+    }                                                                                      \
+    static inline int arinc429_##name##_decode(uint32_t word, double *value)              \
+    {                                                                                      \
+        int status = arinc429_bcd_decode_word(word, value);                                \
+        *value *= (res);                                                                   \
+        return status;                                                                     \
+    }
+
+#define ARINC429_CODEC_BCD_U ARINC429_CODEC_BCD_S
+
+#define ARINC429_CODEC_LABEL_(name, label, format, sign, bits, res, min, max)             \
+    arinc429_##name##_label = (label),
+#define ARINC429_CODEC_FUNCS_(name, label, format, sign, bits, res, min, max)             \
+    ARINC429_CODEC_##format##_##sign(name, label, bits, res, min, max)
+
+enum {
+    ARINC429_LABEL_TABLE(ARINC429_CODEC_LABEL_)
+};
+
+ARINC429_LABEL_TABLE(ARINC429_CODEC_FUNCS_)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_CODEC_H */
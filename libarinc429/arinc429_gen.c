@@ -0,0 +1,332 @@
+/* arinc429_gen.c - Seedable synthetic flight and ARINC 429 word generator with fault injection */
+
+#include "arinc429_gen.h"
+#include "arinc429_bcd.h"
+#include "arinc429_word.h"
+
+#include <math.h>
+#include <string.h>
+
+#define ARINC429_GEN_PI 3.14159265358979323846
+
+#define GROUND_ALT      300.0       /* m, start and end of every flight */
+#define TAKEOFF_VEL     80.0        /* m/s */
+#define APPROACH_VEL    140.0
+#define METERS_PER_DEG  111320.0
+
+const uint8_t arinc429_gen_label[TREND_DFA_NUM_CHANNELS] = {
+    0312,   /* ground speed */
+    0203,   /* pressure altitude */
+    0310,   /* present position latitude */
+    0311,   /* present position longitude */
+    0212    /* altitude rate */
+};
+
+static const char *const fault_name[ARINC429_GEN_NUM_FAULTS] = {
+    "parity", "bcd", "bitflip", "drop", "ssm", "range"
+};
+
+/* ---- xoshiro256** ------------------------------------------------------- */
+
+static inline uint64_t rotl(uint64_t x, int k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t gen_next(uint64_t *s)
+{
+    const uint64_t result = rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+/* Advance s by 2^128 draws */
+static void gen_jump(uint64_t *s)
+{
+    static const uint64_t jump[4] = {
+        0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL
+    };
+    uint64_t t[4] = { 0, 0, 0, 0 };
+    int i, b;
+
+    for (i = 0; i < 4; i++) {
+        for (b = 0; b < 64; b++) {
+            if (jump[i] & ((uint64_t)1 << b)) {
+                t[0] ^= s[0];
+                t[1] ^= s[1];
+                t[2] ^= s[2];
+                t[3] ^= s[3];
+            }
+            gen_next(s);
+        }
+    }
+    memcpy(s, t, sizeof(t));
+}
+
+static uint64_t splitmix64(uint64_t *x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/* Uniform in [0, 1) */
+static inline double gen_unit(arinc429_gen_t *g)
+{
+    return (double)(gen_next(g->rng) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* ---- Fault scheduling --------------------------------------------------- */
+
+/* Items to skip before the next fault of kind k */
+static uint64_t gen_gap(arinc429_gen_t *g, int k)
+{
+    double gap;
+
+    if (g->cfg.rate[k] <= 0.0) {
+        return UINT64_MAX;
+    }
+    if (g->cfg.rate[k] >= 1.0) {
+        return 0;
+    }
+    gap = floor(log(1.0 - gen_unit(g)) / g->log_keep[k]);
+    return gap < 1.8e19 ? (uint64_t)gap : UINT64_MAX;
+}
+
+/* Non-zero if this item gets a fault of kind k */
+static inline int gen_fault(arinc429_gen_t *g, int k)
+{
+    if (g->next_fault[k] != 0) {
+        g->next_fault[k]--;
+        return 0;
+    }
+    g->next_fault[k] = gen_gap(g, k);
+    g->injected[k]++;
+    return 1;
+}
+
+/* ---- Flight model ------------------------------------------------------- */
+
+static void gen_new_flight(arinc429_gen_t *g)
+{
+    arinc429_gen_flight_t *f = &g->flight;
+
+    f->phase        = ARINC429_GEN_CLIMB;
+    f->phase_time   = 0.0;
+    f->alt          = GROUND_ALT;
+    f->vel          = TAKEOFF_VEL;
+    f->vrate        = 0.0;
+    f->cruise_alt   = 8000.0 + 4000.0 * gen_unit(g);
+    f->cruise_vel   = 210.0 + 40.0 * gen_unit(g);
+    f->cruise_time  = 1800.0 + 7200.0 * gen_unit(g);
+    f->climb_rate   = 8.0 + 6.0 * gen_unit(g);
+    f->descent_rate = 6.0 + 4.0 * gen_unit(g);
+    f->heading      = 2.0 * ARINC429_GEN_PI * gen_unit(g);
+    g->flights++;
+}
+
+/* Advance the aircraft by dt and write the five channels to v */
+static void gen_step(arinc429_gen_t *g, double *v)
+{
+    arinc429_gen_flight_t *f = &g->flight;
+    const double dt = g->cfg.dt;
+    double target, cos_lat;
+
+    switch (f->phase) {
+    case ARINC429_GEN_CLIMB:
+        /* Level off over the last 1500 m */
+        target = f->climb_rate * fmin(1.0, (f->cruise_alt - f->alt) / 1500.0 + 0.2);
+        f->vel += (f->cruise_vel - f->vel) * fmin(1.0, dt / 300.0);
+        if (f->alt >= f->cruise_alt) {
+            f->phase = ARINC429_GEN_CRUISE;
+            f->phase_time = 0.0;
+        }
+        break;
+    case ARINC429_GEN_CRUISE:
+        target = (f->cruise_alt - f->alt) * 0.05;
+        f->vel += (f->cruise_vel - f->vel) * fmin(1.0, dt / 300.0);
+        if (f->phase_time >= f->cruise_time) {
+            f->phase = ARINC429_GEN_DESCENT;
+            f->phase_time = 0.0;
+        }
+        break;
+    default:
+        target = -f->descent_rate;
+        f->vel += (APPROACH_VEL - f->vel) * fmin(1.0, dt / 600.0);
+        if (f->alt <= GROUND_ALT) {
+            gen_new_flight(g);
+            target = 0.0;
+        }
+        break;
+    }
+
+    /* Turbulence on the vertical rate and speed, slow heading wander */
+    f->vrate = target + 1.6 * (gen_unit(g) - 0.5);
+    f->vel += gen_unit(g) - 0.5;
+    f->heading += 0.004 * (gen_unit(g) - 0.5) * dt;
+    f->alt += f->vrate * dt;
+    f->phase_time += dt;
+
+    cos_lat = cos(f->lat * (ARINC429_GEN_PI / 180.0));
+    f->lat += f->vel * cos(f->heading) * dt / METERS_PER_DEG;
+    f->lon += f->vel * sin(f->heading) * dt / (METERS_PER_DEG * fmax(cos_lat, 0.05));
+    if ((f->lat > 75.0 && cos(f->heading) > 0.0) || (f->lat < -75.0 && cos(f->heading) < 0.0)) {
+        f->heading = ARINC429_GEN_PI - f->heading;      /* turn back from the poles */
+    }
+    f->lon = f->lon > 180.0 ? f->lon - 360.0 : f->lon < -180.0 ? f->lon + 360.0 : f->lon;
+
+    v[TREND_DFA_CH_VELOCITY] = f->vel;
+    v[TREND_DFA_CH_BAROALT]  = f->alt;
+    v[TREND_DFA_CH_LAT]      = f->lat;
+    v[TREND_DFA_CH_LON]      = f->lon;
+    v[TREND_DFA_CH_VERTRATE] = f->vrate;
+
+    /* Out-of-range position, beyond the anomaly limits of the DFA */
+    if (gen_fault(g, ARINC429_GEN_FAULT_RANGE)) {
+        uint64_t r = gen_next(g->rng);
+        double sign = (r & 1u) ? -1.0 : 1.0;
+
+        if (r & 2u) {
+            v[TREND_DFA_CH_LAT] = sign * (LAT_ANOMALY_THRESHOLD + 1.0 + 89.0 * gen_unit(g));
+        } else {
+            v[TREND_DFA_CH_LON] = sign * (LON_ANOMALY_THRESHOLD + 1.0 + 179.0 * gen_unit(g));
+        }
+    }
+    g->samples++;
+}
+
+/* ---- Public API --------------------------------------------------------- */
+
+void arinc429_gen_default_config(arinc429_gen_config_t *cfg)
+{
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->dt = 1.0;
+}
+
+int arinc429_gen_init(arinc429_gen_t *g, const arinc429_gen_config_t *cfg, uint64_t seed,
+                      uint64_t stream)
+{
+    uint64_t x = seed;
+    int k;
+
+    if (!(cfg->dt > 0.0)) {
+        return -1;
+    }
+    for (k = 0; k < ARINC429_GEN_NUM_FAULTS; k++) {
+        if (!(cfg->rate[k] >= 0.0 && cfg->rate[k] <= 1.0)) {
+            return -1;
+        }
+    }
+
+    memset(g, 0, sizeof(*g));
+    g->cfg = *cfg;
+    for (k = 0; k < 4; k++) {
+        g->rng[k] = splitmix64(&x);
+    }
+    while (stream-- > 0) {
+        gen_jump(g->rng);
+    }
+
+    for (k = 0; k < ARINC429_GEN_NUM_FAULTS; k++) {
+        g->log_keep[k] = log1p(-cfg->rate[k]);
+        g->next_fault[k] = gen_gap(g, k);
+    }
+
+    gen_new_flight(g);
+    g->flight.lat = -60.0 + 120.0 * gen_unit(g);
+    g->flight.lon = -180.0 + 360.0 * gen_unit(g);
+    return 0;
+}
+
+size_t arinc429_gen_samples(arinc429_gen_t *g, double *const *column, size_t n)
+{
+    double v[TREND_DFA_NUM_CHANNELS];
+    size_t i;
+    int ch;
+
+    for (i = 0; i < n; i++) {
+        gen_step(g, v);
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            column[ch][i] = v[ch];
+        }
+    }
+    return n;
+}
+
+/* Rebuild a word's parity after its other bits changed */
+static inline uint32_t gen_repair_parity(uint32_t word)
+{
+    word &= ~ARINC429_PARITY_BIT;
+    return word | arinc429_parity_bit(word);
+}
+
+size_t arinc429_gen_words(arinc429_gen_t *g, uint32_t *words, size_t samples)
+{
+    double v[TREND_DFA_NUM_CHANNELS];
+    size_t n = 0, i;
+    int ch;
+
+    for (i = 0; i < samples; i++) {
+        gen_step(g, v);
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            uint32_t word;
+
+            /* Dropped first, so the other rates are per word emitted */
+            if (gen_fault(g, ARINC429_GEN_FAULT_DROP)) {
+                continue;
+            }
+            word = arinc429_bcd_encode_word(arinc429_gen_label[ch], 0, v[ch]);
+
+            if (gen_fault(g, ARINC429_GEN_FAULT_SSM)) {
+                uint32_t ssm = (gen_next(g->rng) & 1u) ? ARINC429_SSM_BCD_NCD : ARINC429_SSM_BCD_TEST;
+
+                word &= ~(ARINC429_SSM_MASK << ARINC429_SSM_SHIFT);
+                word = gen_repair_parity(word | (ssm << ARINC429_SSM_SHIFT));
+            }
+            if (gen_fault(g, ARINC429_GEN_FAULT_BCD)) {
+                /* Characters 2-5 are the low 16 data bits, 4 each */
+                uint64_t r = gen_next(g->rng);
+                int shift = ARINC429_DATA_SHIFT + 4 * (int)(r & 3u);
+                uint32_t digit = 10u + (uint32_t)((r >> 2) % 6u);
+
+                word &= ~(0xFu << shift);
+                word = gen_repair_parity(word | (digit << shift));
+            }
+            if (gen_fault(g, ARINC429_GEN_FAULT_BITFLIP)) {
+                word ^= 1u << (gen_next(g->rng) % 31u);
+            }
+            if (gen_fault(g, ARINC429_GEN_FAULT_PARITY)) {
+                word ^= ARINC429_PARITY_BIT;
+            }
+            words[n++] = word;
+        }
+    }
+    g->words += n;
+    return n;
+}
+
+const char *arinc429_gen_fault_name(int fault)
+{
+    return fault >= 0 && fault < ARINC429_GEN_NUM_FAULTS ? fault_name[fault] : NULL;
+}
+
+int arinc429_gen_fault_find(const char *name)
+{
+    int k;
+
+    for (k = 0; k < ARINC429_GEN_NUM_FAULTS; k++) {
+        if (strcmp(name, fault_name[k]) == 0) {
+            return k;
+        }
+    }
+    return -1;
+}
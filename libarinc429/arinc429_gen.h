@@ -0,0 +1,116 @@
+/* arinc429_gen.h - Seedable synthetic flight and ARINC 429 word generator with fault injection
+ *
+ * Each generator flies one aircraft through repeated flights: a climb to a
+ * drawn cruise altitude, a cruise of drawn length and a descent to 300 m,
+ * after which the next flight starts where the last one ended. It emits the
+ * five DFA channels as samples (TREND_DFA_CH_* order: velocity m/s,
+ * baroaltitude m, lat, lon, vertrate m/s) or as the five BCD words per
+ * sample that arinc429_replay loops back (labels arinc429_gen_label).
+ *
+ * Faults are injected at configurable per-item rates:
+ *   parity    parity bit inverted                      (per word)
+ *   bcd       one BCD character set to 10-15           (per word)
+ *   bitflip   one of bits 1-31 inverted, parity kept   (per word)
+ *   drop      word not emitted                         (per word)
+ *   ssm       SSM set to no computed data or test      (per word)
+ *   range     lat beyond +-90 or lon beyond +-180      (per sample)
+ * A fault of each kind is scheduled by drawing the gap to its next
+ * occurrence (geometric distribution), so a fault-free item costs one
+ * counter decrement per kind and no random draws.
+ *
+ * Random numbers come from xoshiro256**. A generator is fully determined
+ * by (seed, stream): stream s starts 2^128 draws after stream s - 1, so
+ * the streams of parallel generators never overlap and every run with the
+ * same seed produces the same output, whatever the thread scheduling.
+ */
+
+#ifndef ARINC429_GEN_H
+#define ARINC429_GEN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Fault kinds */
+#define ARINC429_GEN_FAULT_PARITY   0
+#define ARINC429_GEN_FAULT_BCD      1
+#define ARINC429_GEN_FAULT_BITFLIP  2
+#define ARINC429_GEN_FAULT_DROP     3
+#define ARINC429_GEN_FAULT_SSM      4
+#define ARINC429_GEN_FAULT_RANGE    5
+#define ARINC429_GEN_NUM_FAULTS     6
+
+/* Flight phases */
+#define ARINC429_GEN_CLIMB    0
+#define ARINC429_GEN_CRUISE   1
+#define ARINC429_GEN_DESCENT  2
+
+/* Octal label per TREND_DFA_CH_* channel, as in arinc429_replay */
+extern const uint8_t arinc429_gen_label[TREND_DFA_NUM_CHANNELS];
+
+typedef struct {
+    double dt;                              /* seconds per sample (1.0) */
+    double rate[ARINC429_GEN_NUM_FAULTS];   /* probability per item (0) */
+} arinc429_gen_config_t;
+
+typedef struct {
+    int    phase;
+    double phase_time;          /* seconds in the current phase */
+    double alt, vel, vrate, lat, lon, heading;
+    double cruise_alt, cruise_vel, cruise_time, climb_rate, descent_rate;
+} arinc429_gen_flight_t;
+
+typedef struct {
+    arinc429_gen_config_t cfg;
+    uint64_t rng[4];
+    double   log_keep[ARINC429_GEN_NUM_FAULTS];     /* log(1 - rate) */
+    uint64_t next_fault[ARINC429_GEN_NUM_FAULTS];   /* items before the next fault */
+    arinc429_gen_flight_t flight;
+    uint64_t samples;           /* samples generated (also behind words) */
+    uint64_t words;             /* words emitted */
+    uint64_t flights;           /* flights started */
+    uint64_t injected[ARINC429_GEN_NUM_FAULTS];
+} arinc429_gen_t;
+
+/* dt 1 s, no faults */
+void arinc429_gen_default_config(arinc429_gen_config_t *cfg);
+
+/* Function: arinc429_gen_init ================================================
+ * Abstract:
+ *    Seed g from (seed, stream) and start its first flight. Returns 0, or -1
+ *    if dt is not positive or a rate is outside 0..1.
+ */
+int arinc429_gen_init(arinc429_gen_t *g, const arinc429_gen_config_t *cfg, uint64_t seed,
+                      uint64_t stream);
+
+/* Function: arinc429_gen_samples =============================================
+ * Abstract:
+ *    Generate n samples; column[ch] receives n values of channel ch
+ *    (TREND_DFA_CH_*), the layout of flight_csv_stream_read. Returns n.
+ */
+size_t arinc429_gen_samples(arinc429_gen_t *g, double *const *column, size_t n);
+
+/* Function: arinc429_gen_words ===============================================
+ * Abstract:
+ *    Generate samples as BCD words, one per channel in channel order, into
+ *    words (room for samples * TREND_DFA_NUM_CHANNELS). Dropped words leave
+ *    no gap. Returns the number of words written.
+ */
+size_t arinc429_gen_words(arinc429_gen_t *g, uint32_t *words, size_t samples);
+
+/* Name of a fault kind ("parity", "bcd", ...), or NULL */
+const char *arinc429_gen_fault_name(int fault);
+
+/* Fault kind called name, or -1 */
+int arinc429_gen_fault_find(const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_GEN_H */
@@ -0,0 +1,15 @@
+/* arinc429_label.c - ARINC 429 label bit reversal */
+
+#include "arinc429_label.h"
+
+uint8_t arinc429_label_reverse(uint8_t label)
+{
+    uint8_t label_flipped = 0;
+    int i;
+
+    for (i = 0; i < 8; ++i) {
+        label_flipped |= (uint8_t)(((label >> i) & 0x01) << (7 - i));
+    }
+
+    return label_flipped;
+}
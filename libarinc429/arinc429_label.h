@@ -0,0 +1,23 @@
+/* arinc429_label.h - ARINC 429 label handling shared by the S-functions and native tools */
+
+#ifndef ARINC429_LABEL_H
+#define ARINC429_LABEL_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Function: arinc429_label_reverse ===========================================
+ * Abstract:
+ *    ARINC 429 transmits the label MSB first, so the LSB of the octal label
+ *    ends up in the MSB position of the word. Returns the bit-reversed label.
+ */
+uint8_t arinc429_label_reverse(uint8_t label);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_LABEL_H */
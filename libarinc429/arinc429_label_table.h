@@ -0,0 +1,36 @@
+/* arinc429_label_table.h - Compile-time ARINC 429 label definitions
+ *
+ * One X(...) line per label, expanded by arinc429_codec.h into a dedicated
+ * encoder and decoder per label with every constant folded in:
+ *
+ *    X(name, label, format, sign, bits, resolution, min, max)
+ *
+ *    name        C identifier used in the generated function names
+ *    label       octal label
+ *    format      BNR (two's complement binary) or BCD (3-4-4-4-4 digits)
+ *    sign        S (signed) or U (unsigned; BNR sign bit always 0)
+ *    bits        BNR significant bits, sign excluded (1..18); 0 for BCD
+ *    resolution  weight of the LSB (BNR) or of the last BCD digit
+ *    min, max    engineering range; values are clamped to it on encode
+ *
+ * The range must fit the field: |min| and max at most 2^bits * resolution
+ * for BNR, 79999 * resolution for BCD. Units are those of the flight data
+ * fed to trend_dfa (m/s, m, deg), not the ARINC 429 defaults (kt, ft).
+ */
+
+#ifndef ARINC429_LABEL_TABLE_H
+#define ARINC429_LABEL_TABLE_H
+
+#define ARINC429_LABEL_TABLE(X)                                                       \
+    /* trend_dfa inputs, TREND_DFA_CH_* order */                                      \
+    X(ground_speed,   0312, BNR, U, 15, 0.125,                  0.0,     4000.0)      \
+    X(pressure_alt,   0203, BNR, S, 17, 0.125,             -16000.0,    16000.0)      \
+    X(latitude,       0310, BNR, S, 18, 0.000686645507812500,  -90.0,      90.0)      \
+    X(longitude,      0311, BNR, S, 18, 0.000686645507812500, -180.0,     180.0)      \
+    X(altitude_rate,  0212, BNR, S, 15, 0.015625,            -512.0,      512.0)      \
+    /* Other air data */                                                              \
+    X(static_temp,    0213, BNR, S, 11, 0.25,                 -99.0,      99.0)       \
+    X(mach,           0205, BNR, U, 16, 0.0000625,              0.0,       4.0)       \
+    X(dme_distance,   0201, BCD, U,  0, 0.01,                   0.0,     799.99)
+
+#endif /* ARINC429_LABEL_TABLE_H */
@@ -0,0 +1,217 @@
+/* arinc429_rx.c - Receiver label dispatch table with last-value mailboxes */
+
+#include "arinc429_rx.h"
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arinc429_bcd.h"
+#include "arinc429_bnr.h"
+#include "arinc429_word.h"
+
+#define RX_LINE_LEN   256
+#define RX_MAX_FIELDS 8
+
+void arinc429_rx_init(arinc429_rx_t *rx)
+{
+    memset(rx, 0, sizeof(*rx));
+}
+
+arinc429_rx_t *arinc429_rx_create(void)
+{
+    arinc429_rx_t *rx;
+
+#if defined(_WIN32)
+    rx = (arinc429_rx_t *)_aligned_malloc(sizeof(*rx), _Alignof(arinc429_rx_t));
+#else
+    rx = (arinc429_rx_t *)aligned_alloc(_Alignof(arinc429_rx_t), sizeof(*rx));
+#endif
+    if (rx != NULL) {
+        arinc429_rx_init(rx);
+    }
+    return rx;
+}
+
+void arinc429_rx_destroy(arinc429_rx_t *rx)
+{
+#if defined(_WIN32)
+    _aligned_free(rx);
+#else
+    free(rx);
+#endif
+}
+
+static size_t entry_index(uint8_t label, int sdi)
+{
+    return ((size_t)sdi << ARINC429_SDI_SHIFT) | arinc429_label_reverse(label);
+}
+
+int arinc429_rx_define(arinc429_rx_t *rx, uint8_t label, int sdi, int kind,
+                       int bits, double resolution, uint32_t subscribers)
+{
+    int s, first = sdi < 0 ? 0 : sdi, last = sdi < 0 ? 3 : sdi;
+
+    if (sdi > 3 || kind < ARINC429_RX_BCD || kind > ARINC429_RX_DISCRETE) {
+        return -1;
+    }
+    if (kind == ARINC429_RX_BNR &&
+        (bits < 1 || bits > ARINC429_BNR_MAX_BITS || !(resolution > 0.0))) {
+        return -1;
+    }
+
+    for (s = first; s <= last; s++) {
+        size_t idx = entry_index(label, s);
+        arinc429_rx_entry_t *e = &rx->entry[idx];
+
+        if (e->kind == ARINC429_RX_NONE) {
+            rx->defined[rx->num_defined++] = (uint16_t)idx;
+        }
+        memset(e, 0, sizeof(*e));
+        e->kind = (uint8_t)kind;
+        e->bits = (uint8_t)(kind == ARINC429_RX_BNR ? bits : 0);
+        e->resolution = kind == ARINC429_RX_BNR ? resolution : 0.0;
+        e->subscribers = subscribers;
+    }
+    return 0;
+}
+
+static int parse_kind(const char *s)
+{
+    if (strcmp(s, "bcd") == 0) return ARINC429_RX_BCD;
+    if (strcmp(s, "bnr") == 0) return ARINC429_RX_BNR;
+    if (strcmp(s, "dis") == 0) return ARINC429_RX_DISCRETE;
+    return ARINC429_RX_NONE;
+}
+
+int arinc429_rx_load(arinc429_rx_t *rx, const char *path, int *bad_line)
+{
+    char line[RX_LINE_LEN];
+    FILE *fp = fopen(path, "r");
+    int line_no = 0, count = 0;
+
+    if (bad_line != NULL) {
+        *bad_line = 0;
+    }
+    if (fp == NULL) {
+        return -1;
+    }
+
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char *tok[RX_MAX_FIELDS], *hash, *end;
+        unsigned long label = 0;
+        unsigned long subscribers = 1;
+        int bits = 0, sdi = 0, kind = ARINC429_RX_NONE, n = 0, ok;
+        double resolution = 0.0;
+
+        line_no++;
+        if ((hash = strchr(line, '#')) != NULL) {
+            *hash = '\0';
+        }
+        for (tok[0] = strtok(line, " \t\r\n"); tok[n] != NULL && n < RX_MAX_FIELDS - 1; ) {
+            tok[++n] = strtok(NULL, " \t\r\n");
+        }
+        if (n == 0) {
+            continue;
+        }
+
+        ok = n >= 3;
+        if (ok) {
+            label = strtoul(tok[0], &end, 8);
+            ok = *end == '\0' && label <= 0377;
+            sdi = strcmp(tok[1], "*") == 0 ? -1 :
+                  (tok[1][0] >= '0' && tok[1][0] <= '3' && tok[1][1] == '\0') ? tok[1][0] - '0' : 4;
+            kind = parse_kind(tok[2]);
+        }
+        if (ok && kind == ARINC429_RX_BNR) {
+            /* label sdi bnr bits resolution [subscribers] */
+            ok = n >= 5 && n <= 6;
+            if (ok) {
+                bits = atoi(tok[3]);
+                resolution = strtod(tok[4], NULL);
+                if (n == 6) {
+                    subscribers = strtoul(tok[5], NULL, 0);
+                }
+            }
+        } else if (ok) {
+            /* label sdi bcd|dis [subscribers] */
+            ok = n <= 4;
+            if (ok && n == 4) {
+                subscribers = strtoul(tok[3], NULL, 0);
+            }
+        }
+        if (!ok || kind == ARINC429_RX_NONE ||
+            arinc429_rx_define(rx, (uint8_t)label, sdi, kind, bits, resolution,
+                               (uint32_t)subscribers) != 0) {
+            if (bad_line != NULL && *bad_line == 0) {
+                *bad_line = line_no;
+            }
+            continue;
+        }
+        count++;
+    }
+
+    fclose(fp);
+    return count;
+}
+
+int arinc429_rx_decode(const arinc429_rx_entry_t *e, uint32_t word, double *value)
+{
+    switch (e->kind) {
+    case ARINC429_RX_BCD:
+        return arinc429_bcd_decode_word(word, value);
+    case ARINC429_RX_BNR:
+        *value = arinc429_bnr_decode_field(arinc429_word_data(word), e->bits, e->resolution);
+        break;
+    default:
+        *value = (double)arinc429_word_data(word);
+        break;
+    }
+    return ARINC429_OK;
+}
+
+uint32_t arinc429_rx_receive(arinc429_rx_t *rx, uint32_t word, double time)
+{
+    arinc429_rx_entry_t *e = &rx->entry[arinc429_rx_index(word)];
+    double value;
+
+    rx->words++;
+    if (e->kind == ARINC429_RX_NONE) {
+        rx->unknown++;
+        return 0;
+    }
+    if (!arinc429_word_parity_ok(word)) {
+        rx->parity_errors++;
+        return 0;
+    }
+
+    e->status = (int8_t)arinc429_rx_decode(e, word, &value);
+
+    /* An invalid BCD character keeps the last good value */
+    if (e->status == ARINC429_OK) {
+        e->value = value;
+    }
+    e->word = word;
+    e->ssm = (uint8_t)arinc429_word_ssm(word);
+    e->time = time;
+    e->stale = 0;
+    e->updates++;
+    return e->subscribers;
+}
+
+void arinc429_rx_tick(arinc429_rx_t *rx)
+{
+    size_t i;
+
+    for (i = 0; i < rx->num_defined; i++) {
+        rx->entry[rx->defined[i]].stale++;
+    }
+}
+
+const arinc429_rx_entry_t *arinc429_rx_mailbox(const arinc429_rx_t *rx, uint8_t label, int sdi)
+{
+    return &rx->entry[entry_index(label, sdi & 3)];
+}
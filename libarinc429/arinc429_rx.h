@@ -0,0 +1,123 @@
+/* arinc429_rx.h - Receiver label dispatch table with last-value mailboxes
+ *
+ * The table has one cache-line-sized entry per (label, SDI) pair, indexed by
+ * the label byte exactly as received (bits 1-8, still reversed) and the SDI,
+ * so routing a word is a mask and a shift with no label reversal. An entry
+ * holds its decoder (BCD, BNR or discrete) together with the mailbox: the
+ * latest value, SSM, status, timestamp, update count, staleness counter and
+ * the mask of subscribers interested in it. One received word costs one
+ * table lookup and one decode.
+ *
+ * Label definition files have one definition per line:
+ *
+ *    # label  sdi  format  [bits  resolution]  [subscribers]
+ *    203      *    bnr     17    1.0           0x1
+ *    310      0    bnr     18    0.000686646
+ *    312      *    bcd                         0x2
+ *    270      *    dis
+ *
+ * label is octal, sdi is 0-3 or * for all four, format is bcd, bnr or dis
+ * (discrete: the raw 19-bit field). bits and resolution are given for bnr
+ * only; subscribers defaults to 0x1. Text after # is a comment.
+ */
+
+#ifndef ARINC429_RX_H
+#define ARINC429_RX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARINC429_RX_NUM_ENTRIES  (256 * 4)
+
+/* Decoder kinds */
+#define ARINC429_RX_NONE      0
+#define ARINC429_RX_BCD       1
+#define ARINC429_RX_BNR       2
+#define ARINC429_RX_DISCRETE  3
+
+/* One (label, SDI) entry: decoder and mailbox in a single cache line */
+typedef struct {
+    _Alignas(64)
+    double   value;         /* latest decoded value */
+    double   time;          /* time of the latest update */
+    double   resolution;    /* BNR LSB weight */
+    uint32_t word;          /* latest raw word */
+    uint32_t updates;       /* words decoded into this mailbox */
+    uint32_t stale;         /* arinc429_rx_tick calls since the latest update */
+    uint32_t subscribers;   /* caller-defined subscriber bits */
+    uint8_t  kind;          /* ARINC429_RX_* */
+    uint8_t  bits;          /* BNR significant bits */
+    uint8_t  ssm;           /* SSM of the latest word */
+    int8_t   status;        /* ARINC429_OK or the latest decode error */
+} arinc429_rx_entry_t;
+
+typedef struct {
+    arinc429_rx_entry_t entry[ARINC429_RX_NUM_ENTRIES];
+    uint16_t            defined[ARINC429_RX_NUM_ENTRIES];  /* indices of defined entries */
+    size_t              num_defined;
+    uint64_t            words;              /* words offered */
+    uint64_t            unknown;            /* words for undefined labels */
+    uint64_t            parity_errors;      /* dropped before decoding */
+} arinc429_rx_t;
+
+/* Table index of a received word: raw label byte and SDI */
+static inline size_t arinc429_rx_index(uint32_t word)
+{
+    return (size_t)(word & 0x3FFu);
+}
+
+/* Clear the table and counters */
+void arinc429_rx_init(arinc429_rx_t *rx);
+
+/* Allocate a cache-line-aligned, initialised table; NULL if out of memory */
+arinc429_rx_t *arinc429_rx_create(void);
+
+void arinc429_rx_destroy(arinc429_rx_t *rx);
+
+/* Function: arinc429_rx_define ===============================================
+ * Abstract:
+ *    Define octal label for one SDI (0-3) or all four (sdi < 0). bits and
+ *    resolution apply to ARINC429_RX_BNR only. Redefining an entry resets
+ *    its mailbox. Returns 0, or -1 for invalid arguments.
+ */
+int arinc429_rx_define(arinc429_rx_t *rx, uint8_t label, int sdi, int kind,
+                       int bits, double resolution, uint32_t subscribers);
+
+/* Function: arinc429_rx_load =================================================
+ * Abstract:
+ *    Add the definitions in a label definition file. Returns the number of
+ *    definitions, or -1 if the file cannot be read; *bad_line (may be NULL)
+ *    receives the first malformed line number, 0 if there is none.
+ */
+int arinc429_rx_load(arinc429_rx_t *rx, const char *path, int *bad_line);
+
+/* Decode word with entry e's decoder (parity is checked for BCD only) */
+int arinc429_rx_decode(const arinc429_rx_entry_t *e, uint32_t word, double *value);
+
+/* Function: arinc429_rx_receive ==============================================
+ * Abstract:
+ *    Route one word received at time into its mailbox. Returns the
+ *    subscriber mask of the updated entry, or 0 if the label is not defined
+ *    or the parity is wrong (nothing is updated then).
+ */
+uint32_t arinc429_rx_receive(arinc429_rx_t *rx, uint32_t word, double time);
+
+/* Function: arinc429_rx_tick =================================================
+ * Abstract:
+ *    Age every defined mailbox by one; call once per refresh interval and
+ *    read stale to see how many intervals have passed without an update.
+ */
+void arinc429_rx_tick(arinc429_rx_t *rx);
+
+/* Mailbox for an octal label and SDI (never NULL; kind is ARINC429_RX_NONE if undefined) */
+const arinc429_rx_entry_t *arinc429_rx_mailbox(const arinc429_rx_t *rx, uint8_t label, int sdi);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_RX_H */
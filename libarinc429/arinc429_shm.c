@@ -0,0 +1,455 @@
+/* arinc429_shm.c - Shared-memory ring for live ingest of words and flight samples
+ *
+ * Sleeping side:  seq = load(futex word); waiting = 1; fence; recheck the
+ *                 counter; futex_wait(futex word, seq)
+ * Waking side:    store(counter); fence; if exchange(waiting, 0):
+ *                 futex word++; futex_wake
+ *
+ * The two full fences order the waiter's flag against the waker's counter,
+ * so either the waiter sees the new counter before sleeping or the waker
+ * sees the flag; a wake between the recheck and the futex call changes the
+ * futex word and the wait returns at once. Each side also caches the other
+ * side's counter and rereads it only when the cached value says the ring is
+ * empty (consumer) or full (producer), so the shared lines move between
+ * cores only when the ring state actually changes.
+ */
+
+#define _GNU_SOURCE
+
+#include "arinc429_shm.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#define SHM_MAGIC       0x41343239u     /* "A429" */
+#define SHM_VERSION     1u
+#define SHM_CACHE_LINE  64
+#define SHM_HEADER_SIZE 256             /* records start here */
+#define SHM_POLL_NS     100000L         /* sleep between polls without futexes */
+
+typedef struct {
+    _Atomic uint32_t ready;             /* SHM_MAGIC once initialised */
+    uint32_t         version;
+    uint32_t         kind;
+    uint32_t         record_size;
+    uint64_t         capacity;
+
+    /* Producer side */
+    _Alignas(SHM_CACHE_LINE) _Atomic uint64_t head;
+    _Atomic uint64_t dropped;
+    _Atomic uint32_t closed;
+    _Atomic uint32_t head_seq;          /* futex word the consumer sleeps on */
+    _Atomic uint32_t consumer_waiting;
+
+    /* Consumer side */
+    _Alignas(SHM_CACHE_LINE) _Atomic uint64_t tail;
+    _Atomic uint32_t tail_seq;          /* futex word the producer sleeps on */
+    _Atomic uint32_t producer_waiting;
+} shm_header_t;
+
+_Static_assert(sizeof(shm_header_t) <= SHM_HEADER_SIZE, "ring header too large");
+_Static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared counters must be lock-free");
+
+struct arinc429_shm {
+    shm_header_t  *hdr;
+    unsigned char *records;
+    size_t         map_len;
+    size_t         record_size;
+    uint64_t       mask;
+    int            producer;
+    uint64_t       pos;                 /* own counter: head or tail */
+    uint64_t       other;               /* cached counter of the other side */
+    uint64_t       sleeps;
+    uint64_t       wakes;
+};
+
+static size_t kind_record_size(int kind)
+{
+    switch (kind) {
+    case ARINC429_SHM_WORDS:   return sizeof(arinc429_shm_word_t);
+    case ARINC429_SHM_SAMPLES: return sizeof(arinc429_shm_sample_t);
+    default:                   return 0;
+    }
+}
+
+static inline void cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* Sleep on word while it still holds seq, at most timeout_ns (< 0: forever) */
+static void sleep_on(_Atomic uint32_t *word, uint32_t seq, int64_t timeout_ns)
+{
+#if defined(__linux__)
+    struct timespec ts, *tp = NULL;
+
+    if (timeout_ns >= 0) {
+        ts.tv_sec = (time_t)(timeout_ns / 1000000000);
+        ts.tv_nsec = (long)(timeout_ns % 1000000000);
+        tp = &ts;
+    }
+    /* Shared (not FUTEX_PRIVATE): the other side is another process */
+    syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, seq, tp, NULL, 0);
+#else
+    struct timespec ts = { 0, SHM_POLL_NS };
+
+    (void)word;
+    (void)seq;
+    if (timeout_ns >= 0 && timeout_ns < SHM_POLL_NS) {
+        ts.tv_nsec = (long)timeout_ns;
+    }
+    nanosleep(&ts, NULL);
+#endif
+}
+
+/* Wake the other side if it has announced that it sleeps on word */
+static void wake(arinc429_shm_t *shm, _Atomic uint32_t *waiting, _Atomic uint32_t *word)
+{
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiting, memory_order_relaxed) &&
+        atomic_exchange_explicit(waiting, 0, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(word, 1, memory_order_release);
+#if defined(__linux__)
+        syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+        shm->wakes++;
+    }
+}
+
+/* Wait until *counter > above: spin, then sleep on word announcing the wait
+ * in waiting. A consumer also returns -1 once the ring is closed. Returns 1
+ * when the condition holds and 0 on timeout. */
+static int wait_above(arinc429_shm_t *shm, _Atomic uint64_t *counter, uint64_t above,
+                      _Atomic uint32_t *waiting, _Atomic uint32_t *word, int64_t timeout_ns)
+{
+    const int64_t deadline = timeout_ns >= 0 ? now_ns() + timeout_ns : 0;
+    int check_closed = !shm->producer;
+    int i;
+
+    for (i = 0; i < ARINC429_SHM_SPIN_LIMIT; i++) {
+        if (atomic_load_explicit(counter, memory_order_acquire) > above) {
+            return 1;
+        }
+        if (check_closed && atomic_load_explicit(&shm->hdr->closed, memory_order_acquire)) {
+            break;
+        }
+        cpu_relax();
+    }
+
+    for (;;) {
+        uint32_t seq = atomic_load_explicit(word, memory_order_acquire);
+        int64_t left = 0;
+
+        atomic_store_explicit(waiting, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (atomic_load_explicit(counter, memory_order_acquire) > above) {
+            atomic_store_explicit(waiting, 0, memory_order_relaxed);
+            return 1;
+        }
+        if (check_closed && atomic_load_explicit(&shm->hdr->closed, memory_order_acquire)) {
+            atomic_store_explicit(waiting, 0, memory_order_relaxed);
+            return -1;
+        }
+        if (timeout_ns >= 0 && (left = deadline - now_ns()) <= 0) {
+            atomic_store_explicit(waiting, 0, memory_order_relaxed);
+            return 0;
+        }
+        shm->sleeps++;
+        sleep_on(word, seq, timeout_ns >= 0 ? left : -1);
+    }
+}
+
+#if !defined(_WIN32)
+
+static arinc429_shm_t *map_segment(int fd, size_t len, int producer)
+{
+    arinc429_shm_t *shm;
+    void *map;
+
+    map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    shm = (arinc429_shm_t *)calloc(1, sizeof(*shm));
+    if (shm == NULL) {
+        munmap(map, len);
+        return NULL;
+    }
+    shm->hdr = (shm_header_t *)map;
+    shm->records = (unsigned char *)map + SHM_HEADER_SIZE;
+    shm->map_len = len;
+    shm->producer = producer;
+    return shm;
+}
+
+arinc429_shm_t *arinc429_shm_create(const char *name, int kind, size_t capacity)
+{
+    size_t rec = kind_record_size(kind), cap = 1, len;
+    arinc429_shm_t *shm;
+    shm_header_t *hdr;
+    int fd;
+
+    if (rec == 0) {
+        return NULL;
+    }
+    if (capacity == 0) {
+        capacity = ARINC429_SHM_DEFAULT_CAPACITY;
+    }
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+    len = SHM_HEADER_SIZE + cap * rec;
+
+    /* A stale segment from a crashed producer would carry old counters */
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0660);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)len) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    if ((shm = map_segment(fd, len, 1)) == NULL) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    /* ftruncate zero-filled the segment, so every counter starts at 0 */
+    hdr = shm->hdr;
+    hdr->version = SHM_VERSION;
+    hdr->kind = (uint32_t)kind;
+    hdr->record_size = (uint32_t)rec;
+    hdr->capacity = cap;
+    atomic_store_explicit(&hdr->ready, SHM_MAGIC, memory_order_release);
+
+    shm->record_size = rec;
+    shm->mask = cap - 1;
+    shm->pos = 0;
+    shm->other = 0;
+    return shm;
+}
+
+arinc429_shm_t *arinc429_shm_attach(const char *name, int kind)
+{
+    arinc429_shm_t *shm;
+    shm_header_t *hdr;
+    struct stat st;
+    int fd;
+
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < SHM_HEADER_SIZE) {
+        close(fd);
+        return NULL;
+    }
+    shm = map_segment(fd, (size_t)st.st_size, 0);
+    if (shm == NULL) {
+        return NULL;
+    }
+
+    hdr = shm->hdr;
+    if (atomic_load_explicit(&hdr->ready, memory_order_acquire) != SHM_MAGIC ||
+        hdr->version != SHM_VERSION || (kind != 0 && hdr->kind != (uint32_t)kind) ||
+        hdr->record_size != kind_record_size((int)hdr->kind) ||
+        hdr->capacity == 0 || (hdr->capacity & (hdr->capacity - 1)) != 0 ||
+        SHM_HEADER_SIZE + hdr->capacity * hdr->record_size > shm->map_len) {
+        munmap(shm->hdr, shm->map_len);
+        free(shm);
+        return NULL;
+    }
+
+    shm->record_size = hdr->record_size;
+    shm->mask = hdr->capacity - 1;
+    shm->pos = atomic_load_explicit(&hdr->tail, memory_order_acquire);
+    /* Nothing past tail is known to be committed until head is read */
+    shm->other = shm->pos;
+    return shm;
+}
+
+void arinc429_shm_close(arinc429_shm_t *shm)
+{
+    if (shm == NULL) {
+        return;
+    }
+    if (shm->producer) {
+        atomic_store_explicit(&shm->hdr->closed, 1, memory_order_release);
+        wake(shm, &shm->hdr->consumer_waiting, &shm->hdr->head_seq);
+    }
+    munmap(shm->hdr, shm->map_len);
+    free(shm);
+}
+
+int arinc429_shm_unlink(const char *name)
+{
+    return shm_unlink(name) == 0 ? 0 : -1;
+}
+
+#else /* _WIN32 */
+
+arinc429_shm_t *arinc429_shm_create(const char *name, int kind, size_t capacity)
+{
+    (void)name;
+    (void)kind;
+    (void)capacity;
+    return NULL;
+}
+
+arinc429_shm_t *arinc429_shm_attach(const char *name, int kind)
+{
+    (void)name;
+    (void)kind;
+    return NULL;
+}
+
+void arinc429_shm_close(arinc429_shm_t *shm)
+{
+    (void)shm;
+}
+
+int arinc429_shm_unlink(const char *name)
+{
+    (void)name;
+    return -1;
+}
+
+#endif
+
+int arinc429_shm_kind(const arinc429_shm_t *shm)
+{
+    return (int)shm->hdr->kind;
+}
+
+size_t arinc429_shm_record_size(const arinc429_shm_t *shm)
+{
+    return shm->record_size;
+}
+
+size_t arinc429_shm_reserve(arinc429_shm_t *shm, void **records, size_t max)
+{
+    const uint64_t cap = shm->mask + 1;
+    uint64_t free_slots = cap - (shm->pos - shm->other), run;
+
+    if (free_slots < max) {
+        shm->other = atomic_load_explicit(&shm->hdr->tail, memory_order_acquire);
+        free_slots = cap - (shm->pos - shm->other);
+    }
+    run = cap - (shm->pos & shm->mask);
+    if (run > free_slots) run = free_slots;
+    if (run > max) run = max;
+
+    *records = shm->records + (shm->pos & shm->mask) * shm->record_size;
+    return (size_t)run;
+}
+
+void arinc429_shm_commit(arinc429_shm_t *shm, size_t n)
+{
+    shm->pos += n;
+    atomic_store_explicit(&shm->hdr->head, shm->pos, memory_order_release);
+    wake(shm, &shm->hdr->consumer_waiting, &shm->hdr->head_seq);
+}
+
+void arinc429_shm_drop(arinc429_shm_t *shm, size_t n)
+{
+    atomic_fetch_add_explicit(&shm->hdr->dropped, n, memory_order_relaxed);
+}
+
+int arinc429_shm_wait_space(arinc429_shm_t *shm, int64_t timeout_ns)
+{
+    const uint64_t cap = shm->mask + 1;
+
+    if (shm->pos - shm->other < cap) {
+        return 1;
+    }
+    /* Room means tail > head - capacity */
+    if (wait_above(shm, &shm->hdr->tail, shm->pos - cap, &shm->hdr->producer_waiting,
+                   &shm->hdr->tail_seq, timeout_ns) <= 0) {
+        return 0;
+    }
+    shm->other = atomic_load_explicit(&shm->hdr->tail, memory_order_acquire);
+    return 1;
+}
+
+size_t arinc429_shm_peek(arinc429_shm_t *shm, const void **records, size_t max)
+{
+    uint64_t avail = shm->other - shm->pos, run;
+
+    if (avail < max) {
+        shm->other = atomic_load_explicit(&shm->hdr->head, memory_order_acquire);
+        avail = shm->other - shm->pos;
+    }
+    run = shm->mask + 1 - (shm->pos & shm->mask);
+    if (run > avail) run = avail;
+    if (run > max) run = max;
+
+    *records = shm->records + (shm->pos & shm->mask) * shm->record_size;
+    return (size_t)run;
+}
+
+void arinc429_shm_release(arinc429_shm_t *shm, size_t n)
+{
+    shm->pos += n;
+    atomic_store_explicit(&shm->hdr->tail, shm->pos, memory_order_release);
+    wake(shm, &shm->hdr->producer_waiting, &shm->hdr->tail_seq);
+}
+
+int arinc429_shm_wait(arinc429_shm_t *shm, int64_t timeout_ns)
+{
+    int r;
+
+    if (shm->other > shm->pos) {
+        return 1;
+    }
+    r = wait_above(shm, &shm->hdr->head, shm->pos, &shm->hdr->consumer_waiting,
+                   &shm->hdr->head_seq, timeout_ns);
+    if (r > 0) {
+        shm->other = atomic_load_explicit(&shm->hdr->head, memory_order_acquire);
+    } else if (r < 0 && atomic_load_explicit(&shm->hdr->head, memory_order_acquire) > shm->pos) {
+        /* Closed, but records committed before the close are still there */
+        shm->other = atomic_load_explicit(&shm->hdr->head, memory_order_acquire);
+        r = 1;
+    }
+    return r;
+}
+
+void arinc429_shm_stats(const arinc429_shm_t *shm, arinc429_shm_stats_t *stats)
+{
+    shm_header_t *hdr = shm->hdr;
+
+    stats->head = atomic_load_explicit(&hdr->head, memory_order_acquire);
+    stats->tail = atomic_load_explicit(&hdr->tail, memory_order_acquire);
+    stats->dropped = atomic_load_explicit(&hdr->dropped, memory_order_relaxed);
+    stats->capacity = shm->mask + 1;
+    stats->closed = (int)atomic_load_explicit(&hdr->closed, memory_order_acquire);
+    stats->sleeps = shm->sleeps;
+    stats->wakes = shm->wakes;
+}
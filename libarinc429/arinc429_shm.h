@@ -0,0 +1,154 @@
+/* arinc429_shm.h - Shared-memory ring for live ingest of words and flight samples
+ *
+ * A producer process (bus capture daemon, ADS-B decoder, arinc429_shm_feed)
+ * creates a POSIX shared-memory segment holding a single-producer /
+ * single-consumer ring of fixed-size records; the model (arinc429_shm_source)
+ * or any native consumer attaches to it by name. Records are written and
+ * read in place: the producer reserves a contiguous run of slots, fills it
+ * and commits; the consumer peeks at a contiguous run, uses it where it lies
+ * and releases it. Nothing is copied between the two address spaces.
+ *
+ * The handshake is two monotonically increasing 64-bit sequence counters,
+ * head (records committed) and tail (records released), each written by one
+ * side only with release ordering and read by the other with acquire. While
+ * both sides keep up, a commit or release is one store and one load of the
+ * other side's waiter flag: no locks and no system calls. A side that finds
+ * the ring empty (consumer) or full (producer) spins for
+ * ARINC429_SHM_SPIN_LIMIT polls, then raises its waiter flag and sleeps on a
+ * futex; the other side wakes it on its next commit or release only when the
+ * flag is up.
+ *
+ * A producer that must not block (a capture daemon whose bus does not wait)
+ * counts the records it cannot place with arinc429_shm_drop instead.
+ *
+ * Sleeping uses shared (not process-private) futexes on Linux and short
+ * nanosleep polls on other POSIX systems; on Windows create and attach fail.
+ */
+
+#ifndef ARINC429_SHM_H
+#define ARINC429_SHM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARINC429_SHM_DEFAULT_CAPACITY 65536    /* records, power of two */
+#define ARINC429_SHM_SPIN_LIMIT       4096     /* polls before sleeping */
+
+/* Record kinds */
+#define ARINC429_SHM_WORDS    1
+#define ARINC429_SHM_SAMPLES  2
+
+/* One packed bus word */
+typedef struct {
+    uint64_t time_ns;       /* producer timestamp */
+    uint32_t word;
+    uint32_t channel;       /* bus the word came from */
+} arinc429_shm_word_t;
+
+/* One flight sample, channels in TREND_DFA_CH_* order */
+typedef struct {
+    uint64_t time_ns;
+    uint32_t icao24;
+    uint32_t reserved;
+    double   input[TREND_DFA_NUM_CHANNELS];
+} arinc429_shm_sample_t;
+
+typedef struct {
+    uint64_t head;          /* records committed */
+    uint64_t tail;          /* records released */
+    uint64_t dropped;       /* records the producer could not place */
+    uint64_t capacity;
+    int      closed;        /* the producer has detached */
+    /* This side only */
+    uint64_t sleeps;        /* futex waits */
+    uint64_t wakes;         /* futex wakes issued */
+} arinc429_shm_stats_t;
+
+typedef struct arinc429_shm arinc429_shm_t;
+
+/* Function: arinc429_shm_create ==============================================
+ * Abstract:
+ *    Create (replacing any existing one) the segment name ("/arinc429" style)
+ *    for records of kind ARINC429_SHM_WORDS or ARINC429_SHM_SAMPLES, and
+ *    return the producer handle. capacity is rounded up to a power of two (0
+ *    selects ARINC429_SHM_DEFAULT_CAPACITY). Returns NULL on failure.
+ */
+arinc429_shm_t *arinc429_shm_create(const char *name, int kind, size_t capacity);
+
+/* Function: arinc429_shm_attach ==============================================
+ * Abstract:
+ *    Attach to an existing segment as the consumer. kind must match the
+ *    producer's (0 accepts either). Returns NULL if the segment does not
+ *    exist, is not initialised yet or holds another kind.
+ */
+arinc429_shm_t *arinc429_shm_attach(const char *name, int kind);
+
+/* Function: arinc429_shm_close ===============================================
+ * Abstract:
+ *    Detach. A producer marks the ring closed and wakes the consumer first;
+ *    the segment name stays until arinc429_shm_unlink.
+ */
+void arinc429_shm_close(arinc429_shm_t *shm);
+
+/* Remove the segment name; attached processes keep their mapping */
+int arinc429_shm_unlink(const char *name);
+
+/* Record kind and record size in bytes */
+int arinc429_shm_kind(const arinc429_shm_t *shm);
+size_t arinc429_shm_record_size(const arinc429_shm_t *shm);
+
+/* Function: arinc429_shm_reserve =============================================
+ * Abstract:
+ *    Producer: point *records at the next free slots and return how many
+ *    can be written contiguously, at most max (0 if the ring is full). The
+ *    slots become visible to the consumer with arinc429_shm_commit.
+ */
+size_t arinc429_shm_reserve(arinc429_shm_t *shm, void **records, size_t max);
+
+/* Producer: publish n reserved records, waking a sleeping consumer */
+void arinc429_shm_commit(arinc429_shm_t *shm, size_t n);
+
+/* Producer: count n records discarded because the ring was full */
+void arinc429_shm_drop(arinc429_shm_t *shm, size_t n);
+
+/* Function: arinc429_shm_wait_space ==========================================
+ * Abstract:
+ *    Producer: spin, then sleep until the ring has a free slot or
+ *    timeout_ns passes (negative waits forever). Returns 1 if there is room,
+ *    0 on timeout.
+ */
+int arinc429_shm_wait_space(arinc429_shm_t *shm, int64_t timeout_ns);
+
+/* Function: arinc429_shm_peek ================================================
+ * Abstract:
+ *    Consumer: point *records at the oldest committed records and return how
+ *    many are contiguous, at most max (0 if the ring is empty). They stay
+ *    valid until released.
+ */
+size_t arinc429_shm_peek(arinc429_shm_t *shm, const void **records, size_t max);
+
+/* Consumer: hand n peeked records back to the producer */
+void arinc429_shm_release(arinc429_shm_t *shm, size_t n);
+
+/* Function: arinc429_shm_wait ================================================
+ * Abstract:
+ *    Consumer: spin, then sleep until a record is committed or timeout_ns
+ *    passes (negative waits forever). Returns 1 if records are available, 0
+ *    on timeout and -1 if the ring is empty and the producer has closed it.
+ */
+int arinc429_shm_wait(arinc429_shm_t *shm, int64_t timeout_ns);
+
+/* Counters as seen from this side */
+void arinc429_shm_stats(const arinc429_shm_t *shm, arinc429_shm_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_SHM_H */
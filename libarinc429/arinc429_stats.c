@@ -0,0 +1,484 @@
+/* arinc429_stats.c - Per-block step latency histograms and event counters
+ *
+ * Bucket index of a duration v in ticks: v itself below 2^SUB_BITS, else
+ * (e - SUB_BITS + 1) * SUB + the SUB_BITS bits below the leading one, where
+ * e is the position of the leading one. Durations of 2^(MAX_EXP + 1) ticks
+ * or more land in the last bucket.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "arinc429_stats.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SUB_BITS     5
+#define SUB          (1 << SUB_BITS)
+#define MAX_EXP      47                  /* ~13 hours of 3 GHz TSC ticks */
+#define NUM_BUCKETS  ((MAX_EXP - SUB_BITS + 2) * SUB)
+#define CALIBRATE_NS 10000000            /* shortest TSC calibration baseline */
+
+typedef struct {
+    char    *name;
+    uint64_t calls;
+    uint64_t items;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    uint64_t counter[ARINC429_STATS_NUM_COUNTERS];
+    uint64_t bucket[NUM_BUCKETS];
+} stats_block_t;
+
+static stats_block_t *_Atomic blocks[ARINC429_STATS_MAX_BLOCKS];
+
+/* Tick and clock readings at the first registration, and the tick length
+ * measured against them once the baseline is CALIBRATE_NS old. Each is
+ * written by the thread that moves its state from 0 to 1, then published
+ * by storing 2. */
+static _Atomic int based;
+static uint64_t    base_ticks;
+static int64_t     base_ns;
+static _Atomic int calibrated;
+static double      tick_ns;
+
+static const char *const counter_names[ARINC429_STATS_NUM_COUNTERS] = {
+    "clamped", "anomaly", "enter_stable", "enter_increasing", "enter_decreasing",
+    "enter_oscillating", "enter_anomaly"
+};
+
+static int64_t clock_ns(void)
+{
+    struct timespec ts;
+
+#if defined(_WIN32)
+    timespec_get(&ts, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int leading_one(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(v);
+#else
+    int e = 0;
+
+    while (v >>= 1) {
+        e++;
+    }
+    return e;
+#endif
+}
+
+static int bucket_of(uint64_t v)
+{
+    int e;
+
+    if (v < SUB) {
+        return (int)v;
+    }
+    e = leading_one(v);
+    if (e > MAX_EXP) {
+        return NUM_BUCKETS - 1;
+    }
+    return (e - SUB_BITS + 1) * SUB + (int)((v >> (e - SUB_BITS)) & (SUB - 1));
+}
+
+/* Smallest duration falling in bucket i, and the bucket width */
+static uint64_t bucket_low(int i, uint64_t *width)
+{
+    int e;
+
+    if (i < SUB) {
+        *width = 1;
+        return (uint64_t)i;
+    }
+    e = i / SUB + SUB_BITS - 1;
+    *width = (uint64_t)1 << (e - SUB_BITS);
+    return (uint64_t)(SUB + i % SUB) << (e - SUB_BITS);
+}
+
+/* Function: ns_per_tick =====================================================
+ * Abstract:
+ *    Length of a tick in ns. The first call made at least CALIBRATE_NS after
+ *    the first registration fixes the value for good; earlier calls return
+ *    an estimate over the shorter baseline instead of waiting for it.
+ */
+static double ns_per_tick(void)
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || \
+    defined(__i386__)
+    int64_t ns;
+    uint64_t ticks;
+    double scale;
+    int expected = 0;
+
+    if (atomic_load_explicit(&calibrated, memory_order_acquire) == 2) {
+        return tick_ns;
+    }
+    if (atomic_load_explicit(&based, memory_order_acquire) != 2) {
+        return 1.0;
+    }
+    ns = clock_ns() - base_ns;
+    ticks = arinc429_stats_now() - base_ticks;
+    scale = ns > 0 && ticks > 0 ? (double)ns / (double)ticks : 1.0;
+    if (ns >= CALIBRATE_NS &&
+        atomic_compare_exchange_strong(&calibrated, &expected, 1)) {
+        tick_ns = scale;
+        atomic_store_explicit(&calibrated, 2, memory_order_release);
+    }
+    return scale;
+#else
+    return 1.0;
+#endif
+}
+
+static stats_block_t *get(int id)
+{
+    if (id < 0 || id >= ARINC429_STATS_MAX_BLOCKS) {
+        return NULL;
+    }
+    return atomic_load_explicit(&blocks[id], memory_order_acquire);
+}
+
+int arinc429_stats_register(const char *name)
+{
+    stats_block_t *b;
+    int id, expected = 0;
+
+    if (atomic_compare_exchange_strong(&based, &expected, 1)) {
+        base_ns = clock_ns();
+        base_ticks = arinc429_stats_now();
+        atomic_store_explicit(&based, 2, memory_order_release);
+    }
+
+    if (name == NULL) {
+        name = "";
+    }
+    b = (stats_block_t *)calloc(1, sizeof(*b));
+    if (b == NULL || (b->name = (char *)malloc(strlen(name) + 1)) == NULL) {
+        free(b);
+        return -1;
+    }
+    strcpy(b->name, name);
+    b->min = UINT64_MAX;
+
+    for (id = 0; id < ARINC429_STATS_MAX_BLOCKS; id++) {
+        stats_block_t *empty = NULL;
+        if (atomic_compare_exchange_strong(&blocks[id], &empty, b)) {
+            return id;
+        }
+    }
+    free(b->name);
+    free(b);
+    return -1;
+}
+
+void arinc429_stats_unregister(int id)
+{
+    stats_block_t *b;
+
+    if (id >= 0 && id < ARINC429_STATS_MAX_BLOCKS) {
+        b = atomic_exchange(&blocks[id], NULL);
+        if (b != NULL) {
+            free(b->name);
+            free(b);
+        }
+    }
+}
+
+void arinc429_stats_record(int id, uint64_t ticks, uint64_t items)
+{
+    stats_block_t *b = get(id);
+
+    if (b == NULL) {
+        return;
+    }
+    b->calls++;
+    b->items += items;
+    b->total += ticks;
+    if (ticks < b->min) b->min = ticks;
+    if (ticks > b->max) b->max = ticks;
+    b->bucket[bucket_of(ticks)]++;
+}
+
+void arinc429_stats_count(int id, int counter, uint64_t n)
+{
+    stats_block_t *b = get(id);
+
+    if (b != NULL && counter >= 0 && counter < ARINC429_STATS_NUM_COUNTERS) {
+        b->counter[counter] += n;
+    }
+}
+
+int arinc429_stats_find(const char *name)
+{
+    int id;
+
+    for (id = 0; id < ARINC429_STATS_MAX_BLOCKS; id++) {
+        stats_block_t *b = get(id);
+        if (b != NULL && strcmp(b->name, name) == 0) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+/* Duration in ticks at quantile q: the middle of the bucket holding the
+ * ceil(q * calls)-th call, kept within the recorded min and max */
+static double quantile_ticks(const stats_block_t *b, double q)
+{
+    uint64_t rank, seen = 0, low, width;
+    double v;
+    int i;
+
+    if (b->calls == 0) {
+        return 0.0;
+    }
+    if (q <= 0.0) return (double)b->min;
+    if (q >= 1.0) return (double)b->max;
+    rank = (uint64_t)(q * (double)b->calls);
+    if ((double)rank < q * (double)b->calls) rank++;
+    if (rank == 0) rank = 1;
+
+    for (i = 0; i < NUM_BUCKETS; i++) {
+        seen += b->bucket[i];
+        if (seen >= rank) {
+            break;
+        }
+    }
+    low = bucket_low(i < NUM_BUCKETS ? i : NUM_BUCKETS - 1, &width);
+    v = (double)low + (double)(width - 1) * 0.5;
+    if (v < (double)b->min) v = (double)b->min;
+    if (v > (double)b->max) v = (double)b->max;
+    return v;
+}
+
+double arinc429_stats_percentile(int id, double q)
+{
+    stats_block_t *b = get(id);
+
+    return b != NULL ? quantile_ticks(b, q) * ns_per_tick() : 0.0;
+}
+
+static void summarise(const stats_block_t *b, double scale, arinc429_stats_summary_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->name = b->name;
+    s->calls = b->calls;
+    s->items = b->items;
+    s->total_ns = (double)b->total * scale;
+    if (b->calls > 0) {
+        s->min_ns = (double)b->min * scale;
+        s->max_ns = (double)b->max * scale;
+        s->mean_ns = s->total_ns / (double)b->calls;
+    }
+    s->p50_ns = quantile_ticks(b, 0.5) * scale;
+    s->p90_ns = quantile_ticks(b, 0.9) * scale;
+    s->p99_ns = quantile_ticks(b, 0.99) * scale;
+    s->p999_ns = quantile_ticks(b, 0.999) * scale;
+    memcpy(s->counter, b->counter, sizeof(s->counter));
+}
+
+int arinc429_stats_summary(int id, arinc429_stats_summary_t *s)
+{
+    stats_block_t *b = get(id);
+
+    if (b == NULL) {
+        return -1;
+    }
+    summarise(b, ns_per_tick(), s);
+    return 0;
+}
+
+const char *arinc429_stats_counter_name(int counter)
+{
+    return counter >= 0 && counter < ARINC429_STATS_NUM_COUNTERS ? counter_names[counter] : "";
+}
+
+static void write_string(FILE *fp, const char *s)
+{
+    fputc('"', fp);
+    for (; *s != '\0'; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            fprintf(fp, "\\%c", c);
+        } else if (c < 0x20) {
+            fprintf(fp, "\\u%04x", c);      /* block paths may hold newlines */
+        } else {
+            fputc(c, fp);
+        }
+    }
+    fputc('"', fp);
+}
+
+static void write_block(FILE *fp, const stats_block_t *b, double scale, const char *indent)
+{
+    arinc429_stats_summary_t s;
+    uint64_t low, width;
+    int i, first = 1;
+
+    summarise(b, scale, &s);
+    fprintf(fp, "%s{\"block\": ", indent);
+    write_string(fp, s.name);
+    fprintf(fp, ",\n%s \"calls\": %llu, \"items\": %llu, \"total_ns\": %.0f, "
+                "\"items_per_busy_s\": %.6g,\n", indent, (unsigned long long)s.calls,
+            (unsigned long long)s.items, s.total_ns,
+            s.total_ns > 0.0 ? (double)s.items / s.total_ns * 1e9 : 0.0);
+    fprintf(fp, "%s \"min_ns\": %.1f, \"mean_ns\": %.1f, \"p50_ns\": %.1f, \"p90_ns\": %.1f, "
+                "\"p99_ns\": %.1f, \"p999_ns\": %.1f, \"max_ns\": %.1f,\n",
+            indent, s.min_ns, s.mean_ns, s.p50_ns, s.p90_ns, s.p99_ns, s.p999_ns, s.max_ns);
+    fprintf(fp, "%s \"counters\": {", indent);
+    for (i = 0; i < ARINC429_STATS_NUM_COUNTERS; i++) {
+        fprintf(fp, "%s\"%s\": %llu", i ? ", " : "", counter_names[i],
+                (unsigned long long)s.counter[i]);
+    }
+    fprintf(fp, "},\n%s \"histogram\": [", indent);
+    for (i = 0; i < NUM_BUCKETS; i++) {
+        if (b->bucket[i] == 0) {
+            continue;
+        }
+        low = bucket_low(i, &width);
+        fprintf(fp, "%s[%.1f, %.1f, %llu]", first ? "" : ", ", (double)low * scale,
+                (double)(low + width) * scale, (unsigned long long)b->bucket[i]);
+        first = 0;
+    }
+    fprintf(fp, "]}");
+}
+
+static const char *clock_name(void)
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || \
+    defined(__i386__)
+    return "tsc";
+#else
+    return "monotonic";
+#endif
+}
+
+int arinc429_stats_write_json(FILE *fp, int id)
+{
+    double scale = ns_per_tick();
+    int first = 1;
+
+    if (id >= 0) {
+        stats_block_t *b = get(id);
+        if (b == NULL) {
+            return -1;
+        }
+        write_block(fp, b, scale, "");
+        fputc('\n', fp);
+        return ferror(fp) ? -1 : 0;
+    }
+
+    fprintf(fp, "{\"clock\": \"%s\", \"ns_per_tick\": %.6g, \"blocks\": [\n", clock_name(), scale);
+    for (id = 0; id < ARINC429_STATS_MAX_BLOCKS; id++) {
+        stats_block_t *b = get(id);
+        if (b == NULL) {
+            continue;
+        }
+        if (!first) {
+            fprintf(fp, ",\n");
+        }
+        write_block(fp, b, scale, "  ");
+        first = 0;
+    }
+    fprintf(fp, "\n]}\n");
+    return ferror(fp) ? -1 : 0;
+}
+
+/* File name stem for a block name: the name with characters outside
+ * [A-Za-z0-9_-] replaced by '_', cut to fit stem and then ending in '-' and
+ * the FNV-1a hash of the whole name, so long names that share a prefix
+ * still get files of their own */
+static void file_stem(const char *name, char *stem)
+{
+    const size_t len = strlen(name);
+    const size_t keep = len < ARINC429_STATS_NAME_LEN ? len : ARINC429_STATS_NAME_LEN - 10;
+    uint32_t hash = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < keep; i++) {
+        char c = name[i];
+        stem[i] = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') ||
+                  c == '_' || c == '-' ? c : '_';
+    }
+    stem[keep] = '\0';
+    if (keep < len) {
+        for (i = 0; i < len; i++) {
+            hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+        }
+        snprintf(stem + keep, 10, "-%08x", (unsigned)hash);
+    }
+}
+
+int arinc429_stats_dump(int id, const char *dir, char *path, size_t path_len)
+{
+    char file[1024], stem[ARINC429_STATS_NAME_LEN];
+    stats_block_t *b = get(id);
+    FILE *fp;
+    int status;
+
+    if (b == NULL) {
+        return -1;
+    }
+    if (dir == NULL && (dir = getenv("ARINC429_STATS_DIR")) == NULL) {
+        dir = ".";
+    }
+    file_stem(b->name, stem);
+    if ((size_t)snprintf(file, sizeof(file), "%s/%s.stats.json", dir, stem) >= sizeof(file)) {
+        return -1;
+    }
+    if (path != NULL && path_len > 0) {
+        strncpy(path, file, path_len - 1);
+        path[path_len - 1] = '\0';
+    }
+
+    fp = fopen(file, "w");
+    if (fp == NULL) {
+        return -1;
+    }
+    status = arinc429_stats_write_json(fp, id);
+    if (fclose(fp) != 0) {
+        status = -1;
+    }
+    return status;
+}
+
+int arinc429_stats_report(int id, char *line, size_t line_len)
+{
+    char file[1024];
+    arinc429_stats_summary_t s;
+    int status;
+
+    if (line == NULL || line_len == 0) {
+        return -1;
+    }
+    if (arinc429_stats_summary(id, &s) != 0) {
+        snprintf(line, line_len, "stats: block not registered");
+        return -1;
+    }
+    status = arinc429_stats_dump(id, NULL, file, sizeof(file));
+    snprintf(line, line_len,
+             "%s: %llu calls, p50 %.0f ns, p99 %.0f ns, p99.9 %.0f ns, max %.0f ns; %s %s", s.name,
+             (unsigned long long)s.calls, s.p50_ns, s.p99_ns, s.p999_ns, s.max_ns,
+             status == 0 ? "written to" : "cannot write", file);
+    return status;
+}
+
+void arinc429_stats_reset(int id)
+{
+    stats_block_t *b = get(id);
+
+    if (b != NULL) {
+        b->calls = b->items = b->total = b->max = 0;
+        b->min = UINT64_MAX;
+        memset(b->counter, 0, sizeof(b->counter));
+        memset(b->bucket, 0, sizeof(b->bucket));
+    }
+}
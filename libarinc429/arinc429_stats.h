@@ -0,0 +1,173 @@
+/* arinc429_stats.h - Per-block step latency histograms and event counters
+ *
+ * Each instrumented block (an S-function instance, or a library entry point
+ * in a native run) registers under a name and then records, per call, the
+ * elapsed time and the number of items processed (words, tracks, rows) into
+ * a log-linear histogram: exact below 32 ticks, then 32 sub-buckets per power
+ * of two, so any percentile is within 3% of the recorded value. Counters
+ * cover calls, clamped encoder inputs, anomaly steps and DFA transitions into
+ * each state. Results are read back with the query functions below or written
+ * as JSON, which the S-functions do at mdlTerminate.
+ *
+ * Time is read with rdtsc on x86 and CLOCK_MONOTONIC elsewhere. TSC ticks are
+ * converted to nanoseconds only when results are read, against
+ * CLOCK_MONOTONIC over the time since the first registration, which assumes
+ * an invariant TSC (any x86 from the last decade). The first read at least
+ * 10 ms after that registration fixes the conversion; reads before then use
+ * the shorter baseline and never wait.
+ *
+ * Instrumentation is selected at compile time, like ARINC429_TRACE: build
+ * with -DARINC429_STATS=1 to enable it. Otherwise the ARINC429_STATS_* macros
+ * expand to nothing and their arguments are not evaluated.
+ *
+ * A block must be recorded from one thread at a time (as Simulink runs a
+ * block); different blocks may be recorded from different threads.
+ */
+
+#ifndef ARINC429_STATS_H
+#define ARINC429_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "trend_dfa_config.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ARINC429_STATS
+#define ARINC429_STATS 0
+#endif
+
+#define ARINC429_STATS_MAX_BLOCKS  64
+#define ARINC429_STATS_NAME_LEN    96  /* longest file name stem, see arinc429_stats_dump */
+#define ARINC429_STATS_LINE_LEN    (ARINC429_STATS_NAME_LEN + 1024 + 128)
+
+/* Counters */
+#define ARINC429_STATS_CLAMPED       0   /* encoder inputs outside 0..99999 */
+#define ARINC429_STATS_ANOMALY       1   /* track steps in STATE_ANOMALY */
+#define ARINC429_STATS_ENTER(state)  (1 + (state))   /* transitions into STATE_* */
+#define ARINC429_STATS_NUM_COUNTERS  (2 + TREND_DFA_NUM_STATES)
+
+typedef struct {
+    const char *name;
+    uint64_t    calls;
+    uint64_t    items;
+    double      total_ns;       /* time inside the block */
+    double      min_ns;
+    double      max_ns;
+    double      mean_ns;        /* per call */
+    double      p50_ns;
+    double      p90_ns;
+    double      p99_ns;
+    double      p999_ns;
+    uint64_t    counter[ARINC429_STATS_NUM_COUNTERS];
+} arinc429_stats_summary_t;
+
+/* Current time in ticks (TSC cycles on x86, nanoseconds elsewhere) */
+static inline uint64_t arinc429_stats_now(void)
+{
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || defined(__x86_64__) || \
+    defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Function: arinc429_stats_register ==========================================
+ * Abstract:
+ *    Allocate the histogram and counters for a block called name (e.g. the
+ *    block path, kept in full) and return its id, or -1 if
+ *    ARINC429_STATS_MAX_BLOCKS blocks are registered or memory runs out.
+ */
+int arinc429_stats_register(const char *name);
+
+/* Release a block's slot (after its results have been read) */
+void arinc429_stats_unregister(int id);
+
+/* Function: arinc429_stats_record ============================================
+ * Abstract:
+ *    Count one call of ticks duration that processed items items. Never
+ *    blocks and never allocates; ignores id -1.
+ */
+void arinc429_stats_record(int id, uint64_t ticks, uint64_t items);
+
+/* Add n to counter ARINC429_STATS_* of block id */
+void arinc429_stats_count(int id, int counter, uint64_t n);
+
+/* Id of the block registered as name, or -1 */
+int arinc429_stats_find(const char *name);
+
+/* Function: arinc429_stats_summary ===========================================
+ * Abstract:
+ *    Fill s with the block's calls, items, latency percentiles in
+ *    nanoseconds and counters. Returns 0, or -1 for an unknown id.
+ */
+int arinc429_stats_summary(int id, arinc429_stats_summary_t *s);
+
+/* Latency of block id at quantile q (0..1) in nanoseconds, 0 if no calls */
+double arinc429_stats_percentile(int id, double q);
+
+/* JSON key of a counter ("clamped", "anomaly", "enter_stable", ...) */
+const char *arinc429_stats_counter_name(int counter);
+
+/* Function: arinc429_stats_write_json ========================================
+ * Abstract:
+ *    Write block id as one JSON object (summary, counters and the non-empty
+ *    histogram buckets as [lower_ns, upper_ns, count]), or with id -1 every
+ *    registered block as {"clock": ..., "blocks": [...]}. Returns 0 or -1.
+ */
+int arinc429_stats_write_json(FILE *fp, int id);
+
+/* Function: arinc429_stats_dump ==============================================
+ * Abstract:
+ *    Write block id as JSON to <dir>/<name>.stats.json, with characters of
+ *    the name outside [A-Za-z0-9_-] replaced by '_'. A name of
+ *    ARINC429_STATS_NAME_LEN characters or more is cut and ends in a hash
+ *    of the whole name instead, so blocks never share a file. dir NULL uses
+ *    $ARINC429_STATS_DIR, or the current directory. The path written goes
+ *    to path (may be NULL). Returns 0 or -1.
+ */
+int arinc429_stats_dump(int id, const char *dir, char *path, size_t path_len);
+
+/* Function: arinc429_stats_report ============================================
+ * Abstract:
+ *    End-of-run report for a block: dump it with arinc429_stats_dump(id,
+ *    NULL, ...) and put a one-line summary (calls, p50/p99/p99.9/max and the
+ *    file written) into line, which should hold ARINC429_STATS_LINE_LEN
+ *    characters. Returns the dump status.
+ */
+int arinc429_stats_report(int id, char *line, size_t line_len);
+
+/* Clear a block's histogram and counters */
+void arinc429_stats_reset(int id);
+
+#if ARINC429_STATS
+#define ARINC429_STATS_START(t)              uint64_t t = arinc429_stats_now()
+#define ARINC429_STATS_STOP(id, t, items)    arinc429_stats_record((id), arinc429_stats_now() - (t), (items))
+#define ARINC429_STATS_COUNT(id, counter, n) arinc429_stats_count((id), (counter), (n))
+#else
+#define ARINC429_STATS_START(t)              ((void)0)
+#define ARINC429_STATS_STOP(id, t, items)    ((void)0)
+#define ARINC429_STATS_COUNT(id, counter, n) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_STATS_H */
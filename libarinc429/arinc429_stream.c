@@ -0,0 +1,86 @@
+/* arinc429_stream.c - Lazy, subscription-filtered view over packed words */
+
+#include "arinc429_stream.h"
+
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "arinc429_word.h"
+
+void arinc429_stream_init(arinc429_stream_t *s, const uint32_t *words, size_t n,
+                          const arinc429_subscription_t *sub, const arinc429_rx_t *defs)
+{
+    s->words = words;
+    s->num_words = n;
+    s->pos = 0;
+    s->sub = sub;
+    s->defs = defs;
+}
+
+int arinc429_stream_value(const arinc429_stream_t *s, size_t index, double *value)
+{
+    uint32_t word = s->words[index];
+    const arinc429_rx_entry_t *e;
+
+    if (s->defs == NULL ||
+        (e = &s->defs->entry[arinc429_rx_index(word)])->kind == ARINC429_RX_NONE) {
+        *value = 0.0;
+        return 1;
+    }
+    if (e->kind != ARINC429_RX_BCD && !arinc429_word_parity_ok(word)) {
+        arinc429_rx_decode(e, word, value);
+        return ARINC429_ERR_PARITY;
+    }
+    return arinc429_rx_decode(e, word, value);
+}
+
+#if !defined(_WIN32)
+
+int arinc429_capture_open(arinc429_capture_t *cap, const char *path)
+{
+    struct stat st;
+    void *map;
+    int fd;
+
+    memset(cap, 0, sizeof(*cap));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size < (off_t)sizeof(uint32_t)) {
+        close(fd);
+        return 0;               /* empty capture */
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    cap->words = (const uint32_t *)map;
+    cap->map_len = (size_t)st.st_size;
+    cap->num_words = cap->map_len / sizeof(uint32_t);
+    return 0;
+}
+
+void arinc429_capture_close(arinc429_capture_t *cap)
+{
+    if (cap->words != NULL) {
+        munmap((void *)cap->words, cap->map_len);
+        cap->words = NULL;
+    }
+}
+
+#endif /* !_WIN32 */
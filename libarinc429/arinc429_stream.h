@@ -0,0 +1,119 @@
+/* arinc429_stream.h - Lazy, subscription-filtered view over packed words
+ *
+ * A view iterates packed 32-bit words in place, from a mapped capture file
+ * or any caller buffer; nothing is copied or unpacked. Filtering looks only
+ * at the label byte as received (bits 1-8, still reversed) against a 256-bit
+ * subscription bitmap, so an unsubscribed word costs one load and one bit
+ * test. Decoding happens only when a value is asked for, with the decoder of
+ * the label's entry in an arinc429_rx_t definition table.
+ *
+ * Capture files are raw little-endian packed words, as written by
+ * arinc429_bus_sim -w.
+ */
+
+#ifndef ARINC429_STREAM_H
+#define ARINC429_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arinc429_label.h"
+#include "arinc429_rx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARINC429_STREAM_END ((size_t)-1)
+
+/* Bit per label byte as received */
+typedef struct {
+    uint64_t bits[4];
+} arinc429_subscription_t;
+
+typedef struct {
+    const uint32_t                *words;
+    size_t                         num_words;
+    size_t                         pos;         /* next word to examine */
+    const arinc429_subscription_t *sub;
+    const arinc429_rx_t           *defs;        /* decoder per label and SDI */
+} arinc429_stream_t;
+
+typedef struct {
+    const uint32_t *words;
+    size_t          num_words;
+    size_t          map_len;
+} arinc429_capture_t;
+
+static inline void arinc429_sub_clear(arinc429_subscription_t *sub)
+{
+    sub->bits[0] = sub->bits[1] = sub->bits[2] = sub->bits[3] = 0;
+}
+
+/* Subscribe to an octal label */
+static inline void arinc429_sub_add(arinc429_subscription_t *sub, uint8_t label)
+{
+    uint8_t raw = arinc429_label_reverse(label);
+
+    sub->bits[raw >> 6] |= (uint64_t)1 << (raw & 63);
+}
+
+/* Non-zero if word carries a subscribed label */
+static inline int arinc429_sub_match(const arinc429_subscription_t *sub, uint32_t word)
+{
+    uint32_t raw = word & 0xFFu;
+
+    return (int)((sub->bits[raw >> 6] >> (raw & 63)) & 1u);
+}
+
+/* Function: arinc429_stream_init =============================================
+ * Abstract:
+ *    View n words at words, keeping those sub matches. defs supplies the
+ *    decoders for arinc429_stream_value and may be NULL if only raw words
+ *    are needed. Neither the words nor sub or defs are copied.
+ */
+void arinc429_stream_init(arinc429_stream_t *s, const uint32_t *words, size_t n,
+                          const arinc429_subscription_t *sub, const arinc429_rx_t *defs);
+
+/* Function: arinc429_stream_next =============================================
+ * Abstract:
+ *    Index of the next subscribed word, or ARINC429_STREAM_END.
+ */
+static inline size_t arinc429_stream_next(arinc429_stream_t *s)
+{
+    const uint32_t *w = s->words;
+    size_t i = s->pos, n = s->num_words;
+
+    while (i < n && !arinc429_sub_match(s->sub, w[i])) {
+        i++;
+    }
+    if (i == n) {
+        s->pos = n;
+        return ARINC429_STREAM_END;
+    }
+    s->pos = i + 1;
+    return i;
+}
+
+/* Function: arinc429_stream_value ============================================
+ * Abstract:
+ *    Decode word index with its label's decoder from defs. Returns
+ *    ARINC429_OK, ARINC429_ERR_PARITY, ARINC429_ERR_BCD_DIGIT, or 1 if the
+ *    label and SDI have no definition (*value is then 0).
+ */
+int arinc429_stream_value(const arinc429_stream_t *s, size_t index, double *value);
+
+/* Function: arinc429_capture_open ============================================
+ * Abstract:
+ *    Map a capture file read-only (POSIX only). A trailing partial word is
+ *    ignored. Returns 0 or -1.
+ */
+int arinc429_capture_open(arinc429_capture_t *cap, const char *path);
+
+void arinc429_capture_close(arinc429_capture_t *cap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_STREAM_H */
@@ -0,0 +1,172 @@
+/* arinc429_trace.c - Binary trace ring for codec diagnostics
+ *
+ * Producers claim a slot with one fetch-add on the write index, fill it and
+ * publish it by storing index + 1 into the slot's sequence word. The consumer
+ * copies a slot and re-reads the sequence word afterwards; if it changed, a
+ * producer lapped the ring during the copy and the record counts as dropped.
+ */
+
+#include "arinc429_trace.h"
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+#define TRACE_MASK ((uint64_t)ARINC429_TRACE_CAPACITY - 1)
+
+#if (ARINC429_TRACE_CAPACITY & (ARINC429_TRACE_CAPACITY - 1)) != 0
+#error "ARINC429_TRACE_CAPACITY must be a power of two"
+#endif
+
+typedef struct {
+    _Atomic uint64_t seq;              /* index + 1 once published, 0 while written */
+    arinc429_trace_record_t rec;
+} trace_slot_t;
+
+static trace_slot_t     ring[ARINC429_TRACE_CAPACITY];
+static _Atomic uint64_t write_idx;
+static uint64_t         read_idx;      /* consumer only */
+static _Atomic uint64_t dropped;
+static uint64_t         dropped_reported;
+
+/* Block slots: free, claimed while the name is written, then named */
+enum { BLOCK_FREE = 0, BLOCK_CLAIMED, BLOCK_NAMED };
+
+static char        block_name[ARINC429_TRACE_MAX_BLOCKS][ARINC429_TRACE_NAME_LEN];
+static _Atomic int block_state[ARINC429_TRACE_MAX_BLOCKS];
+
+int arinc429_trace_register(const char *name)
+{
+    int id;
+
+    for (id = 0; id < ARINC429_TRACE_MAX_BLOCKS; id++) {
+        int expected = BLOCK_FREE;
+        if (atomic_compare_exchange_strong(&block_state[id], &expected, BLOCK_CLAIMED)) {
+            strncpy(block_name[id], name != NULL ? name : "", ARINC429_TRACE_NAME_LEN - 1);
+            block_name[id][ARINC429_TRACE_NAME_LEN - 1] = '\0';
+            atomic_store_explicit(&block_state[id], BLOCK_NAMED, memory_order_release);
+            return id;
+        }
+    }
+    return -1;
+}
+
+void arinc429_trace_unregister(int id)
+{
+    if (id >= 0 && id < ARINC429_TRACE_MAX_BLOCKS) {
+        atomic_store_explicit(&block_state[id], BLOCK_FREE, memory_order_release);
+    }
+}
+
+void arinc429_trace_record(int kind, int block_id, double time, uint32_t raw,
+                           const int *digits, double value)
+{
+    uint64_t idx = atomic_fetch_add_explicit(&write_idx, 1, memory_order_relaxed);
+    trace_slot_t *slot = &ring[idx & TRACE_MASK];
+    int i;
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->rec.time = time;
+    slot->rec.value = value;
+    slot->rec.raw = raw;
+    slot->rec.block_id = (uint16_t)block_id;
+    slot->rec.kind = (uint8_t)kind;
+    for (i = 0; i < ARINC429_BCD_NUM_DIGITS; i++) {
+        slot->rec.digits[i] = (uint8_t)digits[i];
+    }
+
+    atomic_store_explicit(&slot->seq, idx + 1, memory_order_release);
+}
+
+int arinc429_trace_pop(arinc429_trace_record_t *rec)
+{
+    for (;;) {
+        uint64_t w = atomic_load_explicit(&write_idx, memory_order_acquire);
+        trace_slot_t *slot;
+        uint64_t s1, s2;
+
+        if (read_idx == w) {
+            return 0;
+        }
+        /* Everything older than one lap has been overwritten */
+        if (w - read_idx > ARINC429_TRACE_CAPACITY) {
+            atomic_fetch_add_explicit(&dropped, w - read_idx - ARINC429_TRACE_CAPACITY,
+                                      memory_order_relaxed);
+            read_idx = w - ARINC429_TRACE_CAPACITY;
+        }
+
+        slot = &ring[read_idx & TRACE_MASK];
+        s1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (s1 != read_idx + 1) {
+            if (s1 > read_idx + 1) {
+                /* Already reused by a later lap */
+                atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+                read_idx++;
+                continue;
+            }
+            return 0;   /* producer has not published it yet */
+        }
+
+        *rec = slot->rec;
+        atomic_thread_fence(memory_order_acquire);
+        s2 = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+        read_idx++;
+        if (s2 == s1) {
+            return 1;
+        }
+        atomic_fetch_add_explicit(&dropped, 1, memory_order_relaxed);
+    }
+}
+
+int arinc429_trace_format(const arinc429_trace_record_t *rec, char *buf, size_t len)
+{
+    char bits[ARINC429_BCD_NUM_BITS + 1];
+    const char *name = "?";
+    int i;
+
+    for (i = 0; i < ARINC429_BCD_NUM_BITS; i++) {
+        bits[i] = (char)('0' + ((rec->raw >> (ARINC429_BCD_NUM_BITS - 1 - i)) & 1u));
+    }
+    bits[ARINC429_BCD_NUM_BITS] = '\0';
+
+    if (rec->block_id < ARINC429_TRACE_MAX_BLOCKS &&
+        atomic_load_explicit(&block_state[rec->block_id], memory_order_acquire) == BLOCK_NAMED) {
+        name = block_name[rec->block_id];
+    }
+
+    return snprintf(buf, len, "%s t=%g %s bits=%s digits=%d %d %d %d %d value=%f",
+                    name, rec->time,
+                    rec->kind == ARINC429_TRACE_BCD_ENCODE ? "encode" : "decode",
+                    bits, rec->digits[0], rec->digits[1], rec->digits[2],
+                    rec->digits[3], rec->digits[4], rec->value);
+}
+
+size_t arinc429_trace_drain(arinc429_trace_sink_t sink, void *ctx)
+{
+    arinc429_trace_record_t rec;
+    char line[ARINC429_TRACE_LINE_LEN];
+    size_t count = 0;
+    uint64_t lost;
+
+    while (arinc429_trace_pop(&rec)) {
+        arinc429_trace_format(&rec, line, sizeof(line));
+        sink(line, ctx);
+        count++;
+    }
+
+    lost = atomic_load_explicit(&dropped, memory_order_relaxed);
+    if (lost != dropped_reported) {
+        snprintf(line, sizeof(line), "trace: %llu records overwritten before drain",
+                 (unsigned long long)(lost - dropped_reported));
+        sink(line, ctx);
+        dropped_reported = lost;
+    }
+    return count;
+}
+
+uint64_t arinc429_trace_dropped(void)
+{
+    return atomic_load_explicit(&dropped, memory_order_relaxed);
+}
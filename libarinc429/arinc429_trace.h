@@ -0,0 +1,116 @@
+/* arinc429_trace.h - Binary trace ring for codec diagnostics
+ *
+ * The BCD S-functions record one fixed-size binary record per sample
+ * (block id, simulation time, raw 19-bit field, digits, value) into a
+ * preallocated ring instead of printing from mdlOutputs. Records are
+ * formatted only when the ring is drained, normally at mdlTerminate.
+ *
+ * Tracing is selected at compile time: build with -DARINC429_TRACE=1 to
+ * enable it. Otherwise ARINC429_TRACE_RECORD expands to nothing and its
+ * arguments are not evaluated.
+ *
+ * Any number of threads may record concurrently (one atomic add per
+ * record); draining is single-consumer. When the ring is full the oldest
+ * records are overwritten and counted as dropped.
+ */
+
+#ifndef ARINC429_TRACE_H
+#define ARINC429_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arinc429_bcd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef ARINC429_TRACE
+#define ARINC429_TRACE 0
+#endif
+
+#define ARINC429_TRACE_CAPACITY    8192    /* records, power of two */
+#define ARINC429_TRACE_MAX_BLOCKS  64
+#define ARINC429_TRACE_NAME_LEN    96
+#define ARINC429_TRACE_LINE_LEN    256
+
+/* Record kinds */
+#define ARINC429_TRACE_BCD_DECODE  1
+#define ARINC429_TRACE_BCD_ENCODE  2
+
+typedef struct {
+    double   time;                              /* simulation time */
+    double   value;                             /* decoded value or encoder input */
+    uint32_t raw;                               /* 19-bit field, character 1 in bits 16-18 */
+    uint16_t block_id;                          /* from arinc429_trace_register */
+    uint8_t  kind;                              /* ARINC429_TRACE_BCD_* */
+    uint8_t  digits[ARINC429_BCD_NUM_DIGITS];   /* MSB to LSB */
+} arinc429_trace_record_t;
+
+typedef void (*arinc429_trace_sink_t)(const char *line, void *ctx);
+
+/* Function: arinc429_trace_register ==========================================
+ * Abstract:
+ *    Assign a free block id for name (e.g. the block path). Returns -1 while
+ *    ARINC429_TRACE_MAX_BLOCKS blocks are registered; such records are
+ *    still kept but printed without a name.
+ */
+int arinc429_trace_register(const char *name);
+
+/* Free a block id for reuse, once its records have been drained (the
+ * S-functions do both at mdlTerminate). Ignores -1. */
+void arinc429_trace_unregister(int id);
+
+/* Function: arinc429_trace_record ============================================
+ * Abstract:
+ *    Append one record. Never blocks and never allocates.
+ */
+void arinc429_trace_record(int kind, int block_id, double time, uint32_t raw,
+                           const int *digits, double value);
+
+/* Function: arinc429_trace_pop ===============================================
+ * Abstract:
+ *    Remove the oldest record. Returns 1 if rec was filled, 0 if the ring
+ *    is empty (or the next record is still being written).
+ */
+int arinc429_trace_pop(arinc429_trace_record_t *rec);
+
+/* Format rec as one text line (no newline); returns the snprintf result */
+int arinc429_trace_format(const arinc429_trace_record_t *rec, char *buf, size_t len);
+
+/* Function: arinc429_trace_drain =============================================
+ * Abstract:
+ *    Pop and format every pending record, passing each line to sink, then
+ *    report records lost to overwriting since the previous drain. Returns
+ *    the number of records drained.
+ */
+size_t arinc429_trace_drain(arinc429_trace_sink_t sink, void *ctx);
+
+/* Records overwritten before they were drained (running total) */
+uint64_t arinc429_trace_dropped(void);
+
+/* Pack the 19-element bit array of the bits codec (MSB first) into a field */
+static inline uint32_t arinc429_trace_pack_bits(const uint8_t *bits)
+{
+    uint32_t raw = 0;
+    int i;
+
+    for (i = 0; i < ARINC429_BCD_NUM_BITS; i++) {
+        raw = (raw << 1) | (bits[i] & 1u);
+    }
+    return raw;
+}
+
+#if ARINC429_TRACE
+#define ARINC429_TRACE_RECORD(kind, block_id, time, raw, digits, value) \
+    arinc429_trace_record((kind), (block_id), (time), (raw), (digits), (value))
+#else
+#define ARINC429_TRACE_RECORD(kind, block_id, time, raw, digits, value) ((void)0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_TRACE_H */
@@ -0,0 +1,209 @@
+/* arinc429_tx.c - Event-driven ARINC 429 bus transmitter scheduler */
+
+#include "arinc429_tx.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "arinc429_bcd.h"
+
+#define WHEEL_MASK ((uint64_t)ARINC429_TX_WHEEL_SLOTS - 1)
+
+#if (ARINC429_TX_WHEEL_SLOTS & (ARINC429_TX_WHEEL_SLOTS - 1)) != 0 || ARINC429_TX_WHEEL_SLOTS % 64 != 0
+#error "ARINC429_TX_WHEEL_SLOTS must be a power of two and at least 64"
+#endif
+
+static int ctz64(uint64_t x)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int n = 0;
+    while (!(x & 1u)) {
+        x >>= 1;
+        n++;
+    }
+    return n;
+#endif
+}
+
+static uint64_t slot_of(const arinc429_tx_channel_t *ch, uint64_t time_ns)
+{
+    return (time_ns + ch->word_ns - 1) / ch->word_ns;
+}
+
+static void wheel_insert(arinc429_tx_channel_t *ch, uint32_t idx)
+{
+    uint64_t s = ch->entry[idx].due_slot & WHEEL_MASK;
+
+    ch->entry[idx].next = ch->wheel[s];
+    ch->wheel[s] = idx;
+    ch->occupied[s >> 6] |= (uint64_t)1 << (s & 63);
+}
+
+static void ready_push(arinc429_tx_channel_t *ch, uint32_t idx)
+{
+    ch->entry[idx].next = ARINC429_TX_NONE;
+    if (ch->ready_head == ARINC429_TX_NONE) {
+        ch->ready_head = idx;
+    } else {
+        ch->entry[ch->ready_tail].next = idx;
+    }
+    ch->ready_tail = idx;
+}
+
+/* Move the labels of slot now that are due to the ready queue; labels for a
+ * later turn of the wheel stay */
+static void collect(arinc429_tx_channel_t *ch)
+{
+    uint64_t s = ch->now & WHEEL_MASK;
+    uint32_t *link = &ch->wheel[s];
+
+    while (*link != ARINC429_TX_NONE) {
+        uint32_t idx = *link;
+        if (ch->entry[idx].due_slot <= ch->now) {
+            *link = ch->entry[idx].next;
+            ready_push(ch, idx);
+        } else {
+            link = &ch->entry[idx].next;
+        }
+    }
+    if (ch->wheel[s] == ARINC429_TX_NONE) {
+        ch->occupied[s >> 6] &= ~((uint64_t)1 << (s & 63));
+    }
+}
+
+/* Distance from now to the next occupied wheel slot, or 0 if the wheel is empty */
+static uint64_t next_occupied(const arinc429_tx_channel_t *ch)
+{
+    uint64_t start = (ch->now + 1) & WHEEL_MASK;
+    uint64_t pos = start;
+    uint64_t scanned = 0;
+
+    while (scanned < ARINC429_TX_WHEEL_SLOTS) {
+        uint64_t bits = ch->occupied[pos >> 6] >> (pos & 63);
+        if (bits != 0) {
+            uint64_t hit = pos + (uint64_t)ctz64(bits);
+            return ((hit - ch->now) & WHEEL_MASK) == 0 ? ARINC429_TX_WHEEL_SLOTS
+                                                      : ((hit - ch->now) & WHEEL_MASK);
+        }
+        scanned += 64 - (pos & 63);
+        pos = (pos + 64 - (pos & 63)) & WHEEL_MASK;
+    }
+    return 0;
+}
+
+int arinc429_tx_init(arinc429_tx_channel_t *ch, uint32_t bit_rate,
+                     const arinc429_tx_label_t *labels, size_t n)
+{
+    size_t i;
+
+    memset(ch, 0, sizeof(*ch));
+    if (bit_rate == 0 || n >= ARINC429_TX_NONE) {
+        return -1;
+    }
+    ch->bit_rate = bit_rate;
+    ch->word_ns = (uint64_t)(ARINC429_TX_WORD_BITS + ARINC429_TX_GAP_BITS) * 1000000000u / bit_rate;
+    ch->ready_head = ARINC429_TX_NONE;
+    ch->ready_tail = ARINC429_TX_NONE;
+    for (i = 0; i < ARINC429_TX_WHEEL_SLOTS; i++) {
+        ch->wheel[i] = ARINC429_TX_NONE;
+    }
+
+    ch->entry = (arinc429_tx_entry_t *)calloc(n != 0 ? n : 1, sizeof(arinc429_tx_entry_t));
+    if (ch->entry == NULL) {
+        return -1;
+    }
+    ch->num_labels = n;
+
+    for (i = 0; i < n; i++) {
+        arinc429_tx_entry_t *e = &ch->entry[i];
+        if (!(labels[i].period > 0.0) || !(labels[i].offset >= 0.0)) {
+            arinc429_tx_free(ch);
+            return -1;
+        }
+        e->label = labels[i].label;
+        e->sdi = labels[i].sdi;
+        e->period_ns = (uint64_t)(labels[i].period * 1e9 + 0.5);
+        if (e->period_ns == 0) {
+            e->period_ns = 1;
+        }
+        e->due_ns = (uint64_t)(labels[i].offset * 1e9 + 0.5);
+        e->due_slot = slot_of(ch, e->due_ns);
+        e->word = arinc429_bcd_encode_word(e->label, e->sdi, 0.0);
+        wheel_insert(ch, (uint32_t)i);
+    }
+    return 0;
+}
+
+void arinc429_tx_set_value(arinc429_tx_channel_t *ch, size_t index, double value)
+{
+    arinc429_tx_entry_t *e = &ch->entry[index];
+
+    e->word = arinc429_bcd_encode_word(e->label, e->sdi, value);
+}
+
+void arinc429_tx_set_word(arinc429_tx_channel_t *ch, size_t index, uint32_t word)
+{
+    ch->entry[index].word = word;
+}
+
+uint64_t arinc429_tx_run(arinc429_tx_channel_t *ch, uint64_t until_ns,
+                         arinc429_tx_sink_t sink, void *ctx)
+{
+    uint64_t limit = slot_of(ch, until_ns);
+    uint64_t sent = 0;
+
+    while (ch->now < limit) {
+        collect(ch);
+
+        if (ch->ready_head != ARINC429_TX_NONE) {
+            uint32_t idx = ch->ready_head;
+            arinc429_tx_entry_t *e = &ch->entry[idx];
+            uint64_t t = ch->now * ch->word_ns;
+            uint64_t latency = t - e->due_ns;
+
+            ch->ready_head = e->next;
+            if (sink != NULL) {
+                sink(t, e->word, ctx);
+            }
+            sent++;
+            if (latency > ch->max_latency_ns) {
+                ch->max_latency_ns = latency;
+            }
+            ch->sum_latency_ns += latency;
+
+            /* Next nominal time; an overloaded bus queues it for the next slot */
+            e->due_ns += e->period_ns;
+            e->due_slot = slot_of(ch, e->due_ns);
+            if (e->due_slot <= ch->now) {
+                e->due_slot = ch->now + 1;
+            }
+            wheel_insert(ch, idx);
+            ch->now++;
+        } else {
+            /* Bus idle: jump to the next slot that has labels */
+            uint64_t skip = next_occupied(ch);
+            if (skip == 0 || ch->now + skip > limit) {
+                ch->now = limit;
+            } else {
+                ch->now += skip;
+            }
+        }
+    }
+
+    ch->words += sent;
+    return sent;
+}
+
+double arinc429_tx_utilisation(const arinc429_tx_channel_t *ch)
+{
+    return ch->now > 0 ? (double)ch->words / (double)ch->now : 0.0;
+}
+
+void arinc429_tx_free(arinc429_tx_channel_t *ch)
+{
+    free(ch->entry);
+    ch->entry = NULL;
+    ch->num_labels = 0;
+}
@@ -0,0 +1,107 @@
+/* arinc429_tx.h - Event-driven ARINC 429 bus transmitter scheduler
+ *
+ * One arinc429_tx_channel_t models one transmitter: a list of labels, each
+ * refreshed at its own period, sent one word at a time on a high-speed
+ * (100 kbit/s) or low-speed (12.5 kbit/s) bus. A word occupies 32 bit times
+ * plus the 4-bit-time gap, so time advances in whole word slots.
+ *
+ * Labels wait on a hashed timing wheel of ARINC429_TX_WHEEL_SLOTS word slots
+ * (periods longer than one turn simply stay on the wheel for more turns).
+ * A slot's due labels move to a FIFO ready queue and the bus sends the queue
+ * head, one word per slot; stretches with nothing due are skipped through an
+ * occupancy bitmap, so the cost is per word sent, not per label or per slot.
+ * Periods are kept in nanoseconds against the nominal schedule, so queueing
+ * delay shows up as latency but never as drift.
+ *
+ * Words are encoded when a value is set (arinc429_bcd_encode_word, label in
+ * the on-wire reversed order) and only copied at transmission.
+ */
+
+#ifndef ARINC429_TX_H
+#define ARINC429_TX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARINC429_TX_HIGH_SPEED   100000u    /* bit/s */
+#define ARINC429_TX_LOW_SPEED    12500u
+#define ARINC429_TX_WORD_BITS    32
+#define ARINC429_TX_GAP_BITS     4
+#define ARINC429_TX_WHEEL_SLOTS  4096       /* power of two */
+
+#define ARINC429_TX_NONE         0xFFFFFFFFu
+
+/* One scheduled label */
+typedef struct {
+    uint8_t label;      /* octal label as written, e.g. 0203 */
+    uint8_t sdi;
+    double  period;     /* refresh period, seconds */
+    double  offset;     /* first transmission, seconds */
+} arinc429_tx_label_t;
+
+typedef struct {
+    uint32_t word;          /* current packed word */
+    uint32_t next;          /* wheel or ready list link */
+    uint8_t  label;
+    uint8_t  sdi;
+    uint64_t period_ns;
+    uint64_t due_ns;        /* nominal time of the next transmission */
+    uint64_t due_slot;      /* first word slot at or after due_ns */
+} arinc429_tx_entry_t;
+
+typedef struct {
+    uint32_t             bit_rate;
+    uint64_t             word_ns;       /* one word plus gap */
+    uint64_t             now;           /* next word slot to fill */
+    size_t               num_labels;
+    arinc429_tx_entry_t *entry;
+    uint32_t             wheel[ARINC429_TX_WHEEL_SLOTS];
+    uint64_t             occupied[ARINC429_TX_WHEEL_SLOTS / 64];
+    uint32_t             ready_head;
+    uint32_t             ready_tail;
+    uint64_t             words;         /* words sent */
+    uint64_t             max_latency_ns;
+    uint64_t             sum_latency_ns;
+} arinc429_tx_channel_t;
+
+/* Called once per transmitted word: start time of the word and the word */
+typedef void (*arinc429_tx_sink_t)(uint64_t time_ns, uint32_t word, void *ctx);
+
+/* Function: arinc429_tx_init =================================================
+ * Abstract:
+ *    Set up a channel at bit_rate with n labels; every word starts as the
+ *    label with value 0. Returns 0, or -1 for a bad rate, a non-positive
+ *    period or out of memory.
+ */
+int arinc429_tx_init(arinc429_tx_channel_t *ch, uint32_t bit_rate,
+                     const arinc429_tx_label_t *labels, size_t n);
+
+/* Encode value into label index's BCD word */
+void arinc429_tx_set_value(arinc429_tx_channel_t *ch, size_t index, double value);
+
+/* Replace label index's word with a ready-made one (BNR, discretes) */
+void arinc429_tx_set_word(arinc429_tx_channel_t *ch, size_t index, uint32_t word);
+
+/* Function: arinc429_tx_run ==================================================
+ * Abstract:
+ *    Transmit every word that starts before until_ns and pass each to sink
+ *    (may be NULL) in time order. Returns the number of words sent. Channels
+ *    are independent; to interleave several, run them in short steps.
+ */
+uint64_t arinc429_tx_run(arinc429_tx_channel_t *ch, uint64_t until_ns,
+                         arinc429_tx_sink_t sink, void *ctx);
+
+/* Fraction of the elapsed word slots that carried a word */
+double arinc429_tx_utilisation(const arinc429_tx_channel_t *ch);
+
+void arinc429_tx_free(arinc429_tx_channel_t *ch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_TX_H */
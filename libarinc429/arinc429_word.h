@@ -0,0 +1,110 @@
+/* arinc429_word.h - Packed 32-bit ARINC 429 word layout
+ *
+ * ARINC bit n is stored at uint32 bit (n - 1):
+ *
+ *    32   | 31-30 | 29 ........ 11 | 10-9 | 8 ...... 1
+ *  parity |  SSM  |   data field   |  SDI | label (reversed)
+ *
+ * The label is transmitted MSB first, so bits 1-8 hold the bit-reversed
+ * octal label (see arinc429_label_reverse). Parity is odd over all 32 bits.
+ */
+
+#ifndef ARINC429_WORD_H
+#define ARINC429_WORD_H
+
+#include <stdint.h>
+
+#include "arinc429_label.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARINC429_LABEL_MASK   0x000000FFu
+#define ARINC429_SDI_SHIFT    8
+#define ARINC429_SDI_MASK     0x3u
+#define ARINC429_DATA_SHIFT   10
+#define ARINC429_DATA_MASK    0x7FFFFu     /* 19 bits, ARINC bits 11-29 */
+#define ARINC429_SSM_SHIFT    29
+#define ARINC429_SSM_MASK     0x3u
+#define ARINC429_PARITY_BIT   0x80000000u
+
+/* BCD sign/status matrix */
+#define ARINC429_SSM_BCD_PLUS   0x0u   /* plus, north, east, right, to, above */
+#define ARINC429_SSM_BCD_NCD    0x1u   /* no computed data */
+#define ARINC429_SSM_BCD_TEST   0x2u   /* functional test */
+#define ARINC429_SSM_BCD_MINUS  0x3u   /* minus, south, west, left, from, below */
+
+/* Status codes returned by the word decoders */
+#define ARINC429_OK              0
+#define ARINC429_ERR_PARITY     -1
+#define ARINC429_ERR_BCD_DIGIT  -2
+
+static inline uint32_t arinc429_parity_bit(uint32_t word_without_parity)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (__builtin_popcount(word_without_parity & ~ARINC429_PARITY_BIT) & 1u) ? 0u : ARINC429_PARITY_BIT;
+#else
+    uint32_t v = word_without_parity & ~ARINC429_PARITY_BIT;
+    v ^= v >> 16;
+    v ^= v >> 8;
+    v ^= v >> 4;
+    v ^= v >> 2;
+    v ^= v >> 1;
+    return (v & 1u) ? 0u : ARINC429_PARITY_BIT;
+#endif
+}
+
+/* Non-zero if the word has odd parity */
+static inline int arinc429_word_parity_ok(uint32_t word)
+{
+    return (word & ARINC429_PARITY_BIT) == arinc429_parity_bit(word);
+}
+
+/* Function: arinc429_word_pack ===============================================
+ * Abstract:
+ *    Assemble a word from the octal label, SDI, 19-bit data field and SSM and
+ *    set the odd parity bit.
+ */
+static inline uint32_t arinc429_word_pack(uint8_t label, uint32_t sdi, uint32_t data, uint32_t ssm)
+{
+    uint32_t word = (uint32_t)arinc429_label_reverse(label)
+                  | ((sdi & ARINC429_SDI_MASK) << ARINC429_SDI_SHIFT)
+                  | ((data & ARINC429_DATA_MASK) << ARINC429_DATA_SHIFT)
+                  | ((ssm & ARINC429_SSM_MASK) << ARINC429_SSM_SHIFT);
+
+    return word | arinc429_parity_bit(word);
+}
+
+/* Octal label (undoes the transmit-order reversal) */
+static inline uint8_t arinc429_word_label(uint32_t word)
+{
+    return arinc429_label_reverse((uint8_t)(word & ARINC429_LABEL_MASK));
+}
+
+/* Label byte exactly as it sits in bits 1-8, without reversing */
+static inline uint8_t arinc429_word_raw_label(uint32_t word)
+{
+    return (uint8_t)(word & ARINC429_LABEL_MASK);
+}
+
+static inline uint32_t arinc429_word_sdi(uint32_t word)
+{
+    return (word >> ARINC429_SDI_SHIFT) & ARINC429_SDI_MASK;
+}
+
+static inline uint32_t arinc429_word_data(uint32_t word)
+{
+    return (word >> ARINC429_DATA_SHIFT) & ARINC429_DATA_MASK;
+}
+
+static inline uint32_t arinc429_word_ssm(uint32_t word)
+{
+    return (word >> ARINC429_SSM_SHIFT) & ARINC429_SSM_MASK;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC429_WORD_H */
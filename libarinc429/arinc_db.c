@@ -0,0 +1,526 @@
+/* arinc_db.c - Batched SQLite writer for arinc_verileri.db */
+
+#include "arinc_db.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sqlite3.h>
+
+/* Same DDL as simulation_database_creator.m */
+static const char schema_sql[] =
+    "CREATE TABLE IF NOT EXISTS SIMULATION ("
+    "simulation_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "simulation_name TEXT NOT NULL, "
+    "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+    "description TEXT"
+    ");"
+    "CREATE TABLE IF NOT EXISTS LOCATION ("
+    "location_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "latitude REAL NOT NULL, "
+    "longitude REAL NOT NULL, "
+    "created_at DATETIME DEFAULT CURRENT_TIMESTAMP"
+    ");"
+    "CREATE TABLE IF NOT EXISTS SIMULATION_RUN ("
+    "run_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "simulation_id INTEGER NOT NULL, "
+    "location_id INTEGER NOT NULL, "
+    "start_time REAL, "
+    "stop_time REAL, "
+    "time_step REAL, "
+    "status TEXT DEFAULT 'completed', "
+    "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+    "FOREIGN KEY (simulation_id) REFERENCES SIMULATION(simulation_id), "
+    "FOREIGN KEY (location_id) REFERENCES LOCATION(location_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS ATMOSPHERIC_DATA ("
+    "data_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "run_id INTEGER NOT NULL, "
+    "timestamp REAL, "
+    "barometric_pressure REAL, "
+    "confidence_level REAL, "
+    "current_state_value REAL, "
+    "velocity_x REAL, "
+    "velocity_y REAL, "
+    "vertical_rate REAL, "
+    "recorded_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+    "FOREIGN KEY (run_id) REFERENCES SIMULATION_RUN(run_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS TREND_ANALYSIS ("
+    "trend_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "run_id INTEGER NOT NULL, "
+    "trend_value_1 REAL, "
+    "trend_value_2 REAL, "
+    "trend_value_3 REAL, "
+    "trend_value_4 REAL, "
+    "trend_value_5 REAL, "
+    "trend_value_6 REAL, "
+    "analyzed_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+    "FOREIGN KEY (run_id) REFERENCES SIMULATION_RUN(run_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS INPUT_PARAMETERS ("
+    "input_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "run_id INTEGER NOT NULL, "
+    "baroaltitude_input REAL, "
+    "lat_input REAL, "
+    "lon_input REAL, "
+    "velocity_input REAL, "
+    "vertrate_input REAL, "
+    "created_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+    "FOREIGN KEY (run_id) REFERENCES SIMULATION_RUN(run_id)"
+    ");"
+    "CREATE TABLE IF NOT EXISTS OUTPUT_RESULTS ("
+    "output_id INTEGER PRIMARY KEY AUTOINCREMENT, "
+    "run_id INTEGER NOT NULL, "
+    "final_output_value REAL, "
+    "output_type TEXT, "
+    "units TEXT, "
+    "generated_at DATETIME DEFAULT CURRENT_TIMESTAMP, "
+    "FOREIGN KEY (run_id) REFERENCES SIMULATION_RUN(run_id)"
+    ");";
+
+/* Row tables written per sample */
+enum { TBL_TREND = 0, TBL_ATMOSPHERIC, TBL_INPUTS, NUM_TABLES };
+
+typedef struct {
+    int         mask;
+    const char *prefix;
+    int         columns;        /* bound columns, run_id included */
+} row_table_t;
+
+static const row_table_t row_table[NUM_TABLES] = {
+    { ARINC_DB_TREND,
+      "INSERT INTO TREND_ANALYSIS (run_id, trend_value_1, trend_value_2, trend_value_3, "
+      "trend_value_4, trend_value_5, trend_value_6) VALUES ", 7 },
+    { ARINC_DB_ATMOSPHERIC,
+      "INSERT INTO ATMOSPHERIC_DATA (run_id, timestamp, barometric_pressure, confidence_level, "
+      "current_state_value, velocity_x, velocity_y, vertical_rate) VALUES ", 8 },
+    { ARINC_DB_INPUTS,
+      "INSERT INTO INPUT_PARAMETERS (run_id, baroaltitude_input, lat_input, lon_input, "
+      "velocity_input, vertrate_input) VALUES ", 6 },
+};
+
+typedef struct {
+    double time;
+    double input[TREND_DFA_NUM_CHANNELS];
+    int    state;
+    double confidence;
+    double trends[TREND_DFA_NUM_TRENDS];
+} db_row_t;
+
+struct arinc_db {
+    sqlite3          *conn;
+    arinc_db_config_t cfg;
+    sqlite3_stmt     *batch[NUM_TABLES];    /* batch_rows rows per statement */
+    sqlite3_stmt     *single[NUM_TABLES];   /* one row, for the tail of a flush */
+    sqlite3_stmt     *begin;
+    sqlite3_stmt     *commit;
+    int64_t           run_id;
+    db_row_t         *stage;
+    int               staged;
+    int               in_txn;
+    int               txn_rows;             /* rows inserted in the open transaction */
+    int               failed;               /* an insert or commit failed */
+    char              error[256];           /* SQLite message of that failure */
+    uint64_t          rows;
+    int               have_last;
+    double            last_baroalt;
+};
+
+void arinc_db_default_config(arinc_db_config_t *cfg)
+{
+    cfg->tables = ARINC_DB_ALL_TABLES;
+    cfg->wal = 1;
+    cfg->synchronous = 1;
+    cfg->page_size = 0;
+    cfg->batch_rows = 64;
+    cfg->txn_rows = 65536;
+}
+
+/* ISA pressure (hPa) at a pressure altitude in metres */
+static double isa_pressure_hpa(double altitude)
+{
+    return 1013.25 * pow(1.0 - 2.25577e-5 * altitude, 5.25588);
+}
+
+static int exec_sql(arinc_db_t *db, const char *sql)
+{
+    return sqlite3_exec(db->conn, sql, NULL, NULL, NULL) == SQLITE_OK ? 0 : -1;
+}
+
+static int step_reset(sqlite3_stmt *stmt)
+{
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    return rc == SQLITE_DONE ? 0 : -1;
+}
+
+/* "prefix (?,?,..),(?,?,..)..." for rows rows */
+static sqlite3_stmt *prepare_insert(arinc_db_t *db, const row_table_t *t, int rows)
+{
+    size_t len = strlen(t->prefix) + (size_t)rows * (2 * (size_t)t->columns + 2) + 1;
+    char *sql = (char *)malloc(len);
+    sqlite3_stmt *stmt = NULL;
+    char *p;
+    int r, c;
+
+    if (sql == NULL) {
+        return NULL;
+    }
+    p = sql + sprintf(sql, "%s", t->prefix);
+    for (r = 0; r < rows; r++) {
+        if (r != 0) {
+            *p++ = ',';
+        }
+        *p++ = '(';
+        for (c = 0; c < t->columns; c++) {
+            if (c != 0) {
+                *p++ = ',';
+            }
+            *p++ = '?';
+        }
+        *p++ = ')';
+    }
+    *p = '\0';
+
+    if (sqlite3_prepare_v3(db->conn, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, NULL) != SQLITE_OK) {
+        stmt = NULL;
+    }
+    free(sql);
+    return stmt;
+}
+
+/* Bind one row starting at parameter index p (1-based); returns the next index */
+static int bind_row(arinc_db_t *db, sqlite3_stmt *stmt, int table, int p, const db_row_t *row)
+{
+    int i;
+
+    sqlite3_bind_int64(stmt, p++, db->run_id);
+    switch (table) {
+    case TBL_TREND:
+        for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+            sqlite3_bind_double(stmt, p++, row->trends[i]);
+        }
+        break;
+    case TBL_ATMOSPHERIC:
+        sqlite3_bind_double(stmt, p++, row->time);
+        sqlite3_bind_double(stmt, p++, isa_pressure_hpa(row->input[TREND_DFA_CH_BAROALT]));
+        sqlite3_bind_double(stmt, p++, row->confidence);
+        sqlite3_bind_double(stmt, p++, (double)row->state);
+        sqlite3_bind_double(stmt, p++, row->input[TREND_DFA_CH_VELOCITY]);
+        sqlite3_bind_null(stmt, p++);
+        sqlite3_bind_double(stmt, p++, row->input[TREND_DFA_CH_VERTRATE]);
+        break;
+    default:
+        sqlite3_bind_double(stmt, p++, row->input[TREND_DFA_CH_BAROALT]);
+        sqlite3_bind_double(stmt, p++, row->input[TREND_DFA_CH_LAT]);
+        sqlite3_bind_double(stmt, p++, row->input[TREND_DFA_CH_LON]);
+        sqlite3_bind_double(stmt, p++, row->input[TREND_DFA_CH_VELOCITY]);
+        sqlite3_bind_double(stmt, p++, row->input[TREND_DFA_CH_VERTRATE]);
+        break;
+    }
+    return p;
+}
+
+/* Keep the error, roll the open transaction back so the row tables stay
+ * in step, and drop the staged rows. Returns -1. */
+static int fail(arinc_db_t *db)
+{
+    snprintf(db->error, sizeof(db->error), "%s", sqlite3_errmsg(db->conn));
+    if (!sqlite3_get_autocommit(db->conn)) {
+        exec_sql(db, "ROLLBACK");
+    }
+    db->in_txn = 0;
+    db->txn_rows = 0;
+    db->staged = 0;
+    db->failed = 1;
+    return -1;
+}
+
+static int commit_txn(arinc_db_t *db)
+{
+    if (!db->in_txn) {
+        return 0;
+    }
+    if (step_reset(db->commit) != 0) {
+        return fail(db);
+    }
+    db->in_txn = 0;
+    db->txn_rows = 0;
+    return 0;
+}
+
+/* Insert the staged rows: whole batches through the multi-row statements,
+ * the rest one row at a time */
+static int insert_staged(arinc_db_t *db)
+{
+    int t, r, p;
+
+    if (db->staged == 0) {
+        return 0;
+    }
+    if (!db->in_txn) {
+        if (step_reset(db->begin) != 0) {
+            return fail(db);
+        }
+        db->in_txn = 1;
+    }
+
+    for (t = 0; t < NUM_TABLES; t++) {
+        if (!(db->cfg.tables & row_table[t].mask)) {
+            continue;
+        }
+        if (db->staged == db->cfg.batch_rows) {
+            p = 1;
+            for (r = 0; r < db->staged; r++) {
+                p = bind_row(db, db->batch[t], t, p, &db->stage[r]);
+            }
+            if (step_reset(db->batch[t]) != 0) {
+                return fail(db);
+            }
+        } else {
+            for (r = 0; r < db->staged; r++) {
+                bind_row(db, db->single[t], t, 1, &db->stage[r]);
+                if (step_reset(db->single[t]) != 0) {
+                    return fail(db);
+                }
+            }
+        }
+    }
+
+    db->txn_rows += db->staged;
+    db->staged = 0;
+    if (db->txn_rows >= db->cfg.txn_rows) {
+        return commit_txn(db);
+    }
+    return 0;
+}
+
+arinc_db_t *arinc_db_open(const char *path, const arinc_db_config_t *cfg)
+{
+    arinc_db_t *db;
+    char sql[64];
+    int t;
+
+    db = (arinc_db_t *)calloc(1, sizeof(*db));
+    if (db == NULL) {
+        return NULL;
+    }
+    if (cfg != NULL) {
+        db->cfg = *cfg;
+    } else {
+        arinc_db_default_config(&db->cfg);
+    }
+    if (db->cfg.batch_rows < 1) {
+        db->cfg.batch_rows = 1;
+    } else if (db->cfg.batch_rows > ARINC_DB_MAX_BATCH) {
+        db->cfg.batch_rows = ARINC_DB_MAX_BATCH;
+    }
+    if (db->cfg.txn_rows < db->cfg.batch_rows) {
+        db->cfg.txn_rows = db->cfg.batch_rows;
+    }
+    db->run_id = -1;
+
+    if (sqlite3_open(path, &db->conn) != SQLITE_OK) {
+        arinc_db_close(db);
+        return NULL;
+    }
+
+    /* page_size must precede anything that creates pages */
+    if (db->cfg.page_size > 0) {
+        sprintf(sql, "PRAGMA page_size=%d;", db->cfg.page_size);
+        exec_sql(db, sql);
+    }
+    if (db->cfg.wal && exec_sql(db, "PRAGMA journal_mode=WAL;") != 0) {
+        arinc_db_close(db);
+        return NULL;
+    }
+    sprintf(sql, "PRAGMA synchronous=%d;", db->cfg.synchronous);
+    if (exec_sql(db, sql) != 0 || exec_sql(db, schema_sql) != 0) {
+        arinc_db_close(db);
+        return NULL;
+    }
+
+    db->stage = (db_row_t *)malloc((size_t)db->cfg.batch_rows * sizeof(db_row_t));
+    if (db->stage == NULL ||
+        sqlite3_prepare_v3(db->conn, "BEGIN", -1, SQLITE_PREPARE_PERSISTENT, &db->begin, NULL) != SQLITE_OK ||
+        sqlite3_prepare_v3(db->conn, "COMMIT", -1, SQLITE_PREPARE_PERSISTENT, &db->commit, NULL) != SQLITE_OK) {
+        arinc_db_close(db);
+        return NULL;
+    }
+    for (t = 0; t < NUM_TABLES; t++) {
+        if (!(db->cfg.tables & row_table[t].mask)) {
+            continue;
+        }
+        db->batch[t] = prepare_insert(db, &row_table[t], db->cfg.batch_rows);
+        db->single[t] = prepare_insert(db, &row_table[t], 1);
+        if (db->batch[t] == NULL || db->single[t] == NULL) {
+            arinc_db_close(db);
+            return NULL;
+        }
+    }
+    return db;
+}
+
+static int64_t insert_id(arinc_db_t *db, sqlite3_stmt *stmt)
+{
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return rc == SQLITE_DONE ? (int64_t)sqlite3_last_insert_rowid(db->conn) : -1;
+}
+
+int64_t arinc_db_begin_run(arinc_db_t *db, const arinc_db_run_t *run)
+{
+    sqlite3_stmt *stmt;
+    int64_t simulation_id = run->simulation_id;
+    int64_t location_id;
+
+    if (arinc_db_flush(db) != 0) {
+        return -1;
+    }
+
+    if (simulation_id <= 0) {
+        if (sqlite3_prepare_v2(db->conn,
+                "INSERT INTO SIMULATION (simulation_name, description) VALUES (?, ?)",
+                -1, &stmt, NULL) != SQLITE_OK) {
+            return -1;
+        }
+        sqlite3_bind_text(stmt, 1, run->name != NULL ? run->name : "arinc429_replay", -1, SQLITE_TRANSIENT);
+        if (run->description != NULL) {
+            sqlite3_bind_text(stmt, 2, run->description, -1, SQLITE_TRANSIENT);
+        }
+        if ((simulation_id = insert_id(db, stmt)) < 0) {
+            return -1;
+        }
+    }
+
+    if (sqlite3_prepare_v2(db->conn, "INSERT INTO LOCATION (latitude, longitude) VALUES (?, ?)",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+    sqlite3_bind_double(stmt, 1, run->latitude);
+    sqlite3_bind_double(stmt, 2, run->longitude);
+    if ((location_id = insert_id(db, stmt)) < 0) {
+        return -1;
+    }
+
+    if (sqlite3_prepare_v2(db->conn,
+            "INSERT INTO SIMULATION_RUN (simulation_id, location_id, start_time, time_step, status) "
+            "VALUES (?, ?, ?, ?, 'running')", -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, simulation_id);
+    sqlite3_bind_int64(stmt, 2, location_id);
+    sqlite3_bind_double(stmt, 3, run->start_time);
+    sqlite3_bind_double(stmt, 4, run->time_step);
+    db->run_id = insert_id(db, stmt);
+    db->have_last = 0;
+    return db->run_id;
+}
+
+int arinc_db_append(arinc_db_t *db, double time, const double *input,
+                    const trend_dfa_output_t *out)
+{
+    db_row_t *row;
+
+    if (db->failed) {
+        return -1;
+    }
+    row = &db->stage[db->staged];
+    row->time = time;
+    memcpy(row->input, input, sizeof(row->input));
+    row->state = out->state;
+    row->confidence = out->confidence;
+    memcpy(row->trends, out->trends, sizeof(row->trends));
+    db->last_baroalt = input[TREND_DFA_CH_BAROALT];
+    db->have_last = 1;
+    db->rows++;
+
+    if (++db->staged == db->cfg.batch_rows) {
+        return insert_staged(db);
+    }
+    return 0;
+}
+
+int arinc_db_flush(arinc_db_t *db)
+{
+    if (db->failed || insert_staged(db) != 0) {
+        return -1;
+    }
+    return commit_txn(db);
+}
+
+int arinc_db_end_run(arinc_db_t *db, double stop_time, const char *status)
+{
+    sqlite3_stmt *stmt;
+
+    if (arinc_db_flush(db) != 0 || db->run_id < 0) {
+        return -1;
+    }
+
+    if (sqlite3_prepare_v2(db->conn, "UPDATE SIMULATION_RUN SET stop_time = ?, status = ? WHERE run_id = ?",
+                           -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+    sqlite3_bind_double(stmt, 1, stop_time);
+    sqlite3_bind_text(stmt, 2, status != NULL ? status : "completed", -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 3, db->run_id);
+    if (insert_id(db, stmt) < 0) {
+        return -1;
+    }
+
+    if (db->have_last) {
+        if (sqlite3_prepare_v2(db->conn,
+                "INSERT INTO OUTPUT_RESULTS (run_id, final_output_value, output_type, units) "
+                "VALUES (?, ?, 'Altitude', 'meters')", -1, &stmt, NULL) != SQLITE_OK) {
+            return -1;
+        }
+        sqlite3_bind_int64(stmt, 1, db->run_id);
+        sqlite3_bind_double(stmt, 2, db->last_baroalt);
+        if (insert_id(db, stmt) < 0) {
+            return -1;
+        }
+    }
+    db->run_id = -1;
+    return 0;
+}
+
+uint64_t arinc_db_rows(const arinc_db_t *db)
+{
+    return db->rows;
+}
+
+const char *arinc_db_errmsg(const arinc_db_t *db)
+{
+    if (db->failed) {
+        return db->error;
+    }
+    return db->conn != NULL ? sqlite3_errmsg(db->conn) : "out of memory";
+}
+
+int arinc_db_close(arinc_db_t *db)
+{
+    int rc = 0;
+    int t;
+
+    if (db == NULL) {
+        return 0;
+    }
+    if (db->conn != NULL && db->stage != NULL && db->begin != NULL && db->commit != NULL) {
+        rc = arinc_db_flush(db);
+    }
+    for (t = 0; t < NUM_TABLES; t++) {
+        sqlite3_finalize(db->batch[t]);
+        sqlite3_finalize(db->single[t]);
+    }
+    sqlite3_finalize(db->begin);
+    sqlite3_finalize(db->commit);
+    if (db->conn != NULL && sqlite3_close(db->conn) != SQLITE_OK) {
+        rc = -1;
+    }
+    free(db->stage);
+    free(db);
+    return rc;
+}
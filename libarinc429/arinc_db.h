@@ -0,0 +1,114 @@
+/* arinc_db.h - Batched SQLite writer for arinc_verileri.db
+ *
+ * Writes DFA results into the schema created by simulation_database_creator.m
+ * (the tables are created if missing). Each appended sample becomes one row
+ * in each enabled table:
+ *
+ *    TREND_ANALYSIS    trend_value_1..6 = the six DFA trends
+ *    ATMOSPHERIC_DATA  timestamp, barometric_pressure (hPa, ISA from the
+ *                      pressure altitude), confidence_level, current_state_value
+ *                      (DFA state), velocity_x (ground speed), vertical_rate;
+ *                      velocity_y stays NULL (no track angle in the inputs)
+ *    INPUT_PARAMETERS  the five inputs
+ *
+ * A run is bracketed by arinc_db_begin_run (SIMULATION / LOCATION /
+ * SIMULATION_RUN rows) and arinc_db_end_run (stop time and a final altitude
+ * row in OUTPUT_RESULTS).
+ *
+ * Rows are staged in memory and inserted batch_rows at a time through
+ * prepared multi-row INSERT statements, inside transactions of txn_rows rows.
+ */
+
+#ifndef ARINC_DB_H
+#define ARINC_DB_H
+
+#include <stdint.h>
+
+#include "trend_dfa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Tables filled by arinc_db_append */
+#define ARINC_DB_TREND        0x1
+#define ARINC_DB_ATMOSPHERIC  0x2
+#define ARINC_DB_INPUTS       0x4
+#define ARINC_DB_ALL_TABLES   (ARINC_DB_TREND | ARINC_DB_ATMOSPHERIC | ARINC_DB_INPUTS)
+
+#define ARINC_DB_MAX_BATCH    120     /* 8 columns x 120 rows stays under 999 variables */
+
+typedef struct {
+    int tables;         /* ARINC_DB_* mask */
+    int wal;            /* journal_mode=WAL */
+    int synchronous;    /* PRAGMA synchronous: 0 OFF, 1 NORMAL, 2 FULL */
+    int page_size;      /* bytes, 0 keeps the default; applies to new databases */
+    int batch_rows;     /* rows per INSERT statement, 1..ARINC_DB_MAX_BATCH */
+    int txn_rows;       /* rows per transaction */
+} arinc_db_config_t;
+
+typedef struct {
+    int64_t     simulation_id;      /* 0 inserts a SIMULATION row named name */
+    const char *name;
+    const char *description;
+    double      latitude;           /* LOCATION of the run */
+    double      longitude;
+    double      start_time;
+    double      time_step;
+} arinc_db_run_t;
+
+typedef struct arinc_db arinc_db_t;
+
+/* WAL, synchronous=NORMAL, default page size, 64-row batches, 64k-row transactions */
+void arinc_db_default_config(arinc_db_config_t *cfg);
+
+/* Function: arinc_db_open ====================================================
+ * Abstract:
+ *    Open (or create) the database at path, apply the pragmas, create any
+ *    missing tables and prepare the statements. cfg may be NULL for the
+ *    defaults. Returns NULL on failure.
+ */
+arinc_db_t *arinc_db_open(const char *path, const arinc_db_config_t *cfg);
+
+/* Function: arinc_db_begin_run ===============================================
+ * Abstract:
+ *    Insert the SIMULATION_RUN row (and SIMULATION / LOCATION rows as
+ *    needed) that subsequent samples refer to. Returns the run_id, or -1.
+ */
+int64_t arinc_db_begin_run(arinc_db_t *db, const arinc_db_run_t *run);
+
+/* Function: arinc_db_append ==================================================
+ * Abstract:
+ *    Stage one sample: time, the five inputs (TREND_DFA_CH_* order) and the
+ *    DFA output. Returns 0, or -1 if a batch insert failed. A failed insert
+ *    or commit rolls the open transaction back, so the row tables stay in
+ *    step, and leaves the handle failed: append, flush and end_run then
+ *    return -1 without writing, and arinc_db_errmsg keeps the first error.
+ */
+int arinc_db_append(arinc_db_t *db, double time, const double *input,
+                    const trend_dfa_output_t *out);
+
+/* Insert staged rows and commit. Returns 0 or -1. */
+int arinc_db_flush(arinc_db_t *db);
+
+/* Function: arinc_db_end_run =================================================
+ * Abstract:
+ *    Flush, set the run's stop_time and status, and record the last pressure
+ *    altitude in OUTPUT_RESULTS. Returns 0 or -1.
+ */
+int arinc_db_end_run(arinc_db_t *db, double stop_time, const char *status);
+
+/* Rows appended since open */
+uint64_t arinc_db_rows(const arinc_db_t *db);
+
+/* Last SQLite error message */
+const char *arinc_db_errmsg(const arinc_db_t *db);
+
+/* Flush and close. Returns 0 or -1. */
+int arinc_db_close(arinc_db_t *db);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC_DB_H */
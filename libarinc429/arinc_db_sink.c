@@ -0,0 +1,246 @@
+/* arinc_db_sink.c - Asynchronous database sink for DFA results
+ *
+ * head is written only by the producer. tail is advanced with a CAS by the
+ * consumer after it has copied a slot, and by the producer when it drops the
+ * oldest record; a consumer whose CAS fails lost its slot to the producer,
+ * throws the copy away and retries.
+ */
+
+#include "arinc_db_sink.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SINK_CACHE_LINE  64
+#define SINK_IDLE_NS     1000000L       /* writer sleep when the ring is empty */
+
+typedef struct {
+    double             time;
+    double             input[TREND_DFA_NUM_CHANNELS];
+    trend_dfa_output_t out;
+} sink_record_t;
+
+struct arinc_db_sink {
+    /* Producer side */
+    _Alignas(SINK_CACHE_LINE) _Atomic uint64_t head;
+    _Atomic uint64_t           pushed;
+    _Atomic uint64_t           high_water;
+
+    /* Shared: advanced by the consumer, and by the producer on drop-oldest */
+    _Alignas(SINK_CACHE_LINE) _Atomic uint64_t tail;
+    _Atomic uint64_t           dropped;
+
+    /* Consumer side */
+    _Alignas(SINK_CACHE_LINE) _Atomic uint64_t written;
+    _Atomic int                failed;
+    _Atomic int                stop;
+
+    arinc_db_sink_policy_t policy;
+    uint64_t               mask;
+    sink_record_t         *ring;
+    arinc_db_t            *db;
+    arinc_db_run_t         run;
+    pthread_t              thread;
+};
+
+static int pop(arinc_db_sink_t *sink, sink_record_t *rec)
+{
+    for (;;) {
+        uint64_t t = atomic_load_explicit(&sink->tail, memory_order_acquire);
+
+        if (t == atomic_load_explicit(&sink->head, memory_order_acquire)) {
+            return 0;
+        }
+        memcpy(rec, &sink->ring[t & sink->mask], sizeof(*rec));
+        if (atomic_compare_exchange_strong_explicit(&sink->tail, &t, t + 1,
+                                                    memory_order_acq_rel, memory_order_acquire)) {
+            return 1;
+        }
+    }
+}
+
+static void *writer_thread(void *arg)
+{
+    arinc_db_sink_t *sink = (arinc_db_sink_t *)arg;
+    struct timespec idle = { 0, SINK_IDLE_NS };
+    sink_record_t rec;
+    int started = 0, dirty = 0;
+
+    for (;;) {
+        if (pop(sink, &rec)) {
+            if (atomic_load_explicit(&sink->failed, memory_order_relaxed)) {
+                continue;       /* keep draining so a blocked producer can go on */
+            }
+            if (!started) {
+                sink->run.latitude = rec.input[TREND_DFA_CH_LAT];
+                sink->run.longitude = rec.input[TREND_DFA_CH_LON];
+                sink->run.start_time = rec.time;
+                if (arinc_db_begin_run(sink->db, &sink->run) < 0) {
+                    atomic_store(&sink->failed, 1);
+                    continue;
+                }
+                started = 1;
+            }
+            if (arinc_db_append(sink->db, rec.time, rec.input, &rec.out) != 0) {
+                atomic_store(&sink->failed, 1);
+            }
+            atomic_fetch_add_explicit(&sink->written, 1, memory_order_relaxed);
+            dirty = 1;
+        } else if (atomic_load_explicit(&sink->stop, memory_order_acquire)) {
+            /* The producer has made its last push; stop once that is drained */
+            if (atomic_load_explicit(&sink->tail, memory_order_acquire) ==
+                atomic_load_explicit(&sink->head, memory_order_acquire)) {
+                break;
+            }
+        } else {
+            /* Idle: commit so readers see the rows, then sleep */
+            if (dirty) {
+                if (arinc_db_flush(sink->db) != 0) {
+                    atomic_store(&sink->failed, 1);
+                }
+                dirty = 0;
+            }
+            nanosleep(&idle, NULL);
+        }
+    }
+    return NULL;
+}
+
+arinc_db_sink_t *arinc_db_sink_start(const char *path, const arinc_db_config_t *cfg,
+                                     const arinc_db_run_t *run, size_t capacity,
+                                     arinc_db_sink_policy_t policy)
+{
+    arinc_db_sink_t *sink;
+    size_t cap = 1;
+
+    if (capacity == 0) {
+        capacity = ARINC_DB_SINK_DEFAULT_CAPACITY;
+    }
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    sink = (arinc_db_sink_t *)aligned_alloc(SINK_CACHE_LINE,
+                                            (sizeof(*sink) + SINK_CACHE_LINE - 1) / SINK_CACHE_LINE * SINK_CACHE_LINE);
+    if (sink == NULL) {
+        return NULL;
+    }
+    memset(sink, 0, sizeof(*sink));
+    atomic_init(&sink->head, 0);
+    atomic_init(&sink->pushed, 0);
+    atomic_init(&sink->high_water, 0);
+    atomic_init(&sink->tail, 0);
+    atomic_init(&sink->dropped, 0);
+    atomic_init(&sink->written, 0);
+    atomic_init(&sink->failed, 0);
+    atomic_init(&sink->stop, 0);
+    sink->policy = policy;
+    sink->mask = cap - 1;
+    if (run != NULL) {
+        sink->run = *run;
+    }
+
+    sink->ring = (sink_record_t *)malloc(cap * sizeof(sink_record_t));
+    if (sink->ring == NULL || (sink->db = arinc_db_open(path, cfg)) == NULL) {
+        free(sink->ring);
+        free(sink);
+        return NULL;
+    }
+    if (pthread_create(&sink->thread, NULL, writer_thread, sink) != 0) {
+        arinc_db_close(sink->db);
+        free(sink->ring);
+        free(sink);
+        return NULL;
+    }
+    return sink;
+}
+
+int arinc_db_sink_push(arinc_db_sink_t *sink, double time, const double *input,
+                       const trend_dfa_output_t *out)
+{
+    uint64_t h = atomic_load_explicit(&sink->head, memory_order_relaxed);
+    uint64_t t = atomic_load_explicit(&sink->tail, memory_order_acquire);
+    uint64_t cap = sink->mask + 1;
+    sink_record_t *slot;
+    int dropped = 0;
+
+    atomic_store_explicit(&sink->pushed, atomic_load_explicit(&sink->pushed, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+
+    if (h - t >= cap) {
+        switch (sink->policy) {
+        case ARINC_DB_SINK_DROP_NEWEST:
+            atomic_fetch_add_explicit(&sink->dropped, 1, memory_order_relaxed);
+            return 1;
+        case ARINC_DB_SINK_DROP_OLDEST:
+            /* If the CAS fails the consumer just made room */
+            if (atomic_compare_exchange_strong_explicit(&sink->tail, &t, t + 1,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+                atomic_fetch_add_explicit(&sink->dropped, 1, memory_order_relaxed);
+                dropped = 1;
+            }
+            break;
+        default:
+            do {
+                sched_yield();
+                t = atomic_load_explicit(&sink->tail, memory_order_acquire);
+            } while (h - t >= cap);
+            break;
+        }
+    }
+
+    slot = &sink->ring[h & sink->mask];
+    slot->time = time;
+    memcpy(slot->input, input, sizeof(slot->input));
+    slot->out = *out;
+    atomic_store_explicit(&sink->head, h + 1, memory_order_release);
+
+    t = atomic_load_explicit(&sink->tail, memory_order_relaxed);
+    if (h + 1 - t > atomic_load_explicit(&sink->high_water, memory_order_relaxed)) {
+        atomic_store_explicit(&sink->high_water, h + 1 - t, memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void arinc_db_sink_stats(const arinc_db_sink_t *sink, arinc_db_sink_stats_t *stats)
+{
+    arinc_db_sink_t *s = (arinc_db_sink_t *)sink;
+
+    stats->pushed = atomic_load_explicit(&s->pushed, memory_order_relaxed);
+    stats->written = atomic_load_explicit(&s->written, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&s->dropped, memory_order_relaxed);
+    stats->high_water = atomic_load_explicit(&s->high_water, memory_order_relaxed);
+    stats->capacity = (size_t)(s->mask + 1);
+    stats->failed = atomic_load_explicit(&s->failed, memory_order_relaxed);
+}
+
+int arinc_db_sink_stop(arinc_db_sink_t *sink, double stop_time, arinc_db_sink_stats_t *stats)
+{
+    int rc;
+
+    atomic_store_explicit(&sink->stop, 1, memory_order_release);
+    pthread_join(sink->thread, NULL);
+
+    rc = atomic_load(&sink->failed) ? -1 : 0;
+    if (atomic_load(&sink->written) > 0 && rc == 0 &&
+        arinc_db_end_run(sink->db, stop_time, "completed") != 0) {
+        rc = -1;
+    }
+    if (arinc_db_close(sink->db) != 0) {
+        rc = -1;
+    }
+    if (rc != 0) {
+        atomic_store(&sink->failed, 1);
+    }
+    if (stats != NULL) {
+        arinc_db_sink_stats(sink, stats);
+    }
+
+    free(sink->ring);
+    free(sink);
+    return rc;
+}
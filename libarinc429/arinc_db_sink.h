@@ -0,0 +1,85 @@
+/* arinc_db_sink.h - Asynchronous database sink for DFA results
+ *
+ * The simulation step pushes fixed-size records into a single-producer /
+ * single-consumer ring; a background thread drains the ring into the
+ * database through arinc_db. A push never takes a lock or makes a system
+ * call (except while waiting under ARINC_DB_SINK_BLOCK), so logging adds no
+ * jitter to the step. The run row is created from the first record's
+ * position.
+ *
+ * When the ring is full the push follows the configured policy:
+ *
+ *    ARINC_DB_SINK_BLOCK        wait for the writer thread to make room
+ *    ARINC_DB_SINK_DROP_OLDEST  discard the oldest queued record
+ *    ARINC_DB_SINK_DROP_NEWEST  discard the record being pushed
+ *
+ * Dropped records are counted either way.
+ */
+
+#ifndef ARINC_DB_SINK_H
+#define ARINC_DB_SINK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arinc_db.h"
+#include "trend_dfa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARINC_DB_SINK_DEFAULT_CAPACITY 65536   /* records, power of two */
+
+typedef enum {
+    ARINC_DB_SINK_BLOCK = 0,
+    ARINC_DB_SINK_DROP_OLDEST,
+    ARINC_DB_SINK_DROP_NEWEST
+} arinc_db_sink_policy_t;
+
+typedef struct {
+    uint64_t pushed;            /* records offered by the producer */
+    uint64_t written;           /* records handed to the database */
+    uint64_t dropped;
+    uint64_t high_water;        /* largest queue depth seen */
+    size_t   capacity;
+    int      failed;            /* the writer thread hit a database error */
+} arinc_db_sink_stats_t;
+
+typedef struct arinc_db_sink arinc_db_sink_t;
+
+/* Function: arinc_db_sink_start ==============================================
+ * Abstract:
+ *    Open the database at path (cfg may be NULL) and start the writer
+ *    thread. capacity is rounded up to a power of two (0 selects
+ *    ARINC_DB_SINK_DEFAULT_CAPACITY). run supplies the name, description and
+ *    time step of the run; its position is ignored. Returns NULL on failure.
+ */
+arinc_db_sink_t *arinc_db_sink_start(const char *path, const arinc_db_config_t *cfg,
+                                     const arinc_db_run_t *run, size_t capacity,
+                                     arinc_db_sink_policy_t policy);
+
+/* Function: arinc_db_sink_push ===============================================
+ * Abstract:
+ *    Queue one sample (producer thread only). Returns 0, or 1 if a record
+ *    was dropped.
+ */
+int arinc_db_sink_push(arinc_db_sink_t *sink, double time, const double *input,
+                       const trend_dfa_output_t *out);
+
+/* Counters so far; safe to call from the producer while the writer runs */
+void arinc_db_sink_stats(const arinc_db_sink_t *sink, arinc_db_sink_stats_t *stats);
+
+/* Function: arinc_db_sink_stop ===============================================
+ * Abstract:
+ *    Let the writer drain the ring, end the run at stop_time, close the
+ *    database and free the sink. The final counters go to stats (may be
+ *    NULL). Returns 0, or -1 if any database write failed.
+ */
+int arinc_db_sink_stop(arinc_db_sink_t *sink, double stop_time, arinc_db_sink_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARINC_DB_SINK_H */
@@ -0,0 +1,128 @@
+/* flight_csv.c - Reader for filtered_data.csv style flight dumps */
+
+#include "flight_csv.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Header names in TREND_DFA_CH_* order, as written by the OpenSky export */
+static const char *const column_names[TREND_DFA_NUM_CHANNELS] = {
+    "velocity", "baroaltitude", "lat", "lon", "vertrate"
+};
+
+static void trim_field(char *field)
+{
+    size_t len = strlen(field);
+
+    while (len > 0 && (field[len - 1] == '\n' || field[len - 1] == '\r' ||
+                       field[len - 1] == ' '  || field[len - 1] == '"')) {
+        field[--len] = '\0';
+    }
+    if (field[0] == '"') {
+        memmove(field, field + 1, len);
+    }
+}
+
+int flight_csv_parse_header(char *line, int *col)
+{
+    char *field, *save;
+    int ch, idx = 0;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        col[ch] = -1;
+    }
+
+    for (field = strtok_r(line, ",", &save); field != NULL; field = strtok_r(NULL, ",", &save)) {
+        trim_field(field);
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            if (strcmp(field, column_names[ch]) == 0) {
+                col[ch] = idx;
+            }
+        }
+        idx++;
+    }
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        if (col[ch] < 0) {
+            return -1;
+        }
+    }
+    return idx;
+}
+
+int flight_csv_open(flight_csv_t *csv, const char *path)
+{
+    char line[FLIGHT_CSV_MAX_LINE];
+
+    memset(csv, 0, sizeof(*csv));
+
+    csv->fp = fopen(path, "r");
+    if (csv->fp == NULL) {
+        return -1;
+    }
+
+    if (fgets(line, sizeof(line), csv->fp) == NULL) {
+        flight_csv_close(csv);
+        return -1;
+    }
+    csv->line = 1;
+
+    csv->num_cols = flight_csv_parse_header(line, csv->col);
+    if (csv->num_cols < 0) {
+        flight_csv_close(csv);
+        return -1;
+    }
+
+    return 0;
+}
+
+int flight_csv_read(flight_csv_t *csv, double *sample)
+{
+    char line[FLIGHT_CSV_MAX_LINE];
+    const char *p;
+    char *end;
+    int idx, ch;
+
+    do {
+        if (fgets(line, sizeof(line), csv->fp) == NULL) {
+            return 0;
+        }
+        csv->line++;
+    } while (line[0] == '\n' || line[0] == '\r');
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        sample[ch] = 0.0;
+    }
+
+    /* Walk the fields in place; strtod stops at the next comma */
+    p = line;
+    for (idx = 0; idx < csv->num_cols; idx++) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            if (csv->col[ch] == idx && *p != ',' && *p != '\n' && *p != '\r' && *p != '\0') {
+                sample[ch] = strtod(p, &end);
+                if (end == p) {
+                    return -1;
+                }
+            }
+        }
+        p = strchr(p, ',');
+        if (p == NULL) {
+            break;
+        }
+        p++;
+    }
+
+    if (idx < csv->num_cols - 1) {
+        return -1;
+    }
+
+    return 1;
+}
+
+void flight_csv_close(flight_csv_t *csv)
+{
+    if (csv->fp != NULL) {
+        fclose(csv->fp);
+        csv->fp = NULL;
+    }
+}
@@ -0,0 +1,55 @@
+/* flight_csv.h - Reader for filtered_data.csv style flight dumps */
+
+#ifndef FLIGHT_CSV_H
+#define FLIGHT_CSV_H
+
+#include <stdio.h>
+
+#include "trend_dfa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHT_CSV_MAX_LINE 4096
+
+/* Columns are located by header name, so extra columns (icao24, time, ...)
+ * and any column order are accepted. */
+typedef struct {
+    FILE *fp;
+    int   col[TREND_DFA_NUM_CHANNELS];  /* CSV column index per TREND_DFA_CH_* */
+    int   num_cols;
+    long  line;
+} flight_csv_t;
+
+/* Function: flight_csv_open ==================================================
+ * Abstract:
+ *    Open path and parse the header. Returns 0 on success, -1 if the file
+ *    cannot be opened or one of velocity, baroaltitude, lat, lon, vertrate
+ *    is missing from the header.
+ */
+int flight_csv_open(flight_csv_t *csv, const char *path);
+
+/* Function: flight_csv_read ==================================================
+ * Abstract:
+ *    Read the next row into sample (ordered as TREND_DFA_CH_*). Empty fields
+ *    read as 0. Returns 1 when a row was read, 0 at end of file and -1 on a
+ *    malformed row (csv->line holds the offending line number).
+ */
+int flight_csv_read(flight_csv_t *csv, double *sample);
+
+void flight_csv_close(flight_csv_t *csv);
+
+/* Function: flight_csv_parse_header ==========================================
+ * Abstract:
+ *    Locate the five channel columns in a header line (modified in place).
+ *    Fills col (TREND_DFA_CH_* order) and returns the number of columns, or
+ *    -1 if a required column is missing. Shared by the stream reader.
+ */
+int flight_csv_parse_header(char *line, int *col);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHT_CSV_H */
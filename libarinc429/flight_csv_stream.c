@@ -0,0 +1,387 @@
+/* flight_csv_stream.c - Memory-mapped streaming reader for large flight dumps */
+
+#include "flight_csv_stream.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* strtod input buffer for the slow path (a field cannot be NUL terminated
+ * in place inside a read-only mapping) */
+#define NUMBER_MAX_LEN 64
+
+/* Significant digits that always fit in a uint64_t mantissa */
+#define MANTISSA_MAX_DIGITS 19
+
+/* Powers of ten that are exact doubles; dividing an exact mantissa by one of
+ * them is a single correctly rounded operation, i.e. what strtod returns */
+static const double exact_pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#define EXACT_POW10_MAX 22
+
+static inline int is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define HAVE_SWAR_DIGITS 1
+
+static inline uint64_t load8(const char *p)
+{
+    uint64_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Non-zero if all eight bytes are ASCII digits */
+static inline int is_eight_digits(uint64_t v)
+{
+    return (((v & 0xF0F0F0F0F0F0F0F0ull) |
+             (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) ==
+            0x3333333333333333ull);
+}
+
+/* Eight ASCII digits (first digit in the lowest byte) to their value: pairs,
+ * then quads, then the full eight with three multiplies in one register */
+static inline uint32_t parse_eight_digits(uint64_t v)
+{
+    const uint64_t mask = 0x000000FF000000FFull;
+    const uint64_t mul1 = 100 + (1000000ull << 32);
+    const uint64_t mul2 = 1 + (10000ull << 32);
+
+    v -= 0x3030303030303030ull;
+    v = (v * 10) + (v >> 8);
+    v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)v;
+}
+#else
+#define HAVE_SWAR_DIGITS 0
+#endif
+
+/* Accumulate a digit run into mant; returns the end of the run. Sets
+ * *overflow once more than MANTISSA_MAX_DIGITS digits have been seen. */
+static inline const char *scan_digits(const char *p, const char *end, uint64_t *mant,
+                                      int *digits, int *overflow)
+{
+#if HAVE_SWAR_DIGITS
+    while (end - p >= 8 && *digits + 8 <= MANTISSA_MAX_DIGITS) {
+        uint64_t v = load8(p);
+        if (!is_eight_digits(v)) {
+            break;
+        }
+        *mant = *mant * 100000000u + parse_eight_digits(v);
+        *digits += 8;
+        p += 8;
+    }
+#endif
+    while (p < end && is_digit(*p)) {
+        if (*digits >= MANTISSA_MAX_DIGITS) {
+            *overflow = 1;
+            return p;
+        }
+        *mant = *mant * 10u + (uint64_t)(*p - '0');
+        (*digits)++;
+        p++;
+    }
+    return p;
+}
+
+int flight_csv_parse_number(const char *p, const char *end, double *value)
+{
+    const char *start = p;
+    uint64_t mant = 0;
+    int neg = 0, digits = 0, frac_digits = 0, overflow = 0;
+    char buf[NUMBER_MAX_LEN];
+    size_t len;
+    char *stop;
+    double v;
+
+    if (p < end && (*p == '-' || *p == '+')) {
+        neg = (*p == '-');
+        p++;
+    }
+
+    p = scan_digits(p, end, &mant, &digits, &overflow);
+    if (!overflow && p < end && *p == '.') {
+        const char *frac = ++p;
+        p = scan_digits(p, end, &mant, &digits, &overflow);
+        frac_digits = (int)(p - frac);
+    }
+
+    /* Fast path: plain decimal with an exact mantissa and divisor */
+    if (!overflow && digits > 0 &&
+        !(p < end && (*p == 'e' || *p == 'E')) &&
+        mant <= ((uint64_t)1 << 53) && frac_digits <= EXACT_POW10_MAX) {
+        v = (double)mant / exact_pow10[frac_digits];
+        *value = neg ? -v : v;
+        return 0;
+    }
+
+    /* Exponents, long mantissas, whitespace, inf/nan: defer to strtod */
+    len = (size_t)(end - start);
+    if (len >= sizeof(buf)) {
+        len = sizeof(buf) - 1;
+    }
+    memcpy(buf, start, len);
+    buf[len] = '\0';
+    *value = strtod(buf, &stop);
+    return stop == buf ? -1 : 0;
+}
+
+/* Function: map_window =======================================================
+ * Abstract:
+ *    Map the window containing file offset off (rounded down to a page) and
+ *    drop the previous one.
+ */
+static int map_window(flight_csv_stream_t *s, uint64_t off)
+{
+    uint64_t page = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t aligned = off - off % page;
+    size_t len = s->window;
+    void *map;
+
+    if (aligned + len > s->file_size) {
+        len = (size_t)(s->file_size - aligned);
+    }
+
+    if (s->map != NULL) {
+        munmap((void *)s->map, s->map_len);
+        s->map = NULL;
+    }
+
+    map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, s->fd, (off_t)aligned);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+#ifdef MADV_SEQUENTIAL
+    madvise(map, len, MADV_SEQUENTIAL);
+#endif
+
+    s->map = (const char *)map;
+    s->map_len = len;
+    s->map_off = aligned;
+    s->pos = (size_t)(off - aligned);
+    return 0;
+}
+
+/* Function: next_line ========================================================
+ * Abstract:
+ *    Locate the next complete line, sliding the window if it would cross the
+ *    window end. Returns 1 with [*start, *eol) set (eol at the newline or
+ *    the end of file), 0 at end of file, -1 on a mapping error or a line
+ *    longer than the window.
+ */
+static int next_line(flight_csv_stream_t *s, const char **start, const char **eol)
+{
+    for (;;) {
+        uint64_t off = s->map_off + s->pos;
+        const char *p, *nl;
+
+        if (off >= s->file_size) {
+            return 0;
+        }
+        if (s->pos < s->map_len) {
+            p = s->map + s->pos;
+            nl = memchr(p, '\n', s->map_len - s->pos);
+            if (nl != NULL) {
+                *start = p;
+                *eol = nl;
+                return 1;
+            }
+            if (s->map_off + s->map_len >= s->file_size) {
+                *start = p;
+                *eol = s->map + s->map_len;    /* last line, no newline */
+                return 1;
+            }
+        }
+
+        if (map_window(s, off) != 0) {
+            return -1;
+        }
+        if (memchr(s->map + s->pos, '\n', s->map_len - s->pos) == NULL &&
+            s->map_off + s->map_len < s->file_size) {
+            return -1;   /* line does not fit in one window */
+        }
+    }
+}
+
+/* Function: parse_row ========================================================
+ * Abstract:
+ *    Parse one data line with the rules of flight_csv_read. Returns 0 on
+ *    success, -1 if the row is malformed.
+ */
+static int parse_row(const flight_csv_stream_t *s, const char *p, const char *eol, double *sample)
+{
+    const char *field_end;
+    int idx, ch;
+
+    if (eol > p && eol[-1] == '\r') {
+        eol--;
+    }
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        sample[ch] = 0.0;
+    }
+
+    for (idx = 0; idx < s->num_cols; idx++) {
+        field_end = memchr(p, ',', (size_t)(eol - p));
+        if (field_end == NULL) {
+            field_end = eol;
+        }
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            if (s->col[ch] == idx && p != field_end) {
+                if (flight_csv_parse_number(p, field_end, &sample[ch]) != 0) {
+                    return -1;
+                }
+            }
+        }
+        if (field_end == eol) {
+            break;
+        }
+        p = field_end + 1;
+    }
+
+    return idx < s->num_cols - 1 ? -1 : 0;
+}
+
+uint64_t flight_csv_stream_tell(const flight_csv_stream_t *s)
+{
+    uint64_t off = s->map_off + s->pos;
+
+    return off < s->file_size ? off : s->file_size;
+}
+
+int flight_csv_stream_seek(flight_csv_stream_t *s, uint64_t offset, long line)
+{
+    if (offset > s->file_size) {
+        return -1;
+    }
+    if (offset == s->file_size) {
+        /* At the end: nothing left to map */
+        if (s->map != NULL) {
+            munmap((void *)s->map, s->map_len);
+            s->map = NULL;
+        }
+        s->map_len = 0;
+        s->map_off = offset;
+        s->pos = 0;
+    } else if (map_window(s, offset) != 0) {
+        return -1;
+    }
+    s->line = line;
+    s->pending_error = 0;
+    return 0;
+}
+
+int flight_csv_stream_open(flight_csv_stream_t *s, const char *path, size_t window)
+{
+    char header[FLIGHT_CSV_MAX_LINE];
+    const char *start, *eol;
+    struct stat st;
+    size_t len;
+
+    memset(s, 0, sizeof(*s));
+    s->window = window != 0 ? window : FLIGHT_CSV_STREAM_WINDOW;
+    if (s->window < (size_t)FLIGHT_CSV_MAX_LINE * 4) {
+        s->window = (size_t)FLIGHT_CSV_MAX_LINE * 4;
+    }
+
+    s->fd = open(path, O_RDONLY);
+    if (s->fd < 0) {
+        return -1;
+    }
+    if (fstat(s->fd, &st) != 0 || st.st_size == 0) {
+        flight_csv_stream_close(s);
+        return -1;
+    }
+    s->file_size = (uint64_t)st.st_size;
+
+    if (map_window(s, 0) != 0 || next_line(s, &start, &eol) != 1) {
+        flight_csv_stream_close(s);
+        return -1;
+    }
+
+    len = (size_t)(eol - start);
+    if (len >= sizeof(header)) {
+        len = sizeof(header) - 1;
+    }
+    memcpy(header, start, len);
+    header[len] = '\0';
+    s->pos = (size_t)(eol - s->map) + 1;
+    s->line = 1;
+
+    s->num_cols = flight_csv_parse_header(header, s->col);
+    if (s->num_cols < 0) {
+        flight_csv_stream_close(s);
+        return -1;
+    }
+    return 0;
+}
+
+long flight_csv_stream_read(flight_csv_stream_t *s, double *const *columns, size_t max_rows)
+{
+    double sample[TREND_DFA_NUM_CHANNELS];
+    const char *start, *eol;
+    size_t rows = 0;
+    int rc, ch;
+
+    if (s->pending_error) {
+        s->pending_error = 0;
+        return -1;
+    }
+
+    while (rows < max_rows) {
+        rc = next_line(s, &start, &eol);
+        if (rc == 0) {
+            break;
+        }
+        if (rc < 0) {
+            s->line++;
+            if (rows == 0) {
+                return -1;
+            }
+            s->pending_error = 1;
+            break;
+        }
+
+        s->line++;
+        s->pos = (size_t)(eol - s->map) + 1;
+
+        if (start == eol || *start == '\r') {
+            continue;   /* blank line */
+        }
+        if (parse_row(s, start, eol, sample) != 0) {
+            if (rows == 0) {
+                return -1;
+            }
+            s->pending_error = 1;
+            break;
+        }
+
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            columns[ch][rows] = sample[ch];
+        }
+        rows++;
+    }
+
+    return (long)rows;
+}
+
+void flight_csv_stream_close(flight_csv_stream_t *s)
+{
+    if (s->map != NULL) {
+        munmap((void *)s->map, s->map_len);
+        s->map = NULL;
+    }
+    if (s->fd >= 0) {
+        close(s->fd);
+        s->fd = -1;
+    }
+}
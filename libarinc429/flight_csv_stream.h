@@ -0,0 +1,90 @@
+/* flight_csv_stream.h - Memory-mapped streaming reader for large flight dumps
+ *
+ * Same columns and row rules as flight_csv.h, but the file is mapped in
+ * fixed-size windows (default 64 MiB) that slide forward as rows are
+ * consumed, and rows are returned in chunks as one array per channel. At
+ * most one window is mapped at a time, so memory use does not depend on the
+ * file size. Numbers are parsed eight digits at a time; anything outside the
+ * exactly-representable fast path goes to strtod, so values match
+ * flight_csv_read bit for bit. POSIX only (mmap).
+ */
+
+#ifndef FLIGHT_CSV_STREAM_H
+#define FLIGHT_CSV_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flight_csv.h"
+#include "trend_dfa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHT_CSV_STREAM_WINDOW  ((size_t)64 << 20)   /* bytes mapped at once */
+#define FLIGHT_CSV_STREAM_CHUNK   4096                 /* rows per read, suggested */
+
+typedef struct {
+    int         fd;
+    uint64_t    file_size;
+    const char *map;            /* current window */
+    size_t      map_len;
+    uint64_t    map_off;        /* file offset of map[0], page aligned */
+    size_t      pos;            /* next unread byte, relative to map */
+    size_t      window;
+    int         col[TREND_DFA_NUM_CHANNELS];
+    int         num_cols;
+    long        line;
+    int         pending_error;  /* malformed row found after a partial chunk */
+} flight_csv_stream_t;
+
+/* Function: flight_csv_stream_open ===========================================
+ * Abstract:
+ *    Open path and parse the header. window is the mapping size in bytes
+ *    (0 selects FLIGHT_CSV_STREAM_WINDOW); a row must fit in one window.
+ *    Returns 0 on success, -1 as flight_csv_open.
+ */
+int flight_csv_stream_open(flight_csv_stream_t *s, const char *path, size_t window);
+
+/* Function: flight_csv_stream_read ===========================================
+ * Abstract:
+ *    Read up to max_rows rows; columns[ch] receives channel ch (TREND_DFA_CH_*
+ *    order) and must hold max_rows values. Returns the number of rows read,
+ *    0 at end of file, or -1 on a malformed row (s->line holds its line
+ *    number). Rows read before a malformed row are returned first; the
+ *    following call then returns -1.
+ */
+long flight_csv_stream_read(flight_csv_stream_t *s, double *const *columns, size_t max_rows);
+
+/* Function: flight_csv_stream_tell ===========================================
+ * Abstract:
+ *    File offset of the next unread row, for flight_csv_stream_seek (with
+ *    s->line, the line number of the last line read).
+ */
+uint64_t flight_csv_stream_tell(const flight_csv_stream_t *s);
+
+/* Function: flight_csv_stream_seek ===========================================
+ * Abstract:
+ *    Continue reading at offset, a value returned by flight_csv_stream_tell
+ *    on the same file, with line as the last line read. Only the window
+ *    around offset is mapped; nothing before it is read. Returns 0, or -1 if
+ *    offset lies past the end of the file or cannot be mapped.
+ */
+int flight_csv_stream_seek(flight_csv_stream_t *s, uint64_t offset, long line);
+
+void flight_csv_stream_close(flight_csv_stream_t *s);
+
+/* Function: flight_csv_parse_number ==========================================
+ * Abstract:
+ *    Parse the number at the start of [p, end) like strtod, without needing
+ *    a terminator. Returns 0 and sets *value if a number was found, -1
+ *    otherwise. Trailing characters in the field are ignored, as with strtod.
+ */
+int flight_csv_parse_number(const char *p, const char *end, double *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHT_CSV_STREAM_H */
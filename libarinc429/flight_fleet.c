@@ -0,0 +1,678 @@
+/* flight_fleet.c - Parallel per-aircraft trend DFA replay */
+
+#include "flight_fleet.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flight_csv.h"
+#include "flight_csv_stream.h"
+
+/* ---- Thread helper ------------------------------------------------------ */
+
+/* Run fn on n argument blocks, block 0 on the calling thread. Blocks whose
+ * thread cannot be created run on the calling thread afterwards, so every
+ * job here must also be correct when run one after the other. */
+static void run_threads(int n, void *(*fn)(void *), void *args, size_t stride)
+{
+    pthread_t tid[FLIGHT_FLEET_MAX_THREADS];
+    char *base = (char *)args;
+    int i, started;
+
+    for (started = 1; started < n; started++) {
+        if (pthread_create(&tid[started], NULL, fn, base + (size_t)started * stride) != 0) {
+            break;
+        }
+    }
+    fn(base);
+    for (i = 1; i < started; i++) {
+        pthread_join(tid[i], NULL);
+    }
+    for (i = started; i < n; i++) {
+        fn(base + (size_t)i * stride);
+    }
+}
+
+static int clamp_threads(int n)
+{
+    return n < 1 ? 1 : n > FLIGHT_FLEET_MAX_THREADS ? FLIGHT_FLEET_MAX_THREADS : n;
+}
+
+/* ---- Loading ------------------------------------------------------------ */
+
+typedef struct {
+    const char *begin;          /* first byte of the segment */
+    const char *end;            /* one past its last byte */
+    const int  *col;            /* channel columns */
+    int         num_cols;
+    int         icao_col;
+    int         time_col;
+    size_t      rows;           /* non-empty lines */
+    long        lines;          /* all lines */
+    size_t      first_row;
+    long        first_line;
+    uint32_t   *key;            /* [file row] */
+    double     *time;           /* [file row] */
+    double     *input[TREND_DFA_NUM_CHANNELS];
+    long        bad_line;
+} segment_t;
+
+static char *read_file(const char *path, size_t *len)
+{
+    FILE *fp = fopen(path, "rb");
+    char *buf = NULL;
+    long size;
+
+    if (fp == NULL) {
+        return NULL;
+    }
+    if (fseek(fp, 0, SEEK_END) == 0 && (size = ftell(fp)) >= 0 && fseek(fp, 0, SEEK_SET) == 0) {
+        buf = (char *)malloc((size_t)size + 1);
+        if (buf != NULL && fread(buf, 1, (size_t)size, fp) != (size_t)size) {
+            free(buf);
+            buf = NULL;
+        }
+        if (buf != NULL) {
+            buf[size] = '\0';
+            *len = (size_t)size;
+        }
+    }
+    fclose(fp);
+    return buf;
+}
+
+/* Index of a column in a NUL-terminated header line (quotes and blanks
+ * ignored), -1 if absent */
+static int find_column(const char *line, const char *name)
+{
+    size_t name_len = strlen(name);
+    int idx;
+
+    for (idx = 0; ; idx++) {
+        const char *p = line, *q;
+
+        while (*p == ' ' || *p == '"') p++;
+        for (q = p; *q != ',' && *q != '\n' && *q != '\r' && *q != '\0'; q++) {
+        }
+        line = q;
+        while (q > p && (q[-1] == ' ' || q[-1] == '"')) q--;
+        if ((size_t)(q - p) == name_len && memcmp(p, name, name_len) == 0) {
+            return idx;
+        }
+        if (*line != ',') {
+            return -1;
+        }
+        line++;
+    }
+}
+
+/* 24-bit hex address, optionally quoted; -1 if invalid */
+static long parse_icao24(const char *p)
+{
+    long v = 0;
+    int n = 0;
+
+    if (*p == '"') p++;
+    for (; n < 6; p++, n++) {
+        int c = *p, d;
+        if (c >= '0' && c <= '9') d = c - '0';
+        else if (c >= 'a' && c <= 'f') d = c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') d = c - 'A' + 10;
+        else break;
+        v = v * 16 + d;
+    }
+    return n == 0 ? -1 : v;
+}
+
+static inline int empty_line(const char *p)
+{
+    return *p == '\n' || *p == '\r';
+}
+
+/* Phase 1: count lines and rows of a segment */
+static void *count_segment(void *arg)
+{
+    segment_t *s = (segment_t *)arg;
+    const char *p = s->begin;
+
+    s->rows = 0;
+    s->lines = 0;
+    while (p < s->end) {
+        const char *nl = (const char *)memchr(p, '\n', (size_t)(s->end - p));
+        if (!empty_line(p)) {
+            s->rows++;
+        }
+        s->lines++;
+        p = nl != NULL ? nl + 1 : s->end;
+    }
+    return NULL;
+}
+
+/* Phase 2: parse the rows of a segment into their file-row slots, with the
+ * field rules of flight_csv_read and the number parser of the stream reader */
+static void *parse_segment(void *arg)
+{
+    segment_t *s = (segment_t *)arg;
+    const char *p = s->begin;
+    size_t row = s->first_row;
+    long line = s->first_line;
+
+    s->bad_line = 0;
+    for (; p < s->end; line++) {
+        const char *nl = (const char *)memchr(p, '\n', (size_t)(s->end - p));
+        const char *next = nl != NULL ? nl + 1 : s->end;
+        const char *eol = nl != NULL ? nl : s->end;
+        const char *field = p;
+        double sample[TREND_DFA_NUM_CHANNELS] = {0.0};
+        double t = (double)row;
+        long key = -1;
+        int idx, ch, ok = 1;
+
+        if (empty_line(p)) {
+            p = next;
+            continue;
+        }
+        if (eol > p && eol[-1] == '\r') {
+            eol--;
+        }
+        for (idx = 0; idx < s->num_cols; idx++) {
+            const char *field_end = (const char *)memchr(field, ',', (size_t)(eol - field));
+
+            if (field_end == NULL) {
+                field_end = eol;
+            }
+            if (field_end > field) {
+                if (idx == s->icao_col) {
+                    key = parse_icao24(field);
+                } else if (idx == s->time_col) {
+                    ok &= flight_csv_parse_number(field, field_end, &t) == 0;
+                }
+                for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                    if (s->col[ch] == idx) {
+                        ok &= flight_csv_parse_number(field, field_end, &sample[ch]) == 0;
+                    }
+                }
+            }
+            if (field_end == eol) {
+                break;
+            }
+            field = field_end + 1;
+        }
+        if (!ok || key < 0 || idx < s->num_cols - 1) {
+            s->bad_line = line;
+            return NULL;
+        }
+
+        s->key[row] = (uint32_t)key;
+        s->time[row] = t;
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            s->input[ch][row] = sample[ch];
+        }
+        row++;
+        p = next;
+    }
+    return NULL;
+}
+
+static inline size_t hash_icao24(uint32_t k, size_t mask)
+{
+    uint32_t h = k * 0x9E3779B1u;
+
+    return (size_t)(h ^ (h >> 15)) & mask;
+}
+
+/* Phase 3: track id per row in first-seen order, open addressing on icao24 */
+static uint32_t *assign_tracks(flight_fleet_t *f, const uint32_t *key, size_t **counts)
+{
+    uint32_t *tid = (uint32_t *)malloc(f->num_rows * sizeof(uint32_t) + 1);
+    uint32_t *slot = NULL;          /* track id + 1, 0 if empty */
+    size_t cap = 1024, mask, cap_tracks = 256, r, i;
+    size_t *count = (size_t *)calloc(cap_tracks, sizeof(size_t));
+    uint32_t *icao = (uint32_t *)malloc(cap_tracks * sizeof(uint32_t));
+
+    slot = (uint32_t *)calloc(cap, sizeof(uint32_t));
+    if (tid == NULL || slot == NULL || count == NULL || icao == NULL) {
+        goto fail;
+    }
+    mask = cap - 1;
+
+    f->num_tracks = 0;
+    for (r = 0; r < f->num_rows; r++) {
+        uint32_t k = key[r];
+
+        for (i = hash_icao24(k, mask); slot[i] != 0 && icao[slot[i] - 1] != k; i = (i + 1) & mask) {
+        }
+        if (slot[i] == 0) {
+            if (f->num_tracks == cap_tracks) {
+                size_t *nc = (size_t *)realloc(count, 2 * cap_tracks * sizeof(size_t));
+                uint32_t *ni;
+                if (nc == NULL) goto fail;
+                count = nc;
+                ni = (uint32_t *)realloc(icao, 2 * cap_tracks * sizeof(uint32_t));
+                if (ni == NULL) goto fail;
+                icao = ni;
+                memset(count + cap_tracks, 0, cap_tracks * sizeof(size_t));
+                cap_tracks *= 2;
+            }
+            icao[f->num_tracks] = k;
+            slot[i] = (uint32_t)++f->num_tracks;
+
+            /* Keep the load factor below 1/2 */
+            if (2 * f->num_tracks > cap) {
+                uint32_t *ns = (uint32_t *)calloc(2 * cap, sizeof(uint32_t));
+                size_t j;
+                if (ns == NULL) goto fail;
+                cap *= 2;
+                mask = cap - 1;
+                for (j = 0; j < f->num_tracks; j++) {
+                    for (i = hash_icao24(icao[j], mask); ns[i] != 0; i = (i + 1) & mask) {
+                    }
+                    ns[i] = (uint32_t)j + 1;
+                }
+                free(slot);
+                slot = ns;
+                for (i = hash_icao24(k, mask); icao[slot[i] - 1] != k; i = (i + 1) & mask) {
+                }
+            }
+        }
+        tid[r] = slot[i] - 1;
+        count[tid[r]]++;
+    }
+
+    free(slot);
+    f->icao24 = icao;
+    *counts = count;
+    return tid;
+
+fail:
+    free(tid);
+    free(slot);
+    free(count);
+    free(icao);
+    return NULL;
+}
+
+int flight_fleet_load(flight_fleet_t *f, const char *path, int num_threads)
+{
+    segment_t seg[FLIGHT_FLEET_MAX_THREADS];
+    int col[TREND_DFA_NUM_CHANNELS];
+    uint32_t *key = NULL, *tid = NULL;
+    double *raw_time = NULL, *raw_input[TREND_DFA_NUM_CHANNELS] = {NULL};
+    size_t *count = NULL, len, r, k;
+    const char *body, *end;
+    char *buf, *header = NULL, *nl;
+    int num_cols, icao_col, time_col, n, i, ch, failed = 0;
+    long lines = 2;
+
+    memset(f, 0, sizeof(*f));
+    num_threads = clamp_threads(num_threads);
+
+    buf = read_file(path, &len);
+    if (buf == NULL) {
+        return -1;
+    }
+    end = buf + len;
+    nl = strchr(buf, '\n');
+    body = nl != NULL ? nl + 1 : end;
+
+    /* Channel columns as flight_csv does, then icao24 and time */
+    header = (char *)malloc((size_t)(body - buf) + 1);
+    if (header == NULL) {
+        free(buf);
+        return -1;
+    }
+    memcpy(header, buf, (size_t)(body - buf));
+    header[body - buf] = '\0';
+    icao_col = find_column(header, "icao24");
+    time_col = find_column(header, "time");
+    num_cols = flight_csv_parse_header(header, col);
+    free(header);
+    if (num_cols < 0 || icao_col < 0) {
+        free(buf);
+        return -1;
+    }
+    f->has_time = time_col >= 0;
+
+    /* Segments end on line boundaries */
+    n = num_threads;
+    for (i = 0; i < n; i++) {
+        const char *b = i == 0 ? body : seg[i - 1].end;
+        const char *e = body + (size_t)(end - body) * (size_t)(i + 1) / (size_t)n;
+
+        if (e < b) e = b;
+        if (i == n - 1) {
+            e = end;
+        } else if (e > body && e < end && e[-1] != '\n') {
+            const char *q = (const char *)memchr(e, '\n', (size_t)(end - e));
+            e = q != NULL ? q + 1 : end;
+        }
+        memset(&seg[i], 0, sizeof(seg[i]));
+        seg[i].begin = b;
+        seg[i].end = e;
+        seg[i].col = col;
+        seg[i].num_cols = num_cols;
+        seg[i].icao_col = icao_col;
+        seg[i].time_col = time_col;
+    }
+    run_threads(n, count_segment, seg, sizeof(seg[0]));
+
+    for (i = 0; i < n; i++) {
+        seg[i].first_row = f->num_rows;
+        seg[i].first_line = lines;
+        f->num_rows += seg[i].rows;
+        lines += seg[i].lines;
+    }
+
+    key = (uint32_t *)malloc(f->num_rows * sizeof(uint32_t) + 1);
+    raw_time = (double *)malloc(f->num_rows * sizeof(double) + 1);
+    failed = key == NULL || raw_time == NULL;
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        raw_input[ch] = (double *)malloc(f->num_rows * sizeof(double) + 1);
+        failed |= raw_input[ch] == NULL;
+    }
+    if (!failed) {
+        for (i = 0; i < n; i++) {
+            seg[i].key = key;
+            seg[i].time = raw_time;
+            memcpy(seg[i].input, raw_input, sizeof(raw_input));
+        }
+        run_threads(n, parse_segment, seg, sizeof(seg[0]));
+        for (i = 0; i < n && f->bad_line == 0; i++) {
+            f->bad_line = seg[i].bad_line;
+        }
+        failed = f->bad_line != 0;
+    }
+    free(buf);
+
+    if (!failed) {
+        tid = assign_tracks(f, key, &count);
+        failed = tid == NULL;
+    }
+
+    /* Group rows by track, file order within a track */
+    if (!failed) {
+        f->track_start = (size_t *)malloc((f->num_tracks + 1) * sizeof(size_t));
+        f->position = (size_t *)malloc(f->num_rows * sizeof(size_t) + 1);
+        f->time = (double *)malloc(f->num_rows * sizeof(double) + 1);
+        failed = f->track_start == NULL || f->position == NULL || f->time == NULL;
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            f->input[ch] = (double *)malloc(f->num_rows * sizeof(double) + 1);
+            failed |= f->input[ch] == NULL;
+        }
+    }
+    if (!failed) {
+        f->track_start[0] = 0;
+        for (k = 0; k < f->num_tracks; k++) {
+            f->track_start[k + 1] = f->track_start[k] + count[k];
+            count[k] = f->track_start[k];       /* now the fill cursor */
+        }
+        for (r = 0; r < f->num_rows; r++) {
+            size_t pos = count[tid[r]]++;
+            f->position[r] = pos;
+            f->time[pos] = raw_time[r];
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                f->input[ch][pos] = raw_input[ch][r];
+            }
+        }
+    }
+
+    free(key);
+    free(tid);
+    free(count);
+    free(raw_time);
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        free(raw_input[ch]);
+    }
+    return failed ? -1 : 0;
+}
+
+/* ---- Work-stealing run ---------------------------------------------------- */
+
+/* Chase-Lev deque over a task array filled before the workers start; the
+ * owner pops at bottom, thieves take from top */
+typedef struct {
+    _Alignas(64) atomic_long top;
+    _Alignas(64) atomic_long bottom;
+    const uint32_t *task;
+} deque_t;
+
+typedef struct {
+    flight_fleet_t        *f;
+    deque_t               *deques;
+    int                    self;
+    int                    num_workers;
+    flight_fleet_worker_t  stats;
+} worker_t;
+
+#define TASK_EMPTY -1
+#define TASK_RETRY -2
+
+static long deque_pop(deque_t *d)
+{
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    long t, task = TASK_EMPTY;
+
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t <= b) {
+        task = d->task[b];
+        if (t == b) {
+            /* Last task: race any thief for it */
+            if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                         memory_order_relaxed)) {
+                task = TASK_EMPTY;
+            }
+            atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        }
+    } else {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static long deque_steal(deque_t *d)
+{
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    long b;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+    if (t >= b) {
+        return TASK_EMPTY;
+    }
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1, memory_order_seq_cst,
+                                                 memory_order_relaxed)) {
+        return TASK_RETRY;
+    }
+    return d->task[t];
+}
+
+static void run_track(flight_fleet_t *f, size_t k)
+{
+    trend_dfa_t dfa;
+    trend_dfa_output_t out;
+    double sample[TREND_DFA_NUM_CHANNELS];
+    size_t r;
+    int ch, i;
+
+    trend_dfa_init(&dfa);
+    for (r = f->track_start[k]; r < f->track_start[k + 1]; r++) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            sample[ch] = f->input[ch][r];
+        }
+        trend_dfa_step(&dfa, sample, &out);
+        f->state[r] = (int8_t)out.state;
+        f->confidence[r] = out.confidence;
+        for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+            f->trends[r * TREND_DFA_NUM_TRENDS + (size_t)i] = out.trends[i];
+        }
+    }
+}
+
+static void *run_worker(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
+    flight_fleet_t *f = w->f;
+    long task;
+    int v, busy;
+
+    for (;;) {
+        while ((task = deque_pop(&w->deques[w->self])) != TASK_EMPTY) {
+            run_track(f, (size_t)task);
+            w->stats.tracks++;
+            w->stats.rows += f->track_start[task + 1] - f->track_start[task];
+        }
+
+        /* Own deque is empty: steal until every deque is */
+        do {
+            busy = 0;
+            task = TASK_EMPTY;
+            for (v = 1; v < w->num_workers && task < 0; v++) {
+                task = deque_steal(&w->deques[(w->self + v) % w->num_workers]);
+                busy |= task == TASK_RETRY;
+            }
+        } while (task < 0 && busy);
+        if (task < 0) {
+            return NULL;
+        }
+        run_track(f, (size_t)task);
+        w->stats.tracks++;
+        w->stats.steals++;
+        w->stats.rows += f->track_start[task + 1] - f->track_start[task];
+    }
+}
+
+typedef struct {
+    size_t   length;
+    uint32_t track;
+} track_length_t;
+
+/* Longest track first, then by track id */
+static int compare_length(const void *a, const void *b)
+{
+    const track_length_t *x = (const track_length_t *)a, *y = (const track_length_t *)b;
+
+    if (x->length != y->length) return x->length < y->length ? 1 : -1;
+    return x->track < y->track ? -1 : x->track > y->track;
+}
+
+int flight_fleet_run(flight_fleet_t *f, int num_threads, flight_fleet_worker_t *workers)
+{
+    worker_t worker[FLIGHT_FLEET_MAX_THREADS];
+    deque_t *deques;
+    track_length_t *order;
+    uint32_t *tasks;
+    size_t per, k;
+    int n = clamp_threads(num_threads), i;
+
+    if (f->state == NULL) {
+        f->state = (int8_t *)malloc(f->num_rows + 1);
+        f->confidence = (double *)malloc(f->num_rows * sizeof(double) + 1);
+        f->trends = (double *)malloc(f->num_rows * TREND_DFA_NUM_TRENDS * sizeof(double) + 1);
+    }
+    per = (f->num_tracks + (size_t)n - 1) / (size_t)n;
+    order = (track_length_t *)malloc(f->num_tracks * sizeof(track_length_t) + 1);
+    tasks = (uint32_t *)malloc(per * (size_t)n * sizeof(uint32_t) + 1);
+    deques = (deque_t *)aligned_alloc(_Alignof(deque_t), (size_t)n * sizeof(deque_t));
+    if (f->state == NULL || f->confidence == NULL || f->trends == NULL ||
+        order == NULL || tasks == NULL || deques == NULL) {
+        free(order);
+        free(tasks);
+        free(deques);
+        return -1;
+    }
+
+    /* Deal the tracks longest first, round robin. Each deque is filled from
+     * the bottom up in reverse, so its owner starts with its longest track
+     * and thieves take the shortest ones. */
+    for (k = 0; k < f->num_tracks; k++) {
+        order[k].length = f->track_start[k + 1] - f->track_start[k];
+        order[k].track = (uint32_t)k;
+    }
+    qsort(order, f->num_tracks, sizeof(order[0]), compare_length);
+
+    for (i = 0; i < n; i++) {
+        size_t count = 0;
+        for (k = (size_t)i; k < f->num_tracks; k += (size_t)n) {
+            count++;
+        }
+        for (k = 0; k < count; k++) {
+            tasks[(size_t)i * per + k] = order[(size_t)i + (count - 1 - k) * (size_t)n].track;
+        }
+        deques[i].task = tasks + (size_t)i * per;
+        atomic_init(&deques[i].top, 0);
+        atomic_init(&deques[i].bottom, (long)count);
+
+        memset(&worker[i], 0, sizeof(worker[i]));
+        worker[i].f = f;
+        worker[i].deques = deques;
+        worker[i].self = i;
+        worker[i].num_workers = n;
+    }
+
+    run_threads(n, run_worker, worker, sizeof(worker[0]));
+
+    if (workers != NULL) {
+        for (i = 0; i < n; i++) {
+            workers[i] = worker[i].stats;
+        }
+    }
+    free(order);
+    free(tasks);
+    free(deques);
+    return 0;
+}
+
+/* ---- Access --------------------------------------------------------------- */
+
+void flight_fleet_row(const flight_fleet_t *f, size_t row, double *input, trend_dfa_output_t *out)
+{
+    int ch, i;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        input[ch] = f->input[ch][row];
+    }
+    out->state = f->state[row];
+    out->confidence = f->confidence[row];
+    for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+        out->trends[i] = f->trends[row * TREND_DFA_NUM_TRENDS + (size_t)i];
+    }
+}
+
+size_t flight_fleet_track_of(const flight_fleet_t *f, size_t row)
+{
+    size_t lo = 0, hi = f->num_tracks;
+
+    /* Last track whose start is <= row */
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (f->track_start[mid] <= row) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+void flight_fleet_free(flight_fleet_t *f)
+{
+    int ch;
+
+    free(f->icao24);
+    free(f->track_start);
+    free(f->position);
+    free(f->time);
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        free(f->input[ch]);
+    }
+    free(f->state);
+    free(f->confidence);
+    free(f->trends);
+    memset(f, 0, sizeof(*f));
+}
@@ -0,0 +1,90 @@
+/* flight_fleet.h - Parallel per-aircraft trend DFA replay
+ *
+ * A multi-aircraft dump (OpenSky style, one icao24 column) is loaded, parsed
+ * in parallel and partitioned by aircraft: rows of one icao24 become one
+ * contiguous track, in file order. Every track then runs through its own
+ * trend_dfa_t on a work-stealing thread pool: tracks are dealt longest first
+ * to per-worker deques, a worker takes from the back of its own deque and,
+ * once it is empty, steals from the front of the others. Tracks share
+ * nothing, so no locks are taken while the DFA runs and the result does not
+ * depend on the number of threads or on who ran which track.
+ *
+ * Outputs are kept in track order; flight_fleet_position maps a row of the
+ * file to it, so sinks can consume the merged result in file order.
+ */
+
+#ifndef FLIGHT_FLEET_H
+#define FLIGHT_FLEET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHT_FLEET_MAX_THREADS 256
+
+typedef struct {
+    size_t    num_rows;
+    size_t    num_tracks;
+    uint32_t *icao24;                           /* [track] 24-bit address */
+    size_t   *track_start;                      /* [track + 1] first row of each track */
+    size_t   *position;                         /* [file row] row in track order */
+    double   *time;                             /* [row] time column, or file row index */
+    double   *input[TREND_DFA_NUM_CHANNELS];    /* [row] TREND_DFA_CH_* */
+    int       has_time;
+    long      bad_line;                         /* first malformed line, 0 if none */
+
+    /* Filled by flight_fleet_run */
+    int8_t   *state;                            /* [row] */
+    double   *confidence;                       /* [row] */
+    double   *trends;                           /* [row][TREND_DFA_NUM_TRENDS] */
+} flight_fleet_t;
+
+/* Per-worker counters of one run */
+typedef struct {
+    uint64_t tracks;
+    uint64_t rows;
+    uint64_t steals;
+} flight_fleet_worker_t;
+
+/* Function: flight_fleet_load ================================================
+ * Abstract:
+ *    Read a CSV with icao24, velocity, baroaltitude, lat, lon, vertrate and
+ *    optionally time columns, parse it with num_threads threads and
+ *    partition it by icao24. Returns 0, or -1 if the file cannot be read,
+ *    a column is missing, memory runs out or a row is malformed (f->bad_line
+ *    is then its line number). f is always safe to pass to flight_fleet_free.
+ */
+int flight_fleet_load(flight_fleet_t *f, const char *path, int num_threads);
+
+/* Function: flight_fleet_run =================================================
+ * Abstract:
+ *    Run every track through a fresh DFA on num_threads workers (1 runs on
+ *    the calling thread). workers, if not NULL, receives num_threads entries.
+ *    Returns 0, or -1 if memory or threads cannot be obtained.
+ */
+int flight_fleet_run(flight_fleet_t *f, int num_threads, flight_fleet_worker_t *workers);
+
+/* Row in track order holding file row r */
+static inline size_t flight_fleet_position(const flight_fleet_t *f, size_t r)
+{
+    return f->position[r];
+}
+
+/* Inputs and DFA output of a row in track order */
+void flight_fleet_row(const flight_fleet_t *f, size_t row, double *input, trend_dfa_output_t *out);
+
+/* Track holding a row in track order (binary search) */
+size_t flight_fleet_track_of(const flight_fleet_t *f, size_t row);
+
+void flight_fleet_free(flight_fleet_t *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHT_FLEET_H */
@@ -0,0 +1,404 @@
+/* flight_rec.c - Columnar recording of DFA inputs and outputs */
+
+#include "flight_rec.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+#define rec_fseek _fseeki64
+#define rec_ftell _ftelli64
+#else
+#define rec_fseek fseeko
+#define rec_ftell ftello
+#endif
+
+#define REC_PAGE_SIZE    4096u
+#define REC_BLOCK_ALIGN  64u
+
+/* On-disk structures; all fields naturally aligned, no padding */
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t chunk_rows;
+    uint32_t num_columns;
+    uint64_t chunk_bytes;
+    uint8_t  reserved[32];
+} rec_file_header_t;
+
+typedef struct {
+    char     name[FLIGHT_REC_COLUMN_NAME_LEN];
+    uint32_t type;
+    uint32_t offset;                    /* from the start of the chunk */
+} rec_column_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t rows;
+    uint64_t first_row;
+    double   t_first;
+    double   t_last;
+    uint8_t  reserved[32];
+} rec_chunk_header_t;
+
+static const char *const column_name[FLIGHT_REC_NUM_COLUMNS] = {
+    "time",
+    "velocity", "baroaltitude", "lat", "lon", "vertrate",
+    "state", "confidence",
+    "vel_trend", "baroalt_trend", "lat_trend", "lon_trend", "vertrate_trend", "weighted_trend"
+};
+
+static uint32_t column_type(int col)
+{
+    return col == FLIGHT_REC_COL_STATE ? FLIGHT_REC_U8 : FLIGHT_REC_F64;
+}
+
+static size_t type_size(uint32_t type)
+{
+    return type == FLIGHT_REC_U8 ? sizeof(uint8_t) : sizeof(double);
+}
+
+/* Column block offsets for chunk_rows rows; returns the chunk size in bytes */
+static uint64_t chunk_layout(uint32_t chunk_rows, uint32_t *offset)
+{
+    uint64_t off = FLIGHT_REC_CHUNK_HEADER_SIZE;
+    int col;
+
+    for (col = 0; col < FLIGHT_REC_NUM_COLUMNS; col++) {
+        off = (off + REC_BLOCK_ALIGN - 1) / REC_BLOCK_ALIGN * REC_BLOCK_ALIGN;
+        offset[col] = (uint32_t)off;
+        off += (uint64_t)chunk_rows * type_size(column_type(col));
+    }
+    return (off + REC_PAGE_SIZE - 1) / REC_PAGE_SIZE * REC_PAGE_SIZE;
+}
+
+static int check_header(const uint8_t *hdr, uint32_t *chunk_rows, uint64_t *chunk_bytes)
+{
+    rec_file_header_t fh;
+    rec_column_t cd;
+    uint32_t offset[FLIGHT_REC_NUM_COLUMNS];
+    int col;
+
+    memcpy(&fh, hdr, sizeof(fh));
+    if (memcmp(fh.magic, FLIGHT_REC_MAGIC, sizeof(FLIGHT_REC_MAGIC)) != 0 ||
+        fh.version != FLIGHT_REC_VERSION || fh.header_size != FLIGHT_REC_HEADER_SIZE ||
+        fh.num_columns != FLIGHT_REC_NUM_COLUMNS || fh.chunk_rows == 0 ||
+        fh.chunk_bytes != chunk_layout(fh.chunk_rows, offset)) {
+        return -1;
+    }
+    for (col = 0; col < FLIGHT_REC_NUM_COLUMNS; col++) {
+        memcpy(&cd, hdr + sizeof(fh) + col * sizeof(cd), sizeof(cd));
+        if (cd.type != column_type(col) || cd.offset != offset[col]) {
+            return -1;
+        }
+    }
+
+    *chunk_rows = fh.chunk_rows;
+    *chunk_bytes = fh.chunk_bytes;
+    return 0;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Writer                                                                   */
+/* ------------------------------------------------------------------------ */
+
+static int writer_alloc(flight_rec_writer_t *w)
+{
+    w->buf = calloc(1, (size_t)w->chunk_bytes);
+    return w->buf != NULL ? 0 : -1;
+}
+
+static int write_chunk(flight_rec_writer_t *w)
+{
+    uint64_t pos = FLIGHT_REC_HEADER_SIZE + w->chunk_index * w->chunk_bytes;
+    const double *time = (const double *)(w->buf + w->offset[FLIGHT_REC_COL_TIME]);
+    rec_chunk_header_t ch;
+
+    memset(&ch, 0, sizeof(ch));
+    ch.magic = FLIGHT_REC_CHUNK_MAGIC;
+    ch.rows = w->rows;
+    ch.first_row = w->chunk_index * w->chunk_rows;
+    ch.t_first = time[0];
+    ch.t_last = time[w->rows - 1];
+    memcpy(w->buf, &ch, sizeof(ch));
+
+    if (rec_fseek(w->fp, (long long)pos, SEEK_SET) != 0 ||
+        fwrite(w->buf, 1, (size_t)w->chunk_bytes, w->fp) != (size_t)w->chunk_bytes) {
+        return -1;
+    }
+    return 0;
+}
+
+int flight_rec_create(flight_rec_writer_t *w, const char *path, uint32_t chunk_rows)
+{
+    uint8_t hdr[FLIGHT_REC_HEADER_SIZE];
+    rec_file_header_t fh;
+    rec_column_t cd;
+    int col;
+
+    memset(w, 0, sizeof(*w));
+    w->chunk_rows = chunk_rows != 0 ? chunk_rows : FLIGHT_REC_DEFAULT_CHUNK_ROWS;
+    w->chunk_bytes = chunk_layout(w->chunk_rows, w->offset);
+    w->last_time = -INFINITY;
+
+    memset(hdr, 0, sizeof(hdr));
+    memset(&fh, 0, sizeof(fh));
+    memcpy(fh.magic, FLIGHT_REC_MAGIC, sizeof(FLIGHT_REC_MAGIC));
+    fh.version = FLIGHT_REC_VERSION;
+    fh.header_size = FLIGHT_REC_HEADER_SIZE;
+    fh.chunk_rows = w->chunk_rows;
+    fh.num_columns = FLIGHT_REC_NUM_COLUMNS;
+    fh.chunk_bytes = w->chunk_bytes;
+    memcpy(hdr, &fh, sizeof(fh));
+    for (col = 0; col < FLIGHT_REC_NUM_COLUMNS; col++) {
+        memset(&cd, 0, sizeof(cd));
+        strncpy(cd.name, column_name[col], sizeof(cd.name) - 1);
+        cd.type = column_type(col);
+        cd.offset = w->offset[col];
+        memcpy(hdr + sizeof(fh) + col * sizeof(cd), &cd, sizeof(cd));
+    }
+
+    w->fp = fopen(path, "w+b");
+    if (w->fp == NULL) {
+        return -1;
+    }
+    if (fwrite(hdr, 1, sizeof(hdr), w->fp) != sizeof(hdr) || writer_alloc(w) != 0) {
+        flight_rec_close(w);
+        return -1;
+    }
+    return 0;
+}
+
+int flight_rec_open_append(flight_rec_writer_t *w, const char *path)
+{
+    uint8_t hdr[FLIGHT_REC_HEADER_SIZE];
+    rec_chunk_header_t ch;
+    long long size;
+    uint64_t num_chunks;
+
+    memset(w, 0, sizeof(*w));
+    w->last_time = -INFINITY;
+
+    w->fp = fopen(path, "r+b");
+    if (w->fp == NULL) {
+        return -1;
+    }
+    if (fread(hdr, 1, sizeof(hdr), w->fp) != sizeof(hdr) ||
+        check_header(hdr, &w->chunk_rows, &w->chunk_bytes) != 0 ||
+        writer_alloc(w) != 0 ||
+        chunk_layout(w->chunk_rows, w->offset) != w->chunk_bytes ||
+        rec_fseek(w->fp, 0, SEEK_END) != 0 || (size = rec_ftell(w->fp)) < 0) {
+        fclose(w->fp);
+        free(w->buf);
+        memset(w, 0, sizeof(*w));
+        return -1;
+    }
+
+    num_chunks = ((uint64_t)size - FLIGHT_REC_HEADER_SIZE) / w->chunk_bytes;
+    if (num_chunks > 0) {
+        rec_fseek(w->fp, (long long)(FLIGHT_REC_HEADER_SIZE + (num_chunks - 1) * w->chunk_bytes), SEEK_SET);
+        if (fread(w->buf, 1, (size_t)w->chunk_bytes, w->fp) != (size_t)w->chunk_bytes) {
+            flight_rec_close(w);
+            return -1;
+        }
+        memcpy(&ch, w->buf, sizeof(ch));
+        w->last_time = ch.t_last;
+        if (ch.rows < w->chunk_rows) {
+            /* Keep filling the partial chunk */
+            w->chunk_index = num_chunks - 1;
+            w->rows = ch.rows;
+        } else {
+            w->chunk_index = num_chunks;
+            memset(w->buf, 0, (size_t)w->chunk_bytes);
+        }
+    }
+    return 0;
+}
+
+int flight_rec_append(flight_rec_writer_t *w, double time, const double *input,
+                      const trend_dfa_output_t *out)
+{
+    const uint32_t *offset = w->offset;
+    uint32_t r = w->rows;
+    int i;
+
+    if (w->failed || r >= w->chunk_rows || !(time >= w->last_time)) {
+        return -1;
+    }
+
+    ((double *)(w->buf + offset[FLIGHT_REC_COL_TIME]))[r] = time;
+    for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+        ((double *)(w->buf + offset[FLIGHT_REC_COL_INPUT + i]))[r] = input[i];
+    }
+    (w->buf + offset[FLIGHT_REC_COL_STATE])[r] = (uint8_t)out->state;
+    ((double *)(w->buf + offset[FLIGHT_REC_COL_CONFIDENCE]))[r] = out->confidence;
+    for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+        ((double *)(w->buf + offset[FLIGHT_REC_COL_TREND + i]))[r] = out->trends[i];
+    }
+    w->last_time = time;
+
+    if (++w->rows == w->chunk_rows) {
+        if (write_chunk(w) != 0) {
+            w->failed = 1;
+            return -1;
+        }
+        w->chunk_index++;
+        w->rows = 0;
+        memset(w->buf, 0, (size_t)w->chunk_bytes);
+    }
+    return 0;
+}
+
+int flight_rec_flush(flight_rec_writer_t *w)
+{
+    if (w->failed) {
+        return -1;
+    }
+    if (w->rows > 0 && write_chunk(w) != 0) {
+        w->failed = 1;
+        return -1;
+    }
+    return fflush(w->fp) == 0 ? 0 : -1;
+}
+
+int flight_rec_close(flight_rec_writer_t *w)
+{
+    int rc = 0;
+
+    if (w->fp != NULL) {
+        rc = flight_rec_flush(w);
+        if (fclose(w->fp) != 0) {
+            rc = -1;
+        }
+        w->fp = NULL;
+    }
+    free(w->buf);
+    w->buf = NULL;
+    return rc;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Reader                                                                   */
+/* ------------------------------------------------------------------------ */
+
+#if !defined(_WIN32)
+
+static const rec_chunk_header_t *chunk_header(const flight_rec_reader_t *r, uint64_t k)
+{
+    return (const rec_chunk_header_t *)(r->map + FLIGHT_REC_HEADER_SIZE + k * r->chunk_bytes);
+}
+
+int flight_rec_open(flight_rec_reader_t *r, const char *path)
+{
+    struct stat st;
+    void *map;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < FLIGHT_REC_HEADER_SIZE) {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    r->map = (const uint8_t *)map;
+    r->map_len = (size_t)st.st_size;
+    if (check_header(r->map, &r->chunk_rows, &r->chunk_bytes) != 0) {
+        flight_rec_close_reader(r);
+        return -1;
+    }
+    chunk_layout(r->chunk_rows, r->offset);
+
+    r->num_chunks = (r->map_len - FLIGHT_REC_HEADER_SIZE) / r->chunk_bytes;
+    if (r->num_chunks > 0) {
+        const rec_chunk_header_t *last = chunk_header(r, r->num_chunks - 1);
+        if (last->magic != FLIGHT_REC_CHUNK_MAGIC || last->rows > r->chunk_rows) {
+            flight_rec_close_reader(r);
+            return -1;
+        }
+        r->num_rows = (r->num_chunks - 1) * r->chunk_rows + last->rows;
+    }
+    return 0;
+}
+
+void flight_rec_chunk(const flight_rec_reader_t *r, uint64_t k, flight_rec_chunk_t *view)
+{
+    const uint8_t *base = r->map + FLIGHT_REC_HEADER_SIZE + k * r->chunk_bytes;
+    const rec_chunk_header_t *ch = (const rec_chunk_header_t *)base;
+    const uint32_t *offset = r->offset;
+    int i;
+
+    view->rows = ch->rows;
+    view->first_row = ch->first_row;
+    view->time = (const double *)(base + offset[FLIGHT_REC_COL_TIME]);
+    for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+        view->input[i] = (const double *)(base + offset[FLIGHT_REC_COL_INPUT + i]);
+    }
+    view->state = base + offset[FLIGHT_REC_COL_STATE];
+    view->confidence = (const double *)(base + offset[FLIGHT_REC_COL_CONFIDENCE]);
+    for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+        view->trend[i] = (const double *)(base + offset[FLIGHT_REC_COL_TREND + i]);
+    }
+}
+
+uint64_t flight_rec_seek_time(const flight_rec_reader_t *r, double t)
+{
+    flight_rec_chunk_t view;
+    uint64_t lo = 0, hi = r->num_chunks;
+    size_t a, b;
+
+    /* First chunk whose last time reaches t */
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (chunk_header(r, mid)->t_last < t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo == r->num_chunks) {
+        return r->num_rows;
+    }
+
+    /* First row in that chunk with time >= t */
+    flight_rec_chunk(r, lo, &view);
+    a = 0;
+    b = view.rows;
+    while (a < b) {
+        size_t mid = a + (b - a) / 2;
+        if (view.time[mid] < t) {
+            a = mid + 1;
+        } else {
+            b = mid;
+        }
+    }
+    return view.first_row + a;
+}
+
+void flight_rec_close_reader(flight_rec_reader_t *r)
+{
+    if (r->map != NULL) {
+        munmap((void *)r->map, r->map_len);
+        r->map = NULL;
+    }
+}
+
+#endif /* !_WIN32 */
@@ -0,0 +1,146 @@
+/* flight_rec.h - Columnar recording of DFA inputs and outputs
+ *
+ * File layout (little-endian):
+ *
+ *    header   FLIGHT_REC_HEADER_SIZE bytes: magic, version, chunk geometry
+ *             and the column table (name, type, offset within a chunk)
+ *    chunk 0  FLIGHT_REC_CHUNK_HEADER_SIZE bytes: row count, first row,
+ *             first and last time, then one typed block per column
+ *    chunk 1  ...
+ *
+ * Every chunk has the same size in bytes (room for chunk_rows rows, rounded
+ * up to whole pages), so chunk k lives at header_size + k * chunk_bytes and
+ * every column block sits at a fixed offset inside it. The chunk headers
+ * form the time index: a time lookup binary-searches them and then the time
+ * column of a single chunk, touching only the pages it reads.
+ *
+ * Rows are appended in non-decreasing time order. The writer keeps one chunk
+ * in memory and writes it out when it is full, on flush and on close; only
+ * the last, partially filled chunk is ever rewritten. The writer uses stdio
+ * and builds everywhere; the reader maps the file and is POSIX only.
+ */
+
+#ifndef FLIGHT_REC_H
+#define FLIGHT_REC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "trend_dfa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHT_REC_MAGIC              "A429REC"
+#define FLIGHT_REC_VERSION            1
+#define FLIGHT_REC_HEADER_SIZE        4096
+#define FLIGHT_REC_CHUNK_HEADER_SIZE  64
+#define FLIGHT_REC_CHUNK_MAGIC        0x4B4E4843u   /* "CHNK" */
+#define FLIGHT_REC_DEFAULT_CHUNK_ROWS 4096
+#define FLIGHT_REC_COLUMN_NAME_LEN    24
+
+/* Column types */
+#define FLIGHT_REC_F64  1
+#define FLIGHT_REC_U8   2
+
+/* Columns, in file order */
+enum {
+    FLIGHT_REC_COL_TIME = 0,
+    FLIGHT_REC_COL_INPUT,                                           /* 5 inputs, TREND_DFA_CH_* order */
+    FLIGHT_REC_COL_STATE = FLIGHT_REC_COL_INPUT + TREND_DFA_NUM_CHANNELS,
+    FLIGHT_REC_COL_CONFIDENCE,
+    FLIGHT_REC_COL_TREND,                                           /* 6 trends */
+    FLIGHT_REC_NUM_COLUMNS = FLIGHT_REC_COL_TREND + TREND_DFA_NUM_TRENDS
+};
+
+/* Read-only view of one chunk; pointers go straight into the mapping */
+typedef struct {
+    size_t         rows;
+    uint64_t       first_row;
+    const double  *time;
+    const double  *input[TREND_DFA_NUM_CHANNELS];
+    const uint8_t *state;
+    const double  *confidence;
+    const double  *trend[TREND_DFA_NUM_TRENDS];
+} flight_rec_chunk_t;
+
+typedef struct {
+    FILE     *fp;
+    uint32_t  chunk_rows;
+    uint64_t  chunk_bytes;
+    uint32_t  offset[FLIGHT_REC_NUM_COLUMNS];   /* column blocks within a chunk */
+    uint64_t  chunk_index;      /* chunk currently held in buf */
+    uint32_t  rows;             /* rows in buf */
+    uint8_t  *buf;              /* one chunk, laid out as on disk */
+    double    last_time;
+    int       failed;           /* a chunk write failed; appends are refused */
+} flight_rec_writer_t;
+
+typedef struct {
+    const uint8_t *map;
+    size_t         map_len;
+    uint32_t       chunk_rows;
+    uint64_t       chunk_bytes;
+    uint32_t       offset[FLIGHT_REC_NUM_COLUMNS];
+    uint64_t       num_chunks;
+    uint64_t       num_rows;
+} flight_rec_reader_t;
+
+/* Function: flight_rec_create ================================================
+ * Abstract:
+ *    Create (or truncate) path for writing with chunk_rows rows per chunk
+ *    (0 selects FLIGHT_REC_DEFAULT_CHUNK_ROWS). Returns 0 or -1.
+ */
+int flight_rec_create(flight_rec_writer_t *w, const char *path, uint32_t chunk_rows);
+
+/* Function: flight_rec_open_append ===========================================
+ * Abstract:
+ *    Reopen an existing recording and continue after its last row, filling
+ *    the last chunk if it is partial. Returns 0, or -1 if the file is missing
+ *    or not a recording.
+ */
+int flight_rec_open_append(flight_rec_writer_t *w, const char *path);
+
+/* Function: flight_rec_append ================================================
+ * Abstract:
+ *    Append one row: time, the five inputs (TREND_DFA_CH_* order) and the
+ *    DFA output. Returns 0, or -1 on a write error or if time goes backwards.
+ *    After a write error every later append and flush also returns -1.
+ */
+int flight_rec_append(flight_rec_writer_t *w, double time, const double *input,
+                      const trend_dfa_output_t *out);
+
+/* Write the partial chunk so readers see every appended row. Returns 0 or -1. */
+int flight_rec_flush(flight_rec_writer_t *w);
+
+/* Flush and close. Returns 0 or -1. */
+int flight_rec_close(flight_rec_writer_t *w);
+
+/* Function: flight_rec_open ==================================================
+ * Abstract:
+ *    Map a recording read-only. Returns 0, or -1 if it cannot be opened or
+ *    is not a recording.
+ */
+int flight_rec_open(flight_rec_reader_t *r, const char *path);
+
+/* Function: flight_rec_chunk =================================================
+ * Abstract:
+ *    Fill view with chunk k (0 <= k < num_chunks). No data is copied.
+ */
+void flight_rec_chunk(const flight_rec_reader_t *r, uint64_t k, flight_rec_chunk_t *view);
+
+/* Function: flight_rec_seek_time =============================================
+ * Abstract:
+ *    Index of the first row with time >= t (num_rows if there is none).
+ */
+uint64_t flight_rec_seek_time(const flight_rec_reader_t *r, double t);
+
+void flight_rec_close_reader(flight_rec_reader_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLIGHT_REC_H */
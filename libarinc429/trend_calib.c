@@ -0,0 +1,364 @@
+/* trend_calib.c - Parallel threshold and weight calibration sweep for the trend DFA */
+
+#include "trend_calib.h"
+#include "trend_dfa_decide.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TREND_CALIB_MAX_THREADS 256
+
+/* Configurations advanced together, row by row */
+#define CALIB_BATCH 32
+
+/* A worker takes up to CALIB_GROUP batches at once and runs all of them over
+ * one block of CALIB_ROW_BLOCK rows (96 bytes each, 192 KiB) before the
+ * next, so the feature array is streamed from memory once per group and the
+ * other batches read the block from L2 */
+#define CALIB_GROUP     8
+#define CALIB_ROW_BLOCK 2048
+
+/* Run fn on n argument blocks, block 0 on the calling thread. The jobs here
+ * pull work from a shared counter, so if a thread cannot be created the
+ * remaining ones simply take over its share. */
+static void run_threads(int n, void *(*fn)(void *), void *args, size_t stride)
+{
+    pthread_t tid[TREND_CALIB_MAX_THREADS];
+    char *base = (char *)args;
+    int i, started;
+
+    for (started = 1; started < n; started++) {
+        if (pthread_create(&tid[started], NULL, fn, base + (size_t)started * stride) != 0) {
+            break;
+        }
+    }
+    fn(base);
+    for (i = 1; i < started; i++) {
+        pthread_join(tid[i], NULL);
+    }
+}
+
+static int clamp_threads(int n)
+{
+    return n < 1 ? 1 : n > TREND_CALIB_MAX_THREADS ? TREND_CALIB_MAX_THREADS : n;
+}
+
+/* ---- Features ----------------------------------------------------------- */
+
+typedef struct {
+    trend_calib_row_t   *row;
+    const double *const *input;
+    size_t               num_rows;
+    const size_t        *track_start;
+    size_t               num_tracks;
+    int                  window;
+    atomic_size_t       *next_track;
+} features_job_t;
+
+/* The same windows as trend_dfa_step, pushed row by row; the statistics are
+ * taken exactly where internal_flight_trend_analysis_dfa takes them */
+static void track_features(const features_job_t *job, size_t begin, size_t end)
+{
+    trend_window_t window[TREND_DFA_NUM_CHANNELS];
+    size_t r;
+    int ch, k, filled = 0;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        trend_window_init(&window[ch], job->window, trend_dfa_anomaly_threshold[ch]);
+    }
+    for (r = begin; r < end; r++) {
+        trend_calib_row_t *row = &job->row[r];
+        double sample[TREND_DFA_NUM_CHANNELS];
+
+        memset(row, 0, sizeof(*row));
+        row->first = r == begin;
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            sample[ch] = job->input[ch][r];
+        }
+        trend_window_push_channels(window, sample);
+        if (filled < job->window) {
+            filled++;
+        }
+        if (filled < job->window) {
+            continue;
+        }
+
+        row->evaluated = 1;
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            double variance = trend_window_variance(&window[ch]);
+
+            row->slope[ch] = trend_window_slope(&window[ch]);
+            if (ch == 0 || variance > row->max_variance) row->max_variance = variance;
+
+            /* |y| > threshold for some sample <=> max |y| > threshold; NaN
+             * samples never exceed a threshold and are skipped here too */
+            for (k = 0; k < job->window; k++) {
+                double a = fabs(window[ch].values[k]);
+                if (a > row->peak[ch]) row->peak[ch] = a;
+            }
+        }
+    }
+}
+
+static void *features_worker(void *arg)
+{
+    const features_job_t *job = *(features_job_t *const *)arg;
+    size_t t;
+
+    while ((t = atomic_fetch_add_explicit(job->next_track, 1, memory_order_relaxed)) <
+           job->num_tracks) {
+        if (job->track_start == NULL) {
+            track_features(job, 0, job->num_rows);
+        } else {
+            track_features(job, job->track_start[t], job->track_start[t + 1]);
+        }
+    }
+    return NULL;
+}
+
+int trend_calib_features(trend_calib_features_t *ft, const double *const *input, size_t num_rows,
+                         const size_t *track_start, size_t num_tracks, int window,
+                         int num_threads)
+{
+    const features_job_t *args[TREND_CALIB_MAX_THREADS];
+    atomic_size_t next_track;
+    features_job_t job;
+    int i, n;
+
+    ft->num_rows = num_rows;
+    ft->window = window;
+    ft->row = NULL;
+    if (window < TREND_DFA_MIN_WINDOW || window > TREND_DFA_MAX_WINDOW) {
+        return -1;
+    }
+    ft->row = (trend_calib_row_t *)malloc(num_rows * sizeof(trend_calib_row_t) + 1);
+    if (ft->row == NULL) {
+        return -1;
+    }
+
+    if (track_start == NULL) {
+        num_tracks = 1;
+    }
+    n = clamp_threads(num_threads);
+    if ((size_t)n > num_tracks) {
+        n = num_tracks > 0 ? (int)num_tracks : 1;
+    }
+    atomic_init(&next_track, 0);
+    job.row = ft->row;
+    job.input = input;
+    job.num_rows = num_rows;
+    job.track_start = track_start;
+    job.num_tracks = num_tracks;
+    job.window = window;
+    job.next_track = &next_track;
+    for (i = 0; i < n; i++) {
+        args[i] = &job;
+    }
+    run_threads(n, features_worker, args, sizeof(args[0]));
+    return 0;
+}
+
+void trend_calib_free(trend_calib_features_t *ft)
+{
+    free(ft->row);
+    ft->row = NULL;
+    ft->num_rows = 0;
+}
+
+/* ---- Sweep -------------------------------------------------------------- */
+
+typedef struct {
+    const trend_calib_features_t *ft;
+    const trend_dfa_params_t     *cfg;
+    trend_calib_result_t         *result;
+    size_t                        num_configs;
+    size_t                        group;        /* batches per group */
+    atomic_size_t                *next_group;
+} sweep_job_t;
+
+/* Thresholds and weights of a batch, one lane per configuration, so a row
+ * is classified for the whole batch in one vectorised pass */
+typedef struct {
+    double stable[CALIB_BATCH];
+    double increase[CALIB_BATCH];
+    double decrease[CALIB_BATCH];
+    double oscillation[CALIB_BATCH];
+    double anomaly[TREND_DFA_NUM_CHANNELS][CALIB_BATCH];
+    double weight[TREND_DFA_NUM_CHANNELS][CALIB_BATCH];
+} sweep_batch_t;
+
+/* Unused lanes repeat cfg[0] */
+static void load_batch(sweep_batch_t *b, const trend_dfa_params_t *cfg, size_t count)
+{
+    size_t i;
+    int ch;
+
+    for (i = 0; i < CALIB_BATCH; i++) {
+        const trend_dfa_params_t *c = &cfg[i < count ? i : 0];
+
+        b->stable[i] = c->stable;
+        b->increase[i] = c->increase;
+        b->decrease[i] = c->decrease;
+        b->oscillation[i] = c->oscillation;
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            b->anomaly[ch][i] = c->anomaly[ch];
+            b->weight[ch][i] = c->weight[ch];
+        }
+    }
+}
+
+/* Feature class of row f for every lane: trend_dfa_feature written over
+ * lanes. The class is kept as a double to stay in the width of the lanes. */
+static void classify_row(const sweep_batch_t *b, const trend_calib_row_t *f,
+                         double *restrict feature)
+{
+    int i, ch;
+
+    for (i = 0; i < CALIB_BATCH; i++) {
+        double w = b->weight[TREND_DFA_CH_VELOCITY][i] * f->slope[TREND_DFA_CH_VELOCITY] +
+                   b->weight[TREND_DFA_CH_BAROALT][i] * f->slope[TREND_DFA_CH_BAROALT] +
+                   b->weight[TREND_DFA_CH_LAT][i] * f->slope[TREND_DFA_CH_LAT] +
+                   b->weight[TREND_DFA_CH_LON][i] * f->slope[TREND_DFA_CH_LON] +
+                   b->weight[TREND_DFA_CH_VERTRATE][i] * f->slope[TREND_DFA_CH_VERTRATE];
+        double cls = TREND_DFA_FEAT_AMBIGUOUS;
+
+        cls = fabs(w) <= b->stable[i] ? TREND_DFA_FEAT_FLAT : cls;
+        cls = w < b->decrease[i] ? TREND_DFA_FEAT_DOWN : cls;
+        cls = w > b->increase[i] ? TREND_DFA_FEAT_UP : cls;
+        cls = f->max_variance > b->oscillation[i] ? TREND_DFA_FEAT_HIGH_VARIANCE : cls;
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            cls = f->peak[ch] > b->anomaly[ch][i] ? TREND_DFA_FEAT_ANOMALY : cls;
+        }
+        feature[i] = cls;
+    }
+}
+
+/* Automata of a batch */
+typedef struct {
+    int32_t prev_state[CALIB_BATCH];
+    int32_t state_counter[CALIB_BATCH];
+    int32_t reported[CALIB_BATCH];
+} sweep_state_t;
+
+/* Advance the first count automata of a batch over num rows */
+static void sweep_rows(const trend_calib_row_t *row, size_t num, const sweep_batch_t *b,
+                       sweep_state_t *s, trend_calib_result_t *res, size_t count)
+{
+    double feature[CALIB_BATCH];
+    size_t r, i;
+
+    for (r = 0; r < num; r++) {
+        const trend_calib_row_t *f = &row[r];
+
+        if (f->first) {
+            for (i = 0; i < count; i++) {
+                s->prev_state[i] = STATE_STABLE;
+                s->state_counter[i] = 0;
+            }
+        }
+        if (!f->evaluated) {
+            /* Warm-up rows are reported as STABLE and leave the automata alone */
+            for (i = 0; i < count; i++) {
+                res[i].state[0]++;
+                if (!f->first && s->reported[i] != STATE_STABLE) {
+                    res[i].transition[s->reported[i] - STATE_STABLE][0]++;
+                }
+                s->reported[i] = STATE_STABLE;
+            }
+            continue;
+        }
+        classify_row(b, f, feature);
+
+        /* The automata are independent, so their table lookups overlap */
+        for (i = 0; i < count; i++) {
+            int state = trend_dfa_transition_step((int)feature[i], &s->prev_state[i],
+                                                  &s->state_counter[i]);
+
+            res[i].state[state - STATE_STABLE]++;
+            if (!f->first && state != s->reported[i]) {
+                res[i].transition[s->reported[i] - STATE_STABLE][state - STATE_STABLE]++;
+            }
+            s->reported[i] = state;
+        }
+    }
+}
+
+static void *sweep_worker(void *arg)
+{
+    const sweep_job_t *job = *(const sweep_job_t *const *)arg;
+    sweep_batch_t b[CALIB_GROUP];
+    sweep_state_t state[CALIB_GROUP];
+    size_t count[CALIB_GROUP];
+    size_t group, first, end, r, rows, i, g, num;
+    int from, to;
+
+    for (;;) {
+        group = atomic_fetch_add_explicit(job->next_group, 1, memory_order_relaxed);
+        first = group * job->group * CALIB_BATCH;
+        if (first >= job->num_configs) {
+            break;
+        }
+        end = first;
+        for (num = 0; num < job->group && end < job->num_configs; num++) {
+            count[num] = job->num_configs - end < CALIB_BATCH ? job->num_configs - end : CALIB_BATCH;
+            load_batch(&b[num], &job->cfg[end], count[num]);
+            memset(&state[num], 0, sizeof(state[num]));
+            end += count[num];
+        }
+        memset(&job->result[first], 0, (end - first) * sizeof(trend_calib_result_t));
+
+        for (r = 0; r < job->ft->num_rows; r += rows) {
+            rows = job->ft->num_rows - r < CALIB_ROW_BLOCK ? job->ft->num_rows - r : CALIB_ROW_BLOCK;
+            for (g = 0; g < num; g++) {
+                sweep_rows(&job->ft->row[r], rows, &b[g], &state[g],
+                           &job->result[first + g * CALIB_BATCH], count[g]);
+            }
+        }
+        for (i = first; i < end; i++) {
+            trend_calib_result_t *res = &job->result[i];
+            for (from = 0; from < TREND_CALIB_NUM_STATES; from++) {
+                for (to = 0; to < TREND_CALIB_NUM_STATES; to++) {
+                    res->transitions += res->transition[from][to];
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+void trend_calib_sweep(const trend_calib_features_t *ft, const trend_dfa_params_t *cfg,
+                       size_t num_configs, trend_calib_result_t *result, int num_threads)
+{
+    const sweep_job_t *args[TREND_CALIB_MAX_THREADS];
+    atomic_size_t next_group;
+    sweep_job_t job;
+    size_t batches = (num_configs + CALIB_BATCH - 1) / CALIB_BATCH;
+    size_t group, groups;
+    int i, n;
+
+    n = clamp_threads(num_threads);
+    if ((size_t)n > batches) {
+        n = batches > 0 ? (int)batches : 1;
+    }
+    /* Large groups save bandwidth, but every thread needs one */
+    group = (batches + (size_t)n - 1) / (size_t)n;
+    group = group < 1 ? 1 : group > CALIB_GROUP ? CALIB_GROUP : group;
+    groups = (batches + group - 1) / group;
+    if ((size_t)n > groups) {
+        n = groups > 0 ? (int)groups : 1;
+    }
+    atomic_init(&next_group, 0);
+    job.ft = ft;
+    job.cfg = cfg;
+    job.result = result;
+    job.num_configs = num_configs;
+    job.group = group;
+    job.next_group = &next_group;
+    for (i = 0; i < n; i++) {
+        args[i] = &job;
+    }
+    run_threads(n, sweep_worker, args, sizeof(args[0]));
+}
@@ -0,0 +1,91 @@
+/* trend_calib.h - Parallel threshold and weight calibration sweep for the trend DFA
+ *
+ * The window statistics the DFA decides on (five slopes, the largest
+ * variance and, per channel, the largest |y| in the window) do not depend on
+ * any threshold or weight, so trend_calib_features computes them once per
+ * row of a recorded dataset. trend_calib_sweep then runs every candidate
+ * configuration over the shared features: the weighted trend, the anomaly
+ * test, the feature class and the transition tables of trend_dfa_table.h
+ * are all that is left per row and configuration.
+ *
+ * Configurations are handed out in groups of up to eight batches of 32 to
+ * num_threads workers. A worker walks the rows in cache-sized blocks, each
+ * block once per batch of its group: each row is classified for the whole
+ * batch in one vectorised pass, then the 32 independent automata take
+ * their table steps, so the feature array is streamed from memory once per
+ * group and the lookups of different automata overlap.
+ * Configurations are trend_dfa_params_t; their window field is ignored, the
+ * window size being fixed when the features are computed. With the same
+ * parameters the sweep reproduces trend_dfa_step exactly.
+ */
+
+#ifndef TREND_CALIB_H
+#define TREND_CALIB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TREND_CALIB_NUM_STATES  TREND_DFA_NUM_STATES
+
+/* Reported states of one configuration over the whole dataset. Index
+ * state - STATE_STABLE; warm-up rows count as STABLE, as trend_dfa reports
+ * them. transition[from][to] counts consecutive rows of a track whose
+ * reported state changed. */
+typedef struct {
+    uint64_t state[TREND_CALIB_NUM_STATES];
+    uint64_t transition[TREND_CALIB_NUM_STATES][TREND_CALIB_NUM_STATES];
+    uint64_t transitions;                       /* sum of transition[][] */
+} trend_calib_result_t;
+
+/* Window statistics of one row */
+typedef struct {
+    double  slope[TREND_DFA_NUM_CHANNELS];
+    double  max_variance;
+    double  peak[TREND_DFA_NUM_CHANNELS];       /* max |y| in the window */
+    int32_t first;                              /* first row of a track */
+    int32_t evaluated;                          /* window full, DFA decides */
+} trend_calib_row_t;
+
+typedef struct {
+    size_t             num_rows;
+    int                window;
+    trend_calib_row_t *row;
+} trend_calib_features_t;
+
+/* Function: trend_calib_features =============================================
+ * Abstract:
+ *    Compute the window statistics of every row for windows of window
+ *    samples. input[ch] holds the TREND_DFA_CH_* columns of num_rows rows;
+ *    tracks are the row ranges
+ *    [track_start[t], track_start[t + 1]) and each starts with an empty
+ *    window, like a fresh trend_dfa_t. Pass track_start = NULL for one
+ *    track. Tracks are spread over num_threads threads. Returns 0, or -1 if
+ *    memory runs out or the window size is out of range. ft is always safe
+ *    to pass to trend_calib_free.
+ */
+int trend_calib_features(trend_calib_features_t *ft, const double *const *input, size_t num_rows,
+                         const size_t *track_start, size_t num_tracks, int window,
+                         int num_threads);
+
+/* Function: trend_calib_sweep ================================================
+ * Abstract:
+ *    Evaluate num_configs configurations over ft on num_threads threads
+ *    (1 runs on the calling thread) and write one result per
+ *    configuration, result[i] for cfg[i].
+ */
+void trend_calib_sweep(const trend_calib_features_t *ft, const trend_dfa_params_t *cfg,
+                       size_t num_configs, trend_calib_result_t *result, int num_threads);
+
+void trend_calib_free(trend_calib_features_t *ft);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_CALIB_H */
@@ -0,0 +1,558 @@
+/* trend_ckpt.c - Checkpoints of the trend DFA state for resuming replays */
+
+#include "trend_ckpt.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* On-disk structures; all fields naturally aligned, no padding */
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint32_t num_tracks;
+    uint32_t window;
+    uint64_t bytes;                     /* whole snapshot, header included */
+    double   time;
+    uint64_t row;
+    uint64_t source_pos;
+    int64_t  source_line;
+    uint32_t checksum;                  /* FNV-1a of everything after the header */
+    uint32_t reserved;
+} ckpt_header_t;
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t kind;
+    uint32_t num_tracks;
+    uint32_t window;
+    uint64_t snap_bytes;
+    uint8_t  reserved[32];
+} ckpt_file_header_t;
+
+/* Thresholds, anomaly limits and weights as doubles */
+#define PARAMS_DOUBLES (4 + 2 * TREND_DFA_NUM_CHANNELS)
+
+/* Per channel of a single-track snapshot: sums, mean, m2 and the anomaly
+ * threshold, then head, since_resync, anomaly_count and nonfinite_left */
+#define WINDOW_DOUBLES 7
+#define WINDOW_INTS    4
+
+/* Control words of a multi-track snapshot, padded to 8 bytes */
+#define MULTI_CTRL_INTS ((TREND_DFA_MULTI_CTRL_LEN + 1) & ~1)
+
+static uint32_t fnv1a(const uint8_t *p, size_t n)
+{
+    uint32_t h = 2166136261u;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        h = (h ^ p[i]) * 16777619u;
+    }
+    return h;
+}
+
+static void put(uint8_t **p, const void *src, size_t n)
+{
+    memcpy(*p, src, n);
+    *p += n;
+}
+
+static void get(const uint8_t **p, void *dst, size_t n)
+{
+    memcpy(dst, *p, n);
+    *p += n;
+}
+
+static void put_params(uint8_t **p, const trend_dfa_params_t *params)
+{
+    double v[PARAMS_DOUBLES];
+
+    v[0] = params->stable;
+    v[1] = params->increase;
+    v[2] = params->decrease;
+    v[3] = params->oscillation;
+    memcpy(v + 4, params->anomaly, sizeof(params->anomaly));
+    memcpy(v + 4 + TREND_DFA_NUM_CHANNELS, params->weight, sizeof(params->weight));
+    put(p, v, sizeof(v));
+}
+
+static void get_params(const uint8_t **p, int window, trend_dfa_params_t *params)
+{
+    double v[PARAMS_DOUBLES];
+
+    get(p, v, sizeof(v));
+    params->window = window;
+    params->stable = v[0];
+    params->increase = v[1];
+    params->decrease = v[2];
+    params->oscillation = v[3];
+    memcpy(params->anomaly, v + 4, sizeof(params->anomaly));
+    memcpy(params->weight, v + 4 + TREND_DFA_NUM_CHANNELS, sizeof(params->weight));
+}
+
+static size_t single_bytes(int window)
+{
+    return sizeof(ckpt_header_t) + PARAMS_DOUBLES * sizeof(double) + 4 * sizeof(int32_t) +
+           TREND_DFA_NUM_CHANNELS * (WINDOW_DOUBLES * sizeof(double) + WINDOW_INTS * sizeof(int32_t) +
+                                     (size_t)window * sizeof(double));
+}
+
+static size_t multi_bytes(int num_tracks, int window)
+{
+    return sizeof(ckpt_header_t) + PARAMS_DOUBLES * sizeof(double) +
+           MULTI_CTRL_INTS * sizeof(int32_t) +
+           (TREND_DFA_MULTI_VALUES_LEN(num_tracks, window) + TREND_DFA_MULTI_STATS_LEN(num_tracks)) *
+               sizeof(double) +
+           (TREND_DFA_MULTI_COUNTS_LEN(num_tracks) + 2 * (size_t)num_tracks) * sizeof(int32_t);
+}
+
+size_t trend_ckpt_size(const trend_dfa_t *dfa)
+{
+    return single_bytes(dfa->params.window);
+}
+
+size_t trend_ckpt_size_multi(const trend_dfa_multi_t *m)
+{
+    return multi_bytes(m->num_tracks, m->params.window);
+}
+
+/* Header for a payload that has been written behind it */
+static void finish_header(uint8_t *buf, size_t bytes, int kind, int num_tracks, int window,
+                          const trend_ckpt_info_t *at)
+{
+    ckpt_header_t h;
+
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, TREND_CKPT_MAGIC, sizeof(TREND_CKPT_MAGIC));
+    h.version = TREND_CKPT_VERSION;
+    h.kind = (uint32_t)kind;
+    h.num_tracks = (uint32_t)num_tracks;
+    h.window = (uint32_t)window;
+    h.bytes = bytes;
+    h.time = at->time;
+    h.row = at->row;
+    h.source_pos = at->source_pos;
+    h.source_line = at->source_line;
+    h.checksum = fnv1a(buf + sizeof(h), bytes - sizeof(h));
+    memcpy(buf, &h, sizeof(h));
+}
+
+size_t trend_ckpt_save(const trend_dfa_t *dfa, const trend_ckpt_info_t *at, void *buf, size_t len)
+{
+    const size_t bytes = trend_ckpt_size(dfa);
+    uint8_t *p = (uint8_t *)buf + sizeof(ckpt_header_t);
+    int32_t iv[4];
+    int ch;
+
+    if (len < bytes) {
+        return 0;
+    }
+
+    put_params(&p, &dfa->params);
+    iv[0] = dfa->buffer_idx;
+    iv[1] = dfa->prev_state;
+    iv[2] = dfa->state_counter;
+    iv[3] = 0;
+    put(&p, iv, sizeof(iv));
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        const trend_window_t *w = &dfa->window[ch];
+        double dv[WINDOW_DOUBLES];
+        int32_t wv[WINDOW_INTS];
+
+        dv[0] = w->sum_y;
+        dv[1] = w->sum_y_c;
+        dv[2] = w->sum_xy;
+        dv[3] = w->sum_xy_c;
+        dv[4] = w->mean;
+        dv[5] = w->m2;
+        dv[6] = w->anomaly_threshold;
+        wv[0] = w->head;
+        wv[1] = w->since_resync;
+        wv[2] = w->anomaly_count;
+        wv[3] = w->nonfinite_left;
+        put(&p, dv, sizeof(dv));
+        put(&p, wv, sizeof(wv));
+        put(&p, w->values, (size_t)w->size * sizeof(double));
+    }
+
+    finish_header((uint8_t *)buf, bytes, TREND_CKPT_SINGLE, 1, dfa->params.window, at);
+    return bytes;
+}
+
+size_t trend_ckpt_save_multi(const trend_dfa_multi_t *m, const trend_ckpt_info_t *at,
+                             void *buf, size_t len)
+{
+    const size_t bytes = trend_ckpt_size_multi(m);
+    const size_t n = (size_t)m->num_tracks;
+    uint8_t *p = (uint8_t *)buf + sizeof(ckpt_header_t);
+    int32_t ctrl[MULTI_CTRL_INTS] = { 0 };
+
+    if (len < bytes) {
+        return 0;
+    }
+
+    put_params(&p, &m->params);
+    memcpy(ctrl, m->control, TREND_DFA_MULTI_CTRL_LEN * sizeof(int32_t));
+    put(&p, ctrl, sizeof(ctrl));
+    put(&p, m->values, TREND_DFA_MULTI_VALUES_LEN(n, m->params.window) * sizeof(double));
+    put(&p, m->stats, TREND_DFA_MULTI_STATS_LEN(n) * sizeof(double));
+    put(&p, m->anomaly_count, TREND_DFA_MULTI_COUNTS_LEN(n) * sizeof(int32_t));
+    put(&p, m->prev_state, n * sizeof(int32_t));
+    put(&p, m->state_counter, n * sizeof(int32_t));
+
+    finish_header((uint8_t *)buf, bytes, TREND_CKPT_MULTI, m->num_tracks, m->params.window, at);
+    return bytes;
+}
+
+int trend_ckpt_info(const void *snap, size_t len, trend_ckpt_info_t *info)
+{
+    const uint8_t *p = (const uint8_t *)snap + sizeof(ckpt_header_t);
+    ckpt_header_t h;
+    size_t expect;
+
+    if (len < sizeof(h)) {
+        return -1;
+    }
+    memcpy(&h, snap, sizeof(h));
+    if (memcmp(h.magic, TREND_CKPT_MAGIC, sizeof(TREND_CKPT_MAGIC)) != 0 ||
+        h.version != TREND_CKPT_VERSION || h.window < TREND_DFA_MIN_WINDOW ||
+        h.window > TREND_DFA_MAX_WINDOW || h.num_tracks == 0 || h.num_tracks > INT32_MAX) {
+        return -1;
+    }
+    if (h.kind == TREND_CKPT_SINGLE && h.num_tracks == 1) {
+        expect = single_bytes((int)h.window);
+    } else if (h.kind == TREND_CKPT_MULTI) {
+        expect = multi_bytes((int)h.num_tracks, (int)h.window);
+    } else {
+        return -1;
+    }
+    if (h.bytes != expect || len < expect ||
+        fnv1a(p, expect - sizeof(h)) != h.checksum) {
+        return -1;
+    }
+
+    info->kind = (int)h.kind;
+    info->num_tracks = (int)h.num_tracks;
+    info->time = h.time;
+    info->row = h.row;
+    info->source_pos = h.source_pos;
+    info->source_line = h.source_line;
+    get_params(&p, (int)h.window, &info->params);
+    return trend_dfa_check_params(&info->params);
+}
+
+static int valid_state(int32_t state, int32_t counter)
+{
+    return state >= STATE_STABLE && state <= STATE_ANOMALY && counter >= 0;
+}
+
+int trend_ckpt_load(trend_dfa_t *dfa, const void *snap, size_t len, trend_ckpt_info_t *info)
+{
+    const uint8_t *start = (const uint8_t *)snap + sizeof(ckpt_header_t) + PARAMS_DOUBLES * sizeof(double);
+    const uint8_t *p;
+    trend_ckpt_info_t in;
+    int32_t iv[4], wv[WINDOW_INTS];
+    int ch, window;
+
+    if (trend_ckpt_info(snap, len, &in) != 0 || in.kind != TREND_CKPT_SINGLE) {
+        return -1;
+    }
+    window = in.params.window;
+
+    /* Check the integer fields first so a bad snapshot leaves dfa as it was */
+    p = start;
+    get(&p, iv, sizeof(iv));
+    if (iv[0] < 0 || iv[0] > window || !valid_state(iv[1], iv[2])) {
+        return -1;
+    }
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        p += WINDOW_DOUBLES * sizeof(double);
+        get(&p, wv, sizeof(wv));
+        p += (size_t)window * sizeof(double);
+        if (wv[0] < 0 || wv[0] >= window || wv[1] < 0 || wv[2] < 0 || wv[2] > window ||
+            wv[3] < 0 || wv[3] > window) {
+            return -1;
+        }
+    }
+
+    p = start + sizeof(iv);
+    dfa->params = in.params;
+    dfa->buffer_idx = iv[0];
+    dfa->prev_state = iv[1];
+    dfa->state_counter = iv[2];
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        trend_window_t *w = &dfa->window[ch];
+        double dv[WINDOW_DOUBLES];
+
+        get(&p, dv, sizeof(dv));
+        get(&p, wv, sizeof(wv));
+        w->size = window;
+        w->sum_y = dv[0];
+        w->sum_y_c = dv[1];
+        w->sum_xy = dv[2];
+        w->sum_xy_c = dv[3];
+        w->mean = dv[4];
+        w->m2 = dv[5];
+        w->anomaly_threshold = dv[6];
+        w->head = wv[0];
+        w->since_resync = wv[1];
+        w->anomaly_count = wv[2];
+        w->nonfinite_left = wv[3];
+        /* Only the window's samples; the rest of values[] is never read */
+        get(&p, w->values, (size_t)window * sizeof(double));
+    }
+
+    if (info != NULL) {
+        *info = in;
+    }
+    return 0;
+}
+
+int trend_ckpt_load_multi(trend_dfa_multi_t *m, const void *snap, size_t len,
+                          trend_ckpt_info_t *info)
+{
+    const uint8_t *p = (const uint8_t *)snap + sizeof(ckpt_header_t) + PARAMS_DOUBLES * sizeof(double);
+    const uint8_t *arrays;
+    trend_ckpt_info_t in;
+    int32_t ctrl[MULTI_CTRL_INTS];
+    int32_t state, counter;
+    size_t n, t, counts_off, state_off;
+    int window;
+
+    if (trend_ckpt_info(snap, len, &in) != 0 || in.kind != TREND_CKPT_MULTI ||
+        in.num_tracks != m->num_tracks || in.params.window != m->params.window) {
+        return -1;
+    }
+    n = (size_t)in.num_tracks;
+    window = in.params.window;
+
+    get(&p, ctrl, sizeof(ctrl));
+    if (ctrl[TREND_DFA_MULTI_CTRL_HEAD] < 0 || ctrl[TREND_DFA_MULTI_CTRL_HEAD] >= window ||
+        ctrl[TREND_DFA_MULTI_CTRL_SINCE_RESYNC] < 0 || ctrl[TREND_DFA_MULTI_CTRL_BUFFER_IDX] < 0 ||
+        ctrl[TREND_DFA_MULTI_CTRL_BUFFER_IDX] > window ||
+        ctrl[TREND_DFA_MULTI_CTRL_NONFINITE] < 0 || ctrl[TREND_DFA_MULTI_CTRL_NONFINITE] > window) {
+        return -1;
+    }
+
+    /* Check the per-track words in place before anything is overwritten */
+    arrays = p;
+    counts_off = (TREND_DFA_MULTI_VALUES_LEN(n, window) + TREND_DFA_MULTI_STATS_LEN(n)) * sizeof(double);
+    for (t = 0; t < TREND_DFA_MULTI_COUNTS_LEN(n); t++) {
+        memcpy(&counter, arrays + counts_off + t * sizeof(int32_t), sizeof(counter));
+        if (counter < 0 || counter > window) {
+            return -1;
+        }
+    }
+    state_off = counts_off + TREND_DFA_MULTI_COUNTS_LEN(n) * sizeof(int32_t);
+    for (t = 0; t < n; t++) {
+        memcpy(&state, arrays + state_off + t * sizeof(int32_t), sizeof(state));
+        memcpy(&counter, arrays + state_off + (n + t) * sizeof(int32_t), sizeof(counter));
+        if (!valid_state(state, counter)) {
+            return -1;
+        }
+    }
+
+    m->params = in.params;
+    memcpy(m->control, ctrl, TREND_DFA_MULTI_CTRL_LEN * sizeof(int32_t));
+    get(&p, m->values, TREND_DFA_MULTI_VALUES_LEN(n, window) * sizeof(double));
+    get(&p, m->stats, TREND_DFA_MULTI_STATS_LEN(n) * sizeof(double));
+    get(&p, m->anomaly_count, TREND_DFA_MULTI_COUNTS_LEN(n) * sizeof(int32_t));
+    get(&p, m->prev_state, n * sizeof(int32_t));
+    get(&p, m->state_counter, n * sizeof(int32_t));
+
+    if (info != NULL) {
+        *info = in;
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Writer                                                                   */
+/* ------------------------------------------------------------------------ */
+
+int trend_ckpt_create(trend_ckpt_writer_t *w, const char *path)
+{
+    memset(w, 0, sizeof(*w));
+    w->last_time = -INFINITY;
+    w->fp = fopen(path, "wb");
+    return w->fp != NULL ? 0 : -1;
+}
+
+/* The first snapshot fixes the geometry and writes the file header */
+static int writer_geometry(trend_ckpt_writer_t *w, int kind, int num_tracks, int window, size_t bytes)
+{
+    ckpt_file_header_t fh;
+
+    if (w->snap_bytes != 0) {
+        return (kind == w->kind && num_tracks == w->num_tracks && window == w->window) ? 0 : -1;
+    }
+
+    w->buf = malloc(bytes);
+    if (w->buf == NULL) {
+        return -1;
+    }
+    memset(&fh, 0, sizeof(fh));
+    memcpy(fh.magic, TREND_CKPT_FILE_MAGIC, sizeof(TREND_CKPT_FILE_MAGIC));
+    fh.version = TREND_CKPT_VERSION;
+    fh.kind = (uint32_t)kind;
+    fh.num_tracks = (uint32_t)num_tracks;
+    fh.window = (uint32_t)window;
+    fh.snap_bytes = bytes;
+    if (fwrite(&fh, 1, sizeof(fh), w->fp) != sizeof(fh)) {
+        return -1;
+    }
+
+    w->snap_bytes = bytes;
+    w->kind = kind;
+    w->num_tracks = num_tracks;
+    w->window = window;
+    return 0;
+}
+
+static int write_snapshot(trend_ckpt_writer_t *w, double time)
+{
+    if (fwrite(w->buf, 1, w->snap_bytes, w->fp) != w->snap_bytes || fflush(w->fp) != 0) {
+        return -1;
+    }
+    w->last_time = time;
+    w->count++;
+    return 0;
+}
+
+int trend_ckpt_append(trend_ckpt_writer_t *w, const trend_dfa_t *dfa, const trend_ckpt_info_t *at)
+{
+    if (!(at->time >= w->last_time) ||
+        writer_geometry(w, TREND_CKPT_SINGLE, 1, dfa->params.window, trend_ckpt_size(dfa)) != 0) {
+        return -1;
+    }
+    trend_ckpt_save(dfa, at, w->buf, w->snap_bytes);
+    return write_snapshot(w, at->time);
+}
+
+int trend_ckpt_append_multi(trend_ckpt_writer_t *w, const trend_dfa_multi_t *m,
+                            const trend_ckpt_info_t *at)
+{
+    if (!(at->time >= w->last_time) ||
+        writer_geometry(w, TREND_CKPT_MULTI, m->num_tracks, m->params.window,
+                        trend_ckpt_size_multi(m)) != 0) {
+        return -1;
+    }
+    trend_ckpt_save_multi(m, at, w->buf, w->snap_bytes);
+    return write_snapshot(w, at->time);
+}
+
+int trend_ckpt_close(trend_ckpt_writer_t *w)
+{
+    int rc = 0;
+
+    if (w->fp != NULL && fclose(w->fp) != 0) {
+        rc = -1;
+    }
+    w->fp = NULL;
+    free(w->buf);
+    w->buf = NULL;
+    return rc;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Reader                                                                   */
+/* ------------------------------------------------------------------------ */
+
+#if !defined(_WIN32)
+
+int trend_ckpt_open(trend_ckpt_reader_t *r, const char *path)
+{
+    ckpt_file_header_t fh;
+    struct stat st;
+    void *map;
+    size_t expect;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(fh)) {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    r->map = (const uint8_t *)map;
+    r->map_len = (size_t)st.st_size;
+
+    memcpy(&fh, r->map, sizeof(fh));
+    if (memcmp(fh.magic, TREND_CKPT_FILE_MAGIC, sizeof(TREND_CKPT_FILE_MAGIC)) != 0 ||
+        fh.version != TREND_CKPT_VERSION || fh.window < TREND_DFA_MIN_WINDOW ||
+        fh.window > TREND_DFA_MAX_WINDOW || fh.num_tracks == 0 || fh.num_tracks > INT32_MAX) {
+        trend_ckpt_close_reader(r);
+        return -1;
+    }
+    if (fh.kind == TREND_CKPT_SINGLE && fh.num_tracks == 1) {
+        expect = single_bytes((int)fh.window);
+    } else if (fh.kind == TREND_CKPT_MULTI) {
+        expect = multi_bytes((int)fh.num_tracks, (int)fh.window);
+    } else {
+        expect = 0;
+    }
+    if (expect == 0 || fh.snap_bytes != expect) {
+        trend_ckpt_close_reader(r);
+        return -1;
+    }
+
+    r->snap_bytes = expect;
+    r->kind = (int)fh.kind;
+    r->num_tracks = (int)fh.num_tracks;
+    r->window = (int)fh.window;
+    r->count = (r->map_len - sizeof(fh)) / expect;
+    return 0;
+}
+
+const void *trend_ckpt_get(const trend_ckpt_reader_t *r, uint64_t k)
+{
+    return r->map + sizeof(ckpt_file_header_t) + k * r->snap_bytes;
+}
+
+uint64_t trend_ckpt_seek_time(const trend_ckpt_reader_t *r, double t)
+{
+    uint64_t lo = 0, hi = r->count;
+    ckpt_header_t h;
+
+    /* First snapshot taken after t; the one before it is the answer */
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        memcpy(&h, trend_ckpt_get(r, mid), sizeof(h));
+        if (h.time <= t) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo > 0 ? lo - 1 : r->count;
+}
+
+void trend_ckpt_close_reader(trend_ckpt_reader_t *r)
+{
+    if (r->map != NULL) {
+        munmap((void *)r->map, r->map_len);
+        r->map = NULL;
+    }
+}
+
+#endif /* !_WIN32 */
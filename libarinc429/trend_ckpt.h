@@ -0,0 +1,173 @@
+/* trend_ckpt.h - Checkpoints of the trend DFA state for resuming replays
+ *
+ * A snapshot holds the complete state of a trend_dfa_t (one aircraft) or a
+ * trend_dfa_multi_t (N tracks): parameters, sample windows, ring position,
+ * running sums, hysteresis counters and reported states, tagged with the
+ * sim time and row it was taken at and the caller's position in its input
+ * (e.g. flight_csv_stream_tell). Restoring copies those bytes back, so it is
+ * O(state size), and stepping on gives outputs bit-identical to a run that
+ * never stopped. A snapshot only reads its source, so any number of engines
+ * can be restored from one and run on side by side, e.g. with different
+ * thresholds (what-if runs).
+ *
+ * Snapshot layout (native byte order, every field naturally aligned):
+ *
+ *    header   magic, version, kind, tracks, window, size, time, row, input
+ *             position and a checksum of the payload
+ *    params   thresholds, anomaly limits and weights (the window size is in
+ *             the header)
+ *    single   buffer index, state, counter, then per channel the running
+ *             sums, ring head and anomaly count and only the window's
+ *             samples (not TREND_DFA_MAX_WINDOW)
+ *    multi    the control words, then the values, stats, anomaly count,
+ *             state and counter arrays of trend_dfa_multi_t as they are
+ *
+ * A checkpoint file is a file header followed by snapshots of one geometry
+ * (kind, tracks, window), so all have the same size and snapshot k sits at
+ * a fixed offset. They are appended in non-decreasing time order, which
+ * makes the file its own time index. The writer uses stdio; the reader maps
+ * the file and is POSIX only, as for flight_rec.h.
+ */
+
+#ifndef TREND_CKPT_H
+#define TREND_CKPT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "trend_dfa.h"
+#include "trend_dfa_multi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TREND_CKPT_MAGIC        "A429CKP"
+#define TREND_CKPT_FILE_MAGIC   "A429CKF"
+#define TREND_CKPT_VERSION      1
+
+/* Snapshot kinds */
+#define TREND_CKPT_SINGLE  1    /* trend_dfa_t */
+#define TREND_CKPT_MULTI   2    /* trend_dfa_multi_t */
+
+/* Where a snapshot was taken. On save only time, row and the source fields
+ * are read; trend_ckpt_info fills in everything. */
+typedef struct {
+    int      kind;
+    int      num_tracks;        /* 1 for TREND_CKPT_SINGLE */
+    double   time;              /* sim time of the last step taken */
+    uint64_t row;               /* steps taken */
+    uint64_t source_pos;        /* caller's input position, opaque here */
+    int64_t  source_line;
+    trend_dfa_params_t params;
+} trend_ckpt_info_t;
+
+typedef struct {
+    FILE     *fp;
+    uint8_t  *buf;              /* one snapshot */
+    size_t    snap_bytes;       /* 0 until the first append fixes the geometry */
+    int       kind;
+    int       num_tracks;
+    int       window;
+    uint64_t  count;
+    double    last_time;
+} trend_ckpt_writer_t;
+
+typedef struct {
+    const uint8_t *map;
+    size_t         map_len;
+    size_t         snap_bytes;
+    int            kind;
+    int            num_tracks;
+    int            window;
+    uint64_t       count;
+} trend_ckpt_reader_t;
+
+/* Snapshot size in bytes for a single or multi-track engine */
+size_t trend_ckpt_size(const trend_dfa_t *dfa);
+size_t trend_ckpt_size_multi(const trend_dfa_multi_t *m);
+
+/* Function: trend_ckpt_save ==================================================
+ * Abstract:
+ *    Write a snapshot of dfa taken at at->time / at->row into buf. Returns
+ *    the bytes written, or 0 if len is smaller than trend_ckpt_size(dfa).
+ */
+size_t trend_ckpt_save(const trend_dfa_t *dfa, const trend_ckpt_info_t *at, void *buf, size_t len);
+
+/* As trend_ckpt_save, for all tracks of m */
+size_t trend_ckpt_save_multi(const trend_dfa_multi_t *m, const trend_ckpt_info_t *at,
+                             void *buf, size_t len);
+
+/* Function: trend_ckpt_info ==================================================
+ * Abstract:
+ *    Check a snapshot (magic, version, size, checksum) and describe it.
+ *    Returns 0, or -1 if snap is not a complete, intact snapshot.
+ */
+int trend_ckpt_info(const void *snap, size_t len, trend_ckpt_info_t *info);
+
+/* Function: trend_ckpt_load ==================================================
+ * Abstract:
+ *    Restore dfa, parameters included, from a TREND_CKPT_SINGLE snapshot.
+ *    info (may be NULL) receives its description. Returns 0, or -1 (dfa
+ *    untouched) if the snapshot is damaged or holds an inconsistent state.
+ */
+int trend_ckpt_load(trend_dfa_t *dfa, const void *snap, size_t len, trend_ckpt_info_t *info);
+
+/* Function: trend_ckpt_load_multi ============================================
+ * Abstract:
+ *    Restore every track of m from a TREND_CKPT_MULTI snapshot. m must hold
+ *    arrays for info.num_tracks tracks and window info.params.window, e.g.
+ *    from trend_dfa_multi_alloc(m, info.num_tracks, &info.params); its
+ *    thresholds and weights are replaced by the snapshot's. Returns 0, or -1
+ *    (m untouched) on a mismatch or a damaged snapshot.
+ */
+int trend_ckpt_load_multi(trend_dfa_multi_t *m, const void *snap, size_t len,
+                          trend_ckpt_info_t *info);
+
+/* Function: trend_ckpt_create ================================================
+ * Abstract:
+ *    Create (or truncate) a checkpoint file. The first snapshot appended
+ *    fixes its kind, track count and window size. Returns 0 or -1.
+ */
+int trend_ckpt_create(trend_ckpt_writer_t *w, const char *path);
+
+/* Function: trend_ckpt_append ================================================
+ * Abstract:
+ *    Append a snapshot of dfa (or m) taken at at->time. Returns 0, or -1 on
+ *    a write error, if time goes backwards or if the geometry differs from
+ *    the file's. Each snapshot is flushed, so an interrupted run keeps every
+ *    checkpoint appended before it stopped.
+ */
+int trend_ckpt_append(trend_ckpt_writer_t *w, const trend_dfa_t *dfa, const trend_ckpt_info_t *at);
+int trend_ckpt_append_multi(trend_ckpt_writer_t *w, const trend_dfa_multi_t *m,
+                            const trend_ckpt_info_t *at);
+
+/* Close the file. Returns 0 or -1. */
+int trend_ckpt_close(trend_ckpt_writer_t *w);
+
+/* Function: trend_ckpt_open ==================================================
+ * Abstract:
+ *    Map a checkpoint file read-only. A snapshot cut short by an
+ *    interrupted write is ignored. Returns 0, or -1 if the file cannot be
+ *    opened or is not a checkpoint file.
+ */
+int trend_ckpt_open(trend_ckpt_reader_t *r, const char *path);
+
+/* Snapshot k (0 <= k < count) inside the mapping; its size is r->snap_bytes */
+const void *trend_ckpt_get(const trend_ckpt_reader_t *r, uint64_t k);
+
+/* Function: trend_ckpt_seek_time =============================================
+ * Abstract:
+ *    Index of the last snapshot taken at or before time t, or count if
+ *    there is none. Binary search over the snapshot headers.
+ */
+uint64_t trend_ckpt_seek_time(const trend_ckpt_reader_t *r, double t);
+
+void trend_ckpt_close_reader(trend_ckpt_reader_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_CKPT_H */
@@ -0,0 +1,212 @@
+/* trend_decim.c - Anti-alias filter and decimator ahead of the trend DFA */
+
+#include "trend_decim.h"
+#include "trend_window.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TREND_DECIM_PI 3.14159265358979323846
+
+/* Samples of every channel and track in history slot s */
+#define SLOT(d, s) (&(d)->history[(size_t)(s) * TREND_DECIM_OUT_LEN((d)->num_tracks)])
+
+int trend_decim_check(int ratio, int taps_per_phase)
+{
+    if (ratio < 1 || ratio > TREND_DECIM_MAX_RATIO ||
+        taps_per_phase < 1 || taps_per_phase > TREND_DECIM_MAX_TAPS_PER_PHASE) {
+        return -1;
+    }
+    return 0;
+}
+
+void trend_decim_design(double *coeff, int ratio, int taps)
+{
+    const double fc = 0.5 / (double)ratio;
+    const double mid = (double)(taps - 1) / 2.0;
+    double sum = 0.0;
+    int k;
+
+    if (taps == 1) {
+        coeff[0] = 1.0;
+        return;
+    }
+    for (k = 0; k < taps; k++) {
+        double m = (double)k - mid;
+        double w = 2.0 * TREND_DECIM_PI * (double)k / (double)(taps - 1);
+        double h = m == 0.0 ? 2.0 * fc : sin(2.0 * TREND_DECIM_PI * fc * m) / (TREND_DECIM_PI * m);
+
+        coeff[k] = h * (0.42 - 0.5 * cos(w) + 0.08 * cos(2.0 * w));
+        sum += coeff[k];
+    }
+    for (k = 0; k < taps; k++) {
+        coeff[k] /= sum;
+    }
+}
+
+int trend_decim_alloc(trend_decim_t *d, int num_tracks, int ratio, int taps_per_phase)
+{
+    memset(d, 0, sizeof(*d));
+    if (num_tracks <= 0 || trend_decim_check(ratio, taps_per_phase) != 0) {
+        return -1;
+    }
+
+    d->num_tracks = num_tracks;
+    d->ratio      = ratio;
+    d->taps       = TREND_DECIM_TAPS(ratio, taps_per_phase);
+    d->coeff      = (double *)malloc((size_t)d->taps * sizeof(double));
+    d->history    = (double *)malloc(TREND_DECIM_HISTORY_LEN(num_tracks, d->taps) * sizeof(double));
+    d->control    = (int32_t *)malloc(TREND_DECIM_CTRL_LEN * sizeof(int32_t));
+
+    if (!d->coeff || !d->history || !d->control) {
+        trend_decim_free(d);
+        return -1;
+    }
+
+    trend_decim_init(d);
+    return 0;
+}
+
+void trend_decim_free(trend_decim_t *d)
+{
+    free(d->coeff);
+    free(d->history);
+    free(d->control);
+    memset(d, 0, sizeof(*d));
+}
+
+void trend_decim_init(trend_decim_t *d)
+{
+    trend_decim_design(d->coeff, d->ratio, d->taps);
+    memset(d->history, 0, TREND_DECIM_HISTORY_LEN(d->num_tracks, d->taps) * sizeof(double));
+    d->control[TREND_DECIM_CTRL_HEAD]   = 0;
+    d->control[TREND_DECIM_CTRL_PHASE]  = 0;
+    d->control[TREND_DECIM_CTRL_PRIMED] = 0;
+}
+
+/* Copy one sample per channel and track into history slot s */
+static void trend_decim_store(trend_decim_t *d, int s, const double *const *input)
+{
+    const size_t n = (size_t)d->num_tracks;
+    double *slot = SLOT(d, s);
+    int ch;
+
+    if (n == 1) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            slot[ch] = input[ch][0];
+        }
+        return;
+    }
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        memcpy(slot + (size_t)ch * n, input[ch], n * sizeof(double));
+    }
+}
+
+/* Shift longitude lane l of every history slot by whole turns so that the
+ * newest value is back in -180..180; the history stays continuous */
+static void trend_decim_recentre(trend_decim_t *d, size_t l, double newest)
+{
+    const double shift = 360.0 * nearbyint(newest / 360.0);
+    int k;
+
+    for (k = 0; k < 2 * d->taps; k++) {
+        SLOT(d, k)[l] -= shift;
+    }
+}
+
+/* Continue the longitudes just stored in slot s from prev (the slot before
+ * it) where they crossed the +-180 wrap */
+static void trend_decim_unwrap(trend_decim_t *d, int s, const double *prev)
+{
+    const size_t n = (size_t)d->num_tracks;
+    const size_t lon = (size_t)TREND_DFA_CH_LON * n;
+    double *x = SLOT(d, s);
+    size_t t;
+
+    for (t = lon; t < lon + n; t++) {
+        /* Also taken for non-finite samples, which are kept as they are */
+        if (!(fabs(x[t] - prev[t]) <= 180.0)) {
+            double u = prev[t] + remainder(x[t] - prev[t], 360.0);
+
+            if (isfinite(u)) {
+                x[t] = SLOT(d, s + d->taps)[t] = u;
+                if (fabs(u) > 180.0) {
+                    trend_decim_recentre(d, t, u);
+                }
+            }
+        }
+    }
+}
+
+/* out = sum over k of c[k] * x_k, across all lanes of each slot. The slots
+ * and out are distinct blocks, so restrict lets the lane loop vectorise.
+ * Instantiated for one track, where the lane count is a constant. */
+TREND_WINDOW_INLINE void trend_decim_fir_n(size_t lanes, int taps, const double *restrict c,
+                                           const double *restrict x, double *restrict out)
+{
+    size_t l;
+    int k;
+
+    for (l = 0; l < lanes; l++) {
+        out[l] = c[0] * x[l];
+    }
+    for (k = 1; k < taps; k++) {
+        const double ck = c[k];
+        const double *restrict xk = x + (size_t)k * lanes;
+
+        for (l = 0; l < lanes; l++) {
+            out[l] += ck * xk[l];
+        }
+    }
+}
+
+static void trend_decim_fir(size_t lanes, int taps, const double *restrict c,
+                            const double *restrict x, double *restrict out)
+{
+    if (lanes == TREND_DFA_NUM_CHANNELS) {
+        trend_decim_fir_n(TREND_DFA_NUM_CHANNELS, taps, c, x, out);
+    } else {
+        trend_decim_fir_n(lanes, taps, c, x, out);
+    }
+}
+
+int trend_decim_push(trend_decim_t *d, const double *const *input, double *out)
+{
+    int32_t *ctrl = d->control;
+    int head, s;
+
+    if (!ctrl[TREND_DECIM_CTRL_PRIMED]) {
+        for (s = 0; s < 2 * d->taps; s++) {
+            trend_decim_store(d, s, input);
+        }
+        ctrl[TREND_DECIM_CTRL_HEAD]   = 0;
+        ctrl[TREND_DECIM_CTRL_PHASE]  = 0;
+        ctrl[TREND_DECIM_CTRL_PRIMED] = 1;
+    } else {
+        /* The ring runs backwards, so slots head.. are newest first */
+        head = ctrl[TREND_DECIM_CTRL_HEAD] == 0 ? d->taps - 1 : ctrl[TREND_DECIM_CTRL_HEAD] - 1;
+        trend_decim_store(d, head, input);
+        trend_decim_store(d, head + d->taps, input);
+        trend_decim_unwrap(d, head, SLOT(d, ctrl[TREND_DECIM_CTRL_HEAD]));
+        ctrl[TREND_DECIM_CTRL_HEAD] = head;
+    }
+
+    if (ctrl[TREND_DECIM_CTRL_PHASE] > 0) {
+        ctrl[TREND_DECIM_CTRL_PHASE]--;
+        return 0;
+    }
+    ctrl[TREND_DECIM_CTRL_PHASE] = d->ratio - 1;
+
+    trend_decim_fir(TREND_DECIM_OUT_LEN(d->num_tracks), d->taps, d->coeff,
+                    SLOT(d, ctrl[TREND_DECIM_CTRL_HEAD]), out);
+
+    /* Back into -180..180 */
+    out += (size_t)TREND_DFA_CH_LON * (size_t)d->num_tracks;
+    for (s = 0; s < d->num_tracks; s++) {
+        if (fabs(out[s]) > 180.0) {
+            out[s] = remainder(out[s], 360.0);
+        }
+    }
+    return 1;
+}
@@ -0,0 +1,120 @@
+/* trend_decim.h - Anti-alias filter and decimator ahead of the trend DFA
+ *
+ * Low-pass filters every flight channel of N tracks and keeps one sample in
+ * ratio, so a DFA fed from it steps ratio times less often and sees less of
+ * the high-frequency noise that inflates the window variance into
+ * STATE_OSCILLATING. The filter is a linear-phase FIR (Blackman-windowed
+ * sinc, cut-off at the output Nyquist frequency, unity gain at DC) with
+ * taps_per_phase * ratio taps. It is evaluated only when an output is due,
+ * which costs the same as its polyphase form: taps_per_phase
+ * multiply-adds per input sample and lane.
+ *
+ * Samples are kept as [slot][ch][track], so the multiply-add loop runs over
+ * the five channels of all tracks in one contiguous, vectorisable pass.
+ * The ring is stored twice over, so each output reads its taps as one
+ * contiguous run without wrapping.
+ *
+ * The first sample fills the whole history, so a track starts at its first
+ * value instead of ramping up from zero. The first output is that sample;
+ * after it comes one output every ratio inputs, delayed by
+ * (taps - 1) / 2 input samples. Note for the DFA behind it:
+ *   - slopes are per DFA step, i.e. ratio times the per-input slope, so the
+ *     stable, increase and decrease thresholds scale with ratio;
+ *   - a window of W steps spans W * ratio input samples;
+ *   - a single out-of-range sample is averaged with its neighbours, so the
+ *     anomaly limits apply to the filtered signal;
+ *   - longitude is filtered unwrapped: a step of more than 180 degrees is
+ *     taken as a crossing of the +-180 meridian, the track's history is
+ *     shifted by 360 to stay continuous, and the output is wrapped back to
+ *     -180..180. A crossing therefore neither smears across the filter
+ *     nor overshoots the longitude limit.
+ *
+ * As in trend_dfa_multi.h the state is only referenced, so it can live in
+ * Simulink DWork (trend_decim_sfunc) or come from trend_decim_alloc.
+ */
+
+#ifndef TREND_DECIM_H
+#define TREND_DECIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TREND_DECIM_MAX_RATIO               64
+#define TREND_DECIM_MAX_TAPS_PER_PHASE      32
+#define TREND_DECIM_DEFAULT_TAPS_PER_PHASE  8
+
+/* Scalars of the filter state */
+#define TREND_DECIM_CTRL_HEAD    0     /* slot of the newest sample */
+#define TREND_DECIM_CTRL_PHASE   1     /* inputs until the next output */
+#define TREND_DECIM_CTRL_PRIMED  2     /* history holds real samples */
+#define TREND_DECIM_CTRL_LEN     3
+
+/* Filter length; ratio 1 passes samples through */
+#define TREND_DECIM_TAPS(ratio, taps_per_phase) ((ratio) == 1 ? 1 : (ratio) * (taps_per_phase))
+
+/* Array lengths (in elements) for n tracks and the given filter length */
+#define TREND_DECIM_HISTORY_LEN(n, taps) ((size_t)2 * (size_t)(taps) * TREND_DFA_NUM_CHANNELS * (size_t)(n))
+#define TREND_DECIM_OUT_LEN(n)           ((size_t)TREND_DFA_NUM_CHANNELS * (size_t)(n))
+
+typedef struct {
+    int      num_tracks;
+    int      ratio;
+    int      taps;          /* TREND_DECIM_TAPS(ratio, taps_per_phase) */
+    double  *coeff;         /* [tap], newest sample first */
+    double  *history;       /* [slot][ch][track], 2 * taps slots */
+    int32_t *control;       /* TREND_DECIM_CTRL_* */
+} trend_decim_t;
+
+/* Function: trend_decim_check ================================================
+ * Abstract:
+ *    Returns 0 if ratio is 1..TREND_DECIM_MAX_RATIO and taps_per_phase
+ *    1..TREND_DECIM_MAX_TAPS_PER_PHASE, -1 otherwise.
+ */
+int trend_decim_check(int ratio, int taps_per_phase);
+
+/* Function: trend_decim_design ===============================================
+ * Abstract:
+ *    Fill coeff[0..taps-1] with the anti-alias low-pass for ratio: a
+ *    Blackman-windowed sinc with cut-off 0.5 / ratio cycles per sample,
+ *    normalised to unity DC gain.
+ */
+void trend_decim_design(double *coeff, int ratio, int taps);
+
+/* Function: trend_decim_alloc ================================================
+ * Abstract:
+ *    Allocate and initialise a decimator for num_tracks tracks. Returns 0,
+ *    or -1 on allocation failure or if trend_decim_check rejects the
+ *    arguments.
+ */
+int trend_decim_alloc(trend_decim_t *d, int num_tracks, int ratio, int taps_per_phase);
+
+/* Release arrays obtained from trend_decim_alloc */
+void trend_decim_free(trend_decim_t *d);
+
+/* Function: trend_decim_init =================================================
+ * Abstract:
+ *    Design the filter into d->coeff and reset the history; the next sample
+ *    pushed primes it and produces an output.
+ */
+void trend_decim_init(trend_decim_t *d);
+
+/* Function: trend_decim_push =================================================
+ * Abstract:
+ *    Push one sample per track and channel; input[ch] points to num_tracks
+ *    samples of channel ch (TREND_DFA_CH_*), as for trend_dfa_multi_step.
+ *    Returns 1 and writes TREND_DECIM_OUT_LEN values laid out [ch][track]
+ *    to out when an output is due, otherwise returns 0 and leaves out alone.
+ */
+int trend_decim_push(trend_decim_t *d, const double *const *input, double *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_DECIM_H */
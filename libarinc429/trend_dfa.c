@@ -0,0 +1,136 @@
+/* trend_dfa.c - Flight data trend analysis DFA */
+
+#include "trend_dfa.h"
+#include "trend_dfa_decide.h"
+
+#include <math.h>
+#include <string.h>
+
+/* Anomaly limits in TREND_DFA_CH_* order */
+const double trend_dfa_anomaly_threshold[TREND_DFA_NUM_CHANNELS] = {
+    VEL_ANOMALY_THRESHOLD,      /* m/s - extreme velocity */
+    ALT_ANOMALY_THRESHOLD,      /* m - extreme altitude */
+    LAT_ANOMALY_THRESHOLD,      /* degrees - invalid latitude */
+    LON_ANOMALY_THRESHOLD,      /* degrees - invalid longitude */
+    VERTARE_ANOMALY_THRESHOLD   /* vertical area threshold */
+};
+
+/* Any sample of any channel out of bounds. The windows count out-of-bounds
+ * samples as they enter and leave, so this no longer rescans SAMPLE_SIZE values. */
+static int detect_flight_anomaly(const trend_window_t *window) {
+    int ch;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        if (trend_window_has_anomaly(&window[ch])) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Weighted trend coefficients in TREND_DFA_CH_* order */
+static const double trend_dfa_default_weight[TREND_DFA_NUM_CHANNELS] = {
+    0.4,    /* velocity */
+    0.3,    /* baroaltitude */
+    0.1,    /* latitude */
+    0.1,    /* longitude */
+    0.1     /* vertical rate */
+};
+
+static int internal_flight_trend_analysis_dfa(trend_dfa_t *dfa, double *confidence, double *trend_values) {
+
+    const trend_window_t *window = dfa->window;
+    double variance, max_variance;
+    int ch;
+
+    /* Calculate trends and variances for flight parameters */
+    max_variance = 0.0;
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        trend_values[ch] = trend_window_slope(&window[ch]);
+        variance = trend_window_variance(&window[ch]);
+        if (ch == 0 || variance > max_variance) max_variance = variance;
+    }
+
+    trend_values[5] = trend_dfa_weighted_trend(dfa->params.weight, trend_values);
+
+    return trend_dfa_decide(&dfa->params, detect_flight_anomaly(window), max_variance,
+                            trend_values[5], &dfa->prev_state, &dfa->state_counter, confidence);
+}
+
+void trend_dfa_default_params(trend_dfa_params_t *p)
+{
+    p->window = SAMPLE_SIZE;
+    p->stable = STABLE_THRESHOLD;
+    p->increase = INCREASE_THRESHOLD;
+    p->decrease = DECREASE_THRESHOLD;
+    p->oscillation = OSCILLATION_THRESHOLD;
+    memcpy(p->anomaly, trend_dfa_anomaly_threshold, sizeof(p->anomaly));
+    memcpy(p->weight, trend_dfa_default_weight, sizeof(p->weight));
+}
+
+int trend_dfa_check_params(const trend_dfa_params_t *p)
+{
+    int ch;
+
+    if (p->window < TREND_DFA_MIN_WINDOW || p->window > TREND_DFA_MAX_WINDOW ||
+        isnan(p->stable) || isnan(p->increase) || isnan(p->decrease) || isnan(p->oscillation)) {
+        return -1;
+    }
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        if (isnan(p->anomaly[ch]) || isnan(p->weight[ch])) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void trend_dfa_init(trend_dfa_t *dfa)
+{
+    trend_dfa_params_t p;
+
+    trend_dfa_default_params(&p);
+    trend_dfa_init_params(dfa, &p);
+}
+
+int trend_dfa_init_params(trend_dfa_t *dfa, const trend_dfa_params_t *p)
+{
+    int ch;
+
+    if (trend_dfa_check_params(p) != 0) {
+        return -1;
+    }
+    /* Only the first p->window slots of each window are ever touched */
+    dfa->params = *p;
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        trend_window_init(&dfa->window[ch], p->window, p->anomaly[ch]);
+    }
+    dfa->buffer_idx = 0;
+    dfa->prev_state = STATE_STABLE;
+    dfa->state_counter = 0;
+    return 0;
+}
+
+void trend_dfa_step(trend_dfa_t *dfa, const double *input, trend_dfa_output_t *out)
+{
+    int i;
+
+    /* Add new values; O(1) per channel regardless of the window size */
+    trend_window_push_channels(dfa->window, input);
+
+    /* Saturate so the counter cannot wrap on very long replays */
+    if (dfa->buffer_idx < dfa->params.window) {
+        dfa->buffer_idx++;
+    }
+
+    /* Process when enough samples */
+    if (dfa->buffer_idx >= dfa->params.window) {
+        out->state = internal_flight_trend_analysis_dfa(dfa, &out->confidence, out->trends);
+    } else {
+        /* Initial values */
+        out->state = STATE_STABLE;
+        out->confidence = 0.0;
+        for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+            out->trends[i] = 0.0;
+        }
+    }
+}
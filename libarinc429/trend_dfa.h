@@ -0,0 +1,71 @@
+/* trend_dfa.h - Flight data trend analysis DFA (velocity, baroaltitude, lat, lon, vertrate) */
+
+#ifndef TREND_DFA_H
+#define TREND_DFA_H
+
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+#include "trend_window.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Per-instance DFA state. Holds everything that used to live in RWork and
+ * in the file-level statics, so any number of instances can run side by side. */
+typedef struct {
+    trend_window_t window[TREND_DFA_NUM_CHANNELS];
+    int     buffer_idx;
+    int32_t prev_state;
+    int32_t state_counter;
+    trend_dfa_params_t params;
+} trend_dfa_t;
+
+typedef struct {
+    int    state;
+    double confidence;
+    double trends[TREND_DFA_NUM_TRENDS];
+} trend_dfa_output_t;
+
+/* Anomaly limits in TREND_DFA_CH_* order */
+extern const double trend_dfa_anomaly_threshold[TREND_DFA_NUM_CHANNELS];
+
+/* Window size, thresholds and weights of trend_dfa_config.h */
+void trend_dfa_default_params(trend_dfa_params_t *p);
+
+/* Function: trend_dfa_check_params ===========================================
+ * Abstract:
+ *    Returns 0 if p can configure a DFA, -1 if the window size is outside
+ *    TREND_DFA_MIN_WINDOW..TREND_DFA_MAX_WINDOW or a threshold or weight is
+ *    NaN.
+ */
+int trend_dfa_check_params(const trend_dfa_params_t *p);
+
+/* Function: trend_dfa_init ===================================================
+ * Abstract:
+ *    Clear the sample windows and reset the automaton to STATE_STABLE, with
+ *    the default parameters.
+ */
+void trend_dfa_init(trend_dfa_t *dfa);
+
+/* Function: trend_dfa_init_params ============================================
+ * Abstract:
+ *    As trend_dfa_init, with the window size, thresholds and weights of p.
+ *    Returns 0, or -1 (dfa untouched) if trend_dfa_check_params rejects p.
+ */
+int trend_dfa_init_params(trend_dfa_t *dfa, const trend_dfa_params_t *p);
+
+/* Function: trend_dfa_step ===================================================
+ * Abstract:
+ *    Push one sample per channel (ordered as TREND_DFA_CH_*) into the windows
+ *    and evaluate the automaton. Until a window's worth of samples has been
+ *    seen the output is STATE_STABLE with zero confidence and zero trends.
+ */
+void trend_dfa_step(trend_dfa_t *dfa, const double *input, trend_dfa_output_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_DFA_H */
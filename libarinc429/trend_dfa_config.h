@@ -0,0 +1,68 @@
+/* trend_dfa_config.h - States, thresholds and window size of the flight trend DFA */
+
+#ifndef TREND_DFA_CONFIG_H
+#define TREND_DFA_CONFIG_H
+
+/* State definitions */
+#define STATE_STABLE      1
+#define STATE_INCREASING  2
+#define STATE_DECREASING  3
+#define STATE_OSCILLATING 4
+#define STATE_ANOMALY     5
+#define TREND_DFA_NUM_STATES 5   /* STATE_STABLE .. STATE_ANOMALY */
+
+/* Thresholds - adjusted for flight data */
+#define STABLE_THRESHOLD      0.5
+#define INCREASE_THRESHOLD    2.0
+#define DECREASE_THRESHOLD   -2.0
+#define OSCILLATION_THRESHOLD 100.0
+#define ANOMALY_THRESHOLD     1000.0
+
+/* Flight-specific anomaly thresholds */
+#define VEL_ANOMALY_THRESHOLD     500.0   /* m/s - extreme velocity */
+#define ALT_ANOMALY_THRESHOLD     50000.0 /* m - extreme altitude */
+#define LAT_ANOMALY_THRESHOLD     90.0    /* degrees - invalid latitude */
+#define LON_ANOMALY_THRESHOLD     180.0   /* degrees - invalid longitude */
+#define VERTARE_ANOMALY_THRESHOLD 1000.0  /* vertical area threshold */
+
+#define SAMPLE_SIZE 10
+
+/* Channel order of the DFA inputs */
+#define TREND_DFA_CH_VELOCITY 0
+#define TREND_DFA_CH_BAROALT  1
+#define TREND_DFA_CH_LAT      2
+#define TREND_DFA_CH_LON      3
+#define TREND_DFA_CH_VERTRATE 4
+
+#define TREND_DFA_NUM_CHANNELS 5
+#define TREND_DFA_NUM_TRENDS   6   /* five channel slopes + weighted trend */
+
+/* Window sizes accepted at run time; 8, 16, 32 and 64 have specialised kernels */
+#define TREND_DFA_MIN_WINDOW 2
+#define TREND_DFA_MAX_WINDOW 256
+
+/* Run-time configuration of one DFA. trend_dfa_default_params fills in the
+ * values above (weights 0.4, 0.3, 0.1, 0.1, 0.1). */
+typedef struct {
+    int    window;                              /* SAMPLE_SIZE */
+    double stable;                              /* STABLE_THRESHOLD */
+    double increase;                            /* INCREASE_THRESHOLD */
+    double decrease;                            /* DECREASE_THRESHOLD */
+    double oscillation;                         /* OSCILLATION_THRESHOLD */
+    double anomaly[TREND_DFA_NUM_CHANNELS];     /* *_ANOMALY_THRESHOLD, TREND_DFA_CH_* order */
+    double weight[TREND_DFA_NUM_CHANNELS];      /* weighted trend coefficients */
+} trend_dfa_params_t;
+
+/* The same in single precision, for the float32 and fixed-point DFAs
+ * (trend_dfa_f32.h, trend_dfa_q.h), see trend_dfa_params_to_f32 */
+typedef struct {
+    int   window;
+    float stable;
+    float increase;
+    float decrease;
+    float oscillation;
+    float anomaly[TREND_DFA_NUM_CHANNELS];
+    float weight[TREND_DFA_NUM_CHANNELS];
+} trend_dfa_params_f32_t;
+
+#endif /* TREND_DFA_CONFIG_H */
@@ -0,0 +1,62 @@
+/* trend_dfa_decide.h - State decision shared by the single- and multi-track DFA */
+
+#ifndef TREND_DFA_DECIDE_H
+#define TREND_DFA_DECIDE_H
+
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+#include "trend_dfa_table.h"
+
+/* Weighted trend - by default prioritizing velocity and altitude for flight
+ * analysis. Summed in channel order, so the default weights give the same
+ * result as the original 0.4/0.3/0.1 expression. */
+static inline double trend_dfa_weighted_trend(const double *weight, const double *slope)
+{
+    return weight[TREND_DFA_CH_VELOCITY] * slope[TREND_DFA_CH_VELOCITY] +
+           weight[TREND_DFA_CH_BAROALT] * slope[TREND_DFA_CH_BAROALT] +
+           weight[TREND_DFA_CH_LAT] * slope[TREND_DFA_CH_LAT] +
+           weight[TREND_DFA_CH_LON] * slope[TREND_DFA_CH_LON] +
+           weight[TREND_DFA_CH_VERTRATE] * slope[TREND_DFA_CH_VERTRATE];
+}
+
+/* trend_dfa_weighted_trend in single precision */
+static inline float trend_dfa_weighted_trend_f32(const float *weight, const float *slope)
+{
+    return weight[TREND_DFA_CH_VELOCITY] * slope[TREND_DFA_CH_VELOCITY] +
+           weight[TREND_DFA_CH_BAROALT] * slope[TREND_DFA_CH_BAROALT] +
+           weight[TREND_DFA_CH_LAT] * slope[TREND_DFA_CH_LAT] +
+           weight[TREND_DFA_CH_LON] * slope[TREND_DFA_CH_LON] +
+           weight[TREND_DFA_CH_VERTRATE] * slope[TREND_DFA_CH_VERTRATE];
+}
+
+/* Function: trend_dfa_decide =================================================
+ * Abstract:
+ *    Classify one evaluated window with the thresholds of p and advance the
+ *    automaton through trend_dfa_table.h. prev_state and state_counter are
+ *    the per-track automaton state and are updated in place. Returns the
+ *    state reported for this step.
+ */
+static inline int trend_dfa_decide(const trend_dfa_params_t *p, int anomaly, double max_variance,
+                                   double weighted_trend, int32_t *prev_state,
+                                   int32_t *state_counter, double *confidence)
+{
+    int feature = trend_dfa_feature(p, anomaly, max_variance, weighted_trend);
+
+    *confidence = trend_dfa_feature_confidence[feature];
+    return trend_dfa_transition_step(feature, prev_state, state_counter);
+}
+
+/* trend_dfa_decide in single precision, for the float32 and fixed-point DFAs */
+static inline int trend_dfa_decide_f32(const trend_dfa_params_f32_t *p, int anomaly,
+                                       float max_variance, float weighted_trend,
+                                       int32_t *prev_state, int32_t *state_counter,
+                                       float *confidence)
+{
+    int feature = trend_dfa_feature_f32(p, anomaly, max_variance, weighted_trend);
+
+    *confidence = trend_dfa_feature_confidence_f32[feature];
+    return trend_dfa_transition_step(feature, prev_state, state_counter);
+}
+
+#endif /* TREND_DFA_DECIDE_H */
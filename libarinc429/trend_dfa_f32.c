@@ -0,0 +1,189 @@
+/* trend_dfa_f32.c - Single-precision multi-track trend DFA for embedded targets */
+
+#include "trend_dfa_f32.h"
+#include "trend_dfa.h"
+#include "trend_dfa_decide.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOT(m, ch, slot, win) (&(m)->values[((size_t)(ch) * (win) + (slot)) * (size_t)(m)->num_tracks])
+
+void trend_dfa_params_to_f32(const trend_dfa_params_t *p, trend_dfa_params_f32_t *out)
+{
+    int ch;
+
+    out->window = p->window;
+    out->stable = (float)p->stable;
+    out->increase = (float)p->increase;
+    out->decrease = (float)p->decrease;
+    out->oscillation = (float)p->oscillation;
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        out->anomaly[ch] = (float)p->anomaly[ch];
+        out->weight[ch] = (float)p->weight[ch];
+    }
+}
+
+int trend_dfa_f32_alloc(trend_dfa_f32_t *m, int num_tracks, const trend_dfa_params_t *p)
+{
+    trend_dfa_params_t defaults;
+
+    memset(m, 0, sizeof(*m));
+    if (p == NULL) {
+        trend_dfa_default_params(&defaults);
+        p = &defaults;
+    }
+    if (trend_dfa_check_params(p) != 0 || num_tracks <= 0) {
+        return -1;
+    }
+    trend_dfa_params_to_f32(p, &m->params);
+
+    m->num_tracks    = num_tracks;
+    m->values        = (float *)malloc(TREND_DFA_F32_VALUES_LEN(num_tracks, p->window) *
+                                       sizeof(float));
+    m->prev_state    = (int32_t *)malloc((size_t)num_tracks * sizeof(int32_t));
+    m->state_counter = (int32_t *)malloc((size_t)num_tracks * sizeof(int32_t));
+    m->control       = (int32_t *)malloc(TREND_DFA_F32_CTRL_LEN * sizeof(int32_t));
+
+    if (!m->values || !m->prev_state || !m->state_counter || !m->control) {
+        trend_dfa_f32_free(m);
+        return -1;
+    }
+
+    trend_dfa_f32_init(m);
+    return 0;
+}
+
+void trend_dfa_f32_free(trend_dfa_f32_t *m)
+{
+    free(m->values);
+    free(m->prev_state);
+    free(m->state_counter);
+    free(m->control);
+    memset(m, 0, sizeof(*m));
+}
+
+void trend_dfa_f32_init(trend_dfa_f32_t *m)
+{
+    const int n = m->num_tracks;
+    int t;
+
+    memset(m->values, 0, TREND_DFA_F32_VALUES_LEN(n, m->params.window) * sizeof(float));
+    for (t = 0; t < n; t++) {
+        m->prev_state[t] = STATE_STABLE;
+        m->state_counter[t] = 0;
+    }
+    for (t = 0; t < TREND_DFA_F32_CTRL_LEN; t++) {
+        m->control[t] = 0;
+    }
+}
+
+/* Slope, variance and anomaly flag of one channel of one track. Sums run
+ * over d = y - y_oldest, which for flight data is small next to y, and
+ * against x centred on the window, so the slope is sum(x * d) / sum(x^2)
+ * without the cancelling n * sum_xy - sum_x * sum_y of the double path. */
+static void window_stats(const trend_dfa_f32_t *m, int track, int ch,
+                         float *slope, float *variance, int *anomaly)
+{
+    const size_t n = (size_t)m->num_tracks;
+    const int win = m->params.window;
+    const float thr = m->params.anomaly[ch];
+    const float *v = SLOT(m, ch, 0, win) + track;
+    const int head = m->control[TREND_DFA_F32_CTRL_HEAD];
+    const float y0 = v[(size_t)head * n];
+    float x = -0.5f * (float)(win - 1);
+    float sum_d = 0.0f, sum_xd = 0.0f, mean, m2 = 0.0f, d;
+    int i, out = 0;
+
+    /* Oldest to newest: slots head..win-1, then 0..head-1 */
+    for (i = head; i < win; i++, x += 1.0f) {
+        d = v[i * n] - y0;
+        sum_d += d;
+        sum_xd += x * d;
+        out |= fabsf(v[i * n]) > thr;
+    }
+    for (i = 0; i < head; i++, x += 1.0f) {
+        d = v[i * n] - y0;
+        sum_d += d;
+        sum_xd += x * d;
+        out |= fabsf(v[i * n]) > thr;
+    }
+    mean = sum_d / (float)win;
+    for (i = 0; i < win; i++) {
+        d = v[i * n] - y0 - mean;
+        m2 += d * d;
+    }
+
+    *slope = sum_xd / ((float)win * ((float)win * (float)win - 1.0f) / 12.0f);
+    *variance = m2 / (float)(win - 1);
+    *anomaly = out;
+}
+
+float trend_dfa_f32_slope(const trend_dfa_f32_t *m, int track, int ch)
+{
+    float slope, variance;
+    int anomaly;
+
+    window_stats(m, track, ch, &slope, &variance, &anomaly);
+    return slope;
+}
+
+float trend_dfa_f32_variance(const trend_dfa_f32_t *m, int track, int ch)
+{
+    float slope, variance;
+    int anomaly;
+
+    window_stats(m, track, ch, &slope, &variance, &anomaly);
+    return variance;
+}
+
+void trend_dfa_f32_step(trend_dfa_f32_t *m, const float *const *input,
+                        float *state, float *confidence, float *trends)
+{
+    const int n = m->num_tracks;
+    const int win = m->params.window;
+    int32_t *control = m->control;
+    int head = control[TREND_DFA_F32_CTRL_HEAD];
+    float *weighted;
+    int ch, t;
+
+    /* Add new values over the oldest ones */
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        memcpy(SLOT(m, ch, head, win), input[ch], (size_t)n * sizeof(float));
+    }
+    control[TREND_DFA_F32_CTRL_HEAD] = head + 1 == win ? 0 : head + 1;
+
+    if (control[TREND_DFA_F32_CTRL_BUFFER_IDX] < win) {
+        control[TREND_DFA_F32_CTRL_BUFFER_IDX]++;
+    }
+
+    if (control[TREND_DFA_F32_CTRL_BUFFER_IDX] < win) {
+        /* Initial values */
+        for (t = 0; t < n; t++) {
+            state[t] = (float)STATE_STABLE;
+            confidence[t] = 0.0f;
+        }
+        memset(trends, 0, (size_t)TREND_DFA_NUM_TRENDS * n * sizeof(float));
+        return;
+    }
+
+    weighted = &trends[(size_t)TREND_DFA_NUM_CHANNELS * n];
+    for (t = 0; t < n; t++) {
+        float slope[TREND_DFA_NUM_CHANNELS];
+        float variance, max_variance = 0.0f;
+        int anomaly = 0, out;
+
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            window_stats(m, t, ch, &slope[ch], &variance, &out);
+            if (ch == 0 || variance > max_variance) max_variance = variance;
+            anomaly |= out;
+            trends[(size_t)ch * n + t] = slope[ch];
+        }
+
+        weighted[t] = trend_dfa_weighted_trend_f32(m->params.weight, slope);
+        state[t] = (float)trend_dfa_decide_f32(&m->params, anomaly, max_variance, weighted[t],
+                                               &m->prev_state[t], &m->state_counter[t],
+                                               &confidence[t]);
+    }
+}
@@ -0,0 +1,99 @@
+/* trend_dfa_f32.h - Single-precision multi-track trend DFA for embedded targets
+ *
+ * The trend DFA of trend_dfa_multi.h in float only, for code generated
+ * through cg_sfun.h onto processors with a single-precision FPU, where every
+ * double operation is a library call. Tracks share the ring-buffer head as in
+ * trend_dfa_multi_t, and the arrays are referenced, not owned, so they can
+ * live in Simulink DWork.
+ *
+ * Only the samples are stored: 4 * window bytes per channel and track, plus
+ * 8 bytes of automaton state per track. With the default window of 10 that
+ * is 208 bytes per aircraft, against 408 for the RWork of the original block
+ * and 668 for trend_dfa_multi_t. In return slope, variance and the anomaly
+ * test are recomputed from the window at every step, as two-pass sums over
+ * deviations from the oldest sample, so nothing drifts and there is no
+ * resync; for windows of a few tens of samples the O(window) loop in
+ * float costs less than the O(1) update in emulated double.
+ *
+ * Error against the double DFA (trend_dfa.h) for window n, x = 1..n,
+ * A = sum|x - mean(x)| / sum((x - mean(x))^2) (0.303 for n = 10, about 3/n),
+ * u = 2^-24 and e = u * max|y| the rounding of a sample to float:
+ *    slope     |error| <= A * (e + (n + 3) * u * max|y - y_oldest|)
+ *    variance  |error| <= (2e * sum|y - mean(y)| + n * e^2) / (n - 1)
+ *                         + (n + 3) * u * variance
+ * The weighted trend adds the weighted slope errors. States differ only for
+ * windows within these bounds of a threshold, and anomaly flags only for
+ * samples within one float ulp of their limit. arinc429_dfa_precision checks
+ * the bounds on a recorded dump.
+ */
+
+#ifndef TREND_DFA_F32_H
+#define TREND_DFA_F32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Scalars shared by all tracks */
+#define TREND_DFA_F32_CTRL_HEAD       0
+#define TREND_DFA_F32_CTRL_BUFFER_IDX 1
+#define TREND_DFA_F32_CTRL_LEN        2
+
+/* Sample array length (in elements) for n tracks and the given window size */
+#define TREND_DFA_F32_VALUES_LEN(n, window) ((size_t)TREND_DFA_NUM_CHANNELS * (size_t)(window) * (size_t)(n))
+
+/* params.window must not change while the arrays are in use */
+typedef struct {
+    int      num_tracks;
+    trend_dfa_params_f32_t params;
+    float   *values;         /* [ch][slot][track] sample windows */
+    int32_t *prev_state;     /* [track] */
+    int32_t *state_counter;  /* [track] */
+    int32_t *control;        /* TREND_DFA_F32_CTRL_* */
+} trend_dfa_f32_t;
+
+/* Round p to single precision */
+void trend_dfa_params_to_f32(const trend_dfa_params_t *p, trend_dfa_params_f32_t *out);
+
+/* Function: trend_dfa_f32_alloc ==============================================
+ * Abstract:
+ *    Allocate the state arrays for num_tracks tracks with parameters p (NULL
+ *    for the defaults) and initialise them. Returns 0 on success, -1 on
+ *    allocation failure or if trend_dfa_check_params rejects p.
+ */
+int trend_dfa_f32_alloc(trend_dfa_f32_t *m, int num_tracks, const trend_dfa_params_t *p);
+
+/* Release arrays obtained from trend_dfa_f32_alloc */
+void trend_dfa_f32_free(trend_dfa_f32_t *m);
+
+/* Function: trend_dfa_f32_init ===============================================
+ * Abstract:
+ *    Reset every track: windows full of zeros, automaton in STATE_STABLE.
+ */
+void trend_dfa_f32_init(trend_dfa_f32_t *m);
+
+/* Function: trend_dfa_f32_step ===============================================
+ * Abstract:
+ *    Push one sample per track and channel and evaluate every track, with
+ *    the layout of trend_dfa_multi_step: input[ch] holds num_tracks samples,
+ *    state and confidence num_tracks values and trends
+ *    TREND_DFA_NUM_TRENDS * num_tracks values laid out [trend][track].
+ */
+void trend_dfa_f32_step(trend_dfa_f32_t *m, const float *const *input,
+                        float *state, float *confidence, float *trends);
+
+/* Slope and sample variance of channel ch of one track over the current
+ * window (unfilled slots count as zeros) */
+float trend_dfa_f32_slope(const trend_dfa_f32_t *m, int track, int ch);
+float trend_dfa_f32_variance(const trend_dfa_f32_t *m, int track, int ch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_DFA_F32_H */
@@ -0,0 +1,274 @@
+/* trend_dfa_multi.c - Multi-track trend DFA with structure-of-arrays state */
+
+#include "trend_dfa_multi.h"
+#include "trend_dfa.h"
+#include "trend_dfa_decide.h"
+#include "trend_window.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define STAT(m, stat, ch) (&(m)->stats[((size_t)(stat) * TREND_DFA_NUM_CHANNELS + (ch)) * (size_t)(m)->num_tracks])
+#define SLOT(m, ch, slot, win) (&(m)->values[((size_t)(ch) * (win) + (slot)) * (size_t)(m)->num_tracks])
+
+int trend_dfa_multi_alloc(trend_dfa_multi_t *m, int num_tracks, const trend_dfa_params_t *p)
+{
+    memset(m, 0, sizeof(*m));
+    if (p == NULL) {
+        trend_dfa_default_params(&m->params);
+    } else if (trend_dfa_check_params(p) == 0) {
+        m->params = *p;
+    } else {
+        return -1;
+    }
+    if (num_tracks <= 0) {
+        return -1;
+    }
+
+    m->num_tracks    = num_tracks;
+    m->values        = (double *)malloc(TREND_DFA_MULTI_VALUES_LEN(num_tracks, m->params.window) *
+                                        sizeof(double));
+    m->stats         = (double *)malloc(TREND_DFA_MULTI_STATS_LEN(num_tracks) * sizeof(double));
+    m->anomaly_count = (int32_t *)malloc(TREND_DFA_MULTI_COUNTS_LEN(num_tracks) * sizeof(int32_t));
+    m->prev_state    = (int32_t *)malloc((size_t)num_tracks * sizeof(int32_t));
+    m->state_counter = (int32_t *)malloc((size_t)num_tracks * sizeof(int32_t));
+    m->control       = (int32_t *)malloc(TREND_DFA_MULTI_CTRL_LEN * sizeof(int32_t));
+
+    if (!m->values || !m->stats || !m->anomaly_count || !m->prev_state ||
+        !m->state_counter || !m->control) {
+        trend_dfa_multi_free(m);
+        return -1;
+    }
+
+    trend_dfa_multi_init(m);
+    return 0;
+}
+
+void trend_dfa_multi_free(trend_dfa_multi_t *m)
+{
+    free(m->values);
+    free(m->stats);
+    free(m->anomaly_count);
+    free(m->prev_state);
+    free(m->state_counter);
+    free(m->control);
+    memset(m, 0, sizeof(*m));
+}
+
+void trend_dfa_multi_init(trend_dfa_multi_t *m)
+{
+    const int n = m->num_tracks;
+    int t;
+
+    memset(m->values, 0, TREND_DFA_MULTI_VALUES_LEN(n, m->params.window) * sizeof(double));
+    memset(m->stats, 0, TREND_DFA_MULTI_STATS_LEN(n) * sizeof(double));
+    memset(m->anomaly_count, 0, TREND_DFA_MULTI_COUNTS_LEN(n) * sizeof(int32_t));
+    for (t = 0; t < n; t++) {
+        m->prev_state[t] = STATE_STABLE;
+        m->state_counter[t] = 0;
+    }
+    for (t = 0; t < TREND_DFA_MULTI_CTRL_LEN; t++) {
+        m->control[t] = 0;
+    }
+}
+
+/* The bodies below take the window size as an argument and are instantiated
+ * per specialised size, see TREND_WINDOW_INLINE */
+
+/* Recompute the running sums of every track, mirroring trend_window_resync_n */
+TREND_WINDOW_INLINE void trend_dfa_multi_resync_n(trend_dfa_multi_t *m, int head, const int win)
+{
+    const int n = m->num_tracks;
+    int ch, i, t, slot;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        double *sum_y  = STAT(m, TREND_DFA_MULTI_SUM_Y, ch);
+        double *sum_xy = STAT(m, TREND_DFA_MULTI_SUM_XY, ch);
+        double *mean   = STAT(m, TREND_DFA_MULTI_MEAN, ch);
+        double *m2     = STAT(m, TREND_DFA_MULTI_M2, ch);
+
+        for (t = 0; t < n; t++) {
+            sum_y[t] = 0.0;
+            sum_xy[t] = 0.0;
+            m2[t] = 0.0;
+        }
+
+        slot = head;
+        for (i = 0; i < win; i++) {
+            const double *v = SLOT(m, ch, slot, win);
+            for (t = 0; t < n; t++) {
+                sum_y[t] += v[t];
+                sum_xy[t] += (double)(i + 1) * v[t];
+            }
+            slot = trend_window_next(slot, win);
+        }
+        for (t = 0; t < n; t++) {
+            mean[t] = sum_y[t] / win;
+        }
+        for (i = 0; i < win; i++) {
+            const double *v = SLOT(m, ch, i, win);
+            for (t = 0; t < n; t++) {
+                m2[t] += (v[t] - mean[t]) * (v[t] - mean[t]);
+            }
+        }
+
+        memset(STAT(m, TREND_DFA_MULTI_SUM_Y_C, ch), 0, (size_t)n * sizeof(double));
+        memset(STAT(m, TREND_DFA_MULTI_SUM_XY_C, ch), 0, (size_t)n * sizeof(double));
+    }
+}
+
+/* Replace the oldest sample of one channel in every track. The arrays are
+ * distinct DWork/heap blocks, so restrict lets the track loop vectorise
+ * without alias checks; GCC drops restrict when the body is inlined, so
+ * this one stays an ordinary function shared by all kernels. The anomaly
+ * counts go first, in their own loop: a double compare feeding an int32
+ * add does not vectorise with SSE2 and would keep the statistics loop
+ * scalar; they also note any NaN/Inf input. Returns non-zero if there was
+ * one. */
+static int trend_dfa_multi_update(int n, const double *restrict u, double thr,
+                                   double *restrict slot,
+                                   double *restrict sum_y, double *restrict sum_y_c,
+                                   double *restrict sum_xy, double *restrict sum_xy_c,
+                                   double *restrict mean, double *restrict m2,
+                                   int32_t *restrict count, int win)
+{
+    const double n_x = (double)win;
+    int nonfinite = 0;
+    int t;
+
+    for (t = 0; t < n; t++) {
+        count[t] += (fabs(u[t]) > thr) - (fabs(slot[t]) > thr);
+        nonfinite |= !(fabs(u[t]) <= DBL_MAX);
+    }
+    for (t = 0; t < n; t++) {
+        double y = u[t];
+        double y_old = slot[t];
+        double delta = y - y_old;
+        double old_mean = mean[t];
+
+        slot[t] = y;
+        trend_window_kahan_add(&sum_xy[t], &sum_xy_c[t], n_x * y - sum_y[t]);
+        trend_window_kahan_add(&sum_y[t], &sum_y_c[t], delta);
+        mean[t] = old_mean + delta / n_x;
+        m2[t] += delta * ((y - mean[t]) + (y_old - old_mean));
+    }
+    return nonfinite;
+}
+
+TREND_WINDOW_INLINE void trend_dfa_multi_step_n(trend_dfa_multi_t *m, const double *const *input,
+                                                double *state, double *confidence, double *trends,
+                                                const int win)
+{
+    const int n = m->num_tracks;
+    const double n_x = (double)win;
+    const double sum_x = trend_window_sum_x(win);
+    const double denom = trend_window_denom(win);
+    int32_t *control = m->control;
+    int head = control[TREND_DFA_MULTI_CTRL_HEAD];
+    double *weighted;
+    int nonfinite = 0;
+    int ch, t;
+
+    /* Window update: one pass over contiguous track arrays per channel */
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        nonfinite |= trend_dfa_multi_update(n, input[ch], m->params.anomaly[ch], SLOT(m, ch, head, win),
+                               STAT(m, TREND_DFA_MULTI_SUM_Y, ch),
+                               STAT(m, TREND_DFA_MULTI_SUM_Y_C, ch),
+                               STAT(m, TREND_DFA_MULTI_SUM_XY, ch),
+                               STAT(m, TREND_DFA_MULTI_SUM_XY_C, ch),
+                               STAT(m, TREND_DFA_MULTI_MEAN, ch),
+                               STAT(m, TREND_DFA_MULTI_M2, ch),
+                               &m->anomaly_count[(size_t)ch * n], win);
+    }
+
+    head = trend_window_next(head, win);
+    control[TREND_DFA_MULTI_CTRL_HEAD] = head;
+
+    /* As in trend_window_push_n, rebuild the sums poisoned by a NaN/Inf once
+     * it has left; the countdown is shared, so every track is rebuilt */
+    if (control[TREND_DFA_MULTI_CTRL_NONFINITE] > 0 && --control[TREND_DFA_MULTI_CTRL_NONFINITE] == 0) {
+        trend_dfa_multi_resync_n(m, head, win);
+        control[TREND_DFA_MULTI_CTRL_SINCE_RESYNC] = 0;
+    } else if (++control[TREND_DFA_MULTI_CTRL_SINCE_RESYNC] >= TREND_WINDOW_RESYNC_PERIOD &&
+               control[TREND_DFA_MULTI_CTRL_SINCE_RESYNC] >= win) {
+        trend_dfa_multi_resync_n(m, head, win);
+        control[TREND_DFA_MULTI_CTRL_SINCE_RESYNC] = 0;
+    }
+    if (nonfinite) {
+        control[TREND_DFA_MULTI_CTRL_NONFINITE] = win;
+    }
+
+    if (control[TREND_DFA_MULTI_CTRL_BUFFER_IDX] < win) {
+        control[TREND_DFA_MULTI_CTRL_BUFFER_IDX]++;
+    }
+
+    if (control[TREND_DFA_MULTI_CTRL_BUFFER_IDX] < win) {
+        /* Initial values */
+        for (t = 0; t < n; t++) {
+            state[t] = (double)STATE_STABLE;
+            confidence[t] = 0.0;
+        }
+        memset(trends, 0, (size_t)TREND_DFA_NUM_TRENDS * n * sizeof(double));
+        return;
+    }
+
+    /* Slopes straight into the [trend][track] output */
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        const double *sum_y  = STAT(m, TREND_DFA_MULTI_SUM_Y, ch);
+        const double *sum_xy = STAT(m, TREND_DFA_MULTI_SUM_XY, ch);
+        double *slope = &trends[(size_t)ch * n];
+
+        for (t = 0; t < n; t++) {
+            slope[t] = (n_x * sum_xy[t] - sum_x * sum_y[t]) / denom;
+        }
+    }
+
+    /* Per-track decision */
+    weighted = &trends[(size_t)TREND_DFA_NUM_CHANNELS * n];
+    for (t = 0; t < n; t++) {
+        double slope[TREND_DFA_NUM_CHANNELS];
+        double variance, max_variance = 0.0;
+        int anomaly = 0;
+
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            double m2 = STAT(m, TREND_DFA_MULTI_M2, ch)[t];
+            variance = m2 > 0.0 ? m2 / (win - 1) : 0.0;
+            if (ch == 0 || variance > max_variance) max_variance = variance;
+            anomaly |= m->anomaly_count[(size_t)ch * n + t] > 0;
+            slope[ch] = trends[(size_t)ch * n + t];
+        }
+
+        weighted[t] = trend_dfa_weighted_trend(m->params.weight, slope);
+        state[t] = (double)trend_dfa_decide(&m->params, anomaly, max_variance, weighted[t],
+                                            &m->prev_state[t], &m->state_counter[t],
+                                            &confidence[t]);
+    }
+}
+
+#define TREND_DFA_MULTI_KERNEL(suffix, win)                                                \
+    static void trend_dfa_multi_step_##suffix(trend_dfa_multi_t *m,                        \
+                                              const double *const *input, double *state,   \
+                                              double *confidence, double *trends)          \
+    {                                                                                      \
+        trend_dfa_multi_step_n(m, input, state, confidence, trends, (win));                \
+    }
+
+TREND_DFA_MULTI_KERNEL(8, 8)
+TREND_DFA_MULTI_KERNEL(16, 16)
+TREND_DFA_MULTI_KERNEL(32, 32)
+TREND_DFA_MULTI_KERNEL(64, 64)
+TREND_DFA_MULTI_KERNEL(any, m->params.window)
+
+void trend_dfa_multi_step(trend_dfa_multi_t *m, const double *const *input,
+                          double *state, double *confidence, double *trends)
+{
+    switch (m->params.window) {
+    case 8:  trend_dfa_multi_step_8(m, input, state, confidence, trends);   break;
+    case 16: trend_dfa_multi_step_16(m, input, state, confidence, trends);  break;
+    case 32: trend_dfa_multi_step_32(m, input, state, confidence, trends);  break;
+    case 64: trend_dfa_multi_step_64(m, input, state, confidence, trends);  break;
+    default: trend_dfa_multi_step_any(m, input, state, confidence, trends); break;
+    }
+}
@@ -0,0 +1,91 @@
+/* trend_dfa_multi.h - Multi-track trend DFA with structure-of-arrays state
+ *
+ * Advances N independent tracks (one aircraft each) in a single call. All
+ * tracks receive one sample per step, so they share the ring-buffer head and
+ * the per-sample loops run over contiguous track arrays. Per-track results
+ * match N separate trend_dfa_t instances with the same parameters exactly.
+ * Window sizes 8, 16, 32 and 64 step through kernels specialised for that
+ * size: constant slope coefficients, a masked ring index and an unrolled
+ * resync.
+ */
+
+#ifndef TREND_DFA_MULTI_H
+#define TREND_DFA_MULTI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Running statistics kept per channel and track, see trend_window_t */
+#define TREND_DFA_MULTI_SUM_Y     0
+#define TREND_DFA_MULTI_SUM_Y_C   1
+#define TREND_DFA_MULTI_SUM_XY    2
+#define TREND_DFA_MULTI_SUM_XY_C  3
+#define TREND_DFA_MULTI_MEAN      4
+#define TREND_DFA_MULTI_M2        5
+#define TREND_DFA_MULTI_NUM_STATS 6
+
+/* Scalars shared by all tracks */
+#define TREND_DFA_MULTI_CTRL_HEAD         0
+#define TREND_DFA_MULTI_CTRL_SINCE_RESYNC 1
+#define TREND_DFA_MULTI_CTRL_BUFFER_IDX   2
+#define TREND_DFA_MULTI_CTRL_NONFINITE    3   /* steps until the newest NaN/Inf input leaves */
+#define TREND_DFA_MULTI_CTRL_LEN          4
+
+/* Array lengths (in elements) for n tracks and the given window size */
+#define TREND_DFA_MULTI_VALUES_LEN(n, window) ((size_t)TREND_DFA_NUM_CHANNELS * (size_t)(window) * (size_t)(n))
+#define TREND_DFA_MULTI_STATS_LEN(n)  ((size_t)TREND_DFA_MULTI_NUM_STATS * TREND_DFA_NUM_CHANNELS * (size_t)(n))
+#define TREND_DFA_MULTI_COUNTS_LEN(n) ((size_t)TREND_DFA_NUM_CHANNELS * (size_t)(n))
+
+/* The engine only references its arrays, so they can live in Simulink DWork
+ * or in memory from trend_dfa_multi_alloc. params.window must not change
+ * while the arrays are in use; the thresholds and weights may. */
+typedef struct {
+    int      num_tracks;
+    trend_dfa_params_t params;
+    double  *values;         /* [ch][slot][track] sample windows */
+    double  *stats;          /* [stat][ch][track] running sums */
+    int32_t *anomaly_count;  /* [ch][track] out-of-range samples in window */
+    int32_t *prev_state;     /* [track] */
+    int32_t *state_counter;  /* [track] */
+    int32_t *control;        /* TREND_DFA_MULTI_CTRL_* */
+} trend_dfa_multi_t;
+
+/* Function: trend_dfa_multi_alloc ============================================
+ * Abstract:
+ *    Allocate the state arrays for num_tracks tracks with parameters p (NULL
+ *    for the defaults) and initialise them. Returns 0 on success, -1 on
+ *    allocation failure or if trend_dfa_check_params rejects p.
+ */
+int trend_dfa_multi_alloc(trend_dfa_multi_t *m, int num_tracks, const trend_dfa_params_t *p);
+
+/* Release arrays obtained from trend_dfa_multi_alloc */
+void trend_dfa_multi_free(trend_dfa_multi_t *m);
+
+/* Function: trend_dfa_multi_init =============================================
+ * Abstract:
+ *    Reset every track: windows full of zeros, automaton in STATE_STABLE.
+ */
+void trend_dfa_multi_init(trend_dfa_multi_t *m);
+
+/* Function: trend_dfa_multi_step =============================================
+ * Abstract:
+ *    Push one sample per track and channel and evaluate every track.
+ *    input[ch] points to num_tracks samples of channel ch (TREND_DFA_CH_*).
+ *    state and confidence receive num_tracks values; trends receives
+ *    TREND_DFA_NUM_TRENDS * num_tracks values laid out [trend][track], so in
+ *    MATLAB reshape(trends, N, 6) gives one column per trend.
+ */
+void trend_dfa_multi_step(trend_dfa_multi_t *m, const double *const *input,
+                          double *state, double *confidence, double *trends);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_DFA_MULTI_H */
@@ -0,0 +1,232 @@
+/* trend_dfa_q.c - Fixed-point multi-track trend DFA for embedded targets */
+
+#include "trend_dfa_q.h"
+#include "trend_dfa.h"
+#include "trend_dfa_decide.h"
+#include "trend_dfa_f32.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLOT(m, ch, slot, win) (&(m)->values[((size_t)(ch) * (win) + (slot)) * (size_t)(m)->num_tracks])
+
+static int32_t quantise(float y, float scale)
+{
+    float q = y * scale;
+
+    if (isnan(q)) {
+        return 0;
+    }
+    if (q >= (float)TREND_DFA_Q_MAX) {
+        return TREND_DFA_Q_MAX;
+    }
+    if (q <= -(float)TREND_DFA_Q_MAX) {
+        return -TREND_DFA_Q_MAX;
+    }
+    return (int32_t)lrintf(q);
+}
+
+int trend_dfa_q_check_params(const trend_dfa_params_t *p)
+{
+    int ch;
+
+    if (trend_dfa_check_params(p) != 0) {
+        return -1;
+    }
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        if (!(p->anomaly[ch] > 0.0 && p->anomaly[ch] < TREND_DFA_Q_MAX_LIMIT)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int trend_dfa_q_set_params(trend_dfa_q_t *m, const trend_dfa_params_t *p)
+{
+    int ch, exp, frac;
+    float range;
+
+    if (trend_dfa_q_check_params(p) != 0) {
+        return -1;
+    }
+    trend_dfa_params_to_f32(p, &m->params);
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        /* range = f * 2^exp with 0.5 <= f < 1, so range * 2^(23 - exp) is
+         * just below 2^23 and may still round past TREND_DFA_Q_MAX */
+        range = 2.0f * m->params.anomaly[ch];
+        frexpf(range, &exp);
+        frac = TREND_DFA_Q_BITS - exp;
+        if (ldexpf(range, frac) > (float)TREND_DFA_Q_MAX) {
+            frac--;
+        }
+        if (frac > 30) {
+            frac = 30;
+        }
+        m->frac_bits[ch] = frac;
+        m->limit[ch] = (int32_t)floorf(ldexpf(m->params.anomaly[ch], frac));
+    }
+    return 0;
+}
+
+int trend_dfa_q_alloc(trend_dfa_q_t *m, int num_tracks, const trend_dfa_params_t *p)
+{
+    trend_dfa_params_t defaults;
+
+    memset(m, 0, sizeof(*m));
+    if (p == NULL) {
+        trend_dfa_default_params(&defaults);
+        p = &defaults;
+    }
+    if (trend_dfa_q_set_params(m, p) != 0 || num_tracks <= 0) {
+        return -1;
+    }
+
+    m->num_tracks    = num_tracks;
+    m->values        = (int32_t *)malloc(TREND_DFA_Q_VALUES_LEN(num_tracks, p->window) *
+                                         sizeof(int32_t));
+    m->prev_state    = (int32_t *)malloc((size_t)num_tracks * sizeof(int32_t));
+    m->state_counter = (int32_t *)malloc((size_t)num_tracks * sizeof(int32_t));
+    m->control       = (int32_t *)malloc(TREND_DFA_Q_CTRL_LEN * sizeof(int32_t));
+
+    if (!m->values || !m->prev_state || !m->state_counter || !m->control) {
+        trend_dfa_q_free(m);
+        return -1;
+    }
+
+    trend_dfa_q_init(m);
+    return 0;
+}
+
+void trend_dfa_q_free(trend_dfa_q_t *m)
+{
+    free(m->values);
+    free(m->prev_state);
+    free(m->state_counter);
+    free(m->control);
+    memset(m, 0, sizeof(*m));
+}
+
+void trend_dfa_q_init(trend_dfa_q_t *m)
+{
+    const int n = m->num_tracks;
+    int t;
+
+    memset(m->values, 0, TREND_DFA_Q_VALUES_LEN(n, m->params.window) * sizeof(int32_t));
+    for (t = 0; t < n; t++) {
+        m->prev_state[t] = STATE_STABLE;
+        m->state_counter[t] = 0;
+    }
+    for (t = 0; t < TREND_DFA_Q_CTRL_LEN; t++) {
+        m->control[t] = 0;
+    }
+}
+
+/* Slope, variance and anomaly flag of one channel of one track, from exact
+ * integer sums against x = 0..win-1 */
+static void window_stats(const trend_dfa_q_t *m, int track, int ch,
+                         float *slope, float *variance, int *anomaly)
+{
+    const size_t n = (size_t)m->num_tracks;
+    const int win = m->params.window;
+    const int32_t limit = m->limit[ch];
+    const float scale = ldexpf(1.0f, m->frac_bits[ch]);
+    const int32_t *v = SLOT(m, ch, 0, win) + track;
+    const int head = m->control[TREND_DFA_Q_CTRL_HEAD];
+    const int64_t w = win;
+    int64_t sum_q = 0, sum_xq = 0, sum_q2 = 0, num;
+    int i, x = 0, out = 0;
+
+    /* Oldest to newest: slots head..win-1, then 0..head-1 */
+    for (i = head; i < win; i++, x++) {
+        sum_xq += (int64_t)x * v[i * n];
+    }
+    for (i = 0; i < head; i++, x++) {
+        sum_xq += (int64_t)x * v[i * n];
+    }
+    for (i = 0; i < win; i++) {
+        int32_t q = v[i * n];
+        sum_q += q;
+        sum_q2 += (int64_t)q * q;
+        out |= q > limit || q < -limit;
+    }
+
+    num = w * sum_xq - w * (w - 1) / 2 * sum_q;
+    *slope = (float)num / ((float)(w * w * (w * w - 1) / 12) * scale);
+    num = w * sum_q2 - sum_q * sum_q;
+    *variance = (float)num / ((float)(w * (w - 1)) * scale * scale);
+    *anomaly = out;
+}
+
+float trend_dfa_q_slope(const trend_dfa_q_t *m, int track, int ch)
+{
+    float slope, variance;
+    int anomaly;
+
+    window_stats(m, track, ch, &slope, &variance, &anomaly);
+    return slope;
+}
+
+float trend_dfa_q_variance(const trend_dfa_q_t *m, int track, int ch)
+{
+    float slope, variance;
+    int anomaly;
+
+    window_stats(m, track, ch, &slope, &variance, &anomaly);
+    return variance;
+}
+
+void trend_dfa_q_step(trend_dfa_q_t *m, const float *const *input,
+                      float *state, float *confidence, float *trends)
+{
+    const int n = m->num_tracks;
+    const int win = m->params.window;
+    int32_t *control = m->control;
+    int head = control[TREND_DFA_Q_CTRL_HEAD];
+    float *weighted;
+    int ch, t;
+
+    /* Add new values over the oldest ones */
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        const float scale = ldexpf(1.0f, m->frac_bits[ch]);
+        int32_t *slot = SLOT(m, ch, head, win);
+        for (t = 0; t < n; t++) {
+            slot[t] = quantise(input[ch][t], scale);
+        }
+    }
+    control[TREND_DFA_Q_CTRL_HEAD] = head + 1 == win ? 0 : head + 1;
+
+    if (control[TREND_DFA_Q_CTRL_BUFFER_IDX] < win) {
+        control[TREND_DFA_Q_CTRL_BUFFER_IDX]++;
+    }
+
+    if (control[TREND_DFA_Q_CTRL_BUFFER_IDX] < win) {
+        /* Initial values */
+        for (t = 0; t < n; t++) {
+            state[t] = (float)STATE_STABLE;
+            confidence[t] = 0.0f;
+        }
+        memset(trends, 0, (size_t)TREND_DFA_NUM_TRENDS * n * sizeof(float));
+        return;
+    }
+
+    weighted = &trends[(size_t)TREND_DFA_NUM_CHANNELS * n];
+    for (t = 0; t < n; t++) {
+        float slope[TREND_DFA_NUM_CHANNELS];
+        float variance, max_variance = 0.0f;
+        int anomaly = 0, out;
+
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            window_stats(m, t, ch, &slope[ch], &variance, &out);
+            if (ch == 0 || variance > max_variance) max_variance = variance;
+            anomaly |= out;
+            trends[(size_t)ch * n + t] = slope[ch];
+        }
+
+        weighted[t] = trend_dfa_weighted_trend_f32(m->params.weight, slope);
+        state[t] = (float)trend_dfa_decide_f32(&m->params, anomaly, max_variance, weighted[t],
+                                               &m->prev_state[t], &m->state_counter[t],
+                                               &confidence[t]);
+    }
+}
@@ -0,0 +1,118 @@
+/* trend_dfa_q.h - Fixed-point multi-track trend DFA for embedded targets
+ *
+ * Layout and interface of trend_dfa_f32.h, with every sample stored as a
+ * signed Q-format int32_t. Each channel has its own format: the most
+ * fractional bits for which twice the channel's anomaly limit still fits in
+ * TREND_DFA_Q_BITS bits, which with the default limits gives velocity Q10.13,
+ * altitude Q17.6, latitude Q8.15, longitude Q9.14 and vertical rate Q11.12.
+ * Larger samples saturate; they are anomalies in any case. NaN samples read
+ * as zero. Memory is that of the float32 DFA, 208 bytes per aircraft for a
+ * window of 10.
+ *
+ * With |q| < 2^23 and at most 256 samples, sum(q), sum(i * q), sum(q^2) and
+ * the slope and variance numerators built from them are exact in int64_t.
+ * The only floating-point operations are the conversion of the inputs and
+ * the final scaling of slope and variance.
+ *
+ * Error against the double DFA (trend_dfa.h), with A as in trend_dfa_f32.h
+ * and e = 2^-frac_bits (one rounding to float, one to the Q grid):
+ *    slope     |error| <= A * e + 2^-22 * |slope|
+ *    variance  |error| <= (2e * sum|y - mean(y)| + n * e^2) / (n - 1)
+ *                         + 2^-22 * variance
+ * For the default limits e is 1.2e-4 m/s, 1.6e-2 m, 3.1e-5 and 6.1e-5
+ * degrees and 2.4e-4 m/s. The bounds hold for windows without saturated
+ * samples; anomaly flags differ only for samples within e of their limit.
+ */
+
+#ifndef TREND_DFA_Q_H
+#define TREND_DFA_Q_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Magnitude bits of a stored sample, sign excluded */
+#define TREND_DFA_Q_BITS 23
+#define TREND_DFA_Q_MAX  ((int32_t)((1L << TREND_DFA_Q_BITS) - 1))
+
+/* Anomaly limits must be positive and below this, so that the formats keep
+ * at least one fractional bit */
+#define TREND_DFA_Q_MAX_LIMIT 4194304.0   /* 2^22 */
+
+/* Scalars shared by all tracks */
+#define TREND_DFA_Q_CTRL_HEAD       0
+#define TREND_DFA_Q_CTRL_BUFFER_IDX 1
+#define TREND_DFA_Q_CTRL_LEN        2
+
+/* Sample array length (in elements) for n tracks and the given window size */
+#define TREND_DFA_Q_VALUES_LEN(n, window) ((size_t)TREND_DFA_NUM_CHANNELS * (size_t)(window) * (size_t)(n))
+
+/* params.window must not change while the arrays are in use. frac_bits and
+ * limit follow from params.anomaly, see trend_dfa_q_set_params. */
+typedef struct {
+    int      num_tracks;
+    trend_dfa_params_f32_t params;
+    int      frac_bits[TREND_DFA_NUM_CHANNELS];
+    int32_t  limit[TREND_DFA_NUM_CHANNELS];  /* anomaly limits in the stored format */
+    int32_t *values;         /* [ch][slot][track] sample windows */
+    int32_t *prev_state;     /* [track] */
+    int32_t *state_counter;  /* [track] */
+    int32_t *control;        /* TREND_DFA_Q_CTRL_* */
+} trend_dfa_q_t;
+
+/* Function: trend_dfa_q_check_params =========================================
+ * Abstract:
+ *    As trend_dfa_check_params, and every anomaly limit must be in
+ *    (0, TREND_DFA_Q_MAX_LIMIT). Returns 0 or -1.
+ */
+int trend_dfa_q_check_params(const trend_dfa_params_t *p);
+
+/* Function: trend_dfa_q_set_params ===========================================
+ * Abstract:
+ *    Take thresholds and weights from p and derive the sample formats from
+ *    its anomaly limits. Stored samples are not converted, so on a running
+ *    DFA the limits must stay as they were. Returns 0, or -1 (m untouched)
+ *    if trend_dfa_q_check_params rejects p.
+ */
+int trend_dfa_q_set_params(trend_dfa_q_t *m, const trend_dfa_params_t *p);
+
+/* Function: trend_dfa_q_alloc ================================================
+ * Abstract:
+ *    Allocate the state arrays for num_tracks tracks with parameters p (NULL
+ *    for the defaults) and initialise them. Returns 0 on success, -1 on
+ *    allocation failure or if trend_dfa_q_check_params rejects p.
+ */
+int trend_dfa_q_alloc(trend_dfa_q_t *m, int num_tracks, const trend_dfa_params_t *p);
+
+/* Release arrays obtained from trend_dfa_q_alloc */
+void trend_dfa_q_free(trend_dfa_q_t *m);
+
+/* Function: trend_dfa_q_init =================================================
+ * Abstract:
+ *    Reset every track: windows full of zeros, automaton in STATE_STABLE.
+ */
+void trend_dfa_q_init(trend_dfa_q_t *m);
+
+/* Function: trend_dfa_q_step =================================================
+ * Abstract:
+ *    Quantise one sample per track and channel, push it and evaluate every
+ *    track. Layout as trend_dfa_f32_step.
+ */
+void trend_dfa_q_step(trend_dfa_q_t *m, const float *const *input,
+                      float *state, float *confidence, float *trends);
+
+/* Slope and sample variance of channel ch of one track over the current
+ * window (unfilled slots count as zeros) */
+float trend_dfa_q_slope(const trend_dfa_q_t *m, int track, int ch);
+float trend_dfa_q_variance(const trend_dfa_q_t *m, int track, int ch);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_DFA_Q_H */
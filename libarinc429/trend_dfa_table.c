@@ -0,0 +1,49 @@
+/* trend_dfa_table.c - Table-driven state transitions of the flight trend DFA */
+
+#include "trend_dfa_table.h"
+
+/* Every feature class but AMBIGUOUS votes for one state whatever the current
+ * state; AMBIGUOUS keeps the current state */
+const int8_t trend_dfa_transition[TREND_DFA_NUM_FEATURES][TREND_DFA_NUM_STATES] = {
+    /* from:  STABLE             INCREASING         DECREASING         OSCILLATING        ANOMALY */
+    /* ANOMALY */
+    {  STATE_ANOMALY,     STATE_ANOMALY,     STATE_ANOMALY,     STATE_ANOMALY,     STATE_ANOMALY     },
+    /* HIGH_VARIANCE */
+    {  STATE_OSCILLATING, STATE_OSCILLATING, STATE_OSCILLATING, STATE_OSCILLATING, STATE_OSCILLATING },
+    /* UP */
+    {  STATE_INCREASING,  STATE_INCREASING,  STATE_INCREASING,  STATE_INCREASING,  STATE_INCREASING  },
+    /* DOWN */
+    {  STATE_DECREASING,  STATE_DECREASING,  STATE_DECREASING,  STATE_DECREASING,  STATE_DECREASING  },
+    /* FLAT */
+    {  STATE_STABLE,      STATE_STABLE,      STATE_STABLE,      STATE_STABLE,      STATE_STABLE      },
+    /* AMBIGUOUS */
+    {  STATE_STABLE,      STATE_INCREASING,  STATE_DECREASING,  STATE_OSCILLATING, STATE_ANOMALY     },
+};
+
+/* A state is reported once it has been seen twice in a row; ANOMALY at once */
+const int8_t trend_dfa_hold[TREND_DFA_NUM_STATES] = {
+    2,      /* STABLE */
+    2,      /* INCREASING */
+    2,      /* DECREASING */
+    2,      /* OSCILLATING */
+    1       /* ANOMALY */
+};
+
+const double trend_dfa_feature_confidence[TREND_DFA_NUM_FEATURES] = {
+    0.95,   /* ANOMALY */
+    0.8,    /* HIGH_VARIANCE */
+    0.85,   /* UP */
+    0.85,   /* DOWN */
+    0.9,    /* FLAT */
+    0.6     /* AMBIGUOUS */
+};
+
+/* The same values for the single-precision DFAs */
+const float trend_dfa_feature_confidence_f32[TREND_DFA_NUM_FEATURES] = {
+    0.95f,  /* ANOMALY */
+    0.8f,   /* HIGH_VARIANCE */
+    0.85f,  /* UP */
+    0.85f,  /* DOWN */
+    0.9f,   /* FLAT */
+    0.6f    /* AMBIGUOUS */
+};
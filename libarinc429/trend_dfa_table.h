@@ -0,0 +1,103 @@
+/* trend_dfa_table.h - Table-driven state transitions of the flight trend DFA
+ *
+ * Each evaluated window is reduced to one feature class: the first of
+ * anomaly, high variance, rising, falling and flat whose test holds, else
+ * ambiguous. trend_dfa_transition then gives, for a feature class and the
+ * current state, the state the window votes for, and trend_dfa_hold how
+ * many consecutive votes that state needs before it is reported. The
+ * confidence depends on the feature class alone.
+ *
+ * Control flow does not depend on the states, so a new state (say a climb
+ * or descent phase) only needs a row in the tables and a feature class that
+ * leads to it.
+ */
+
+#ifndef TREND_DFA_TABLE_H
+#define TREND_DFA_TABLE_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Feature classes, in decision priority order */
+#define TREND_DFA_FEAT_ANOMALY       0   /* a sample beyond its anomaly limit */
+#define TREND_DFA_FEAT_HIGH_VARIANCE 1   /* max variance > oscillation */
+#define TREND_DFA_FEAT_UP            2   /* weighted trend > increase */
+#define TREND_DFA_FEAT_DOWN          3   /* weighted trend < decrease */
+#define TREND_DFA_FEAT_FLAT          4   /* |weighted trend| <= stable */
+#define TREND_DFA_FEAT_AMBIGUOUS     5   /* none of the above */
+#define TREND_DFA_NUM_FEATURES       6
+
+/* [feature][state - STATE_STABLE]: the state this window votes for */
+extern const int8_t trend_dfa_transition[TREND_DFA_NUM_FEATURES][TREND_DFA_NUM_STATES];
+
+/* [state - STATE_STABLE]: consecutive votes before the state is reported */
+extern const int8_t trend_dfa_hold[TREND_DFA_NUM_STATES];
+
+/* [feature]: confidence reported with the window */
+extern const double trend_dfa_feature_confidence[TREND_DFA_NUM_FEATURES];
+extern const float trend_dfa_feature_confidence_f32[TREND_DFA_NUM_FEATURES];
+
+/* Function: trend_dfa_feature ================================================
+ * Abstract:
+ *    Feature class of one evaluated window for the thresholds of p. The
+ *    tests are applied lowest priority first as selects, which compile to
+ *    conditional moves rather than branches on the data. A NaN trend or
+ *    variance fails its tests, as in the original if/else cascade.
+ */
+static inline int trend_dfa_feature(const trend_dfa_params_t *p, int anomaly, double max_variance,
+                                    double weighted_trend)
+{
+    int feature = TREND_DFA_FEAT_AMBIGUOUS;
+
+    feature = fabs(weighted_trend) <= p->stable ? TREND_DFA_FEAT_FLAT : feature;
+    feature = weighted_trend < p->decrease ? TREND_DFA_FEAT_DOWN : feature;
+    feature = weighted_trend > p->increase ? TREND_DFA_FEAT_UP : feature;
+    feature = max_variance > p->oscillation ? TREND_DFA_FEAT_HIGH_VARIANCE : feature;
+    feature = anomaly ? TREND_DFA_FEAT_ANOMALY : feature;
+    return feature;
+}
+
+/* trend_dfa_feature in single precision, for the float32 and fixed-point DFAs */
+static inline int trend_dfa_feature_f32(const trend_dfa_params_f32_t *p, int anomaly,
+                                        float max_variance, float weighted_trend)
+{
+    int feature = TREND_DFA_FEAT_AMBIGUOUS;
+
+    feature = fabsf(weighted_trend) <= p->stable ? TREND_DFA_FEAT_FLAT : feature;
+    feature = weighted_trend < p->decrease ? TREND_DFA_FEAT_DOWN : feature;
+    feature = weighted_trend > p->increase ? TREND_DFA_FEAT_UP : feature;
+    feature = max_variance > p->oscillation ? TREND_DFA_FEAT_HIGH_VARIANCE : feature;
+    feature = anomaly ? TREND_DFA_FEAT_ANOMALY : feature;
+    return feature;
+}
+
+/* Function: trend_dfa_transition_step ========================================
+ * Abstract:
+ *    Advance one automaton by a window of the given feature class.
+ *    prev_state is the reported state and state_counter the number of
+ *    consecutive windows that voted for it; both are updated in place.
+ *    Returns the state reported for this step.
+ */
+static inline int trend_dfa_transition_step(int feature, int32_t *prev_state,
+                                            int32_t *state_counter)
+{
+    int from = *prev_state;
+    int to = trend_dfa_transition[feature][from - STATE_STABLE];
+    int32_t count = to == from ? *state_counter + 1 : 1;
+
+    *state_counter = count;
+    *prev_state = count >= trend_dfa_hold[to - STATE_STABLE] ? to : from;
+    return *prev_state;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_DFA_TABLE_H */
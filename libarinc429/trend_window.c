@@ -0,0 +1,148 @@
+/* trend_window.c - O(1) sliding window statistics for the trend DFA */
+
+#include "trend_window.h"
+
+#include <math.h>
+
+/* The bodies below take the window size as an argument. The specialised
+ * instances pass a literal, so after inlining the divisions by n become
+ * multiplications (exact for powers of two), the ring index wraps with a
+ * mask and the resync loops have a constant trip count and are unrolled.
+ * The generic instance passes w->size; both give identical results. */
+
+/* Recompute every running statistic from the stored samples */
+TREND_WINDOW_INLINE void trend_window_resync_n(trend_window_t *w, const int n)
+{
+    double sum_y = 0.0, sum_xy = 0.0, mean, m2 = 0.0;
+    int i, idx;
+
+    idx = w->head;
+    for (i = 0; i < n; i++) {
+        sum_y += w->values[idx];
+        sum_xy += (double)(i + 1) * w->values[idx];
+        idx = trend_window_next(idx, n);
+    }
+    mean = sum_y / n;
+    for (i = 0; i < n; i++) {
+        m2 += (w->values[i] - mean) * (w->values[i] - mean);
+    }
+
+    w->sum_y = sum_y;
+    w->sum_y_c = 0.0;
+    w->sum_xy = sum_xy;
+    w->sum_xy_c = 0.0;
+    w->mean = mean;
+    w->m2 = m2;
+    w->since_resync = 0;
+}
+
+TREND_WINDOW_INLINE void trend_window_push_n(trend_window_t *w, double y, const int n)
+{
+    double y_old = w->values[w->head];
+    double delta = y - y_old;
+    double old_mean = w->mean;
+
+    w->values[w->head] = y;
+    w->head = trend_window_next(w->head, n);
+
+    /* Every remaining sample moves one position towards x = 1, which takes
+     * sum_y (including y_old at x = 1) off sum_xy; the new sample enters at x = n. */
+    trend_window_kahan_add(&w->sum_xy, &w->sum_xy_c, (double)n * y - w->sum_y);
+    trend_window_kahan_add(&w->sum_y, &w->sum_y_c, delta);
+
+    /* Welford update for replacing y_old by y */
+    w->mean = old_mean + delta / (double)n;
+    w->m2 += delta * ((y - w->mean) + (y_old - old_mean));
+
+    if (fabs(y_old) > w->anomaly_threshold) w->anomaly_count--;
+    if (fabs(y) > w->anomaly_threshold) w->anomaly_count++;
+
+    /* Rebuild the sums poisoned by a NaN/Inf as soon as it has left */
+    if (w->nonfinite_left > 0 && --w->nonfinite_left == 0) {
+        trend_window_resync_n(w, n);
+    } else if (++w->since_resync >= TREND_WINDOW_RESYNC_PERIOD && w->since_resync >= n) {
+        trend_window_resync_n(w, n);
+    }
+    if (!isfinite(y)) {
+        w->nonfinite_left = n;
+    }
+}
+
+/* One push and one all-channel push per window size */
+#define TREND_WINDOW_KERNEL(suffix, n)                                                    \
+    static void trend_window_push_##suffix(trend_window_t *w, double y)                  \
+    {                                                                                     \
+        trend_window_push_n(w, y, (n));                                                   \
+    }                                                                                     \
+    static void trend_window_push_channels_##suffix(trend_window_t *w, const double *y)  \
+    {                                                                                     \
+        int ch;                                                                           \
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {                                 \
+            trend_window_push_n(&w[ch], y[ch], (n));                                      \
+        }                                                                                 \
+    }
+
+TREND_WINDOW_KERNEL(8, 8)
+TREND_WINDOW_KERNEL(16, 16)
+TREND_WINDOW_KERNEL(32, 32)
+TREND_WINDOW_KERNEL(64, 64)
+TREND_WINDOW_KERNEL(any, w->size)
+
+void trend_window_init(trend_window_t *w, int size, double anomaly_threshold)
+{
+    int i;
+
+    for (i = 0; i < size; i++) {
+        w->values[i] = 0.0;
+    }
+    w->size = size;
+    w->head = 0;
+    w->since_resync = 0;
+    w->sum_y = 0.0;
+    w->sum_y_c = 0.0;
+    w->sum_xy = 0.0;
+    w->sum_xy_c = 0.0;
+    w->mean = 0.0;
+    w->m2 = 0.0;
+    w->anomaly_threshold = anomaly_threshold;
+    w->anomaly_count = 0;
+    w->nonfinite_left = 0;
+}
+
+void trend_window_push(trend_window_t *w, double y)
+{
+    switch (w->size) {
+    case 8:  trend_window_push_8(w, y);   break;
+    case 16: trend_window_push_16(w, y);  break;
+    case 32: trend_window_push_32(w, y);  break;
+    case 64: trend_window_push_64(w, y);  break;
+    default: trend_window_push_any(w, y); break;
+    }
+}
+
+void trend_window_push_channels(trend_window_t *w, const double *y)
+{
+    switch (w->size) {
+    case 8:  trend_window_push_channels_8(w, y);   break;
+    case 16: trend_window_push_channels_16(w, y);  break;
+    case 32: trend_window_push_channels_32(w, y);  break;
+    case 64: trend_window_push_channels_64(w, y);  break;
+    default: trend_window_push_channels_any(w, y); break;
+    }
+}
+
+double trend_window_slope(const trend_window_t *w)
+{
+    double denom = trend_window_denom(w->size);
+
+    if (fabs(denom) < 1e-10) {
+        return 0.0;
+    }
+    return ((double)w->size * w->sum_xy - trend_window_sum_x(w->size) * w->sum_y) / denom;
+}
+
+double trend_window_variance(const trend_window_t *w)
+{
+    /* Incremental M2 can dip just below zero for a constant window */
+    return w->m2 > 0.0 ? w->m2 / (w->size - 1) : 0.0;
+}
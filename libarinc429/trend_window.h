@@ -0,0 +1,130 @@
+/* trend_window.h - O(1) sliding window statistics for the trend DFA */
+
+#ifndef TREND_WINDOW_H
+#define TREND_WINDOW_H
+
+#include "trend_dfa_config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Full recompute of the running sums every this many samples (or every
+ * window length if larger), which keeps the per-step cost amortised O(1)
+ * while bounding floating-point drift on long replays. */
+#define TREND_WINDOW_RESYNC_PERIOD 1024
+
+/* Kernels specialised on the window size are written once as an inline body
+ * taking the size as an argument and instantiated with literal sizes; this
+ * makes sure the body is inlined, so the literal is folded in */
+#if defined(__GNUC__)
+#define TREND_WINDOW_INLINE static inline __attribute__((always_inline))
+#elif defined(_MSC_VER)
+#define TREND_WINDOW_INLINE static __forceinline
+#else
+#define TREND_WINDOW_INLINE static inline
+#endif
+
+/* x = 1..n is fixed, so its sums only depend on the window size */
+static inline double trend_window_sum_x(int n)
+{
+    return (double)n * ((double)n + 1.0) / 2.0;
+}
+
+static inline double trend_window_denom(int n)
+{
+    double sum_x2 = (double)n * ((double)n + 1.0) * (2.0 * (double)n + 1.0) / 6.0;
+    return (double)n * sum_x2 - trend_window_sum_x(n) * trend_window_sum_x(n);
+}
+
+/* Ring buffer over the last size samples of one channel, size between
+ * TREND_DFA_MIN_WINDOW and TREND_DFA_MAX_WINDOW.
+ *
+ * The window starts out full of zeros, exactly like the zero-initialised
+ * RWork buffers of the original block, so every push replaces the oldest
+ * sample and the sums below always describe size values. Sample positions
+ * are x = 1..size from oldest to newest.
+ *
+ * Tolerance: slope and variance are not bit-identical to the two-pass
+ * reference (calculate_slope/calculate_variance) because the sums are
+ * updated incrementally. Measured against the reference over 5e6 samples
+ * of altitude-scale data, including step changes between flights, the
+ * absolute error stays below 1e-13 * max|y| for the slope and
+ * 1e-14 * max|y|^2 for the variance, max|y| taken over the whole replay
+ * (arinc429_dfa_precision checks both). This only matters
+ * for windows sitting exactly on a DFA threshold.
+ *
+ * A NaN or infinite sample makes the running sums non-finite, and no
+ * incremental update can take it out again. The window therefore counts
+ * down the pushes until its newest non-finite sample has left and then
+ * recomputes the sums, so slope and variance are finite again exactly when
+ * the two-pass formulas would be. */
+typedef struct {
+    double values[TREND_DFA_MAX_WINDOW];
+    int    size;
+    int    head;            /* index of the oldest sample */
+    int    since_resync;
+    double sum_y;           /* sum of y, Kahan compensated */
+    double sum_y_c;
+    double sum_xy;          /* sum of x*y, Kahan compensated */
+    double sum_xy_c;
+    double mean;            /* Welford running mean / M2 */
+    double m2;
+    double anomaly_threshold;
+    int    anomaly_count;   /* samples in window with |y| > anomaly_threshold */
+    int    nonfinite_left;  /* pushes until the newest NaN/Inf sample leaves, or 0 */
+} trend_window_t;
+
+/* Ring index after i; a mask for power-of-two n known at compile time */
+TREND_WINDOW_INLINE int trend_window_next(int i, const int n)
+{
+    return (n & (n - 1)) == 0 ? (i + 1) & (n - 1) : (i + 1 == n ? 0 : i + 1);
+}
+
+/* Kahan-compensated accumulation of delta into *sum */
+static inline void trend_window_kahan_add(double *sum, double *comp, double delta)
+{
+    double y = delta - *comp;
+    double t = *sum + y;
+    *comp = (t - *sum) - y;
+    *sum = t;
+}
+
+/* Function: trend_window_init ================================================
+ * Abstract:
+ *    Fill a window of size samples (TREND_DFA_MIN_WINDOW..TREND_DFA_MAX_WINDOW,
+ *    not checked here) with zeros. Samples with |y| > anomaly_threshold are
+ *    counted while they are inside the window.
+ */
+void trend_window_init(trend_window_t *w, int size, double anomaly_threshold);
+
+/* Function: trend_window_push ================================================
+ * Abstract:
+ *    Replace the oldest sample with y and update all running statistics.
+ *    Window sizes 8, 16, 32 and 64 run a kernel specialised for that size
+ *    (constant divisors, masked ring index, unrolled resync); other sizes
+ *    take the generic path with the same results.
+ */
+void trend_window_push(trend_window_t *w, double y);
+
+/* Push y[ch] into w[ch] for all TREND_DFA_NUM_CHANNELS windows, which must
+ * have the same size; the size is dispatched once for all of them */
+void trend_window_push_channels(trend_window_t *w, const double *y);
+
+/* Least-squares slope of y against x = 1..size */
+double trend_window_slope(const trend_window_t *w);
+
+/* Sample variance (n - 1 denominator) */
+double trend_window_variance(const trend_window_t *w);
+
+/* Non-zero if any sample in the window exceeds the anomaly threshold */
+static inline int trend_window_has_anomaly(const trend_window_t *w)
+{
+    return w->anomaly_count > 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TREND_WINDOW_H */
@@ -0,0 +1,950 @@
+/* arinc429_bench.c - Micro- and macro-benchmarks for the codec, label and DFA kernels
+ *
+ * Label bit reversal (the loop of arinc_label_sfunction.c against a lookup
+ * table and a swap network), BCD encode/decode per word and per batch with
+ * every batch kernel the CPU supports, one trend DFA step in double, float32
+ * and fixed point and across 64 tracks, the DFA behind a 16:1 decimator
+ * (per input row), the full parallel replay of a
+ * synthetic multi-flight dump (parse and DFA), and SQLite insert throughput.
+ *
+ * Each benchmark is repeated, doubling the count, until one measurement
+ * lasts -t seconds; it is then measured -r times and the fastest run is
+ * reported as ns per item and items per second. On Linux, cycles,
+ * instructions and cache misses are counted through perf_event_open where
+ * the kernel allows user-space counting (perf_event_paranoid <= 2) and are
+ * reported per item; otherwise they are null. -j writes the results as JSON
+ * so runs can be compared over time.
+ */
+
+#define _GNU_SOURCE
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/utsname.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include "arinc429_bcd.h"
+#include "arinc429_bcd_batch.h"
+#include "arinc429_gen.h"
+#include "arinc429_label.h"
+#include "trend_decim.h"
+#include "trend_dfa.h"
+#include "trend_dfa_f32.h"
+#include "trend_dfa_multi.h"
+#include "trend_dfa_q.h"
+#if ARINC429_HAVE_FLEET
+#include "flight_fleet.h"
+#endif
+#if ARINC429_HAVE_SQLITE
+#include "arinc_db.h"
+#endif
+
+#define BATCH        4096   /* words, values or DFA rows per repetition */
+#define MULTI_TRACKS 64
+#define DECIM_RATIO  16
+
+/* ------------------------------------------------------------------------ */
+/* Hardware counters */
+
+#define NUM_COUNTERS 3
+
+static const char *const counter_name[NUM_COUNTERS] = { "cycles", "instructions", "cache_misses" };
+
+typedef struct {
+    int      fd[NUM_COUNTERS];
+    uint64_t value[NUM_COUNTERS];
+    int      valid[NUM_COUNTERS];
+} counters_t;
+
+static void counters_open(counters_t *c)
+{
+    int i;
+
+    for (i = 0; i < NUM_COUNTERS; i++) {
+        c->fd[i] = -1;
+    }
+#ifdef __linux__
+    {
+        static const uint64_t config[NUM_COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+        };
+        struct perf_event_attr attr;
+
+        for (i = 0; i < NUM_COUNTERS; i++) {
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = config[i];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1;       /* include the replay worker threads */
+            c->fd[i] = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+    }
+#endif
+}
+
+static void counters_close(counters_t *c)
+{
+    int i;
+
+    for (i = 0; i < NUM_COUNTERS; i++) {
+        if (c->fd[i] >= 0) {
+            close(c->fd[i]);
+        }
+    }
+}
+
+static void counters_start(counters_t *c)
+{
+#ifdef __linux__
+    int i;
+
+    for (i = 0; i < NUM_COUNTERS; i++) {
+        if (c->fd[i] >= 0) {
+            ioctl(c->fd[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(c->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#else
+    (void)c;
+#endif
+}
+
+static void counters_stop(counters_t *c)
+{
+    int i;
+
+    for (i = 0; i < NUM_COUNTERS; i++) {
+        c->valid[i] = 0;
+#ifdef __linux__
+        if (c->fd[i] >= 0) {
+            ioctl(c->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+            c->valid[i] = read(c->fd[i], &c->value[i], sizeof(c->value[i])) == sizeof(c->value[i]);
+        }
+#endif
+    }
+}
+
+/* ------------------------------------------------------------------------ */
+/* Benchmark data */
+
+typedef struct {
+    uint8_t  label[256];
+    double   value[BATCH];
+    uint32_t word[BATCH];
+    double   decoded[BATCH];
+    int8_t   status[BATCH];
+    double  *row[TREND_DFA_NUM_CHANNELS];       /* [ch][BATCH] flight samples */
+    float   *row_f[TREND_DFA_NUM_CHANNELS];
+    trend_dfa_t dfa;
+    trend_dfa_f32_t dfa_f32;
+    trend_dfa_q_t dfa_q;
+    trend_dfa_multi_t multi;
+    trend_decim_t decim;
+    double  *multi_in;                          /* [ch][track] */
+    double  *multi_out;                         /* state, confidence, trends */
+    const char *csv_path;
+    int      flights;
+    int      rows_per_flight;
+    int      threads;
+#if ARINC429_HAVE_FLEET
+    flight_fleet_t fleet;
+    int      fleet_loaded;
+#endif
+#if ARINC429_HAVE_SQLITE
+    char     db_path[64];
+    arinc_db_t *db;
+#endif
+} bench_data_t;
+
+static volatile uint64_t sink;
+
+/* xorshift64* */
+static uint64_t next_random(uint64_t *s)
+{
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return *s * 2685821657736338717ULL;
+}
+
+static double next_unit(uint64_t *s)
+{
+    return (double)(next_random(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* One synthetic 1 Hz flight: climb, cruise, descent. k is the row within
+ * the flight, out receives the five channels. */
+typedef struct {
+    double alt, vel, lat, lon, heading;
+    uint64_t seed;
+} synth_flight_t;
+
+static void synth_init(synth_flight_t *f, int index)
+{
+    f->seed = 0x9e3779b97f4a7c15ULL * (uint64_t)(index + 1);
+    f->alt = 300.0;
+    f->vel = 80.0;
+    f->lat = 35.0 + 20.0 * next_unit(&f->seed);
+    f->lon = -120.0 + 150.0 * next_unit(&f->seed);
+    f->heading = 6.283 * next_unit(&f->seed);
+}
+
+static void synth_step(synth_flight_t *f, int k, int rows, double *out)
+{
+    double phase = (double)k / (double)rows, noise = next_unit(&f->seed) - 0.5, vrate;
+
+    if (phase < 0.2) {
+        vrate = 12.0 + 4.0 * noise;
+        f->vel += 0.1;
+    } else if (phase < 0.75) {
+        vrate = 3.0 * noise;
+        f->vel += 0.5 * noise;
+    } else {
+        vrate = -8.0 + 4.0 * noise;
+        f->vel -= 0.05;
+    }
+    f->alt += vrate;
+    f->heading += 0.004 * noise;
+    f->lat += f->vel * cos(f->heading) * 9e-6;
+    f->lon += f->vel * sin(f->heading) * 1.3e-5;
+
+    out[TREND_DFA_CH_VELOCITY] = f->vel;
+    out[TREND_DFA_CH_BAROALT] = f->alt;
+    out[TREND_DFA_CH_LAT] = f->lat;
+    out[TREND_DFA_CH_LON] = f->lon;
+    out[TREND_DFA_CH_VERTRATE] = vrate;
+}
+
+/* OpenSky-style dump: one row per aircraft and second, aircraft interleaved */
+static int write_fleet_csv(const char *path, int flights, int rows)
+{
+    synth_flight_t *f = (synth_flight_t *)malloc((size_t)flights * sizeof(*f));
+    double s[TREND_DFA_NUM_CHANNELS];
+    FILE *fp = fopen(path, "w");
+    int i, k;
+
+    if (f == NULL || fp == NULL) {
+        free(f);
+        if (fp != NULL) fclose(fp);
+        return -1;
+    }
+    for (i = 0; i < flights; i++) {
+        synth_init(&f[i], i);
+    }
+    fprintf(fp, "time,icao24,velocity,baroaltitude,lat,lon,vertrate\n");
+    for (k = 0; k < rows; k++) {
+        for (i = 0; i < flights; i++) {
+            synth_step(&f[i], k, rows, s);
+            fprintf(fp, "%d,%06x,%.6f,%.2f,%.7f,%.7f,%.3f\n", 1717200000 + k, 0x400000 + i,
+                    s[0], s[1], s[2], s[3], s[4]);
+        }
+    }
+    free(f);
+    return fclose(fp) == 0 ? 0 : -1;
+}
+
+static int setup(bench_data_t *d)
+{
+    synth_flight_t f;
+    double s[TREND_DFA_NUM_CHANNELS];
+    uint64_t seed = 12345;
+    int i, ch;
+
+    for (i = 0; i < 256; i++) {
+        d->label[i] = (uint8_t)i;
+    }
+    for (i = 0; i < BATCH; i++) {
+        d->value[i] = (next_unit(&seed) - 0.5) * 160000.0;
+        d->word[i] = arinc429_bcd_encode_word(0203, 0, d->value[i]);
+    }
+
+    synth_init(&f, 0);
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        d->row[ch] = (double *)malloc(BATCH * sizeof(double));
+        d->row_f[ch] = (float *)malloc(BATCH * sizeof(float));
+        if (d->row[ch] == NULL || d->row_f[ch] == NULL) {
+            return -1;
+        }
+    }
+    for (i = 0; i < BATCH; i++) {
+        synth_step(&f, i, BATCH, s);
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            d->row[ch][i] = s[ch];
+            d->row_f[ch][i] = (float)s[ch];
+        }
+    }
+
+    trend_dfa_init(&d->dfa);
+    if (trend_dfa_f32_alloc(&d->dfa_f32, 1, NULL) != 0 || trend_dfa_q_alloc(&d->dfa_q, 1, NULL) != 0 ||
+        trend_dfa_multi_alloc(&d->multi, MULTI_TRACKS, NULL) != 0 ||
+        trend_decim_alloc(&d->decim, 1, DECIM_RATIO, TREND_DECIM_DEFAULT_TAPS_PER_PHASE) != 0) {
+        return -1;
+    }
+    d->multi_in = (double *)malloc((size_t)TREND_DFA_NUM_CHANNELS * MULTI_TRACKS * sizeof(double));
+    d->multi_out = (double *)malloc((size_t)(2 + TREND_DFA_NUM_TRENDS) * MULTI_TRACKS * sizeof(double));
+    return d->multi_in != NULL && d->multi_out != NULL ? 0 : -1;
+}
+
+static void teardown(bench_data_t *d)
+{
+    int ch;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        free(d->row[ch]);
+        free(d->row_f[ch]);
+    }
+    trend_dfa_f32_free(&d->dfa_f32);
+    trend_dfa_q_free(&d->dfa_q);
+    trend_dfa_multi_free(&d->multi);
+    trend_decim_free(&d->decim);
+    free(d->multi_in);
+    free(d->multi_out);
+#if ARINC429_HAVE_FLEET
+    if (d->fleet_loaded) {
+        flight_fleet_free(&d->fleet);
+    }
+#endif
+#if ARINC429_HAVE_SQLITE
+    if (d->db != NULL) {
+        char path[80];
+        arinc_db_end_run(d->db, 0.0, "completed");
+        arinc_db_close(d->db);
+        unlink(d->db_path);
+        snprintf(path, sizeof(path), "%s-wal", d->db_path);
+        unlink(path);
+        snprintf(path, sizeof(path), "%s-shm", d->db_path);
+        unlink(path);
+    }
+#endif
+}
+
+/* ------------------------------------------------------------------------ */
+/* Benchmarks: each runs reps repetitions and returns the items processed */
+
+static uint64_t bench_label_loop(bench_data_t *d, uint64_t reps)
+{
+    uint64_t r, acc = 0;
+    int i;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < 256; i++) {
+            acc += arinc429_label_reverse(d->label[i]);
+        }
+    }
+    sink = acc;
+    return reps * 256;
+}
+
+static uint8_t label_table[256];
+
+static uint64_t bench_label_table(bench_data_t *d, uint64_t reps)
+{
+    uint64_t r, acc = 0;
+    int i;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < 256; i++) {
+            acc += label_table[d->label[i]];
+        }
+    }
+    sink = acc;
+    return reps * 256;
+}
+
+static inline uint8_t label_reverse_swap(uint8_t x)
+{
+    x = (uint8_t)((x & 0xF0) >> 4 | (x & 0x0F) << 4);
+    x = (uint8_t)((x & 0xCC) >> 2 | (x & 0x33) << 2);
+    return (uint8_t)((x & 0xAA) >> 1 | (x & 0x55) << 1);
+}
+
+static uint64_t bench_label_swap(bench_data_t *d, uint64_t reps)
+{
+    uint64_t r, acc = 0;
+    int i;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < 256; i++) {
+            acc += label_reverse_swap(d->label[i]);
+        }
+    }
+    sink = acc;
+    return reps * 256;
+}
+
+static uint64_t bench_bcd_encode_word(bench_data_t *d, uint64_t reps)
+{
+    uint64_t r, acc = 0;
+    int i;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < BATCH; i++) {
+            acc += arinc429_bcd_encode_word(0203, 0, d->value[i]);
+        }
+    }
+    sink = acc;
+    return reps * BATCH;
+}
+
+static uint64_t bench_bcd_decode_word(bench_data_t *d, uint64_t reps)
+{
+    uint64_t r;
+    double acc = 0.0, v;
+    int i;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < BATCH; i++) {
+            arinc429_bcd_decode_word(d->word[i], &v);
+            acc += v;
+        }
+    }
+    sink = (uint64_t)acc;
+    return reps * BATCH;
+}
+
+static uint64_t bench_bcd_encode_words(bench_data_t *d, uint64_t reps)
+{
+    uint64_t r;
+
+    for (r = 0; r < reps; r++) {
+        arinc429_bcd_encode_words(d->value, d->word, BATCH, 0203, 0);
+    }
+    sink = d->word[BATCH - 1];
+    return reps * BATCH;
+}
+
+static uint64_t bench_bcd_decode_words(bench_data_t *d, uint64_t reps)
+{
+    uint64_t r, errors = 0;
+
+    for (r = 0; r < reps; r++) {
+        errors += arinc429_bcd_decode_words(d->word, d->decoded, d->status, BATCH);
+    }
+    sink = errors + (uint64_t)d->decoded[BATCH - 1];
+    return reps * BATCH;
+}
+
+/* Synthetic traffic with every word fault at 1e-4, into a buffer of its own
+ * so the decode benchmarks keep their words */
+static uint64_t bench_gen_words(bench_data_t *d, uint64_t reps)
+{
+    static uint32_t words[BATCH];
+    arinc429_gen_config_t cfg;
+    arinc429_gen_t g;
+    uint64_t r, n = 0;
+    int k;
+
+    (void)d;
+    arinc429_gen_default_config(&cfg);
+    for (k = 0; k < ARINC429_GEN_FAULT_RANGE; k++) {
+        cfg.rate[k] = 1e-4;
+    }
+    arinc429_gen_init(&g, &cfg, 1, 0);
+    for (r = 0; r < reps; r++) {
+        n += arinc429_gen_words(&g, words, BATCH / TREND_DFA_NUM_CHANNELS);
+    }
+    sink = n + words[0];
+    return n;
+}
+
+static uint64_t bench_dfa_double(bench_data_t *d, uint64_t reps)
+{
+    trend_dfa_output_t out;
+    double s[TREND_DFA_NUM_CHANNELS];
+    uint64_t r, acc = 0;
+    int i, ch;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < BATCH; i++) {
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                s[ch] = d->row[ch][i];
+            }
+            trend_dfa_step(&d->dfa, s, &out);
+            acc += (uint64_t)out.state;
+        }
+    }
+    sink = acc;
+    return reps * BATCH;
+}
+
+/* Items are input rows; the DFA steps on one in DECIM_RATIO */
+static uint64_t bench_dfa_decimated(bench_data_t *d, uint64_t reps)
+{
+    trend_dfa_output_t out;
+    const double *in[TREND_DFA_NUM_CHANNELS];
+    double s[TREND_DFA_NUM_CHANNELS];
+    uint64_t r, acc = 0;
+    int i, ch;
+
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < BATCH; i++) {
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                in[ch] = &d->row[ch][i];
+            }
+            if (trend_decim_push(&d->decim, in, s)) {
+                trend_dfa_step(&d->dfa, s, &out);
+                acc += (uint64_t)out.state;
+            }
+        }
+    }
+    sink = acc;
+    return reps * BATCH;
+}
+
+/* The float DFAs share one body; step is trend_dfa_f32_step or trend_dfa_q_step */
+#define BENCH_DFA_F32(name, member, step)                                        \
+    static uint64_t name(bench_data_t *d, uint64_t reps)                         \
+    {                                                                            \
+        const float *in[TREND_DFA_NUM_CHANNELS];                                 \
+        float state, conf, trends[TREND_DFA_NUM_TRENDS];                         \
+        uint64_t r, acc = 0;                                                     \
+        int i, ch;                                                               \
+        for (r = 0; r < reps; r++) {                                             \
+            for (i = 0; i < BATCH; i++) {                                        \
+                for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {                \
+                    in[ch] = &d->row_f[ch][i];                                   \
+                }                                                                \
+                step(&d->member, in, &state, &conf, trends);                     \
+                acc += (uint64_t)state;                                          \
+            }                                                                    \
+        }                                                                        \
+        sink = acc;                                                              \
+        return reps * BATCH;                                                     \
+    }
+
+BENCH_DFA_F32(bench_dfa_f32, dfa_f32, trend_dfa_f32_step)
+BENCH_DFA_F32(bench_dfa_q, dfa_q, trend_dfa_q_step)
+
+/* Items are track steps */
+static uint64_t bench_dfa_multi(bench_data_t *d, uint64_t reps)
+{
+    const double *in[TREND_DFA_NUM_CHANNELS];
+    double *out = d->multi_out;
+    uint64_t r;
+    int i, ch, t;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        in[ch] = &d->multi_in[ch * MULTI_TRACKS];
+    }
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < BATCH / MULTI_TRACKS; i++) {
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                for (t = 0; t < MULTI_TRACKS; t++) {
+                    d->multi_in[ch * MULTI_TRACKS + t] = d->row[ch][(i * 7 + t) % BATCH];
+                }
+            }
+            trend_dfa_multi_step(&d->multi, in, out, out + MULTI_TRACKS, out + 2 * MULTI_TRACKS);
+        }
+    }
+    sink = (uint64_t)out[0];
+    return reps * (BATCH / MULTI_TRACKS) * MULTI_TRACKS;
+}
+
+#if ARINC429_HAVE_FLEET
+/* Parse and partition the synthetic dump; items are rows */
+static uint64_t bench_replay_load(bench_data_t *d, uint64_t reps)
+{
+    flight_fleet_t f;
+    uint64_t r, rows = 0;
+
+    for (r = 0; r < reps; r++) {
+        if (flight_fleet_load(&f, d->csv_path, d->threads) != 0) {
+            flight_fleet_free(&f);
+            return 0;
+        }
+        rows += f.num_rows;
+        flight_fleet_free(&f);
+    }
+    return rows;
+}
+
+static uint64_t replay_run(bench_data_t *d, uint64_t reps, int threads)
+{
+    uint64_t r;
+
+    if (!d->fleet_loaded) {
+        if (flight_fleet_load(&d->fleet, d->csv_path, d->threads) != 0) {
+            flight_fleet_free(&d->fleet);
+            return 0;
+        }
+        d->fleet_loaded = 1;
+    }
+    for (r = 0; r < reps; r++) {
+        if (flight_fleet_run(&d->fleet, threads, NULL) != 0) {
+            return 0;
+        }
+    }
+    return reps * d->fleet.num_rows;
+}
+
+static uint64_t bench_replay_run_1(bench_data_t *d, uint64_t reps)
+{
+    return replay_run(d, reps, 1);
+}
+
+static uint64_t bench_replay_run_all(bench_data_t *d, uint64_t reps)
+{
+    return replay_run(d, reps, d->threads);
+}
+#endif
+
+#if ARINC429_HAVE_SQLITE
+/* Rows appended to all three tables; flushed at the end of every measurement */
+static uint64_t bench_db_append(bench_data_t *d, uint64_t reps)
+{
+    trend_dfa_output_t out;
+    double s[TREND_DFA_NUM_CHANNELS];
+    uint64_t r;
+    int i, ch;
+
+    if (d->db == NULL) {
+        arinc_db_run_t run;
+        int fd;
+
+        snprintf(d->db_path, sizeof(d->db_path), "/tmp/arinc429_bench_XXXXXX");
+        fd = mkstemp(d->db_path);
+        if (fd < 0) {
+            return 0;
+        }
+        close(fd);
+        d->db = arinc_db_open(d->db_path, NULL);
+        memset(&run, 0, sizeof(run));
+        run.name = "arinc429_bench";
+        run.time_step = 1.0;
+        if (d->db == NULL || arinc_db_begin_run(d->db, &run) < 0) {
+            return 0;
+        }
+    }
+    memset(&out, 0, sizeof(out));
+    out.state = STATE_STABLE;
+    for (r = 0; r < reps; r++) {
+        for (i = 0; i < BATCH; i++) {
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                s[ch] = d->row[ch][i];
+            }
+            if (arinc_db_append(d->db, (double)i, s, &out) != 0) {
+                return 0;
+            }
+        }
+    }
+    return arinc_db_flush(d->db) == 0 ? reps * BATCH : 0;
+}
+#endif
+
+typedef struct {
+    const char *name;
+    uint64_t  (*run)(bench_data_t *d, uint64_t reps);
+    int         isa;        /* batch kernel to select, -1 for none */
+} bench_t;
+
+static const bench_t benches[] = {
+    { "label/reverse_loop",        bench_label_loop,       -1 },
+    { "label/reverse_table",       bench_label_table,      -1 },
+    { "label/reverse_swap",        bench_label_swap,       -1 },
+    { "bcd/encode_word",           bench_bcd_encode_word,  -1 },
+    { "bcd/decode_word",           bench_bcd_decode_word,  -1 },
+    { "bcd/encode_words_scalar",   bench_bcd_encode_words, ARINC429_ISA_SCALAR },
+    { "bcd/encode_words_sse41",    bench_bcd_encode_words, ARINC429_ISA_SSE41 },
+    { "bcd/encode_words_avx2",     bench_bcd_encode_words, ARINC429_ISA_AVX2 },
+    { "bcd/decode_words_scalar",   bench_bcd_decode_words, ARINC429_ISA_SCALAR },
+    { "bcd/decode_words_sse41",    bench_bcd_decode_words, ARINC429_ISA_SSE41 },
+    { "bcd/decode_words_avx2",     bench_bcd_decode_words, ARINC429_ISA_AVX2 },
+    { "gen/words",                 bench_gen_words,        -1 },
+    { "dfa/step_double",           bench_dfa_double,       -1 },
+    { "dfa/step_float32",          bench_dfa_f32,          -1 },
+    { "dfa/step_q",                bench_dfa_q,            -1 },
+    { "dfa/multi_step_64",         bench_dfa_multi,        -1 },
+    { "dfa/decimate_16_step",      bench_dfa_decimated,    -1 },
+#if ARINC429_HAVE_FLEET
+    { "replay/load",               bench_replay_load,      -1 },
+    { "replay/run_1_thread",       bench_replay_run_1,     -1 },
+    { "replay/run_all_threads",    bench_replay_run_all,   -1 },
+#endif
+#if ARINC429_HAVE_SQLITE
+    { "db/append",                 bench_db_append,        -1 },
+#endif
+};
+
+#define NUM_BENCHES ((int)(sizeof(benches) / sizeof(benches[0])))
+
+/* Replay benchmarks need the synthetic dump written first */
+static int is_replay(const bench_t *b)
+{
+    return strncmp(b->name, "replay/", 7) == 0;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Driver */
+
+typedef struct {
+    const char *name;
+    uint64_t    items;
+    double      seconds;
+    uint64_t    counter[NUM_COUNTERS];
+    int         counter_valid[NUM_COUNTERS];
+} result_t;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/* Returns 0, or -1 if the benchmark failed */
+static int measure(const bench_t *b, bench_data_t *d, counters_t *c, double min_time,
+                   int repeats, result_t *res)
+{
+    uint64_t reps = 1, items;
+    double t0, secs;
+    int i, k;
+
+    /* Grow the repetition count until one run lasts min_time */
+    for (;;) {
+        t0 = now_seconds();
+        if (b->run(d, reps) == 0) {
+            return -1;
+        }
+        secs = now_seconds() - t0;
+        if (secs >= min_time || reps >= ((uint64_t)1 << 40)) {
+            break;
+        }
+        reps = secs > 0.0 && min_time / secs < 2.0 ? (uint64_t)((double)reps * min_time / secs * 1.1) + 1 :
+                                                   reps * 2;
+    }
+
+    res->name = b->name;
+    for (i = 0; i < repeats; i++) {
+        counters_start(c);
+        t0 = now_seconds();
+        items = b->run(d, reps);
+        secs = now_seconds() - t0;
+        counters_stop(c);
+        if (items == 0) {
+            return -1;
+        }
+        if (i == 0 || secs / (double)items < res->seconds / (double)res->items) {
+            res->items = items;
+            res->seconds = secs;
+            for (k = 0; k < NUM_COUNTERS; k++) {
+                res->counter[k] = c->value[k];
+                res->counter_valid[k] = c->valid[k];
+            }
+        }
+    }
+    return 0;
+}
+
+static void write_json(FILE *fp, const result_t *res, int n, const bench_data_t *d,
+                       double min_time, int repeats)
+{
+    struct utsname u;
+    int i, k;
+
+    if (uname(&u) != 0) {
+        memset(&u, 0, sizeof(u));
+    }
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"timestamp\": %ld,\n", (long)time(NULL));
+    fprintf(fp, "  \"host\": {\"sysname\": \"%s\", \"release\": \"%s\", \"machine\": \"%s\", "
+                "\"cpus\": %ld},\n", u.sysname, u.release, u.machine, sysconf(_SC_NPROCESSORS_ONLN));
+#ifdef __VERSION__
+    fprintf(fp, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(fp, "  \"config\": {\"min_time\": %g, \"repeats\": %d, \"flights\": %d, "
+                "\"rows_per_flight\": %d, \"threads\": %d, \"window\": %d},\n",
+            min_time, repeats, d->flights, d->rows_per_flight, d->threads, SAMPLE_SIZE);
+    fprintf(fp, "  \"benchmarks\": [\n");
+    for (i = 0; i < n; i++) {
+        const result_t *r = &res[i];
+        fprintf(fp, "    {\"name\": \"%s\", \"items\": %llu, \"seconds\": %.9g, "
+                    "\"ns_per_item\": %.6g, \"items_per_s\": %.6g",
+                r->name, (unsigned long long)r->items, r->seconds,
+                r->seconds * 1e9 / (double)r->items, (double)r->items / r->seconds);
+        for (k = 0; k < NUM_COUNTERS; k++) {
+            if (r->counter_valid[k]) {
+                fprintf(fp, ", \"%s_per_item\": %.6g", counter_name[k],
+                        (double)r->counter[k] / (double)r->items);
+            } else {
+                fprintf(fp, ", \"%s_per_item\": null", counter_name[k]);
+            }
+        }
+        fprintf(fp, "}%s\n", i + 1 < n ? "," : "");
+    }
+    fprintf(fp, "  ]\n}\n");
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -f <text>   only run benchmarks whose name contains text\n"
+            "  -t <sec>    minimum time per measurement (default 0.2)\n"
+            "  -r <n>      measurements per benchmark, fastest kept (default 3)\n"
+            "  -n <n>      flights in the synthetic replay dump (default 200)\n"
+            "  -l <n>      rows per flight (default 3600)\n"
+            "  -p <n>      threads for the parallel replay (default: online CPUs)\n"
+            "  -j <file>   write the results as JSON ('-' for stdout)\n"
+            "  --list      list the benchmarks and exit\n"
+            "  -q          do not print the table\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = NULL, *json_path = NULL;
+    double min_time = 0.2;
+    int repeats = 3, quiet = 0, failed = 0, num_results = 0;
+    char csv_path[64] = "";
+    bench_data_t *d;
+    result_t res[NUM_BENCHES];
+    counters_t counters;
+    int i, k;
+
+    d = (bench_data_t *)calloc(1, sizeof(*d));
+    if (d == NULL) {
+        return 1;
+    }
+    d->flights = 200;
+    d->rows_per_flight = 3600;
+    d->threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            min_time = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            d->flights = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            d->rows_per_flight = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            d->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--list") == 0) {
+            for (k = 0; k < NUM_BENCHES; k++) {
+                printf("%s\n", benches[k].name);
+            }
+            return 0;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (repeats < 1 || d->flights < 1 || d->rows_per_flight < 1 || d->threads < 1) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    for (i = 0; i < 256; i++) {
+        label_table[i] = arinc429_label_reverse((uint8_t)i);
+        if (label_reverse_swap((uint8_t)i) != label_table[i]) {
+            fprintf(stderr, "%s: label reversal variants disagree at %d\n", argv[0], i);
+            return 1;
+        }
+    }
+    if (setup(d) != 0) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+#if ARINC429_HAVE_FLEET
+    for (k = 0; k < NUM_BENCHES; k++) {
+        if (is_replay(&benches[k]) && (filter == NULL || strstr(benches[k].name, filter) != NULL)) {
+            break;
+        }
+    }
+    if (k < NUM_BENCHES) {
+        int fd;
+
+        snprintf(csv_path, sizeof(csv_path), "/tmp/arinc429_bench_XXXXXX");
+        fd = mkstemp(csv_path);
+        if (fd < 0 || (close(fd), write_fleet_csv(csv_path, d->flights, d->rows_per_flight)) != 0) {
+            fprintf(stderr, "%s: cannot write the synthetic dump\n", argv[0]);
+            return 1;
+        }
+        d->csv_path = csv_path;
+    }
+#endif
+
+    counters_open(&counters);
+    if (!quiet) {
+        printf("%-26s %14s %12s %12s %12s %12s\n", "benchmark", "items/s", "ns/item",
+               "cycles/item", "instr/item", "misses/item");
+    }
+    for (k = 0; k < NUM_BENCHES; k++) {
+        const bench_t *b = &benches[k];
+        result_t *r = &res[num_results];
+
+        if (filter != NULL && strstr(b->name, filter) == NULL) {
+            continue;
+        }
+        if (is_replay(b) && d->csv_path == NULL) {
+            continue;
+        }
+        /* Batch kernels the CPU lacks are skipped rather than measured twice */
+        if (b->isa >= 0 && arinc429_bcd_batch_set_isa((arinc429_isa_t)b->isa) != (arinc429_isa_t)b->isa) {
+            continue;
+        }
+        memset(r, 0, sizeof(*r));
+        if (measure(b, d, &counters, min_time, repeats, r) != 0) {
+            fprintf(stderr, "%s: %s failed\n", argv[0], b->name);
+            failed = 1;
+            continue;
+        }
+        num_results++;
+        if (!quiet) {
+            printf("%-26s %14.4g %12.3f", r->name, (double)r->items / r->seconds,
+                   r->seconds * 1e9 / (double)r->items);
+            for (i = 0; i < NUM_COUNTERS; i++) {
+                if (r->counter_valid[i]) {
+                    printf(" %12.3f", (double)r->counter[i] / (double)r->items);
+                } else {
+                    printf(" %12s", "-");
+                }
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+    }
+    counters_close(&counters);
+
+    if (json_path != NULL) {
+        FILE *fp = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (fp == NULL) {
+            fprintf(stderr, "%s: cannot create %s\n", argv[0], json_path);
+            failed = 1;
+        } else {
+            write_json(fp, res, num_results, d, min_time, repeats);
+            if (fp != stdout && fclose(fp) != 0) {
+                fprintf(stderr, "%s: writing %s failed\n", argv[0], json_path);
+                failed = 1;
+            }
+        }
+    }
+
+    teardown(d);
+    if (csv_path[0] != '\0') {
+        unlink(csv_path);
+    }
+    free(d);
+    return failed ? 1 : 0;
+}
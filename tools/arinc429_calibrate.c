@@ -0,0 +1,449 @@
+/* arinc429_calibrate.c - Sweep trend DFA thresholds and weights over a recorded dataset
+ *
+ * Every -p option names one parameter of trend_dfa_params_t and the values
+ * to try; parameters not named keep their trend_dfa_config.h value. By
+ * default the configurations are the full grid over all -p values; with -n
+ * that many configurations are drawn at random instead (ranges uniformly,
+ * lists by element). Window statistics are computed once, then every
+ * configuration is evaluated on -j threads (trend_calib.h) and written as
+ * one CSV row of parameters, state histogram and transition counts.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "flight_csv_stream.h"
+#include "flight_fleet.h"
+#include "trend_calib.h"
+
+#define MAX_CONFIGS 100000000UL
+
+static const char *const state_name[TREND_CALIB_NUM_STATES] = {
+    "stable", "increasing", "decreasing", "oscillating", "anomaly"
+};
+
+/* Sweepable parameters, in output column order */
+static const struct {
+    const char *name;
+    size_t      offset;
+} param[] = {
+    { "stable",           offsetof(trend_dfa_params_t, stable) },
+    { "increase",         offsetof(trend_dfa_params_t, increase) },
+    { "decrease",         offsetof(trend_dfa_params_t, decrease) },
+    { "oscillation",      offsetof(trend_dfa_params_t, oscillation) },
+    { "vel_anomaly",      offsetof(trend_dfa_params_t, anomaly) + TREND_DFA_CH_VELOCITY * sizeof(double) },
+    { "alt_anomaly",      offsetof(trend_dfa_params_t, anomaly) + TREND_DFA_CH_BAROALT * sizeof(double) },
+    { "lat_anomaly",      offsetof(trend_dfa_params_t, anomaly) + TREND_DFA_CH_LAT * sizeof(double) },
+    { "lon_anomaly",      offsetof(trend_dfa_params_t, anomaly) + TREND_DFA_CH_LON * sizeof(double) },
+    { "vertrate_anomaly", offsetof(trend_dfa_params_t, anomaly) + TREND_DFA_CH_VERTRATE * sizeof(double) },
+    { "w_vel",            offsetof(trend_dfa_params_t, weight) + TREND_DFA_CH_VELOCITY * sizeof(double) },
+    { "w_alt",            offsetof(trend_dfa_params_t, weight) + TREND_DFA_CH_BAROALT * sizeof(double) },
+    { "w_lat",            offsetof(trend_dfa_params_t, weight) + TREND_DFA_CH_LAT * sizeof(double) },
+    { "w_lon",            offsetof(trend_dfa_params_t, weight) + TREND_DFA_CH_LON * sizeof(double) },
+    { "w_vertrate",       offsetof(trend_dfa_params_t, weight) + TREND_DFA_CH_VERTRATE * sizeof(double) },
+};
+
+#define NUM_PARAMS ((int)(sizeof(param) / sizeof(param[0])))
+
+/* Values given for one parameter */
+typedef struct {
+    int     index;              /* into param[] */
+    int     is_range;           /* lo:hi[:n] rather than a list */
+    double  lo, hi;
+    size_t  count;
+    double *value;              /* the list, or the n grid points of a range */
+} sweep_param_t;
+
+static double *param_field(trend_dfa_params_t *cfg, int index)
+{
+    return (double *)((char *)cfg + param[index].offset);
+}
+
+static void usage(const char *prog)
+{
+    int i;
+
+    fprintf(stderr,
+            "Usage: %s [options] <input.csv>\n"
+            "  -p <name>=<v1>,<v2>,...   try these values\n"
+            "  -p <name>=<lo>:<hi>[:<n>] n evenly spaced values (default 10);\n"
+            "                            with -n, drawn uniformly from [lo, hi]\n"
+            "  -n <count>  draw count random configurations instead of the grid\n"
+            "  -s <seed>   random seed (default 1)\n"
+            "  -w <n>      window size in samples (default 10, 2..256)\n"
+            "  -f          partition the rows by the icao24 column, one track per\n"
+            "              aircraft (default: the whole file is one track)\n"
+            "  -j <n>      worker threads (default: online CPUs)\n"
+            "  -o <file>   write the result table there (default: stdout)\n"
+            "  -q          do not print the summary (stderr)\n"
+            "Parameters:",
+            prog);
+    for (i = 0; i < NUM_PARAMS; i++) {
+        fprintf(stderr, " %s", param[i].name);
+    }
+    fputc('\n', stderr);
+}
+
+/* Parse "name=..." into p. Returns 0, or -1 if it is malformed. */
+static int parse_param(const char *spec, sweep_param_t *p)
+{
+    const char *eq = strchr(spec, '=');
+    const char *s;
+    char *end;
+    size_t n;
+    int i;
+
+    memset(p, 0, sizeof(*p));
+    p->index = -1;
+    if (eq == NULL) {
+        return -1;
+    }
+    for (i = 0; i < NUM_PARAMS; i++) {
+        if (strlen(param[i].name) == (size_t)(eq - spec) &&
+            strncmp(spec, param[i].name, (size_t)(eq - spec)) == 0) {
+            p->index = i;
+        }
+    }
+    if (p->index < 0) {
+        return -1;
+    }
+
+    s = eq + 1;
+    if (strchr(s, ':') != NULL) {
+        p->is_range = 1;
+        p->lo = strtod(s, &end);
+        if (end == s || *end != ':') {
+            return -1;
+        }
+        s = end + 1;
+        p->hi = strtod(s, &end);
+        if (end == s || (*end != ':' && *end != '\0')) {
+            return -1;
+        }
+        p->count = 10;
+        if (*end == ':') {
+            s = end + 1;
+            p->count = (size_t)strtoul(s, &end, 10);
+            if (end == s || *end != '\0' || p->count < 1 || p->count > MAX_CONFIGS) {
+                return -1;
+            }
+        }
+        p->value = (double *)malloc(p->count * sizeof(double));
+        if (p->value == NULL) {
+            return -1;
+        }
+        for (n = 0; n < p->count; n++) {
+            p->value[n] = p->count == 1 ? p->lo :
+                          p->lo + (p->hi - p->lo) * (double)n / (double)(p->count - 1);
+        }
+        return 0;
+    }
+
+    for (n = 1, i = 0; s[i] != '\0'; i++) {
+        n += s[i] == ',';
+    }
+    p->value = (double *)malloc(n * sizeof(double));
+    if (p->value == NULL) {
+        return -1;
+    }
+    for (p->count = 0; p->count < n; p->count++) {
+        p->value[p->count] = strtod(s, &end);
+        if (end == s || (*end != ',' && *end != '\0')) {
+            return -1;
+        }
+        s = end + 1;
+    }
+    return 0;
+}
+
+/* splitmix64; reproducible on every platform, unlike rand() */
+static uint64_t next_random(uint64_t *seed)
+{
+    uint64_t z = (*seed += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/* Uniform in [0, 1) */
+static double next_unit(uint64_t *seed)
+{
+    return (double)(next_random(seed) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static trend_dfa_params_t *make_configs(const sweep_param_t *sp, int num_sp, int window,
+                                        size_t num_random, uint64_t seed, size_t *num_configs)
+{
+    trend_dfa_params_t base, *cfg;
+    size_t total = 1, c, rest;
+    int i;
+
+    trend_dfa_default_params(&base);
+    base.window = window;
+    if (num_random > 0) {
+        total = num_random;
+    } else {
+        for (i = 0; i < num_sp; i++) {
+            if (sp[i].count > MAX_CONFIGS / total) {
+                return NULL;
+            }
+            total *= sp[i].count;
+        }
+    }
+
+    cfg = (trend_dfa_params_t *)malloc(total * sizeof(trend_dfa_params_t));
+    if (cfg == NULL) {
+        return NULL;
+    }
+    for (c = 0; c < total; c++) {
+        cfg[c] = base;
+        if (num_random == 0) {
+            /* Mixed-radix index into the grid; the last -p varies fastest */
+            rest = c;
+            for (i = num_sp - 1; i >= 0; i--) {
+                *param_field(&cfg[c], sp[i].index) = sp[i].value[rest % sp[i].count];
+                rest /= sp[i].count;
+            }
+            continue;
+        }
+        for (i = 0; i < num_sp; i++) {
+            *param_field(&cfg[c], sp[i].index) = sp[i].is_range ?
+                sp[i].lo + (sp[i].hi - sp[i].lo) * next_unit(&seed) :
+                sp[i].value[next_random(&seed) % sp[i].count];
+        }
+    }
+    *num_configs = total;
+    return cfg;
+}
+
+/* Whole file as one track, column-wise */
+static int load_track(const char *path, double **input, size_t *num_rows, long *bad_line)
+{
+    flight_csv_stream_t csv;
+    double *column[TREND_DFA_NUM_CHANNELS];
+    size_t capacity = 0, rows = 0;
+    long n;
+    int ch;
+
+    memset(input, 0, TREND_DFA_NUM_CHANNELS * sizeof(input[0]));
+    *bad_line = 0;
+    if (flight_csv_stream_open(&csv, path, 0) != 0) {
+        return -1;
+    }
+    for (;;) {
+        if (rows + FLIGHT_CSV_STREAM_CHUNK > capacity) {
+            capacity = capacity == 0 ? (size_t)1 << 16 : capacity * 2;
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                double *grown = (double *)realloc(input[ch], capacity * sizeof(double));
+                if (grown == NULL) {
+                    flight_csv_stream_close(&csv);
+                    return -1;
+                }
+                input[ch] = grown;
+            }
+        }
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            column[ch] = input[ch] + rows;
+        }
+        n = flight_csv_stream_read(&csv, column, FLIGHT_CSV_STREAM_CHUNK);
+        if (n <= 0) {
+            break;
+        }
+        rows += (size_t)n;
+    }
+    if (n < 0) {
+        *bad_line = csv.line;
+    }
+    flight_csv_stream_close(&csv);
+    *num_rows = rows;
+    return n < 0 ? -1 : 0;
+}
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *stop)
+{
+    return (double)(stop->tv_sec - start->tv_sec) +
+           (double)(stop->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int window = SAMPLE_SIZE;
+    int quiet = 0, fleet_mode = 0, num_sp = 0, failed = 0, status = 1, i, j;
+    unsigned long num_random = 0;
+    uint64_t seed = 1;
+    sweep_param_t sp[sizeof(param) / sizeof(param[0])];
+    trend_dfa_params_t *cfg = NULL;
+    trend_calib_result_t *result = NULL;
+    trend_calib_features_t ft = { 0, 0, NULL };
+    flight_fleet_t fleet;
+    double *track[TREND_DFA_NUM_CHANNELS] = { NULL };
+    size_t num_configs = 0, num_rows = 0, num_tracks = 1, c;
+    long bad_line = 0;
+    struct timespec t0, t1, t2, t3;
+    FILE *out = stdout;
+
+    memset(&fleet, 0, sizeof(fleet));
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            if (num_sp == NUM_PARAMS || parse_param(argv[++i], &sp[num_sp]) != 0) {
+                fprintf(stderr, "%s: bad parameter spec '%s'\n", argv[0], argv[i]);
+                if (num_sp < NUM_PARAMS) {
+                    free(sp[num_sp].value);
+                }
+                goto done;
+            }
+            for (j = 0; j < num_sp; j++) {
+                if (sp[j].index == sp[num_sp].index) {
+                    fprintf(stderr, "%s: %s given twice\n", argv[0], param[sp[j].index].name);
+                    free(sp[num_sp].value);
+                    goto done;
+                }
+            }
+            num_sp++;
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            num_random = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            window = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-f") == 0) {
+            fleet_mode = 1;
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            status = 2;
+            goto done;
+        } else {
+            input_path = argv[i];
+        }
+    }
+    if (input_path == NULL || num_threads < 1 || num_threads > FLIGHT_FLEET_MAX_THREADS ||
+        num_random > MAX_CONFIGS || window < TREND_DFA_MIN_WINDOW || window > TREND_DFA_MAX_WINDOW) {
+        usage(argv[0]);
+        status = 2;
+        goto done;
+    }
+
+    cfg = make_configs(sp, num_sp, window, num_random, seed, &num_configs);
+    result = cfg != NULL ? (trend_calib_result_t *)malloc(num_configs * sizeof(*result)) : NULL;
+    if (result == NULL) {
+        fprintf(stderr, "%s: too many configurations\n", argv[0]);
+        goto done;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (fleet_mode) {
+        if (flight_fleet_load(&fleet, input_path, num_threads) != 0) {
+            bad_line = fleet.bad_line;
+            failed = 1;
+        }
+        num_rows = fleet.num_rows;
+        num_tracks = fleet.num_tracks;
+    } else {
+        failed = load_track(input_path, track, &num_rows, &bad_line) != 0;
+    }
+    if (failed) {
+        if (bad_line != 0) {
+            fprintf(stderr, "%s: malformed row at %s:%ld\n", argv[0], input_path, bad_line);
+        } else {
+            fprintf(stderr, "%s: cannot read %s or required columns missing\n", argv[0], input_path);
+        }
+        goto done;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    if (trend_calib_features(&ft, (const double *const *)(fleet_mode ? fleet.input : track),
+                             num_rows, fleet_mode ? fleet.track_start : NULL, num_tracks,
+                             window, num_threads) != 0) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        goto done;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+    trend_calib_sweep(&ft, cfg, num_configs, result, num_threads);
+    clock_gettime(CLOCK_MONOTONIC, &t3);
+
+    if (output_path != NULL) {
+        out = fopen(output_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "%s: cannot create %s\n", argv[0], output_path);
+            goto done;
+        }
+    }
+    fprintf(out, "config");
+    for (i = 0; i < NUM_PARAMS; i++) {
+        fprintf(out, ",%s", param[i].name);
+    }
+    for (i = 0; i < TREND_CALIB_NUM_STATES; i++) {
+        fprintf(out, ",n_%s", state_name[i]);
+    }
+    fprintf(out, ",transitions");
+    for (i = 0; i < TREND_CALIB_NUM_STATES; i++) {
+        for (j = 0; j < TREND_CALIB_NUM_STATES; j++) {
+            if (i != j) {
+                fprintf(out, ",%s_to_%s", state_name[i], state_name[j]);
+            }
+        }
+    }
+    fputc('\n', out);
+    for (c = 0; c < num_configs; c++) {
+        fprintf(out, "%zu", c);
+        for (i = 0; i < NUM_PARAMS; i++) {
+            fprintf(out, ",%.10g", *param_field(&cfg[c], i));
+        }
+        for (i = 0; i < TREND_CALIB_NUM_STATES; i++) {
+            fprintf(out, ",%llu", (unsigned long long)result[c].state[i]);
+        }
+        fprintf(out, ",%llu", (unsigned long long)result[c].transitions);
+        for (i = 0; i < TREND_CALIB_NUM_STATES; i++) {
+            for (j = 0; j < TREND_CALIB_NUM_STATES; j++) {
+                if (i != j) {
+                    fprintf(out, ",%llu", (unsigned long long)result[c].transition[i][j]);
+                }
+            }
+        }
+        fputc('\n', out);
+    }
+    status = 0;
+    if (out != stdout ? fclose(out) != 0 : fflush(out) != 0) {
+        fprintf(stderr, "%s: writing the output failed\n", argv[0]);
+        status = 1;
+    }
+
+    if (!quiet) {
+        double sweep_secs = elapsed_seconds(&t2, &t3);
+        fprintf(stderr, "rows:        %zu in %zu tracks\n", num_rows, num_tracks);
+        fprintf(stderr, "window:      %d\n", window);
+        fprintf(stderr, "configs:     %zu\n", num_configs);
+        fprintf(stderr, "threads:     %d\n", num_threads);
+        fprintf(stderr, "load:        %.6f s\n", elapsed_seconds(&t0, &t1));
+        fprintf(stderr, "features:    %.6f s\n", elapsed_seconds(&t1, &t2));
+        fprintf(stderr, "sweep:       %.6f s (%.0f row-configs/s)\n", sweep_secs,
+                sweep_secs > 0.0 ? (double)num_rows * (double)num_configs / sweep_secs : 0.0);
+    }
+
+done:
+    for (i = 0; i < num_sp; i++) {
+        free(sp[i].value);
+    }
+    for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+        free(track[i]);
+    }
+    trend_calib_free(&ft);
+    flight_fleet_free(&fleet);
+    free(cfg);
+    free(result);
+    return status;
+}
@@ -0,0 +1,540 @@
+/* arinc429_dfa_precision.c - Compare the double, float32 and fixed-point trend DFAs
+ *
+ * Runs a filtered_data.csv style file (or a synthetic flight with -s) through
+ * trend_dfa.h, trend_dfa_f32.h and trend_dfa_q.h side by side as one track.
+ * At every evaluated step the slopes, variances and weighted trend of the
+ * reduced-precision DFAs are checked against the double DFA and the error
+ * bounds documented in their headers; the largest error, its ratio to the
+ * bound, and state and anomaly disagreements are printed per channel. The
+ * running sums of the double DFA and of the multi-track DFA are checked
+ * against the two-pass formulas of the original block as well, also with
+ * NaN and infinite samples mixed in (--nan): once such a sample has left
+ * the window their slopes and variances must be finite and within the
+ * drift bound of trend_window.h again. Each DFA is then timed alone over
+ * the same rows. Exits with 1 if an error exceeds its bound.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "flight_csv_stream.h"
+#include "trend_dfa.h"
+#include "trend_dfa_f32.h"
+#include "trend_dfa_multi.h"
+#include "trend_dfa_q.h"
+
+#define NUM_VARIANTS 2   /* float32, fixed point */
+
+static const char *const variant_name[NUM_VARIANTS] = { "float32", "q" };
+
+static const char *const channel_name[TREND_DFA_NUM_TRENDS] = {
+    "velocity", "baroaltitude", "lat", "lon", "vertrate", "weighted"
+};
+
+/* Largest error and error/bound ratio seen for one statistic */
+typedef struct {
+    double err;
+    double ratio;
+    unsigned long checked;
+} error_stat_t;
+
+typedef struct {
+    error_stat_t  slope[TREND_DFA_NUM_TRENDS];
+    error_stat_t  variance[TREND_DFA_NUM_CHANNELS];
+    unsigned long state_mismatch;
+    unsigned long anomaly_mismatch;
+} variant_stat_t;
+
+/* Running-sum engines checked against the two-pass formulas */
+#define NUM_SUMS 2   /* trend_dfa_t, trend_dfa_multi_t */
+
+static const char *const sums_name[NUM_SUMS] = { "double", "multi" };
+
+typedef struct {
+    error_stat_t  slope[TREND_DFA_NUM_CHANNELS];
+    error_stat_t  variance[TREND_DFA_NUM_CHANNELS];
+    unsigned long stuck;        /* non-finite where the two-pass result is finite */
+} sums_stat_t;
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <input.csv>\n"
+            "       %s [options] -s <rows>\n"
+            "  -s <rows>   synthetic climb/cruise/descent flight instead of a file\n"
+            "  -w <n>      window size (default %d)\n"
+            "  --nan <n>   replace every n-th sample with NaN, +Inf or -Inf in turn\n"
+            "  -q          do not print the summary\n",
+            prog, prog, SAMPLE_SIZE);
+}
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *stop)
+{
+    return (double)(stop->tv_sec - start->tv_sec) +
+           (double)(stop->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+/* Whole file as one track, column-wise */
+static int load_track(const char *path, double **input, size_t *num_rows, long *bad_line)
+{
+    flight_csv_stream_t csv;
+    double *column[TREND_DFA_NUM_CHANNELS];
+    size_t capacity = 0, rows = 0;
+    long n;
+    int ch;
+
+    memset(input, 0, TREND_DFA_NUM_CHANNELS * sizeof(input[0]));
+    *bad_line = 0;
+    if (flight_csv_stream_open(&csv, path, 0) != 0) {
+        return -1;
+    }
+    for (;;) {
+        if (rows + FLIGHT_CSV_STREAM_CHUNK > capacity) {
+            capacity = capacity == 0 ? (size_t)1 << 16 : capacity * 2;
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                double *grown = (double *)realloc(input[ch], capacity * sizeof(double));
+                if (grown == NULL) {
+                    flight_csv_stream_close(&csv);
+                    return -1;
+                }
+                input[ch] = grown;
+            }
+        }
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            column[ch] = input[ch] + rows;
+        }
+        n = flight_csv_stream_read(&csv, column, FLIGHT_CSV_STREAM_CHUNK);
+        if (n <= 0) {
+            break;
+        }
+        rows += (size_t)n;
+    }
+    if (n < 0) {
+        *bad_line = csv.line;
+    }
+    flight_csv_stream_close(&csv);
+    *num_rows = rows;
+    return n < 0 ? -1 : 0;
+}
+
+/* xorshift64*, uniform in [-1, 1) */
+static double next_noise(uint64_t *s)
+{
+    *s ^= *s >> 12;
+    *s ^= *s << 25;
+    *s ^= *s >> 27;
+    return (double)((*s * 2685821657736338717ULL) >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+}
+
+/* 1 Hz flight legs of 40 to 80 minutes: climb to cruise, cruise with
+ * turbulence, descend, with the occasional out-of-range velocity spike */
+static int synth_track(double **input, size_t rows)
+{
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+    double alt = 300.0, vel = 80.0, lat = 47.2, lon = -3.0, heading = 0.7;
+    size_t r, leg_start = 0, leg_len = 0;
+    int ch;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        input[ch] = (double *)malloc(rows * sizeof(double));
+        if (input[ch] == NULL) {
+            return -1;
+        }
+    }
+    for (r = 0; r < rows; r++) {
+        double phase, vrate;
+
+        if (r - leg_start >= leg_len) {
+            leg_start = r;
+            leg_len = 2400 + (size_t)((next_noise(&seed) + 1.0) * 1200.0);
+            alt = 300.0;
+            vel = 80.0;
+        }
+        phase = (double)(r - leg_start) / (double)leg_len;
+        if (phase < 0.2) {
+            vrate = 12.0 + 2.0 * next_noise(&seed);
+            vel += 0.08 + 0.05 * next_noise(&seed);
+        } else if (phase < 0.75) {
+            vrate = 1.5 * next_noise(&seed);
+            vel += 0.3 * next_noise(&seed);
+        } else {
+            vrate = -8.0 + 2.0 * next_noise(&seed);
+            vel -= 0.05 + 0.05 * next_noise(&seed);
+        }
+        alt += vrate;
+        heading += 0.002 * next_noise(&seed);
+        lat += vel * cos(heading) * 9e-6;
+        lon += vel * sin(heading) * 1.3e-5;
+
+        input[TREND_DFA_CH_VELOCITY][r] = r % 7919 == 7918 ? 650.0 : vel;
+        input[TREND_DFA_CH_BAROALT][r] = alt;
+        input[TREND_DFA_CH_LAT][r] = lat;
+        input[TREND_DFA_CH_LON][r] = lon;
+        input[TREND_DFA_CH_VERTRATE][r] = vrate;
+    }
+    return 0;
+}
+
+static void record(error_stat_t *s, double err, double bound)
+{
+    double ratio = bound > 0.0 ? err / bound : (err > 0.0 ? HUGE_VAL : 0.0);
+
+    if (err > s->err) s->err = err;
+    if (ratio > s->ratio) s->ratio = ratio;
+    s->checked++;
+}
+
+/* Cycle NaN, +Inf and -Inf through the channels, one sample every n rows */
+static void inject_nonfinite(double **input, size_t rows, size_t every)
+{
+    static const double bad[3] = { NAN, INFINITY, -INFINITY };
+    size_t r, k;
+
+    for (r = every - 1, k = 0; r < rows; r += every, k++) {
+        input[k % TREND_DFA_NUM_CHANNELS][r] = bad[k % 3];
+    }
+}
+
+/* Largest finite |y| of one channel over the whole input */
+static double channel_scale(const double *y, size_t rows)
+{
+    double max_y = 0.0;
+    size_t r;
+
+    for (r = 0; r < rows; r++) {
+        if (isfinite(y[r]) && fabs(y[r]) > max_y) max_y = fabs(y[r]);
+    }
+    return max_y;
+}
+
+/* Check a window's running slope and variance against the two-pass
+ * formulas (calculate_slope/calculate_variance of the original block) and
+ * the drift bound of trend_window.h for a channel whose largest |y| is
+ * max_y. values holds the n samples, the oldest at head. */
+static void check_sums(sums_stat_t *s, int ch, double max_y, const double *values, int head,
+                       int n, double slope, double variance)
+{
+    double sum_y = 0.0, sum_xy = 0.0, mean, m2 = 0.0;
+    double ref_slope, ref_variance;
+    int i, idx = head;
+
+    for (i = 0; i < n; i++) {
+        sum_y += values[idx];
+        sum_xy += (double)(i + 1) * values[idx];
+        idx = idx + 1 == n ? 0 : idx + 1;
+    }
+    mean = sum_y / n;
+    for (i = 0; i < n; i++) {
+        m2 += (values[i] - mean) * (values[i] - mean);
+    }
+    ref_slope = ((double)n * sum_xy - trend_window_sum_x(n) * sum_y) / trend_window_denom(n);
+    ref_variance = m2 / (n - 1);
+
+    if (!isfinite(ref_slope) || !isfinite(ref_variance)) {
+        return;     /* a NaN/Inf is in the window */
+    }
+    if (!isfinite(slope) || !isfinite(variance)) {
+        s->stuck++;
+        return;
+    }
+    record(&s->slope[ch], fabs(slope - ref_slope), 1e-13 * max_y);
+    record(&s->variance[ch], fabs(variance - ref_variance), 1e-14 * max_y * max_y);
+}
+
+/* Check one evaluated step of both reduced-precision DFAs against the
+ * double one, with the bounds of trend_dfa_f32.h and trend_dfa_q.h */
+static void compare_step(const trend_dfa_t *ref, const trend_dfa_output_t *out,
+                         const trend_dfa_f32_t *f, const float *f_state, const float *f_trends,
+                         const trend_dfa_q_t *q, const float *q_state, const float *q_trends,
+                         variant_stat_t *stat)
+{
+    const int n = ref->params.window;
+    const double u = ldexp(1.0, -24);
+    const double sum_x2 = (double)n * ((double)n * n - 1.0) / 12.0;
+    double a = 0.0, weighted_bound[NUM_VARIANTS] = {0.0, 0.0};
+    int ref_anomaly = out->state == STATE_ANOMALY, weighted_ok = 1;
+    int ch, i, v;
+
+    for (i = 0; i < n; i++) {
+        a += fabs((double)i - 0.5 * (n - 1));
+    }
+    a /= sum_x2;
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        const trend_window_t *w = &ref->window[ch];
+        double max_y = 0.0, max_d = 0.0, spread = 0.0, mean = w->sum_y / n;
+        double slope = out->trends[ch], variance = trend_window_variance(w);
+        double e, slope_bound, var_bound, ref_slack_s, ref_slack_v;
+        int finite = 1;
+
+        for (i = 0; i < n; i++) {
+            double y = w->values[i];
+            finite &= isfinite(y);
+            if (fabs(y) > max_y) max_y = fabs(y);
+            if (fabs(y - w->values[w->head]) > max_d) max_d = fabs(y - w->values[w->head]);
+            spread += fabs(y - mean);
+        }
+        if (!finite) {
+            weighted_ok = 0;
+            continue;
+        }
+        /* Drift allowance of the incremental double window, see trend_window.h */
+        ref_slack_s = 1e-13 * max_y;
+        ref_slack_v = 1e-15 * max_y * max_y;
+
+        e = u * max_y;
+        slope_bound = a * (e + (n + 3) * u * max_d) + ref_slack_s;
+        var_bound = (2.0 * e * spread + n * e * e) / (n - 1) + (n + 3) * u * variance + ref_slack_v;
+        record(&stat[0].slope[ch], fabs(trend_dfa_f32_slope(f, 0, ch) - slope), slope_bound);
+        record(&stat[0].variance[ch], fabs(trend_dfa_f32_variance(f, 0, ch) - variance), var_bound);
+        weighted_bound[0] += fabs(ref->params.weight[ch]) * slope_bound;
+
+        if (max_y > 2.0 * ref->params.anomaly[ch]) {
+            /* Saturated in fixed point, an anomaly either way */
+            weighted_ok = 0;
+            continue;
+        }
+        e = ldexp(1.0, -q->frac_bits[ch]);
+        slope_bound = a * e + ldexp(1.0, -22) * fabs(slope) + ref_slack_s;
+        var_bound = (2.0 * e * spread + n * e * e) / (n - 1) + ldexp(1.0, -22) * variance + ref_slack_v;
+        record(&stat[1].slope[ch], fabs(trend_dfa_q_slope(q, 0, ch) - slope), slope_bound);
+        record(&stat[1].variance[ch], fabs(trend_dfa_q_variance(q, 0, ch) - variance), var_bound);
+        weighted_bound[1] += fabs(ref->params.weight[ch]) * slope_bound;
+    }
+
+    if (weighted_ok) {
+        /* Plus the float rounding of the weighted sum itself */
+        double scale = 0.0;
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            scale += fabs(ref->params.weight[ch] * out->trends[ch]);
+        }
+        for (v = 0; v < NUM_VARIANTS; v++) {
+            const float *trends = v == 0 ? f_trends : q_trends;
+            record(&stat[v].slope[TREND_DFA_NUM_CHANNELS],
+                   fabs(trends[TREND_DFA_NUM_CHANNELS] - out->trends[TREND_DFA_NUM_CHANNELS]),
+                   weighted_bound[v] + 8.0 * u * scale);
+        }
+    }
+
+    stat[0].state_mismatch += (int)f_state[0] != out->state;
+    stat[1].state_mismatch += (int)q_state[0] != out->state;
+    stat[0].anomaly_mismatch += ((int)f_state[0] == STATE_ANOMALY) != ref_anomaly;
+    stat[1].anomaly_mismatch += ((int)q_state[0] == STATE_ANOMALY) != ref_anomaly;
+}
+
+int main(int argc, char **argv)
+{
+    const char *input_path = NULL;
+    size_t synth_rows = 0, num_rows = 0, nan_every = 0, r;
+    double *input[TREND_DFA_NUM_CHANNELS] = {NULL};
+    float sample_f[TREND_DFA_NUM_CHANNELS];
+    const float *column_f[TREND_DFA_NUM_CHANNELS];
+    double sample[TREND_DFA_NUM_CHANNELS];
+    trend_dfa_params_t params;
+    trend_dfa_t ref;
+    trend_dfa_output_t out;
+    trend_dfa_f32_t f;
+    trend_dfa_q_t q;
+    trend_dfa_multi_t m;
+    const double *column[TREND_DFA_NUM_CHANNELS];
+    double m_state, m_conf, m_trends[TREND_DFA_NUM_TRENDS];
+    double scale[TREND_DFA_NUM_CHANNELS];
+    sums_stat_t sums[NUM_SUMS];
+    float f_state, f_conf, f_trends[TREND_DFA_NUM_TRENDS];
+    float q_state, q_conf, q_trends[TREND_DFA_NUM_TRENDS];
+    variant_stat_t stat[NUM_VARIANTS];
+    struct timespec t0, t1;
+    double secs[3];
+    size_t bytes_double, bytes_low;
+    long bad_line = 0;
+    int quiet = 0, failed = 0;
+    int ch, i, v;
+
+    trend_dfa_default_params(&params);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            synth_rows = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+            params.window = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--nan") == 0 && i + 1 < argc) {
+            nan_every = (size_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            input_path = argv[i];
+        }
+    }
+    if ((input_path == NULL) == (synth_rows == 0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (trend_dfa_init_params(&ref, &params) != 0 ||
+        trend_dfa_f32_alloc(&f, 1, &params) != 0 || trend_dfa_q_alloc(&q, 1, &params) != 0 ||
+        trend_dfa_multi_alloc(&m, 1, &params) != 0) {
+        fprintf(stderr, "%s: invalid window or parameters\n", argv[0]);
+        return 2;
+    }
+
+    if (synth_rows > 0) {
+        if (synth_track(input, synth_rows) != 0) {
+            fprintf(stderr, "%s: out of memory\n", argv[0]);
+            return 1;
+        }
+        num_rows = synth_rows;
+    } else if (load_track(input_path, input, &num_rows, &bad_line) != 0) {
+        if (bad_line > 0) {
+            fprintf(stderr, "%s: malformed row at %s:%ld\n", argv[0], input_path, bad_line);
+        } else {
+            fprintf(stderr, "%s: cannot read %s or required columns missing\n", argv[0], input_path);
+        }
+        return 1;
+    }
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        scale[ch] = channel_scale(input[ch], num_rows);
+    }
+    if (nan_every > 0) {
+        inject_nonfinite(input, num_rows, nan_every);
+    }
+
+    /* Lockstep comparison */
+    memset(stat, 0, sizeof(stat));
+    memset(sums, 0, sizeof(sums));
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        column_f[ch] = &sample_f[ch];
+        column[ch] = &sample[ch];
+    }
+    for (r = 0; r < num_rows; r++) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            sample[ch] = input[ch][r];
+            sample_f[ch] = (float)input[ch][r];
+        }
+        trend_dfa_step(&ref, sample, &out);
+        trend_dfa_f32_step(&f, column_f, &f_state, &f_conf, f_trends);
+        trend_dfa_q_step(&q, column_f, &q_state, &q_conf, q_trends);
+        trend_dfa_multi_step(&m, column, &m_state, &m_conf, m_trends);
+        if (r + 1 >= (size_t)params.window) {
+            compare_step(&ref, &out, &f, &f_state, f_trends, &q, &q_state, q_trends, stat);
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                const int w = params.window;
+                const double m2 = m.stats[TREND_DFA_MULTI_M2 * TREND_DFA_NUM_CHANNELS + ch];
+
+                check_sums(&sums[0], ch, scale[ch], ref.window[ch].values, ref.window[ch].head, w,
+                           out.trends[ch], trend_window_variance(&ref.window[ch]));
+                check_sums(&sums[1], ch, scale[ch], &m.values[(size_t)ch * w],
+                           m.control[TREND_DFA_MULTI_CTRL_HEAD], w, m_trends[ch],
+                           m2 > 0.0 ? m2 / (w - 1) : 0.0);
+            }
+        }
+    }
+
+    /* Each DFA alone */
+    trend_dfa_init_params(&ref, &params);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (r = 0; r < num_rows; r++) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            sample[ch] = input[ch][r];
+        }
+        trend_dfa_step(&ref, sample, &out);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    secs[0] = elapsed_seconds(&t0, &t1);
+
+    trend_dfa_f32_init(&f);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (r = 0; r < num_rows; r++) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            sample_f[ch] = (float)input[ch][r];
+        }
+        trend_dfa_f32_step(&f, column_f, &f_state, &f_conf, f_trends);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    secs[1] = elapsed_seconds(&t0, &t1);
+
+    trend_dfa_q_init(&q);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (r = 0; r < num_rows; r++) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            sample_f[ch] = (float)input[ch][r];
+        }
+        trend_dfa_q_step(&q, column_f, &q_state, &q_conf, q_trends);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    secs[2] = elapsed_seconds(&t0, &t1);
+
+    /* Per-track state of the Simulink block in each precision */
+    bytes_double = TREND_DFA_MULTI_VALUES_LEN(1, params.window) * sizeof(double) +
+                   TREND_DFA_MULTI_STATS_LEN(1) * sizeof(double) +
+                   TREND_DFA_MULTI_COUNTS_LEN(1) * sizeof(int32_t) + 2 * sizeof(int32_t);
+    bytes_low = TREND_DFA_F32_VALUES_LEN(1, params.window) * sizeof(float) + 2 * sizeof(int32_t);
+
+    for (v = 0; v < NUM_VARIANTS; v++) {
+        for (ch = 0; ch < TREND_DFA_NUM_TRENDS; ch++) {
+            failed |= stat[v].slope[ch].ratio > 1.0;
+            if (ch < TREND_DFA_NUM_CHANNELS) {
+                failed |= stat[v].variance[ch].ratio > 1.0;
+            }
+        }
+    }
+    for (v = 0; v < NUM_SUMS; v++) {
+        for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+            failed |= sums[v].slope[ch].ratio > 1.0 || sums[v].variance[ch].ratio > 1.0;
+        }
+        failed |= sums[v].stuck > 0;
+    }
+
+    if (!quiet) {
+        printf("rows:        %lu\n", (unsigned long)num_rows);
+        printf("window:      %d\n", params.window);
+        printf("bytes/track: double %lu, float32 %lu, q %lu\n",
+               (unsigned long)bytes_double, (unsigned long)bytes_low, (unsigned long)bytes_low);
+        printf("step time:   double %.1f ns, float32 %.1f ns, q %.1f ns\n",
+               secs[0] * 1e9 / (double)(num_rows ? num_rows : 1),
+               secs[1] * 1e9 / (double)(num_rows ? num_rows : 1),
+               secs[2] * 1e9 / (double)(num_rows ? num_rows : 1));
+        printf("%-8s %-13s %12s %9s %12s %9s\n",
+               "dfa", "channel", "slope err", "/bound", "var err", "/bound");
+        for (v = 0; v < NUM_VARIANTS; v++) {
+            for (ch = 0; ch < TREND_DFA_NUM_TRENDS; ch++) {
+                const error_stat_t *s = &stat[v].slope[ch];
+                printf("%-8s %-13s %12.3g %9.3f", variant_name[v], channel_name[ch], s->err, s->ratio);
+                if (ch < TREND_DFA_NUM_CHANNELS) {
+                    printf(" %12.3g %9.3f\n", stat[v].variance[ch].err, stat[v].variance[ch].ratio);
+                } else {
+                    printf("\n");
+                }
+            }
+            printf("%-8s states differing: %lu, anomaly flags differing: %lu\n", variant_name[v],
+                   stat[v].state_mismatch, stat[v].anomaly_mismatch);
+        }
+        printf("%-8s %-13s %12s %9s %12s %9s\n",
+               "2-pass", "channel", "slope err", "/bound", "var err", "/bound");
+        for (v = 0; v < NUM_SUMS; v++) {
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                printf("%-8s %-13s %12.3g %9.3f %12.3g %9.3f\n", sums_name[v], channel_name[ch],
+                       sums[v].slope[ch].err, sums[v].slope[ch].ratio,
+                       sums[v].variance[ch].err, sums[v].variance[ch].ratio);
+            }
+            printf("%-8s non-finite after the NaN/Inf left: %lu\n", sums_name[v], sums[v].stuck);
+        }
+    }
+    if (failed) {
+        fprintf(stderr, "%s: error bound exceeded\n", argv[0]);
+    }
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        free(input[ch]);
+    }
+    trend_dfa_f32_free(&f);
+    trend_dfa_q_free(&q);
+    trend_dfa_multi_free(&m);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,247 @@
+/* arinc429_fleet_replay.c - Replay a multi-aircraft flight dump in parallel
+ *
+ * Rows are partitioned by icao24 and every aircraft runs through its own
+ * trend DFA on a work-stealing thread pool (flight_fleet.h). The CSV output
+ * is merged back into file order and carries the icao24 of each row. The
+ * other sinks are per aircraft: one flight_rec recording <file>.<icao24>
+ * each and, with SQLite available, one SIMULATION run each in
+ * arinc_verileri.db, described as "<input> icao24 <icao24>". The ARINC word
+ * loopback of arinc429_replay is not applied; inputs go to the DFA as read.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "flight_fleet.h"
+#include "flight_rec.h"
+#include "trend_dfa.h"
+#if ARINC429_HAVE_SQLITE
+#include "arinc_db.h"
+#endif
+
+#define PATH_LEN 4096
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <input.csv>\n"
+            "  -j <n>      worker threads (default: online CPUs)\n"
+            "  -o <file>   write per-row DFA output as CSV, in file order\n"
+            "  -r <file>   record inputs and DFA output as flight_rec files\n"
+            "              <file>.<icao24>, one per aircraft (time must not go\n"
+            "              backwards within an aircraft)\n"
+#if ARINC429_HAVE_SQLITE
+            "  -d <db>     log one run per aircraft into an arinc_verileri.db style\n"
+            "              database\n"
+#endif
+            "  -v          print per-worker counters\n"
+            "  -q          do not print the summary\n",
+            prog);
+}
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *stop)
+{
+    return (double)(stop->tv_sec - start->tv_sec) +
+           (double)(stop->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    const char *record_path = NULL;
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int quiet = 0, verbose = 0, failed = 0, rec_failed = 0, i;
+    flight_fleet_t fleet;
+    flight_fleet_worker_t workers[FLIGHT_FLEET_MAX_THREADS];
+    unsigned long state_count[STATE_ANOMALY + 1] = {0};
+    struct timespec t0, t1, t2, t3;
+    flight_rec_writer_t rec;
+    char path[PATH_LEN];
+    FILE *out = NULL;
+    size_t r, t;
+#if ARINC429_HAVE_SQLITE
+    const char *db_path = NULL;
+    arinc_db_config_t db_cfg;
+    arinc_db_run_t run;
+    arinc_db_t *db = NULL;
+    char description[PATH_LEN];
+    int db_failed = 0;
+
+    arinc_db_default_config(&db_cfg);
+#endif
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+#if ARINC429_HAVE_SQLITE
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            db_path = argv[++i];
+#endif
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            input_path = argv[i];
+        }
+    }
+    if (input_path == NULL || num_threads < 1 || num_threads > FLIGHT_FLEET_MAX_THREADS) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (flight_fleet_load(&fleet, input_path, num_threads) != 0) {
+        if (fleet.bad_line != 0) {
+            fprintf(stderr, "%s: malformed row at %s:%ld\n", argv[0], input_path, fleet.bad_line);
+        } else {
+            fprintf(stderr, "%s: cannot read %s or required columns (icao24, ...) missing\n",
+                    argv[0], input_path);
+        }
+        flight_fleet_free(&fleet);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    if (flight_fleet_run(&fleet, num_threads, workers) != 0) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        flight_fleet_free(&fleet);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+
+    if (output_path != NULL) {
+        out = fopen(output_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "%s: cannot create %s\n", argv[0], output_path);
+            flight_fleet_free(&fleet);
+            return 1;
+        }
+        fprintf(out, "sample,icao24,time,state,confidence,vel_trend,baroalt_trend,lat_trend,"
+                     "lon_trend,vertrate_trend,weighted_trend\n");
+    }
+#if ARINC429_HAVE_SQLITE
+    if (db_path != NULL) {
+        db = arinc_db_open(db_path, &db_cfg);
+        if (db == NULL) {
+            fprintf(stderr, "%s: cannot open database %s\n", argv[0], db_path);
+            flight_fleet_free(&fleet);
+            return 1;
+        }
+    }
+#endif
+
+    /* Merge the per-track results back into file order */
+    for (r = 0; r < fleet.num_rows; r++) {
+        size_t pos = flight_fleet_position(&fleet, r);
+        double sample[TREND_DFA_NUM_CHANNELS];
+        trend_dfa_output_t result;
+
+        flight_fleet_row(&fleet, pos, sample, &result);
+        state_count[result.state]++;
+
+        if (out != NULL) {
+            fprintf(out, "%zu,%06x,%.10g,%d,%.6g", r,
+                    (unsigned)fleet.icao24[flight_fleet_track_of(&fleet, pos)],
+                    fleet.time[pos], result.state, result.confidence);
+            for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+                fprintf(out, ",%.10g", result.trends[i]);
+            }
+            fputc('\n', out);
+        }
+    }
+    if (out != NULL && fclose(out) != 0) {
+        failed = 1;
+    }
+
+    /* Recordings and database runs per aircraft, in track order */
+    for (t = 0; t < fleet.num_tracks; t++) {
+        size_t first = fleet.track_start[t], end = fleet.track_start[t + 1];
+        unsigned icao24 = (unsigned)fleet.icao24[t];
+        double sample[TREND_DFA_NUM_CHANNELS];
+        trend_dfa_output_t result;
+
+        if (record_path != NULL && !rec_failed) {
+            memset(&rec, 0, sizeof(rec));
+            rec_failed = (size_t)snprintf(path, sizeof(path), "%s.%06x", record_path, icao24) >=
+                         sizeof(path) || flight_rec_create(&rec, path, 0) != 0;
+            for (r = first; r < end && !rec_failed; r++) {
+                flight_fleet_row(&fleet, r, sample, &result);
+                rec_failed = flight_rec_append(&rec, fleet.time[r], sample, &result) != 0;
+            }
+            rec_failed |= flight_rec_close(&rec) != 0;
+            if (rec_failed) {
+                fprintf(stderr, "%s: writing %s failed\n", argv[0], path);
+            }
+        }
+#if ARINC429_HAVE_SQLITE
+        if (db != NULL && !db_failed && end > first) {
+            flight_fleet_row(&fleet, first, sample, &result);
+            snprintf(description, sizeof(description), "%s icao24 %06x", input_path, icao24);
+            memset(&run, 0, sizeof(run));
+            run.name = "arinc429_fleet_replay";
+            run.description = description;
+            run.latitude = sample[TREND_DFA_CH_LAT];
+            run.longitude = sample[TREND_DFA_CH_LON];
+            run.start_time = fleet.time[first];
+            run.time_step = 1.0;
+            db_failed = arinc_db_begin_run(db, &run) < 0;
+            for (r = first; r < end && !db_failed; r++) {
+                flight_fleet_row(&fleet, r, sample, &result);
+                db_failed = arinc_db_append(db, fleet.time[r], sample, &result) != 0;
+            }
+            db_failed |= arinc_db_end_run(db, fleet.time[end - 1],
+                                          db_failed ? "failed" : "completed") != 0;
+        }
+#endif
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t3);
+
+    failed |= rec_failed;
+#if ARINC429_HAVE_SQLITE
+    if (db != NULL) {
+        failed |= db_failed;
+        if (db_failed) {
+            fprintf(stderr, "%s: %s: %s\n", argv[0], db_path, arinc_db_errmsg(db));
+        }
+        failed |= arinc_db_close(db) != 0;
+    }
+#endif
+    if (failed) {
+        fprintf(stderr, "%s: writing the output failed\n", argv[0]);
+    }
+
+    if (!quiet) {
+        double run_secs = elapsed_seconds(&t1, &t2);
+        printf("rows:        %zu in %zu tracks\n", fleet.num_rows, fleet.num_tracks);
+        printf("threads:     %d\n", num_threads);
+        printf("load:        %.6f s (parse and partition)\n", elapsed_seconds(&t0, &t1));
+        printf("dfa:         %.6f s (%.0f rows/s)\n", run_secs,
+               run_secs > 0.0 ? (double)fleet.num_rows / run_secs : 0.0);
+        printf("merge:       %.6f s\n", elapsed_seconds(&t2, &t3));
+        printf("states:      STABLE=%lu INCREASING=%lu DECREASING=%lu OSCILLATING=%lu ANOMALY=%lu\n",
+               state_count[STATE_STABLE], state_count[STATE_INCREASING],
+               state_count[STATE_DECREASING], state_count[STATE_OSCILLATING],
+               state_count[STATE_ANOMALY]);
+        if (verbose) {
+            printf("worker  tracks    rows        steals\n");
+            for (i = 0; i < num_threads; i++) {
+                printf("%6d  %-8llu  %-10llu  %llu\n", i, (unsigned long long)workers[i].tracks,
+                       (unsigned long long)workers[i].rows, (unsigned long long)workers[i].steals);
+            }
+        }
+    }
+
+    flight_fleet_free(&fleet);
+    return failed ? 1 : 0;
+}
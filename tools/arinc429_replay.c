@@ -0,0 +1,541 @@
+/* arinc429_replay.c - Replay a recorded flight CSV through the ARINC 429 chain at native speed
+ *
+ * For every row the five flight parameters are packed into 32-bit ARINC 429
+ * BCD words (arinc429_word_encoder), decoded again (arinc429_word_decoder) and
+ * fed to the trend DFA (trend_dfa_sfunc_flight), mirroring arinc429_decoder.slx
+ * without a Simulink session. The sign travels in the SSM, so negative
+ * longitudes and vertical rates survive the loopback. With --bnr the words
+ * are BNR instead, through the per-label codecs generated from
+ * arinc429_label_table.h, which keep the fractional part BCD drops.
+ *
+ * The CSV is memory-mapped and read in chunks of FLIGHT_CSV_STREAM_CHUNK rows;
+ * each chunk goes through the batch word codec one channel at a time, so
+ * memory use stays fixed however large the dump is.
+ *
+ * With SQLite available (ARINC429_HAVE_SQLITE) the DFA output can also be
+ * logged into arinc_verileri.db as one SIMULATION_RUN.
+ *
+ * With -c the DFA state is checkpointed every --every rows (trend_ckpt.h),
+ * together with the position in the CSV. --resume restores the last
+ * checkpoint at or before row --at and carries on from the next row without
+ * reading the file before it, so an interrupted run continues where it
+ * stopped. Several runs can start from one checkpoint with different --set
+ * thresholds (what-if runs).
+ *
+ * With --decimate the decoded samples go through the anti-alias filter of
+ * trend_decim.h and the DFA steps on every n-th row only. Its slopes are then
+ * per n rows, so the thresholds given with --set should allow for that.
+ *
+ * Built with -DARINC429_STATS=1 (cmake -DARINC429_STATS=ON) the chunk encode
+ * and decode and every DFA step are timed into latency histograms, the same
+ * ones the S-functions dump at mdlTerminate, and --stats writes them as JSON.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arinc429_bcd.h"
+#include "arinc429_codec.h"
+#include "arinc429_word.h"
+#include "arinc429_bcd_batch.h"
+#include "arinc429_stats.h"
+#include "flight_csv_stream.h"
+#include "flight_rec.h"
+#include "trend_ckpt.h"
+#include "trend_decim.h"
+#include "trend_dfa.h"
+#if ARINC429_HAVE_SQLITE
+#include "arinc_db.h"
+#endif
+
+/* Octal label per TREND_DFA_CH_* channel used for the loopback words */
+static const uint8_t channel_label[TREND_DFA_NUM_CHANNELS] = {
+    0312,   /* ground speed */
+    0203,   /* pressure altitude */
+    0310,   /* present position latitude */
+    0311,   /* present position longitude */
+    0212    /* altitude rate */
+};
+
+/* Encode a chunk of one channel into BNR words and decode it in place;
+ * returns the number of words that failed to decode */
+#define BNR_LOOPBACK(name)                                                          \
+    static unsigned long loopback_##name(double *x, uint32_t *words, long n)       \
+    {                                                                              \
+        unsigned long errors = 0;                                                  \
+        long r;                                                                    \
+        for (r = 0; r < n; r++) {                                                  \
+            words[r] = arinc429_##name##_encode(0, x[r]);                          \
+        }                                                                          \
+        for (r = 0; r < n; r++) {                                                  \
+            if (arinc429_##name##_decode(words[r], &x[r]) != ARINC429_OK ||        \
+                arinc429_word_label(words[r]) != arinc429_##name##_label) {        \
+                errors++;                                                          \
+            }                                                                      \
+        }                                                                          \
+        return errors;                                                             \
+    }
+
+BNR_LOOPBACK(ground_speed)
+BNR_LOOPBACK(pressure_alt)
+BNR_LOOPBACK(latitude)
+BNR_LOOPBACK(longitude)
+BNR_LOOPBACK(altitude_rate)
+
+static unsigned long (*const bnr_loopback[TREND_DFA_NUM_CHANNELS])(double *, uint32_t *, long) = {
+    loopback_ground_speed,
+    loopback_pressure_alt,
+    loopback_latitude,
+    loopback_longitude,
+    loopback_altitude_rate
+};
+
+#define DEFAULT_CKPT_EVERY 65536UL
+
+/* Thresholds --set may change; they are read at every step, so they also
+ * apply to a restored DFA */
+static const struct {
+    const char *name;
+    size_t      offset;
+} tunable[] = {
+    { "stable",      offsetof(trend_dfa_params_t, stable) },
+    { "increase",    offsetof(trend_dfa_params_t, increase) },
+    { "decrease",    offsetof(trend_dfa_params_t, decrease) },
+    { "oscillation", offsetof(trend_dfa_params_t, oscillation) },
+};
+#define NUM_TUNABLE (sizeof(tunable) / sizeof(tunable[0]))
+#define MAX_SETS    8
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <input.csv>\n"
+            "  -o <file>   write per-sample DFA output as CSV (default: none)\n"
+            "  -r <file>   record inputs and DFA output as a flight_rec file\n"
+            "              (time = row index, i.e. seconds for 1 Hz dumps)\n"
+#if ARINC429_HAVE_SQLITE
+            "  -d <db>     log the run into an arinc_verileri.db style database\n"
+            "  --sync <n>  PRAGMA synchronous for -d (0 OFF, 1 NORMAL, 2 FULL)\n"
+#endif
+            "  --bnr       loop back through BNR words instead of BCD\n"
+            "  --direct    bypass the ARINC word encode/decode stage\n"
+            "  -c <file>   write checkpoints of the DFA state to file\n"
+            "  --every <n> rows between checkpoints (default %lu, rounded up to whole chunks)\n"
+            "  --resume <file>  continue from a checkpoint of the same input\n"
+            "  --at <row>  resume from the last checkpoint at or before this row (default: last)\n"
+            "  --set <name>=<value>  override a threshold (stable, increase, decrease,\n"
+            "              oscillation), also after --resume\n"
+            "  --decimate <n>  low-pass filter the samples and step the DFA on every\n"
+            "              n-th row (1..%d; not with -c or --resume)\n"
+#if ARINC429_STATS
+            "  --stats <file>  write per-stage latency histograms and counters as JSON\n"
+#endif
+            "  -q          do not print the summary\n",
+            prog, DEFAULT_CKPT_EVERY, TREND_DECIM_MAX_RATIO);
+}
+
+#if ARINC429_STATS
+/* Values the word encoder clamps (NaN included) */
+static uint64_t count_clamped(const double *v, long n)
+{
+    uint64_t clamped = 0;
+    long r;
+
+    for (r = 0; r < n; r++) {
+        clamped += !(fabs(v[r]) <= ARINC429_BCD_FIELD_MAX_VALUE);
+    }
+    return clamped;
+}
+#endif
+
+/* Parse name=value into one of the tunable thresholds; returns its index or -1 */
+static int parse_set(const char *arg, double *value)
+{
+    const char *eq = strchr(arg, '=');
+    char *end;
+    size_t k;
+
+    if (eq == NULL) {
+        return -1;
+    }
+    for (k = 0; k < NUM_TUNABLE; k++) {
+        if (strlen(tunable[k].name) == (size_t)(eq - arg) &&
+            strncmp(arg, tunable[k].name, (size_t)(eq - arg)) == 0) {
+            *value = strtod(eq + 1, &end);
+            return (end != eq + 1 && *end == '\0') ? (int)k : -1;
+        }
+    }
+    return -1;
+}
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *stop)
+{
+    return (double)(stop->tv_sec - start->tv_sec) +
+           (double)(stop->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    const char *input_path = NULL;
+    const char *output_path = NULL;
+    const char *record_path = NULL;
+    const char *ckpt_path = NULL, *resume_path = NULL;
+    unsigned long ckpt_every = DEFAULT_CKPT_EVERY, resume_at = 0, first_row = 0, last_ckpt = 0;
+    int have_at = 0, num_sets = 0, ckpt_failed = 0, rec_failed = 0, set_index[MAX_SETS];
+    double set_value[MAX_SETS];
+    trend_ckpt_writer_t ckpt;
+    trend_ckpt_info_t at;
+    int direct = 0, bnr = 0, quiet = 0;
+    flight_csv_stream_t csv;
+    trend_dfa_t dfa;
+    trend_dfa_output_t result;
+    trend_decim_t decim;
+    int decimate = 1;
+    const double *row_in[TREND_DFA_NUM_CHANNELS];
+    double sample[TREND_DFA_NUM_CHANNELS];
+    double *column[TREND_DFA_NUM_CHANNELS] = {NULL};
+    uint32_t *words = NULL;
+    int8_t *status = NULL;
+    unsigned long state_count[STATE_ANOMALY + 1] = {0};
+    unsigned long rows = 0, steps = 0, word_errors = 0;
+    struct timespec t_start, t_stop;
+    FILE *out = NULL;
+    flight_rec_writer_t rec;
+    long n, r;
+    int ch, i, failed = 0;
+#if ARINC429_HAVE_SQLITE
+    const char *db_path = NULL;
+    arinc_db_config_t db_cfg;
+    arinc_db_run_t run;
+    arinc_db_t *db = NULL;
+    int db_failed = 0;
+
+    arinc_db_default_config(&db_cfg);
+#endif
+#if ARINC429_STATS
+    const char *stats_path = NULL;
+    int st_encode, st_decode, st_dfa, prev_state = STATE_STABLE;
+#endif
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output_path = argv[++i];
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            record_path = argv[++i];
+#if ARINC429_HAVE_SQLITE
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            db_path = argv[++i];
+        } else if (strcmp(argv[i], "--sync") == 0 && i + 1 < argc) {
+            db_cfg.synchronous = atoi(argv[++i]);
+#endif
+#if ARINC429_STATS
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            stats_path = argv[++i];
+#endif
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            ckpt_path = argv[++i];
+        } else if (strcmp(argv[i], "--every") == 0 && i + 1 < argc) {
+            ckpt_every = strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+            resume_path = argv[++i];
+        } else if (strcmp(argv[i], "--at") == 0 && i + 1 < argc) {
+            resume_at = strtoul(argv[++i], NULL, 10);
+            have_at = 1;
+        } else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            if (num_sets == MAX_SETS ||
+                (set_index[num_sets] = parse_set(argv[++i], &set_value[num_sets])) < 0) {
+                fprintf(stderr, "%s: bad --set '%s'\n", argv[0], argv[i]);
+                return 2;
+            }
+            num_sets++;
+        } else if (strcmp(argv[i], "--decimate") == 0 && i + 1 < argc) {
+            decimate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bnr") == 0) {
+            bnr = 1;
+        } else if (strcmp(argv[i], "--direct") == 0) {
+            direct = 1;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            input_path = argv[i];
+        }
+    }
+    if (input_path == NULL || ckpt_every == 0 ||
+        trend_decim_check(decimate, TREND_DECIM_DEFAULT_TAPS_PER_PHASE) != 0) {
+        usage(argv[0]);
+        return 2;
+    }
+    /* Checkpoints hold the DFA state only, not the filter history */
+    if (decimate > 1 && (ckpt_path != NULL || resume_path != NULL)) {
+        fprintf(stderr, "%s: --decimate cannot be combined with -c or --resume\n", argv[0]);
+        return 2;
+    }
+
+    if (flight_csv_stream_open(&csv, input_path, 0) != 0) {
+        fprintf(stderr, "%s: cannot open %s or required columns missing\n", argv[0], input_path);
+        return 1;
+    }
+
+    if (output_path != NULL) {
+        out = fopen(output_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "%s: cannot create %s\n", argv[0], output_path);
+            flight_csv_stream_close(&csv);
+            return 1;
+        }
+        fprintf(out, "sample,state,confidence,vel_trend,baroalt_trend,lat_trend,"
+                     "lon_trend,vertrate_trend,weighted_trend\n");
+    }
+
+    if (record_path != NULL && flight_rec_create(&rec, record_path, 0) != 0) {
+        fprintf(stderr, "%s: cannot create %s\n", argv[0], record_path);
+        flight_csv_stream_close(&csv);
+        return 1;
+    }
+
+#if ARINC429_HAVE_SQLITE
+    if (db_path != NULL && (db = arinc_db_open(db_path, &db_cfg)) == NULL) {
+        fprintf(stderr, "%s: cannot open database %s\n", argv[0], db_path);
+        flight_csv_stream_close(&csv);
+        return 1;
+    }
+#endif
+
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        column[ch] = malloc(FLIGHT_CSV_STREAM_CHUNK * sizeof(double));
+        failed |= (column[ch] == NULL);
+    }
+    words = malloc(FLIGHT_CSV_STREAM_CHUNK * sizeof(uint32_t));
+    status = malloc(FLIGHT_CSV_STREAM_CHUNK * sizeof(int8_t));
+    memset(&decim, 0, sizeof(decim));
+    if (decimate > 1) {
+        failed |= trend_decim_alloc(&decim, 1, decimate, TREND_DECIM_DEFAULT_TAPS_PER_PHASE) != 0;
+    }
+    if (failed || words == NULL || status == NULL) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return 1;
+    }
+
+#if ARINC429_STATS
+    st_encode = arinc429_stats_register("replay/bcd_encode_words");
+    st_decode = arinc429_stats_register("replay/bcd_decode_words");
+    st_dfa = arinc429_stats_register("replay/trend_dfa_step");
+#endif
+
+    trend_dfa_init(&dfa);
+
+    if (resume_path != NULL) {
+        trend_ckpt_reader_t reader;
+        uint64_t k;
+
+        if (trend_ckpt_open(&reader, resume_path) != 0 || reader.count == 0) {
+            fprintf(stderr, "%s: %s is not a checkpoint file or holds no checkpoint\n", argv[0],
+                    resume_path);
+            return 1;
+        }
+        /* Checkpoint times are the index of the last row stepped */
+        k = have_at ? trend_ckpt_seek_time(&reader, (double)resume_at) : reader.count - 1;
+        if (k == reader.count ||
+            trend_ckpt_load(&dfa, trend_ckpt_get(&reader, k), reader.snap_bytes, &at) != 0 ||
+            flight_csv_stream_seek(&csv, at.source_pos, (long)at.source_line) != 0) {
+            fprintf(stderr, "%s: no usable checkpoint%s in %s\n", argv[0],
+                    have_at ? " at or before --at" : "", resume_path);
+            trend_ckpt_close_reader(&reader);
+            return 1;
+        }
+        trend_ckpt_close_reader(&reader);
+        rows = first_row = last_ckpt = (unsigned long)at.row;
+    }
+    for (i = 0; i < num_sets; i++) {
+        *(double *)((char *)&dfa.params + tunable[set_index[i]].offset) = set_value[i];
+    }
+    if (trend_dfa_check_params(&dfa.params) != 0) {
+        fprintf(stderr, "%s: --set values rejected (thresholds must not be NaN)\n", argv[0]);
+        return 2;
+    }
+
+    memset(&ckpt, 0, sizeof(ckpt));
+    if (ckpt_path != NULL && trend_ckpt_create(&ckpt, ckpt_path) != 0) {
+        fprintf(stderr, "%s: cannot create %s\n", argv[0], ckpt_path);
+        return 1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+
+    while ((n = flight_csv_stream_read(&csv, column, FLIGHT_CSV_STREAM_CHUNK)) > 0) {
+        if (!direct && bnr) {
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                word_errors += bnr_loopback[ch](column[ch], words, n);
+            }
+        } else if (!direct) {
+            /* Transmit/receive loopback through packed BCD words */
+            for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                ARINC429_STATS_COUNT(st_encode, ARINC429_STATS_CLAMPED, count_clamped(column[ch], n));
+
+                ARINC429_STATS_START(t_encode);
+                arinc429_bcd_encode_words(column[ch], words, (size_t)n, channel_label[ch], 0);
+                ARINC429_STATS_STOP(st_encode, t_encode, (uint64_t)n);
+
+                ARINC429_STATS_START(t_decode);
+                arinc429_bcd_decode_words(words, column[ch], status, (size_t)n);
+                ARINC429_STATS_STOP(st_decode, t_decode, (uint64_t)n);
+                for (r = 0; r < n; r++) {
+                    if (status[r] != ARINC429_OK || arinc429_word_label(words[r]) != channel_label[ch]) {
+                        word_errors++;
+                    }
+                }
+            }
+        }
+
+        for (r = 0; r < n; r++) {
+            if (decimate > 1) {
+                for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                    row_in[ch] = &column[ch][r];
+                }
+                if (!trend_decim_push(&decim, row_in, sample)) {
+                    rows++;
+                    continue;
+                }
+            } else {
+                for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                    sample[ch] = column[ch][r];
+                }
+            }
+
+            ARINC429_STATS_START(t_dfa);
+            trend_dfa_step(&dfa, sample, &result);
+            ARINC429_STATS_STOP(st_dfa, t_dfa, 1);
+            state_count[result.state]++;
+            steps++;
+#if ARINC429_STATS
+            if (result.state != prev_state) {
+                arinc429_stats_count(st_dfa, ARINC429_STATS_ENTER(result.state), 1);
+                prev_state = result.state;
+            }
+            if (result.state == STATE_ANOMALY) {
+                arinc429_stats_count(st_dfa, ARINC429_STATS_ANOMALY, 1);
+            }
+#endif
+
+            if (out != NULL) {
+                fprintf(out, "%lu,%d,%.6g", rows, result.state, result.confidence);
+                for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+                    fprintf(out, ",%.10g", result.trends[i]);
+                }
+                fputc('\n', out);
+            }
+            if (record_path != NULL && !rec_failed) {
+                rec_failed = flight_rec_append(&rec, (double)rows, sample, &result) != 0;
+            }
+#if ARINC429_HAVE_SQLITE
+            if (db != NULL && !db_failed) {
+                if (rows == first_row) {
+                    /* The run is located at the first position replayed */
+                    memset(&run, 0, sizeof(run));
+                    run.name = "arinc429_replay";
+                    run.description = input_path;
+                    run.latitude = sample[TREND_DFA_CH_LAT];
+                    run.longitude = sample[TREND_DFA_CH_LON];
+                    run.time_step = 1.0;
+                    db_failed |= arinc_db_begin_run(db, &run) < 0;
+                }
+                db_failed |= arinc_db_append(db, (double)rows, sample, &result) != 0;
+            }
+#endif
+            rows++;
+        }
+
+        /* At a chunk boundary the CSV position is that of the next row */
+        if (ckpt_path != NULL && !ckpt_failed && rows - last_ckpt >= ckpt_every) {
+            at.time = (double)(rows - 1);
+            at.row = rows;
+            at.source_pos = flight_csv_stream_tell(&csv);
+            at.source_line = csv.line;
+            ckpt_failed = trend_ckpt_append(&ckpt, &dfa, &at) != 0;
+            last_ckpt = rows;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t_stop);
+
+    if (n < 0) {
+        fprintf(stderr, "%s: malformed row at %s:%ld\n", argv[0], input_path, csv.line);
+    }
+    flight_csv_stream_close(&csv);
+    if (ckpt_path != NULL && (trend_ckpt_close(&ckpt) != 0 || ckpt_failed)) {
+        fprintf(stderr, "%s: writing %s failed\n", argv[0], ckpt_path);
+        n = -1;
+    }
+    if (out != NULL) {
+        fclose(out);
+    }
+    if (record_path != NULL && (flight_rec_close(&rec) != 0 || rec_failed)) {
+        fprintf(stderr, "%s: writing %s failed\n", argv[0], record_path);
+        n = -1;
+    }
+#if ARINC429_HAVE_SQLITE
+    if (db != NULL) {
+        if ((rows > 0 && arinc_db_end_run(db, (double)rows, n < 0 ? "failed" : "completed") != 0) ||
+            db_failed) {
+            fprintf(stderr, "%s: writing %s failed: %s\n", argv[0], db_path, arinc_db_errmsg(db));
+            n = -1;
+        }
+        arinc_db_close(db);
+    }
+#endif
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        free(column[ch]);
+    }
+    free(words);
+    free(status);
+    if (decimate > 1) {
+        trend_decim_free(&decim);
+    }
+
+#if ARINC429_STATS
+    if (stats_path != NULL) {
+        FILE *fp = fopen(stats_path, "w");
+        int st_failed = fp == NULL;
+
+        if (fp != NULL) {
+            st_failed |= arinc429_stats_write_json(fp, -1) != 0;
+            st_failed |= fclose(fp) != 0;
+        }
+        if (st_failed) {
+            fprintf(stderr, "%s: writing %s failed\n", argv[0], stats_path);
+            n = -1;
+        }
+    }
+#endif
+
+    if (!quiet) {
+        double secs = elapsed_seconds(&t_start, &t_stop);
+        printf("rows:        %lu\n", rows - first_row);
+        if (resume_path != NULL) {
+            printf("resumed at:  row %lu\n", first_row);
+        }
+        if (ckpt_path != NULL) {
+            printf("checkpoints: %llu\n", (unsigned long long)ckpt.count);
+        }
+        if (decimate > 1) {
+            printf("dfa steps:   %lu (1 in %d rows)\n", steps, decimate);
+        }
+        printf("elapsed:     %.6f s\n", secs);
+        printf("throughput:  %.0f rows/s\n", secs > 0.0 ? (double)(rows - first_row) / secs : 0.0);
+        if (!direct) {
+            printf("word errors: %lu\n", word_errors);
+        }
+        printf("states:      STABLE=%lu INCREASING=%lu DECREASING=%lu OSCILLATING=%lu ANOMALY=%lu\n",
+               state_count[STATE_STABLE], state_count[STATE_INCREASING],
+               state_count[STATE_DECREASING], state_count[STATE_OSCILLATING],
+               state_count[STATE_ANOMALY]);
+    }
+
+    return n < 0 ? 1 : 0;
+}
@@ -0,0 +1,330 @@
+/* arinc429_shm_feed.c - Reference producer (and test consumer) for the live-ingest ring
+ *
+ * Producer: creates the shared-memory ring (arinc429_shm.h) and feeds it
+ * with packed words from a capture file (arinc429_bus_sim -w), flight samples
+ * from a filtered_data.csv style dump, or synthetic records, optionally paced
+ * at -r records per second. By default a full ring makes the producer wait
+ * for the consumer; with -d it drops records the way a bus capture daemon
+ * would.
+ *
+ * Consumer (-x): attaches to the ring, drains it in place until the producer
+ * closes it, checks that timestamps never go backwards and prints the
+ * throughput, the producer-to-consumer latency and the futex sleep and wake
+ * counts. Run it against the producer to check a setup without MATLAB:
+ *
+ *    arinc429_shm_feed -x &  arinc429_shm_feed -N 10000000
+ */
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "arinc429_bcd.h"
+#include "arinc429_shm.h"
+#include "arinc429_stream.h"
+#include "flight_csv.h"
+
+#define DEFAULT_NAME   "/arinc429"
+#define BATCH          256      /* records per commit */
+#define ATTACH_WAIT_S  10       /* consumer: wait this long for the producer */
+
+typedef struct {
+    int                kind;
+    uint64_t           count;   /* synthetic records left */
+    uint64_t           seq;
+    arinc429_capture_t cap;     /* word source */
+    size_t             cap_pos;
+    flight_csv_t       csv;     /* sample source */
+    int                have_cap, have_csv;
+    double             alt, vel;
+} source_t;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t t_ns)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t)(t_ns / 1000000000u);
+    ts.tv_nsec = (long)(t_ns % 1000000000u);
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+/* Fill one record in place; returns 0 at the end of the source */
+static int next_record(source_t *src, void *rec, uint64_t t)
+{
+    if (src->kind == ARINC429_SHM_WORDS) {
+        arinc429_shm_word_t *w = (arinc429_shm_word_t *)rec;
+
+        if (src->have_cap) {
+            if (src->cap_pos == src->cap.num_words) {
+                return 0;
+            }
+            w->word = src->cap.words[src->cap_pos++];
+        } else {
+            if (src->count == 0) {
+                return 0;
+            }
+            src->count--;
+            /* Pressure altitude sweeping 0..39999 ft */
+            w->word = arinc429_bcd_encode_word(0203, 0, (double)(src->seq % 40000));
+        }
+        w->time_ns = t;
+        w->channel = 0;
+    } else {
+        arinc429_shm_sample_t *s = (arinc429_shm_sample_t *)rec;
+        int r;
+
+        if (src->have_csv) {
+            if ((r = flight_csv_read(&src->csv, s->input)) <= 0) {
+                if (r < 0) {
+                    fprintf(stderr, "malformed row at line %ld\n", src->csv.line);
+                }
+                return 0;
+            }
+        } else {
+            if (src->count == 0) {
+                return 0;
+            }
+            src->count--;
+            /* Climb at 10 m/s to 11000 m, then cruise */
+            src->alt = src->alt < 11000.0 ? src->alt + 10.0 : 11000.0;
+            src->vel = src->vel < 240.0 ? src->vel + 0.2 : 240.0;
+            s->input[TREND_DFA_CH_VELOCITY] = src->vel;
+            s->input[TREND_DFA_CH_BAROALT] = src->alt;
+            s->input[TREND_DFA_CH_LAT] = 41.0 + 1e-5 * (double)src->seq;
+            s->input[TREND_DFA_CH_LON] = 29.0 + 1e-5 * (double)src->seq;
+            s->input[TREND_DFA_CH_VERTRATE] = src->alt < 11000.0 ? 10.0 : 0.0;
+        }
+        s->time_ns = t;
+        s->icao24 = 0x4b8000;
+        s->reserved = 0;
+    }
+    src->seq++;
+    return 1;
+}
+
+static int produce(const char *name, source_t *src, size_t capacity, double rate, int drop)
+{
+    arinc429_shm_t *shm = arinc429_shm_create(name, src->kind, capacity);
+    arinc429_shm_stats_t st;
+    const size_t rec_size = src->kind == ARINC429_SHM_WORDS ? sizeof(arinc429_shm_word_t)
+                                                             : sizeof(arinc429_shm_sample_t);
+    uint64_t start, sent = 0, dropped = 0;
+    int more = 1;
+
+    if (shm == NULL) {
+        fprintf(stderr, "cannot create shared memory %s\n", name);
+        return 1;
+    }
+    start = now_ns();
+
+    while (more) {
+        size_t want = BATCH, got, i;
+        unsigned char *rec;
+        void *slots;
+        uint64_t t;
+
+        if (rate > 0.0) {
+            /* Records due by now, at least one */
+            uint64_t due = (uint64_t)((double)(now_ns() - start) * rate * 1e-9) + 1;
+            if (due <= sent + dropped) {
+                sleep_until(start + (uint64_t)((double)(sent + dropped) * 1e9 / rate));
+                continue;
+            }
+            if (due - sent - dropped < want) {
+                want = (size_t)(due - sent - dropped);
+            }
+        }
+
+        got = arinc429_shm_reserve(shm, &slots, want);
+        if (got == 0) {
+            if (drop) {
+                /* The bus does not wait: consume the source and count it */
+                unsigned char tmp[sizeof(arinc429_shm_sample_t)];
+                more = next_record(src, tmp, now_ns());
+                if (more) {
+                    arinc429_shm_drop(shm, 1);
+                    dropped++;
+                }
+            } else {
+                arinc429_shm_wait_space(shm, -1);
+            }
+            continue;
+        }
+
+        t = now_ns();
+        rec = (unsigned char *)slots;
+        for (i = 0; i < got; i++, rec += rec_size) {
+            if (!next_record(src, rec, t)) {
+                more = 0;
+                break;
+            }
+        }
+        arinc429_shm_commit(shm, i);
+        sent += i;
+    }
+
+    arinc429_shm_stats(shm, &st);
+    fprintf(stderr, "%llu records sent, %llu dropped in %.3f s, %llu futex wakes, %llu sleeps\n",
+            (unsigned long long)sent, (unsigned long long)dropped, (double)(now_ns() - start) * 1e-9,
+            (unsigned long long)st.wakes, (unsigned long long)st.sleeps);
+    arinc429_shm_close(shm);
+    return 0;
+}
+
+static int consume(const char *name, int kind)
+{
+    arinc429_shm_t *shm = NULL;
+    arinc429_shm_stats_t st;
+    uint64_t count = 0, last_t = 0, backwards = 0, lat_sum = 0, lat_max = 0, start = 0;
+    size_t rec_size;
+    int i;
+
+    for (i = 0; i < ATTACH_WAIT_S * 100 && (shm = arinc429_shm_attach(name, kind)) == NULL; i++) {
+        struct timespec ts = { 0, 10000000L };
+        nanosleep(&ts, NULL);
+    }
+    if (shm == NULL) {
+        fprintf(stderr, "cannot attach to shared memory %s\n", name);
+        return 1;
+    }
+    rec_size = arinc429_shm_record_size(shm);
+
+    while (arinc429_shm_wait(shm, -1) > 0) {
+        const void *recs;
+        size_t n = arinc429_shm_peek(shm, &recs, BATCH), k;
+        uint64_t now = now_ns();
+
+        if (count == 0) {
+            start = now;
+        }
+        /* Both record kinds begin with time_ns */
+        for (k = 0; k < n; k++) {
+            uint64_t t = *(const uint64_t *)((const unsigned char *)recs + k * rec_size);
+            backwards += t < last_t;
+            last_t = t;
+            if (now > t) {
+                lat_sum += now - t;
+                if (now - t > lat_max) lat_max = now - t;
+            }
+        }
+        arinc429_shm_release(shm, n);
+        count += n;
+    }
+
+    arinc429_shm_stats(shm, &st);
+    printf("%llu records (%s) in %.3f s, %.3g records/s\n", (unsigned long long)count,
+           arinc429_shm_kind(shm) == ARINC429_SHM_WORDS ? "words" : "samples",
+           (double)(now_ns() - start) * 1e-9, (double)count / ((double)(now_ns() - start) * 1e-9));
+    printf("latency mean %.1f us, max %.1f us; %llu dropped by the producer\n",
+           count ? (double)lat_sum / (double)count * 1e-3 : 0.0, (double)lat_max * 1e-3,
+           (unsigned long long)st.dropped);
+    printf("%llu futex sleeps, %llu wakes; %llu timestamps out of order\n",
+           (unsigned long long)st.sleeps, (unsigned long long)st.wakes, (unsigned long long)backwards);
+    arinc429_shm_close(shm);
+    arinc429_shm_unlink(name);
+    return backwards != 0;
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] [capture.bin | flights.csv]\n"
+            "  -n <name>   shared-memory name (default %s)\n"
+            "  -k <kind>   words or samples (default: samples for a .csv source, else words)\n"
+            "  -c <n>      ring capacity in records (default %d)\n"
+            "  -r <rate>   records per second (default: as fast as the consumer takes them)\n"
+            "  -N <n>      synthetic records when no source is given (default 1000000)\n"
+            "  -d          drop records when the ring is full instead of waiting\n"
+            "  -x          consume: drain the ring and report throughput and latency\n",
+            prog, DEFAULT_NAME, ARINC429_SHM_DEFAULT_CAPACITY);
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = DEFAULT_NAME, *path = NULL, *kind_arg = NULL;
+    size_t capacity = 0;
+    double rate = 0.0;
+    int drop = 0, consumer = 0, status, i;
+    source_t src;
+
+    memset(&src, 0, sizeof(src));
+    src.count = 1000000;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            name = argv[++i];
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            kind_arg = argv[++i];
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            capacity = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            rate = atof(argv[++i]);
+        } else if (strcmp(argv[i], "-N") == 0 && i + 1 < argc) {
+            src.count = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-d") == 0) {
+            drop = 1;
+        } else if (strcmp(argv[i], "-x") == 0) {
+            consumer = 1;
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (kind_arg != NULL) {
+        if (strcmp(kind_arg, "words") == 0) {
+            src.kind = ARINC429_SHM_WORDS;
+        } else if (strcmp(kind_arg, "samples") == 0) {
+            src.kind = ARINC429_SHM_SAMPLES;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    } else if (path != NULL && strlen(path) > 4 && strcmp(path + strlen(path) - 4, ".csv") == 0) {
+        src.kind = ARINC429_SHM_SAMPLES;
+    } else if (!consumer) {
+        src.kind = ARINC429_SHM_WORDS;
+    }
+
+    if (consumer) {
+        return consume(name, src.kind);
+    }
+
+    if (path != NULL && src.kind == ARINC429_SHM_WORDS) {
+        if (arinc429_capture_open(&src.cap, path) != 0) {
+            fprintf(stderr, "cannot open capture %s\n", path);
+            return 1;
+        }
+        src.have_cap = 1;
+    } else if (path != NULL) {
+        if (flight_csv_open(&src.csv, path) != 0) {
+            fprintf(stderr, "cannot open %s or a required column is missing\n", path);
+            return 1;
+        }
+        src.have_csv = 1;
+    }
+
+    status = produce(name, &src, capacity, rate, drop);
+
+    if (src.have_cap) {
+        arinc429_capture_close(&src.cap);
+    }
+    if (src.have_csv) {
+        flight_csv_close(&src.csv);
+    }
+    return status;
+}
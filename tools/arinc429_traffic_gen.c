@@ -0,0 +1,383 @@
+/* arinc429_traffic_gen.c - Multithreaded synthetic flight and ARINC 429 traffic generator
+ *
+ * Every thread runs its own arinc429_gen_t (arinc429_gen.h) on its own
+ * random stream, flying one aircraft through climb, cruise and descent
+ * and emitting BCD words or flight samples with faults injected at the
+ * rates given with -f. A thread's output depends only on the seed, its
+ * index and its share of -n, so a run can be repeated exactly.
+ *
+ * Output goes nowhere by default (pure generation rate), to a file with -o
+ * (words as a raw capture like arinc429_bus_sim -w, samples as
+ * filtered_data.csv style CSV; with several threads thread t writes
+ * <file>.<t>), and with -x into a consumer on the same thread: the words
+ * are batch-decoded and routed by label into a trend DFA, the samples go
+ * into the DFA directly. The summary then sets the faults injected against
+ * what the decoder and the DFA caught, which makes the tool both a load
+ * generator for the decode and DFA engines and a soak test:
+ *
+ *    arinc429_traffic_gen -n 100000000 -x -f parity=1e-4 -f bcd=1e-4 -f range=1e-5
+ */
+
+#define _GNU_SOURCE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "arinc429_bcd_batch.h"
+#include "arinc429_gen.h"
+#include "arinc429_word.h"
+#include "trend_dfa.h"
+
+#define MAX_THREADS      256
+#define BLOCK            4096       /* samples per generator call */
+#define DEFAULT_SAMPLES  10000000ULL
+#define PATH_LEN         4096
+
+typedef struct {
+    arinc429_gen_t gen;
+    int      words;             /* 1 words, 0 samples */
+    int      check;             /* -x */
+    uint64_t count;             /* samples to generate */
+    char     path[PATH_LEN];    /* output file, "" for none */
+    /* What the consumer saw (-x) */
+    uint64_t parity_errors;
+    uint64_t bcd_errors;
+    uint64_t ssm_failures;
+    uint64_t foreign_labels;
+    uint64_t dfa_steps;
+    uint64_t anomaly_steps;
+    int      failed;
+} worker_t;
+
+/* TREND_DFA_CH_* channel of each octal label, -1 for labels not generated */
+static int8_t channel_of[256];
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -m <mode>   words (BCD words, default) or samples\n"
+            "  -n <n>      samples to generate over all threads (default %llu; 5 words each)\n"
+            "  -j <n>      threads (default: all cores)\n"
+            "  -s <seed>   random seed (default 1)\n"
+            "  --dt <s>    seconds per sample (default 1)\n"
+            "  -f <fault>=<rate>  inject a fault with probability rate per item:\n"
+            "              parity, bcd, bitflip, drop, ssm (per word), range (per sample)\n"
+            "  -o <file>   write words as a raw capture or samples as CSV; with several\n"
+            "              threads, thread t writes <file>.<t>\n"
+            "  -x          decode the words and run a trend DFA on every thread\n"
+            "  -q          do not print the summary\n",
+            prog, DEFAULT_SAMPLES);
+}
+
+/* Parse fault=rate into cfg; returns 0 or -1 */
+static int parse_fault(const char *arg, arinc429_gen_config_t *cfg)
+{
+    char name[32];
+    const char *eq = strchr(arg, '=');
+    char *end;
+    double rate;
+    int k;
+
+    if (eq == NULL || (size_t)(eq - arg) >= sizeof(name)) {
+        return -1;
+    }
+    memcpy(name, arg, (size_t)(eq - arg));
+    name[eq - arg] = '\0';
+    rate = strtod(eq + 1, &end);
+    if ((k = arinc429_gen_fault_find(name)) < 0 || end == eq + 1 || *end != '\0' ||
+        !(rate >= 0.0 && rate <= 1.0)) {
+        return -1;
+    }
+    cfg->rate[k] = rate;
+    return 0;
+}
+
+static void count_state(worker_t *w, const trend_dfa_output_t *res)
+{
+    w->dfa_steps++;
+    w->anomaly_steps += res->state == STATE_ANOMALY;
+}
+
+/* Decode a block of words and feed complete samples to the DFA. Each word
+ * updates its channel; the altitude rate word, last of a sample, steps the
+ * DFA, so a sample whose altitude rate word was lost is skipped. */
+static void consume_words(worker_t *w, trend_dfa_t *dfa, double *cur, const uint32_t *words,
+                          double *values, int8_t *status, size_t n)
+{
+    trend_dfa_output_t res;
+    size_t i;
+
+    arinc429_bcd_decode_words(words, values, status, n);
+    for (i = 0; i < n; i++) {
+        uint32_t ssm;
+        int ch;
+
+        if (status[i] == ARINC429_ERR_PARITY) {
+            w->parity_errors++;
+            continue;
+        }
+        if (status[i] == ARINC429_ERR_BCD_DIGIT) {
+            w->bcd_errors++;
+            continue;
+        }
+        ch = channel_of[arinc429_word_label(words[i])];
+        if (ch < 0) {
+            w->foreign_labels++;
+            continue;
+        }
+        ssm = arinc429_word_ssm(words[i]);
+        if (ssm == ARINC429_SSM_BCD_NCD || ssm == ARINC429_SSM_BCD_TEST) {
+            w->ssm_failures++;
+            continue;
+        }
+        cur[ch] = values[i];
+        if (ch == TREND_DFA_CH_VERTRATE) {
+            trend_dfa_step(dfa, cur, &res);
+            count_state(w, &res);
+        }
+    }
+}
+
+static int write_samples(FILE *out, double *const *column, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        if (fprintf(out, "%.6f,%.2f,%.7f,%.7f,%.3f\n", column[TREND_DFA_CH_VELOCITY][i],
+                    column[TREND_DFA_CH_BAROALT][i], column[TREND_DFA_CH_LAT][i],
+                    column[TREND_DFA_CH_LON][i], column[TREND_DFA_CH_VERTRATE][i]) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void *worker_run(void *arg)
+{
+    worker_t *w = (worker_t *)arg;
+    uint32_t *words = (uint32_t *)malloc(BLOCK * TREND_DFA_NUM_CHANNELS * sizeof(uint32_t));
+    double *values = (double *)malloc(BLOCK * TREND_DFA_NUM_CHANNELS * sizeof(double));
+    int8_t *status = (int8_t *)malloc(BLOCK * TREND_DFA_NUM_CHANNELS * sizeof(int8_t));
+    double *column[TREND_DFA_NUM_CHANNELS];
+    double cur[TREND_DFA_NUM_CHANNELS] = { 0 };
+    trend_dfa_t dfa;
+    trend_dfa_output_t res;
+    uint64_t left = w->count;
+    FILE *out = NULL;
+    size_t k, n, i;
+    int ch;
+
+    /* Sample columns share the decode buffer */
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        column[ch] = values != NULL ? values + (size_t)ch * BLOCK : NULL;
+    }
+    if (words == NULL || values == NULL || status == NULL) {
+        w->failed = 1;
+        goto done;
+    }
+    if (w->path[0] != '\0') {
+        out = fopen(w->path, w->words ? "wb" : "w");
+        if (out == NULL) {
+            w->failed = 1;
+            goto done;
+        }
+        setvbuf(out, NULL, _IOFBF, 1 << 20);
+        if (!w->words) {
+            fprintf(out, "velocity,baroaltitude,lat,lon,vertrate\n");
+        }
+    }
+    trend_dfa_init(&dfa);
+
+    while (left > 0 && !w->failed) {
+        k = left < BLOCK ? (size_t)left : BLOCK;
+        if (w->words) {
+            n = arinc429_gen_words(&w->gen, words, k);
+            if (out != NULL && fwrite(words, sizeof(uint32_t), n, out) != n) {
+                w->failed = 1;
+            }
+            if (w->check) {
+                consume_words(w, &dfa, cur, words, values, status, n);
+            }
+        } else {
+            arinc429_gen_samples(&w->gen, column, k);
+            if (out != NULL && write_samples(out, column, k) != 0) {
+                w->failed = 1;
+            }
+            for (i = 0; w->check && i < k; i++) {
+                for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+                    cur[ch] = column[ch][i];
+                }
+                trend_dfa_step(&dfa, cur, &res);
+                count_state(w, &res);
+            }
+        }
+        left -= k;
+    }
+
+done:
+    if (out != NULL && fclose(out) != 0) {
+        w->failed = 1;
+    }
+    free(words);
+    free(values);
+    free(status);
+    return NULL;
+}
+
+static double elapsed_seconds(const struct timespec *start, const struct timespec *stop)
+{
+    return (double)(stop->tv_sec - start->tv_sec) +
+           (double)(stop->tv_nsec - start->tv_nsec) * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+    static worker_t workers[MAX_THREADS];
+    pthread_t tid[MAX_THREADS];
+    arinc429_gen_config_t cfg;
+    const char *out_path = NULL;
+    uint64_t total = DEFAULT_SAMPLES, seed = 1;
+    uint64_t samples = 0, words = 0, injected[ARINC429_GEN_NUM_FAULTS] = { 0 };
+    uint64_t parity = 0, bcd = 0, ssm = 0, foreign = 0, steps = 0, anomaly = 0;
+    int num_threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int word_mode = 1, check = 0, quiet = 0, failed = 0, started, i, k;
+    struct timespec t_start, t_stop;
+    double secs;
+
+    arinc429_gen_default_config(&cfg);
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "words") == 0) {
+                word_mode = 1;
+            } else if (strcmp(argv[i], "samples") == 0) {
+                word_mode = 0;
+            } else {
+                usage(argv[0]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            total = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            num_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--dt") == 0 && i + 1 < argc) {
+            cfg.dt = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            if (parse_fault(argv[++i], &cfg) != 0) {
+                fprintf(stderr, "%s: bad fault '%s'\n", argv[0], argv[i]);
+                return 2;
+            }
+        } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (strcmp(argv[i], "-x") == 0) {
+            check = 1;
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (num_threads < 1 || num_threads > MAX_THREADS || !(cfg.dt > 0.0)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    memset(channel_of, -1, sizeof(channel_of));
+    for (k = 0; k < TREND_DFA_NUM_CHANNELS; k++) {
+        channel_of[arinc429_gen_label[k]] = (int8_t)k;
+    }
+
+    /* Thread t takes stream t and an equal share of the samples */
+    for (i = 0; i < num_threads; i++) {
+        worker_t *w = &workers[i];
+
+        arinc429_gen_init(&w->gen, &cfg, seed, (uint64_t)i);
+        w->words = word_mode;
+        w->check = check;
+        w->count = total / (uint64_t)num_threads + ((uint64_t)i < total % (uint64_t)num_threads);
+        if (out_path != NULL && num_threads == 1) {
+            snprintf(w->path, sizeof(w->path), "%s", out_path);
+        } else if (out_path != NULL) {
+            snprintf(w->path, sizeof(w->path), "%s.%d", out_path, i);
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t_start);
+    for (started = 1; started < num_threads; started++) {
+        if (pthread_create(&tid[started], NULL, worker_run, &workers[started]) != 0) {
+            break;
+        }
+    }
+    worker_run(&workers[0]);
+    for (i = 1; i < started; i++) {
+        pthread_join(tid[i], NULL);
+    }
+    /* Threads that could not be created run here, with the same output */
+    for (i = started; i < num_threads; i++) {
+        worker_run(&workers[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t_stop);
+    secs = elapsed_seconds(&t_start, &t_stop);
+
+    for (i = 0; i < num_threads; i++) {
+        const worker_t *w = &workers[i];
+
+        if (w->failed) {
+            fprintf(stderr, "%s: thread %d failed%s%s\n", argv[0], i,
+                    w->path[0] != '\0' ? " writing " : "", w->path);
+            failed = 1;
+        }
+        samples += w->gen.samples;
+        words += w->gen.words;
+        for (k = 0; k < ARINC429_GEN_NUM_FAULTS; k++) {
+            injected[k] += w->gen.injected[k];
+        }
+        parity += w->parity_errors;
+        bcd += w->bcd_errors;
+        ssm += w->ssm_failures;
+        foreign += w->foreign_labels;
+        steps += w->dfa_steps;
+        anomaly += w->anomaly_steps;
+    }
+
+    if (!quiet) {
+        printf("threads:     %d\n", num_threads);
+        printf("samples:     %llu\n", (unsigned long long)samples);
+        if (word_mode) {
+            printf("words:       %llu\n", (unsigned long long)words);
+        }
+        printf("elapsed:     %.6f s\n", secs);
+        printf("throughput:  %.0f samples/s", secs > 0.0 ? (double)samples / secs : 0.0);
+        if (word_mode) {
+            printf(", %.0f words/s", secs > 0.0 ? (double)words / secs : 0.0);
+        }
+        printf("\ninjected:   ");
+        for (k = 0; k < ARINC429_GEN_NUM_FAULTS; k++) {
+            if (word_mode || k == ARINC429_GEN_FAULT_RANGE) {
+                printf(" %s=%llu", arinc429_gen_fault_name(k), (unsigned long long)injected[k]);
+            }
+        }
+        printf("\n");
+        if (check && word_mode) {
+            printf("decoded:     parity errors=%llu bcd errors=%llu ssm failures=%llu "
+                   "foreign labels=%llu\n",
+                   (unsigned long long)parity, (unsigned long long)bcd, (unsigned long long)ssm,
+                   (unsigned long long)foreign);
+        }
+        if (check) {
+            printf("dfa:         steps=%llu anomaly=%llu\n", (unsigned long long)steps,
+                   (unsigned long long)anomaly);
+        }
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,99 @@
+/* flight_rec_dump.c - Print a time slice of a flight_rec recording as CSV
+ *
+ * The start row is found through the chunk time index, so only the chunks
+ * inside [from, to] are ever touched, however long the recording is.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "flight_rec.h"
+
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <recording>\n"
+            "  --from <t>  first time to print (default: start)\n"
+            "  --to <t>    last time to print (default: end)\n"
+            "  -i          print only the file summary\n",
+            prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = NULL;
+    double from = -1e300, to = 1e300;
+    int info = 0;
+    flight_rec_reader_t rec;
+    flight_rec_chunk_t view;
+    uint64_t row, k;
+    size_t r;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--from") == 0 && i + 1 < argc) {
+            from = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "--to") == 0 && i + 1 < argc) {
+            to = strtod(argv[++i], NULL);
+        } else if (strcmp(argv[i], "-i") == 0) {
+            info = 1;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path == NULL) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    if (flight_rec_open(&rec, path) != 0) {
+        fprintf(stderr, "%s: cannot open %s or not a recording\n", argv[0], path);
+        return 1;
+    }
+
+    if (info) {
+        printf("rows:        %llu\n", (unsigned long long)rec.num_rows);
+        printf("chunks:      %llu x %u rows (%llu bytes)\n",
+               (unsigned long long)rec.num_chunks, rec.chunk_rows,
+               (unsigned long long)rec.chunk_bytes);
+        if (rec.num_rows > 0) {
+            flight_rec_chunk(&rec, 0, &view);
+            printf("first time:  %.10g\n", view.time[0]);
+            flight_rec_chunk(&rec, rec.num_chunks - 1, &view);
+            printf("last time:   %.10g\n", view.time[view.rows - 1]);
+        }
+        flight_rec_close_reader(&rec);
+        return 0;
+    }
+
+    printf("time,velocity,baroaltitude,lat,lon,vertrate,state,confidence,vel_trend,"
+           "baroalt_trend,lat_trend,lon_trend,vertrate_trend,weighted_trend\n");
+
+    row = flight_rec_seek_time(&rec, from);
+    for (k = row / rec.chunk_rows; k < rec.num_chunks; k++) {
+        flight_rec_chunk(&rec, k, &view);
+        for (r = (size_t)(row - view.first_row); r < view.rows; r++) {
+            if (view.time[r] > to) {
+                flight_rec_close_reader(&rec);
+                return 0;
+            }
+            printf("%.10g", view.time[r]);
+            for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+                printf(",%.10g", view.input[i][r]);
+            }
+            printf(",%d,%.6g", view.state[r], view.confidence[r]);
+            for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+                printf(",%.10g", view.trend[i][r]);
+            }
+            putchar('\n');
+        }
+        row = view.first_row + view.rows;
+    }
+
+    flight_rec_close_reader(&rec);
+    return 0;
+}
@@ -0,0 +1,236 @@
+#define S_FUNCTION_NAME  trend_db_sink
+#define S_FUNCTION_LEVEL 2
+
+#include "simstruc.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "arinc_db_sink.h"
+
+/* Logs the five flight inputs and the trend DFA outputs (wire them from
+ * trend_dfa_sfunc_flight) into arinc_verileri.db as one SIMULATION_RUN.
+ * mdlOutputs only queues a record; a background thread does the SQLite
+ * work, so the step time does not depend on the database. */
+
+/* Parameters: database file (char array), backpressure policy
+ * (0 = block, 1 = drop oldest, 2 = drop newest), queue capacity in records
+ * (0 = default) and PRAGMA synchronous (0 OFF, 1 NORMAL, 2 FULL) */
+#define FILE_PARAM(S)     ssGetSFcnParam(S, 0)
+#define POLICY_PARAM(S)   ssGetSFcnParam(S, 1)
+#define CAPACITY_PARAM(S) ssGetSFcnParam(S, 2)
+#define SYNC_PARAM(S)     ssGetSFcnParam(S, 3)
+#define NUM_PARAMS        4
+
+/* Input ports: velocity, baroaltitude, lat, lon, vertrate, state,
+ * confidence, trends (6) */
+#define IN_STATE        TREND_DFA_NUM_CHANNELS
+#define IN_CONFIDENCE   (IN_STATE + 1)
+#define IN_TRENDS       (IN_STATE + 2)
+#define NUM_INPUTS      (IN_STATE + 3)
+
+#define FILE_NAME_LEN   1024
+
+/* PWork: the running sink */
+#define PWORK_SINK      0
+#define NUM_PWORK       1
+
+#define MDL_CHECK_PARAMETERS
+#if defined(MDL_CHECK_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Nonzero if p is a double scalar holding an integer from lo to hi */
+static int is_int_scalar(const mxArray *p, double lo, double hi)
+{
+    double v;
+
+    if (!mxIsDouble(p) || mxGetNumberOfElements(p) != 1) {
+        return 0;
+    }
+    v = mxGetScalar(p);
+    return v >= lo && v <= hi && v == floor(v);
+}
+
+/* Function: mdlCheckParameters ===============================================
+ * Abstract:
+ *    The file name must be a non-empty string; policy, capacity and
+ *    synchronous must be integer scalars in range.
+ */
+static void mdlCheckParameters(SimStruct *S)
+{
+    if (!mxIsChar(FILE_PARAM(S)) || mxIsEmpty(FILE_PARAM(S))) {
+        ssSetErrorStatus(S, "Database file name must be a non-empty string");
+        return;
+    }
+    if (!is_int_scalar(POLICY_PARAM(S), 0.0, 2.0)) {
+        ssSetErrorStatus(S, "Policy must be 0 (block), 1 (drop oldest) or 2 (drop newest)");
+        return;
+    }
+    if (!is_int_scalar(CAPACITY_PARAM(S), 0.0, (double)INT32_MAX)) {
+        ssSetErrorStatus(S, "Queue capacity must be a non-negative integer");
+        return;
+    }
+    if (!is_int_scalar(SYNC_PARAM(S), 0.0, 2.0)) {
+        ssSetErrorStatus(S, "Synchronous must be 0, 1 or 2");
+        return;
+    }
+}
+#endif
+
+/* Function: mdlInitializeSizes ===============================================
+ * Abstract:
+ *    The sizes information is used by Simulink to determine the S-function
+ *    block's characteristics (number of inputs, outputs, states, etc.).
+ */
+static void mdlInitializeSizes(SimStruct *S)
+{
+    int i;
+
+    /* Set number of expected parameters */
+    ssSetNumSFcnParams(S, NUM_PARAMS);
+#if defined(MATLAB_MEX_FILE)
+    if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
+        return; /* Parameter mismatch reported by Simulink */
+    }
+    mdlCheckParameters(S);
+    if (ssGetErrorStatus(S) != NULL) {
+        return;
+    }
+#endif
+    for (i = 0; i < NUM_PARAMS; i++) {
+        ssSetSFcnParamTunable(S, i, 0);
+    }
+
+    /* Set number of input and output ports */
+    if (!ssSetNumInputPorts(S, NUM_INPUTS)) return;
+    if (!ssSetNumOutputPorts(S, 0)) return;
+
+    for (i = 0; i < NUM_INPUTS; i++) {
+        ssSetInputPortWidth(S, i, i == IN_TRENDS ? TREND_DFA_NUM_TRENDS : 1);
+        ssSetInputPortDataType(S, i, SS_DOUBLE);
+        ssSetInputPortRequiredContiguous(S, i, true);
+        ssSetInputPortDirectFeedThrough(S, i, 1);
+    }
+
+    /* Set sample times */
+    ssSetNumSampleTimes(S, 1);
+
+    /* Sink handle in PWork */
+    ssSetNumRWork(S, 0);
+    ssSetNumIWork(S, 0);
+    ssSetNumPWork(S, NUM_PWORK);
+    ssSetNumModes(S, 0);
+    ssSetNumNonsampledZCs(S, 0);
+
+    /* Set options */
+    ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
+}
+
+/* Function: mdlInitializeSampleTimes =========================================
+ * Abstract:
+ *    This function is used to specify the sample time(s) for your
+ *    S-function. You must register the same number of sample times as
+ *    specified in ssSetNumSampleTimes.
+ */
+static void mdlInitializeSampleTimes(SimStruct *S)
+{
+    ssSetSampleTime(S, 0, INHERITED_SAMPLE_TIME);
+    ssSetOffsetTime(S, 0, 0.0);
+    ssSetModelReferenceSampleTimeDefaultInheritance(S);
+}
+
+#define MDL_START
+#if defined(MDL_START)
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Open the database and start the writer thread.
+ */
+static void mdlStart(SimStruct *S)
+{
+    char path[FILE_NAME_LEN];
+    arinc_db_config_t cfg;
+    arinc_db_run_t run;
+    arinc_db_sink_t *sink;
+
+    ssGetPWork(S)[PWORK_SINK] = NULL;
+
+    if (mxGetString(FILE_PARAM(S), path, sizeof(path)) != 0) {
+        ssSetErrorStatus(S, "Database file name too long");
+        return;
+    }
+
+    arinc_db_default_config(&cfg);
+    cfg.synchronous = (int)mxGetScalar(SYNC_PARAM(S));
+
+    memset(&run, 0, sizeof(run));
+    run.name = ssGetModelName(S);
+    run.description = ssGetPath(S);
+    run.time_step = ssGetSampleTime(S, 0);
+
+    sink = arinc_db_sink_start(path, &cfg, &run, (size_t)mxGetScalar(CAPACITY_PARAM(S)),
+                               (arinc_db_sink_policy_t)(int)mxGetScalar(POLICY_PARAM(S)));
+    if (sink == NULL) {
+        ssSetErrorStatus(S, "Cannot open database");
+        return;
+    }
+
+    ssGetPWork(S)[PWORK_SINK] = sink;
+}
+#endif
+
+/* Function: mdlOutputs =======================================================
+ * Abstract:
+ *    Queue one record stamped with the current simulation time. In a
+ *    continuous context only major time steps are logged; minor steps are
+ *    solver trial points, not samples.
+ */
+static void mdlOutputs(SimStruct *S, int_T tid)
+{
+    arinc_db_sink_t *sink = (arinc_db_sink_t *)ssGetPWork(S)[PWORK_SINK];
+    double input[TREND_DFA_NUM_CHANNELS];
+    trend_dfa_output_t out;
+    const real_T *trends;
+    int i;
+
+    if (sink == NULL || !ssIsMajorTimeStep(S)) {
+        return;
+    }
+
+    for (i = 0; i < TREND_DFA_NUM_CHANNELS; i++) {
+        input[i] = ((const real_T *)ssGetInputPortSignal(S, i))[0];
+    }
+    out.state = (int)((const real_T *)ssGetInputPortSignal(S, IN_STATE))[0];
+    out.confidence = ((const real_T *)ssGetInputPortSignal(S, IN_CONFIDENCE))[0];
+    trends = (const real_T *)ssGetInputPortSignal(S, IN_TRENDS);
+    for (i = 0; i < TREND_DFA_NUM_TRENDS; i++) {
+        out.trends[i] = trends[i];
+    }
+
+    arinc_db_sink_push(sink, ssGetT(S), input, &out);
+}
+
+/* Function: mdlTerminate =====================================================
+ * Abstract:
+ *    Drain the queue, close the run and report the queue counters.
+ */
+static void mdlTerminate(SimStruct *S)
+{
+    arinc_db_sink_t *sink = (arinc_db_sink_t *)ssGetPWork(S)[PWORK_SINK];
+    arinc_db_sink_stats_t st;
+
+    if (sink == NULL) {
+        return;
+    }
+
+    if (arinc_db_sink_stop(sink, ssGetT(S), &st) != 0) {
+        ssPrintf("%s: database write failed\n", ssGetPath(S));
+    }
+    ssPrintf("%s: %.0f records queued, %.0f written, %.0f dropped, high-water %.0f of %.0f\n",
+             ssGetPath(S), (double)st.pushed, (double)st.written, (double)st.dropped,
+             (double)st.high_water, (double)st.capacity);
+    ssGetPWork(S)[PWORK_SINK] = NULL;
+}
+
+/* Required S-function trailer */
+#ifdef  MATLAB_MEX_FILE    /* Is this file being compiled as a MEX-file? */
+#include "simulink.c"      /* MEX-file interface mechanism */
+#else
+#include "cg_sfun.h"       /* Code generation registration function */
+#endif
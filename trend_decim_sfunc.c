@@ -0,0 +1,368 @@
+/* trend_decim_sfunc.c - Anti-alias filter and decimator for the trend DFA inputs */
+
+#define S_FUNCTION_NAME  trend_decim_sfunc
+#define S_FUNCTION_LEVEL 2
+
+#include "simstruc.h"
+#include "trend_decim.h"
+#include <math.h>
+#include <string.h>
+
+/* The filter lives in libarinc429/trend_decim.h; this file only maps
+ * Simulink ports and work vectors onto it.
+ *
+ * Goes between a fast source and trend_dfa_sfunc_flight: five inputs
+ * (velocity, baroaltitude, lat, lon, vertrate), scalars or width-N vectors
+ * of N tracks, are low-pass filtered and come out on five outputs of the
+ * same width at ratio times the input sample time. The DFA behind it
+ * inherits the slower rate and so steps ratio times less often. Its slope
+ * thresholds are per step and scale with ratio (see trend_decim.h).
+ *
+ * Parameters:
+ *   ratio            input samples per output, 1..64
+ *   taps per phase   optional, 1..32 (default 8); the filter has
+ *                    ratio * taps per phase taps
+ * Neither is tunable, as both size the DWork.
+ *
+ * Sample times are port based: the inputs inherit a discrete sample time Ts
+ * and the outputs run at ratio * Ts with the same offset. The filter state
+ * is DWork, and the output of each input hit is kept there until the
+ * output hit that reads it, which falls on the same step. */
+
+/* S-Function implementation */
+#define NUM_PORTS        TREND_DFA_NUM_CHANNELS
+
+#define RATIO_PARAM(S)   ssGetSFcnParam(S, 0)
+#define TAPS_PARAM(S)    ssGetSFcnParam(S, 1)
+
+/* DWork layout, see trend_decim_t; DWORK_OUT holds the latest output */
+#define DWORK_COEFF      0
+#define DWORK_HISTORY    1
+#define DWORK_CONTROL    2
+#define DWORK_OUT        3
+#define NUM_DWORK        4
+
+static int_T get_ratio(SimStruct *S)
+{
+    return (int_T)mxGetScalar(RATIO_PARAM(S));
+}
+
+static int_T get_taps(SimStruct *S)
+{
+    int_T per_phase = ssGetSFcnParamsCount(S) > 1 ? (int_T)mxGetScalar(TAPS_PARAM(S))
+                                                  : TREND_DECIM_DEFAULT_TAPS_PER_PHASE;
+
+    return TREND_DECIM_TAPS(get_ratio(S), per_phase);
+}
+
+static void set_port_widths(SimStruct *S, int_T num_tracks)
+{
+    int i;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        ssSetInputPortWidth(S, i, num_tracks);
+        ssSetOutputPortWidth(S, i, num_tracks);
+    }
+}
+
+static void set_port_sample_times(SimStruct *S, real_T in_time, real_T offset)
+{
+    int i;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        ssSetInputPortSampleTime(S, i, in_time);
+        ssSetInputPortOffsetTime(S, i, offset);
+        ssSetOutputPortSampleTime(S, i, in_time * get_ratio(S));
+        ssSetOutputPortOffsetTime(S, i, offset);
+    }
+}
+
+#define MDL_CHECK_PARAMETERS
+#if defined(MDL_CHECK_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Function: mdlCheckParameters ===============================================
+ * Abstract:
+ *    The ratio must be an integer from 1 to TREND_DECIM_MAX_RATIO and the
+ *    taps per phase, if given, one from 1 to TREND_DECIM_MAX_TAPS_PER_PHASE.
+ */
+static void mdlCheckParameters(SimStruct *S)
+{
+    double ratio, taps = TREND_DECIM_DEFAULT_TAPS_PER_PHASE;
+
+    if (!mxIsDouble(RATIO_PARAM(S)) || mxGetNumberOfElements(RATIO_PARAM(S)) != 1) {
+        ssSetErrorStatus(S, "Ratio must be a scalar");
+        return;
+    }
+    ratio = mxGetScalar(RATIO_PARAM(S));
+    if (!(ratio >= 1.0 && ratio <= TREND_DECIM_MAX_RATIO) || ratio != floor(ratio)) {
+        ssSetErrorStatus(S, "Ratio must be an integer from 1 to 64");
+        return;
+    }
+    if (ssGetSFcnParamsCount(S) > 1) {
+        if (!mxIsDouble(TAPS_PARAM(S)) || mxGetNumberOfElements(TAPS_PARAM(S)) != 1) {
+            ssSetErrorStatus(S, "Taps per phase must be a scalar");
+            return;
+        }
+        taps = mxGetScalar(TAPS_PARAM(S));
+    }
+    if (!(taps >= 1.0 && taps <= TREND_DECIM_MAX_TAPS_PER_PHASE) || taps != floor(taps)) {
+        ssSetErrorStatus(S, "Taps per phase must be an integer from 1 to 32");
+        return;
+    }
+}
+#endif
+
+/* Function: mdlInitializeSizes ===============================================
+ * Abstract:
+ *    Five double ports in and out, widths set later from the number of
+ *    tracks, port-based sample times and the DWork count; the ratio and taps
+ *    per phase are checked here as they size the DWork.
+ */
+static void mdlInitializeSizes(SimStruct *S)
+{
+    int i;
+
+    /* Ratio, and optionally the taps per phase */
+    ssSetNumSFcnParams(S, ssGetSFcnParamsCount(S) == 2 ? 2 : 1);
+    if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
+        return;
+    }
+#if defined(MATLAB_MEX_FILE)
+    mdlCheckParameters(S);
+    if (ssGetErrorStatus(S) != NULL) {
+        return;
+    }
+#endif
+    for (i = 0; i < ssGetNumSFcnParams(S); i++) {
+        ssSetSFcnParamTunable(S, i, 0);
+    }
+
+    ssSetNumContStates(S, 0);
+    ssSetNumDiscStates(S, 0);
+
+    if (!ssSetNumInputPorts(S, NUM_PORTS)) return;
+    if (!ssSetNumOutputPorts(S, NUM_PORTS)) return;
+
+    for (i = 0; i < NUM_PORTS; i++) {
+        ssSetInputPortWidth(S, i, DYNAMICALLY_SIZED);
+        ssSetInputPortDataType(S, i, SS_DOUBLE);
+        ssSetInputPortComplexSignal(S, i, COMPLEX_NO);
+        ssSetInputPortDirectFeedThrough(S, i, 1);
+        ssSetInputPortRequiredContiguous(S, i, 1);
+        ssSetInputPortSampleTime(S, i, INHERITED_SAMPLE_TIME);
+        ssSetInputPortOffsetTime(S, i, 0.0);
+
+        ssSetOutputPortWidth(S, i, DYNAMICALLY_SIZED);
+        ssSetOutputPortDataType(S, i, SS_DOUBLE);
+        ssSetOutputPortComplexSignal(S, i, COMPLEX_NO);
+        ssSetOutputPortSampleTime(S, i, INHERITED_SAMPLE_TIME);
+        ssSetOutputPortOffsetTime(S, i, 0.0);
+    }
+
+    /* Inputs at Ts, outputs at ratio * Ts */
+    ssSetNumSampleTimes(S, PORT_BASED_SAMPLE_TIMES);
+
+    /* Widths depend on the number of tracks, see mdlSetWorkWidths */
+    ssSetNumDWork(S, NUM_DWORK);
+
+    ssSetNumRWork(S, 0);
+    ssSetNumIWork(S, 0);
+    ssSetNumPWork(S, 0);
+    ssSetNumModes(S, 0);
+    ssSetNumNonsampledZCs(S, 0);
+
+    ssSetOperatingPointCompliance(S, USE_DEFAULT_OPERATING_POINT);
+
+    ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
+}
+
+#define MDL_SET_INPUT_PORT_WIDTH
+/* Function: mdlSetInputPortWidth =============================================
+ * Abstract:
+ *    An input width is the number of tracks; all ports take it.
+ */
+static void mdlSetInputPortWidth(SimStruct *S, int_T port, int_T inputPortWidth)
+{
+    set_port_widths(S, inputPortWidth);
+}
+
+#define MDL_SET_OUTPUT_PORT_WIDTH
+/* Function: mdlSetOutputPortWidth ============================================
+ * Abstract:
+ *    An output width is the number of tracks; all ports take it.
+ */
+static void mdlSetOutputPortWidth(SimStruct *S, int_T port, int_T outputPortWidth)
+{
+    set_port_widths(S, outputPortWidth);
+}
+
+#define MDL_SET_DEFAULT_PORT_DIMENSION_INFO
+/* Function: mdlSetDefaultPortDimensionInfo ===================================
+ * Abstract:
+ *    Unconnected ports fall back to a single aircraft.
+ */
+static void mdlSetDefaultPortDimensionInfo(SimStruct *S)
+{
+    set_port_widths(S, 1);
+}
+
+#define MDL_SET_INPUT_PORT_SAMPLE_TIME
+/* Function: mdlSetInputPortSampleTime ========================================
+ * Abstract:
+ *    Inputs run at the inherited discrete Ts; the outputs follow at
+ *    ratio * Ts with the same offset.
+ */
+static void mdlSetInputPortSampleTime(SimStruct *S, int_T port, real_T sampleTime,
+                                      real_T offsetTime)
+{
+    if (!(sampleTime > 0.0) || mxIsInf(sampleTime)) {
+        ssSetErrorStatus(S, "Inputs must have a discrete sample time");
+        return;
+    }
+    set_port_sample_times(S, sampleTime, offsetTime);
+}
+
+#define MDL_SET_OUTPUT_PORT_SAMPLE_TIME
+/* Function: mdlSetOutputPortSampleTime =======================================
+ * Abstract:
+ *    An output sample time fixed downstream sets the inputs to 1/ratio of
+ *    it; it must be discrete as well.
+ */
+static void mdlSetOutputPortSampleTime(SimStruct *S, int_T port, real_T sampleTime,
+                                       real_T offsetTime)
+{
+    if (!(sampleTime > 0.0) || mxIsInf(sampleTime)) {
+        ssSetErrorStatus(S, "Outputs must have a discrete sample time");
+        return;
+    }
+    set_port_sample_times(S, sampleTime / get_ratio(S), offsetTime);
+}
+
+/* Function: mdlInitializeSampleTimes =========================================
+ * Abstract:
+ *    Nothing to register: sample times are port based.
+ */
+static void mdlInitializeSampleTimes(SimStruct *S)
+{
+}
+
+#define MDL_SET_WORK_WIDTHS
+/* Function: mdlSetWorkWidths =================================================
+ * Abstract:
+ *    Check that all inputs carry the same number of tracks and size the
+ *    coefficient, history, control and output DWork for it.
+ */
+static void mdlSetWorkWidths(SimStruct *S)
+{
+    int_T num_tracks = ssGetInputPortWidth(S, 0);
+    int_T taps = get_taps(S);
+    int i;
+
+    for (i = 1; i < NUM_PORTS; i++) {
+        if (ssGetInputPortWidth(S, i) != num_tracks) {
+            ssSetErrorStatus(S, "All inputs must have the same width (number of tracks)");
+            return;
+        }
+    }
+
+    ssSetDWorkWidth(S, DWORK_COEFF, taps);
+    ssSetDWorkDataType(S, DWORK_COEFF, SS_DOUBLE);
+    ssSetDWorkName(S, DWORK_COEFF, "coeff");
+
+    ssSetDWorkWidth(S, DWORK_HISTORY, (int_T)TREND_DECIM_HISTORY_LEN(num_tracks, taps));
+    ssSetDWorkDataType(S, DWORK_HISTORY, SS_DOUBLE);
+    ssSetDWorkName(S, DWORK_HISTORY, "history");
+
+    ssSetDWorkWidth(S, DWORK_CONTROL, TREND_DECIM_CTRL_LEN);
+    ssSetDWorkDataType(S, DWORK_CONTROL, SS_INT32);
+    ssSetDWorkName(S, DWORK_CONTROL, "control");
+
+    ssSetDWorkWidth(S, DWORK_OUT, (int_T)TREND_DECIM_OUT_LEN(num_tracks));
+    ssSetDWorkDataType(S, DWORK_OUT, SS_DOUBLE);
+    ssSetDWorkName(S, DWORK_OUT, "decimated");
+}
+
+/* Point the filter at this block's DWork */
+static int bind_dwork(SimStruct *S, trend_decim_t *d)
+{
+    d->num_tracks = ssGetInputPortWidth(S, 0);
+    d->ratio      = get_ratio(S);
+    d->taps       = get_taps(S);
+    d->coeff      = (double*)ssGetDWork(S, DWORK_COEFF);
+    d->history    = (double*)ssGetDWork(S, DWORK_HISTORY);
+    d->control    = (int32_T*)ssGetDWork(S, DWORK_CONTROL);
+
+    return d->coeff && d->history && d->control && ssGetDWork(S, DWORK_OUT);
+}
+
+#define MDL_START
+#if defined(MDL_START)
+/* Function: mdlStart =========================================================
+ * Abstract:
+ *    Design the filter into the coefficient DWork, clear its history and
+ *    zero the output held for the first output hit.
+ */
+static void mdlStart(SimStruct *S)
+{
+    trend_decim_t d;
+
+    if (!bind_dwork(S, &d)) {
+        ssSetErrorStatus(S, "DWork allocation failed");
+        return;
+    }
+
+    trend_decim_init(&d);
+    memset(ssGetDWork(S, DWORK_OUT), 0, TREND_DECIM_OUT_LEN(d.num_tracks) * sizeof(real_T));
+}
+#endif
+
+/* Function: mdlOutputs =======================================================
+ * Abstract:
+ *    Push the inputs through the filter on an input hit and copy the
+ *    latest decimated output to the ports on an output hit.
+ */
+static void mdlOutputs(SimStruct *S, int_T tid)
+{
+    real_T *decimated = (real_T*)ssGetDWork(S, DWORK_OUT);
+    int_T n = ssGetInputPortWidth(S, 0);
+    int i;
+
+    /* Filter every input sample; every ratio-th one updates the output */
+    if (ssIsSampleHit(S, ssGetInputPortSampleTimeIndex(S, 0), tid)) {
+        const real_T *input[NUM_PORTS];
+        trend_decim_t d;
+
+        for (i = 0; i < NUM_PORTS; i++) {
+            input[i] = (const real_T*)ssGetInputPortSignal(S, i);
+            if (!input[i]) {
+                ssSetErrorStatus(S, "Null pointer detected");
+                return;
+            }
+        }
+        if (!bind_dwork(S, &d)) {
+            ssSetErrorStatus(S, "DWork is null");
+            return;
+        }
+        trend_decim_push(&d, input, decimated);
+    }
+
+    if (ssIsSampleHit(S, ssGetOutputPortSampleTimeIndex(S, 0), tid)) {
+        for (i = 0; i < NUM_PORTS; i++) {
+            memcpy(ssGetOutputPortSignal(S, i), decimated + (size_t)i * (size_t)n,
+                   (size_t)n * sizeof(real_T));
+        }
+    }
+}
+
+/* Function: mdlTerminate =====================================================
+ * Abstract:
+ *    Nothing to release; all state is DWork.
+ */
+static void mdlTerminate(SimStruct *S)
+{
+}
+
+#ifdef  MATLAB_MEX_FILE
+#include "simulink.c"
+#else
+#include "cg_sfun.h"
+#endif
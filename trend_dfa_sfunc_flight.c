@@ -4,380 +4,540 @@
 #define S_FUNCTION_LEVEL 2
 
 #include "simstruc.h"
+#include "trend_dfa.h"
+#include "trend_dfa_f32.h"
+#include "trend_dfa_multi.h"
+#include "trend_dfa_q.h"
+#include "arinc429_stats.h"
 #include <string.h>
-#include <math.h>
-
-/* Copy the DFA functions directly into this file to avoid linking issues */
-
-/* State definitions */
-#define STATE_STABLE      1
-#define STATE_INCREASING  2  
-#define STATE_DECREASING  3
-#define STATE_OSCILLATING 4
-#define STATE_ANOMALY     5
-
-/* Thresholds - adjusted for flight data */
-#define STABLE_THRESHOLD      0.5
-#define INCREASE_THRESHOLD    2.0
-#define DECREASE_THRESHOLD   -2.0
-#define OSCILLATION_THRESHOLD 100.0
-#define ANOMALY_THRESHOLD     1000.0
-
-/* Flight-specific anomaly thresholds */
-#define VEL_ANOMALY_THRESHOLD     500.0   /* m/s - extreme velocity */
-#define ALT_ANOMALY_THRESHOLD     50000.0 /* m - extreme altitude */
-#define LAT_ANOMALY_THRESHOLD     90.0    /* degrees - invalid latitude */
-#define LON_ANOMALY_THRESHOLD     180.0   /* degrees - invalid longitude */
-#define VERTARE_ANOMALY_THRESHOLD 1000.0  /* vertical area threshold */
-
-#define SAMPLE_SIZE 10
-
-/* Static variables for DFA state persistence */
-static int prev_state = STATE_STABLE;
-static int state_counter = 0;
-
-/* Internal DFA functions */
-static double calculate_slope(double *x, double *y, int n) {
-    double sum_x = 0, sum_y = 0, sum_xy = 0, sum_x2 = 0;
-    double denominator, slope;
+
+/* The DFA itself lives in libarinc429/; this file only maps Simulink ports
+ * and work vectors onto it.
+ *
+ * The five inputs may be scalars (one aircraft, as before) or width-N vectors
+ * (N aircraft, one element per track). All inputs must have the same width.
+ * Outputs are state (N), confidence (N), trends (6*N, laid out [trend][track])
+ * and name (N). Per-track window, hysteresis and counter state is kept as
+ * structure-of-arrays DWork, so one mdlOutputs call advances every track and
+ * several instances in one model do not interfere.
+ *
+ * Parameters are optional: with none the block uses trend_dfa_config.h.
+ * Otherwise give all four,
+ *   window       samples per window, 2..256 (not tunable, sizes the DWork)
+ *   thresholds   [stable increase decrease oscillation]
+ *   anomaly      [velocity baroaltitude lat lon vertrate] |y| limits
+ *   weights      [velocity baroaltitude lat lon vertrate] trend weights
+ * e.g. 16, [0.5 2 -2 100], [500 50000 90 180 1000], [0.4 0.3 0.1 0.1 0.1].
+ * They are parsed at mdlStart and when tuned (mdlProcessParameters) into a
+ * params DWork holding the engine's own form, not on every step.
+ * Windows of 8, 16, 32 and 64 samples run size-specialised kernels.
+ *
+ * The arithmetic is chosen when the block is compiled, for targets with a
+ * single-precision FPU (build_sfunctions precision argument):
+ *   TREND_DFA_SFUNC_PRECISION 0   double, trend_dfa_multi.h (default)
+ *   TREND_DFA_SFUNC_PRECISION 1   float32, trend_dfa_f32.h
+ *   TREND_DFA_SFUNC_PRECISION 2   Q-format fixed point, trend_dfa_q.h
+ * With 1 or 2 all ports are single and the DWork holds only the sample
+ * windows and automaton state; in fixed point the anomaly limits are not
+ * tunable, as they set the sample format.
+ *
+ * Built with -DARINC429_STATS=1 the block times each step and counts the
+ * transitions into each state and the track steps spent in STATE_ANOMALY
+ * (arinc429_stats.h); the results are written as JSON at mdlTerminate. */
+
+#ifndef TREND_DFA_SFUNC_PRECISION
+#define TREND_DFA_SFUNC_PRECISION 0
+#endif
+
+/* S-Function implementation */
+#define NUM_INPUTS      5
+#define NUM_OUTPUTS     4
+
+#define WINDOW_PARAM(S)  ssGetSFcnParam(S, 0)
+#define THRESH_PARAM(S)  ssGetSFcnParam(S, 1)
+#define ANOMALY_PARAM(S) ssGetSFcnParam(S, 2)
+#define WEIGHT_PARAM(S)  ssGetSFcnParam(S, 3)
+#define NUM_PARAMS       4
+
+/* IWork (only with -DARINC429_STATS=1): stats block id, then the state each
+ * track reported at the previous step, to count transitions */
+#define IWORK_STATS_ID  0
+#define IWORK_REPORTED  1
+
+#if TREND_DFA_SFUNC_PRECISION == 0
+/* DWork layout, see trend_dfa_multi_t */
+#define DWORK_VALUES        0
+#define DWORK_STATS         1
+#define DWORK_ANOMALY_COUNT 2
+#define DWORK_PREV_STATE    3
+#define DWORK_STATE_COUNTER 4
+#define DWORK_CONTROL       5
+#define DWORK_PARAMS        6
+#define NUM_DWORK           7
+
+typedef real_T port_T;
+typedef trend_dfa_multi_t engine_t;
+#define PORT_DTYPE  SS_DOUBLE
+#define CTRL_LEN    TREND_DFA_MULTI_CTRL_LEN
+#define engine_init trend_dfa_multi_init
+#define engine_step trend_dfa_multi_step
+#else
+/* DWork layout, see trend_dfa_f32_t and trend_dfa_q_t */
+#define DWORK_VALUES        0
+#define DWORK_PREV_STATE    1
+#define DWORK_STATE_COUNTER 2
+#define DWORK_CONTROL       3
+#define DWORK_PARAMS        4
+#define NUM_DWORK           5
+
+typedef real32_T port_T;
+#define PORT_DTYPE  SS_SINGLE
+#if TREND_DFA_SFUNC_PRECISION == 1
+typedef trend_dfa_f32_t engine_t;
+#define VALUES_DTYPE SS_SINGLE
+#define VALUES_LEN   TREND_DFA_F32_VALUES_LEN
+#define CTRL_LEN     TREND_DFA_F32_CTRL_LEN
+#define engine_init  trend_dfa_f32_init
+#define engine_step  trend_dfa_f32_step
+#else
+typedef trend_dfa_q_t engine_t;
+#define VALUES_DTYPE SS_INT32
+#define VALUES_LEN   TREND_DFA_Q_VALUES_LEN
+#define CTRL_LEN     TREND_DFA_Q_CTRL_LEN
+#define engine_init  trend_dfa_q_init
+#define engine_step  trend_dfa_q_step
+#endif
+#endif
+
+/* The params DWork holds an engine_t of which only the parameter fields are
+ * used; it is declared as doubles so it is aligned for the struct, and
+ * copied in and out with memcpy */
+#define PARAMS_LEN ((sizeof(engine_t) + sizeof(real_T) - 1) / sizeof(real_T))
+
+static void set_port_widths(SimStruct *S, int_T num_tracks)
+{
     int i;
-    
-    for (i = 0; i < n; i++) {
-        sum_x += x[i];
-        sum_y += y[i];
-        sum_xy += x[i] * y[i];
-        sum_x2 += x[i] * x[i];
-    }
-    
-    denominator = n * sum_x2 - sum_x * sum_x;
-    
-    if (fabs(denominator) < 1e-10) {
-        slope = 0.0;
-    } else {
-        slope = (n * sum_xy - sum_x * sum_y) / denominator;
+
+    for (i = 0; i < NUM_INPUTS; i++) {
+        ssSetInputPortWidth(S, i, num_tracks);
     }
-    
-    return slope;
+    ssSetOutputPortWidth(S, 0, num_tracks);
+    ssSetOutputPortWidth(S, 1, num_tracks);
+    ssSetOutputPortWidth(S, 2, num_tracks * TREND_DFA_NUM_TRENDS);
+    ssSetOutputPortWidth(S, 3, num_tracks);
 }
 
-static double calculate_variance(double *data, int n) {
-    double mean = 0, variance = 0;
-    int i;
-    
-    for (i = 0; i < n; i++) {
-        mean += data[i];
-    }
-    mean /= n;
-    
-    for (i = 0; i < n; i++) {
-        variance += (data[i] - mean) * (data[i] - mean);
+/* Parameters from the dialog, or the defaults if the block has none */
+static void get_params(SimStruct *S, trend_dfa_params_t *p)
+{
+    const real_T *thresh, *anomaly, *weight;
+    int ch;
+
+    trend_dfa_default_params(p);
+    if (ssGetSFcnParamsCount(S) != NUM_PARAMS) {
+        return;
     }
-    variance /= (n - 1);
-    
-    return variance;
-}
+    thresh  = mxGetPr(THRESH_PARAM(S));
+    anomaly = mxGetPr(ANOMALY_PARAM(S));
+    weight  = mxGetPr(WEIGHT_PARAM(S));
 
-static int detect_flight_anomaly(double *vel, double *baroalt, double *lat, double *lon, double *vertare) {
-    int i;
-    
-    for (i = 0; i < SAMPLE_SIZE; i++) {
-        /* Check velocity anomalies */
-        if (fabs(vel[i]) > VEL_ANOMALY_THRESHOLD) {
-            return 1;
-        }
-        
-        /* Check altitude anomalies */
-        if (fabs(baroalt[i]) > ALT_ANOMALY_THRESHOLD) {
-            return 1;
-        }
-        
-        /* Check latitude bounds */
-        if (fabs(lat[i]) > LAT_ANOMALY_THRESHOLD) {
-            return 1;
-        }
-        
-        /* Check longitude bounds */
-        if (fabs(lon[i]) > LON_ANOMALY_THRESHOLD) {
-            return 1;
-        }
-        
-        /* Check vertical area anomalies */
-        if (fabs(vertare[i]) > VERTARE_ANOMALY_THRESHOLD) {
-            return 1;
-        }
+    p->window      = (int)mxGetPr(WINDOW_PARAM(S))[0];
+    p->stable      = thresh[0];
+    p->increase    = thresh[1];
+    p->decrease    = thresh[2];
+    p->oscillation = thresh[3];
+    for (ch = 0; ch < TREND_DFA_NUM_CHANNELS; ch++) {
+        p->anomaly[ch] = anomaly[ch];
+        p->weight[ch] = weight[ch];
     }
-    return 0;
 }
 
-static int internal_flight_trend_analysis_dfa(double *vel_array, double *baroalt_array, double *lat_array, 
-                                             double *lon_array, double *vertare_array, 
-                                             double *confidence, double *trend_values) {
-    
-    int i;
-    double x_points[SAMPLE_SIZE];
-    double vel_trend, baroalt_trend, lat_trend, lon_trend, vertare_trend;
-    double vel_var, baroalt_var, lat_var, lon_var, vertare_var;
-    double weighted_trend, max_variance;
-    int new_state, current_state;
-    
-    /* Initialize x points */
-    for (i = 0; i < SAMPLE_SIZE; i++) {
-        x_points[i] = (double)(i + 1);
-    }
-    
-    /* Calculate trends for flight parameters */
-    vel_trend = calculate_slope(x_points, vel_array, SAMPLE_SIZE);
-    baroalt_trend = calculate_slope(x_points, baroalt_array, SAMPLE_SIZE);
-    lat_trend = calculate_slope(x_points, lat_array, SAMPLE_SIZE);
-    lon_trend = calculate_slope(x_points, lon_array, SAMPLE_SIZE);
-    vertare_trend = calculate_slope(x_points, vertare_array, SAMPLE_SIZE);
-    
-    /* Calculate variances */
-    vel_var = calculate_variance(vel_array, SAMPLE_SIZE);
-    baroalt_var = calculate_variance(baroalt_array, SAMPLE_SIZE);
-    lat_var = calculate_variance(lat_array, SAMPLE_SIZE);
-    lon_var = calculate_variance(lon_array, SAMPLE_SIZE);
-    vertare_var = calculate_variance(vertare_array, SAMPLE_SIZE);
-    
-    /* Find maximum variance */
-    max_variance = vel_var;
-    if (baroalt_var > max_variance) max_variance = baroalt_var;
-    if (lat_var > max_variance) max_variance = lat_var;
-    if (lon_var > max_variance) max_variance = lon_var;
-    if (vertare_var > max_variance) max_variance = vertare_var;
-    
-    /* Calculate weighted trend - prioritizing velocity and altitude for flight analysis */
-    weighted_trend = 0.4 * vel_trend + 0.3 * baroalt_trend + 0.1 * lat_trend + 
-                     0.1 * lon_trend + 0.1 * vertare_trend;
-    
-    /* State decision logic */
-    if (detect_flight_anomaly(vel_array, baroalt_array, lat_array, lon_array, vertare_array)) {
-        new_state = STATE_ANOMALY;
-        *confidence = 0.95;
+#define MDL_CHECK_PARAMETERS
+#if defined(MDL_CHECK_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Function: mdlCheckParameters ===============================================
+ * Abstract:
+ *    The window must be an integer from TREND_DFA_MIN_WINDOW to
+ *    TREND_DFA_MAX_WINDOW, the thresholds four values and the anomaly
+ *    limits and weights one value per channel, none of them NaN.
+ */
+static void mdlCheckParameters(SimStruct *S)
+{
+    trend_dfa_params_t p;
+    double window;
+
+    if (ssGetSFcnParamsCount(S) != NUM_PARAMS) {
+        return;
     }
-    else if (max_variance > OSCILLATION_THRESHOLD) {
-        new_state = STATE_OSCILLATING;
-        *confidence = 0.8;
+    if (!mxIsDouble(WINDOW_PARAM(S)) || mxGetNumberOfElements(WINDOW_PARAM(S)) != 1) {
+        ssSetErrorStatus(S, "Window must be a scalar");
+        return;
     }
-    else if (weighted_trend > INCREASE_THRESHOLD) {
-        new_state = STATE_INCREASING;
-        *confidence = 0.85;
+    window = mxGetPr(WINDOW_PARAM(S))[0];
+    if (window < TREND_DFA_MIN_WINDOW || window > TREND_DFA_MAX_WINDOW ||
+        window != (double)(int)window) {
+        ssSetErrorStatus(S, "Window must be an integer from 2 to 256");
+        return;
     }
-    else if (weighted_trend < DECREASE_THRESHOLD) {
-        new_state = STATE_DECREASING;
-        *confidence = 0.85;
+    if (!mxIsDouble(THRESH_PARAM(S)) || mxGetNumberOfElements(THRESH_PARAM(S)) != 4) {
+        ssSetErrorStatus(S, "Thresholds must be [stable increase decrease oscillation]");
+        return;
     }
-    else if (fabs(weighted_trend) <= STABLE_THRESHOLD) {
-        new_state = STATE_STABLE;
-        *confidence = 0.9;
+    if (!mxIsDouble(ANOMALY_PARAM(S)) ||
+        mxGetNumberOfElements(ANOMALY_PARAM(S)) != TREND_DFA_NUM_CHANNELS) {
+        ssSetErrorStatus(S, "Anomaly limits must have one value per input");
+        return;
     }
-    else {
-        new_state = prev_state;
-        *confidence = 0.6;
+    if (!mxIsDouble(WEIGHT_PARAM(S)) ||
+        mxGetNumberOfElements(WEIGHT_PARAM(S)) != TREND_DFA_NUM_CHANNELS) {
+        ssSetErrorStatus(S, "Weights must have one value per input");
+        return;
     }
-    
-    /* State transition with hysteresis */
-    if (new_state == prev_state) {
-        state_counter++;
-    } else {
-        state_counter = 1;
+    get_params(S, &p);
+    if (trend_dfa_check_params(&p) != 0) {
+        ssSetErrorStatus(S, "Parameters must not be NaN");
+        return;
     }
-    
-    if (state_counter >= 2 || new_state == STATE_ANOMALY) {
-        current_state = new_state;
-        prev_state = new_state;
-    } else {
-        current_state = prev_state;
+#if TREND_DFA_SFUNC_PRECISION == 2
+    if (trend_dfa_q_check_params(&p) != 0) {
+        ssSetErrorStatus(S, "Fixed-point anomaly limits must be positive and below 2^22");
+        return;
     }
-    
-    /* Fill trend values - flight parameters */
-    trend_values[0] = vel_trend;
-    trend_values[1] = baroalt_trend;
-    trend_values[2] = lat_trend;
-    trend_values[3] = lon_trend;
-    trend_values[4] = vertare_trend;
-    trend_values[5] = weighted_trend;
-    
-    return current_state;
+#endif
 }
-
-/* S-Function implementation */
-#define NUM_INPUTS      5
-#define NUM_OUTPUTS     4
-#define TOTAL_RWORK_SIZE    51
+#endif
 
 static void mdlInitializeSizes(SimStruct *S)
 {
     int i;
-    
-    ssSetNumSFcnParams(S, 0);
+
+    /* No parameters (defaults) or all of them */
+    ssSetNumSFcnParams(S, ssGetSFcnParamsCount(S) == 0 ? 0 : NUM_PARAMS);
     if (ssGetNumSFcnParams(S) != ssGetSFcnParamsCount(S)) {
         return;
     }
+#if defined(MATLAB_MEX_FILE)
+    mdlCheckParameters(S);
+    if (ssGetErrorStatus(S) != NULL) {
+        return;
+    }
+#endif
+    for (i = 0; i < ssGetNumSFcnParams(S); i++) {
+        /* The window sizes the DWork; thresholds and weights may change */
+        ssSetSFcnParamTunable(S, i, i != 0 && (TREND_DFA_SFUNC_PRECISION != 2 || i != 2));
+    }
 
     ssSetNumContStates(S, 0);
     ssSetNumDiscStates(S, 0);
 
     if (!ssSetNumInputPorts(S, NUM_INPUTS)) return;
-    
+
     for (i = 0; i < NUM_INPUTS; i++) {
-        ssSetInputPortWidth(S, i, 1);
-        ssSetInputPortDataType(S, i, SS_DOUBLE);
+        ssSetInputPortWidth(S, i, DYNAMICALLY_SIZED);
+        ssSetInputPortDataType(S, i, PORT_DTYPE);
         ssSetInputPortComplexSignal(S, i, COMPLEX_NO);
         ssSetInputPortDirectFeedThrough(S, i, 1);
         ssSetInputPortRequiredContiguous(S, i, 1);
     }
 
     if (!ssSetNumOutputPorts(S, NUM_OUTPUTS)) return;
-    
-    ssSetOutputPortWidth(S, 0, 1);
-    ssSetOutputPortDataType(S, 0, SS_DOUBLE);
-    ssSetOutputPortComplexSignal(S, 0, COMPLEX_NO);
-    
-    ssSetOutputPortWidth(S, 1, 1);
-    ssSetOutputPortDataType(S, 1, SS_DOUBLE);
-    ssSetOutputPortComplexSignal(S, 1, COMPLEX_NO);
-    
-    ssSetOutputPortWidth(S, 2, 6);
-    ssSetOutputPortDataType(S, 2, SS_DOUBLE);
-    ssSetOutputPortComplexSignal(S, 2, COMPLEX_NO);
-    
-    ssSetOutputPortWidth(S, 3, 1);
-    ssSetOutputPortDataType(S, 3, SS_DOUBLE);
-    ssSetOutputPortComplexSignal(S, 3, COMPLEX_NO);
+
+    for (i = 0; i < NUM_OUTPUTS; i++) {
+        ssSetOutputPortWidth(S, i, DYNAMICALLY_SIZED);
+        ssSetOutputPortDataType(S, i, PORT_DTYPE);
+        ssSetOutputPortComplexSignal(S, i, COMPLEX_NO);
+    }
 
     ssSetNumSampleTimes(S, 1);
-    ssSetNumRWork(S, TOTAL_RWORK_SIZE);
-    ssSetNumIWork(S, 0);
+
+    /* Widths depend on the number of tracks, see mdlSetWorkWidths */
+    ssSetNumDWork(S, NUM_DWORK);
+
+    ssSetNumRWork(S, 0);
+    ssSetNumIWork(S, ARINC429_STATS ? DYNAMICALLY_SIZED : 0);
     ssSetNumPWork(S, 0);
     ssSetNumModes(S, 0);
     ssSetNumNonsampledZCs(S, 0);
 
+    /* The whole engine state is DWork, so a saved operating point resumes
+     * the DFA exactly; native replays use trend_ckpt.h instead */
+    ssSetOperatingPointCompliance(S, USE_DEFAULT_OPERATING_POINT);
+
     ssSetOptions(S, SS_OPTION_EXCEPTION_FREE_CODE);
 }
 
+#define MDL_SET_INPUT_PORT_WIDTH
+static void mdlSetInputPortWidth(SimStruct *S, int_T port, int_T inputPortWidth)
+{
+    set_port_widths(S, inputPortWidth);
+}
+
+#define MDL_SET_OUTPUT_PORT_WIDTH
+static void mdlSetOutputPortWidth(SimStruct *S, int_T port, int_T outputPortWidth)
+{
+    if (port == 2) {
+        if (outputPortWidth % TREND_DFA_NUM_TRENDS != 0) {
+            ssSetErrorStatus(S, "Trend output width must be a multiple of 6");
+            return;
+        }
+        set_port_widths(S, outputPortWidth / TREND_DFA_NUM_TRENDS);
+    } else {
+        set_port_widths(S, outputPortWidth);
+    }
+}
+
+#define MDL_SET_DEFAULT_PORT_DIMENSION_INFO
+static void mdlSetDefaultPortDimensionInfo(SimStruct *S)
+{
+    /* Unconnected ports fall back to a single aircraft */
+    set_port_widths(S, 1);
+}
+
+#define MDL_SET_WORK_WIDTHS
+static void mdlSetWorkWidths(SimStruct *S)
+{
+    int_T num_tracks = ssGetInputPortWidth(S, 0);
+    trend_dfa_params_t p;
+    int i;
+
+    for (i = 1; i < NUM_INPUTS; i++) {
+        if (ssGetInputPortWidth(S, i) != num_tracks) {
+            ssSetErrorStatus(S, "All inputs must have the same width (number of tracks)");
+            return;
+        }
+    }
+
+    get_params(S, &p);
+#if TREND_DFA_SFUNC_PRECISION == 0
+    ssSetDWorkWidth(S, DWORK_VALUES, (int_T)TREND_DFA_MULTI_VALUES_LEN(num_tracks, p.window));
+    ssSetDWorkDataType(S, DWORK_VALUES, SS_DOUBLE);
+    ssSetDWorkName(S, DWORK_VALUES, "window_values");
+
+    ssSetDWorkWidth(S, DWORK_STATS, (int_T)TREND_DFA_MULTI_STATS_LEN(num_tracks));
+    ssSetDWorkDataType(S, DWORK_STATS, SS_DOUBLE);
+    ssSetDWorkName(S, DWORK_STATS, "window_stats");
+
+    ssSetDWorkWidth(S, DWORK_ANOMALY_COUNT, (int_T)TREND_DFA_MULTI_COUNTS_LEN(num_tracks));
+    ssSetDWorkDataType(S, DWORK_ANOMALY_COUNT, SS_INT32);
+    ssSetDWorkName(S, DWORK_ANOMALY_COUNT, "anomaly_count");
+#else
+    ssSetDWorkWidth(S, DWORK_VALUES, (int_T)VALUES_LEN(num_tracks, p.window));
+    ssSetDWorkDataType(S, DWORK_VALUES, VALUES_DTYPE);
+    ssSetDWorkName(S, DWORK_VALUES, "window_values");
+#endif
+
+    ssSetDWorkWidth(S, DWORK_PREV_STATE, num_tracks);
+    ssSetDWorkDataType(S, DWORK_PREV_STATE, SS_INT32);
+    ssSetDWorkName(S, DWORK_PREV_STATE, "prev_state");
+
+    ssSetDWorkWidth(S, DWORK_STATE_COUNTER, num_tracks);
+    ssSetDWorkDataType(S, DWORK_STATE_COUNTER, SS_INT32);
+    ssSetDWorkName(S, DWORK_STATE_COUNTER, "state_counter");
+
+    ssSetDWorkWidth(S, DWORK_CONTROL, CTRL_LEN);
+    ssSetDWorkDataType(S, DWORK_CONTROL, SS_INT32);
+    ssSetDWorkName(S, DWORK_CONTROL, "control");
+
+    ssSetDWorkWidth(S, DWORK_PARAMS, (int_T)PARAMS_LEN);
+    ssSetDWorkDataType(S, DWORK_PARAMS, SS_DOUBLE);
+    ssSetDWorkName(S, DWORK_PARAMS, "params");
+
+#if ARINC429_STATS
+    ssSetNumIWork(S, IWORK_REPORTED + num_tracks);
+#endif
+}
+
 static void mdlInitializeSampleTimes(SimStruct *S)
 {
     ssSetSampleTime(S, 0, INHERITED_SAMPLE_TIME);
     ssSetOffsetTime(S, 0, 0.0);
 }
 
+/* Convert the dialog parameters into the params DWork. Returns 0 or -1 */
+static int cache_params(SimStruct *S)
+{
+    real_T *cached = (real_T*)ssGetDWork(S, DWORK_PARAMS);
+    trend_dfa_params_t p;
+    engine_t m;
+
+    if (cached == NULL) {
+        return -1;
+    }
+    memset(&m, 0, sizeof(m));
+    get_params(S, &p);
+#if TREND_DFA_SFUNC_PRECISION == 0
+    m.params = p;
+#elif TREND_DFA_SFUNC_PRECISION == 1
+    trend_dfa_params_to_f32(&p, &m.params);
+#else
+    if (trend_dfa_q_set_params(&m, &p) != 0) {
+        return -1;
+    }
+#endif
+    memcpy(cached, &m, sizeof(m));
+    return 0;
+}
+
+/* Point the engine at this block's DWork and cached parameters */
+static int bind_dwork(SimStruct *S, engine_t *m)
+{
+    const real_T *cached = (const real_T*)ssGetDWork(S, DWORK_PARAMS);
+
+    if (cached == NULL) {
+        return 0;
+    }
+    memcpy(m, cached, sizeof(*m));
+    m->num_tracks    = ssGetInputPortWidth(S, 0);
+#if TREND_DFA_SFUNC_PRECISION == 0
+    m->values        = (double*)ssGetDWork(S, DWORK_VALUES);
+    m->stats         = (double*)ssGetDWork(S, DWORK_STATS);
+    m->anomaly_count = (int32_T*)ssGetDWork(S, DWORK_ANOMALY_COUNT);
+    m->prev_state    = (int32_T*)ssGetDWork(S, DWORK_PREV_STATE);
+    m->state_counter = (int32_T*)ssGetDWork(S, DWORK_STATE_COUNTER);
+    m->control       = (int32_T*)ssGetDWork(S, DWORK_CONTROL);
+
+    return m->values && m->stats && m->anomaly_count && m->prev_state &&
+           m->state_counter && m->control;
+#else
+#if TREND_DFA_SFUNC_PRECISION == 1
+    m->values        = (real32_T*)ssGetDWork(S, DWORK_VALUES);
+#else
+    m->values        = (int32_T*)ssGetDWork(S, DWORK_VALUES);
+#endif
+    m->prev_state    = (int32_T*)ssGetDWork(S, DWORK_PREV_STATE);
+    m->state_counter = (int32_T*)ssGetDWork(S, DWORK_STATE_COUNTER);
+    m->control       = (int32_T*)ssGetDWork(S, DWORK_CONTROL);
+
+    return m->values && m->prev_state && m->state_counter && m->control;
+#endif
+}
+
 #define MDL_START
-#if defined(MDL_START) 
+#if defined(MDL_START)
 static void mdlStart(SimStruct *S)
 {
-    real_T *rwork = ssGetRWork(S);
-    int i;
-    
-    if (rwork == NULL) {
-        ssSetErrorStatus(S, "RWork allocation failed");
+    engine_t m;
+
+    if (cache_params(S) != 0 || !bind_dwork(S, &m)) {
+        ssSetErrorStatus(S, "DWork allocation failed");
         return;
     }
-    
-    for (i = 0; i < TOTAL_RWORK_SIZE; i++) {
-        rwork[i] = 0.0;
+
+    engine_init(&m);
+
+#if ARINC429_STATS
+    {
+        int_T *iw = ssGetIWork(S);
+        int_T t;
+
+        iw[IWORK_STATS_ID] = arinc429_stats_register(ssGetPath(S));
+        for (t = 0; t < m.num_tracks; t++) {
+            iw[IWORK_REPORTED + t] = m.prev_state[t];
+        }
+    }
+#endif
+}
+#endif
+
+#define MDL_PROCESS_PARAMETERS
+#if defined(MDL_PROCESS_PARAMETERS) && defined(MATLAB_MEX_FILE)
+/* Function: mdlProcessParameters =============================================
+ * Abstract:
+ *    Re-cache tuned thresholds and weights (already checked by
+ *    mdlCheckParameters); the next step uses them.
+ */
+static void mdlProcessParameters(SimStruct *S)
+{
+    if (cache_params(S) != 0) {
+        ssSetErrorStatus(S, "Parameters could not be applied");
+    }
+}
+#endif
+
+#if ARINC429_STATS
+/* Count this step's transitions and anomaly steps from the reported states */
+static void count_states(SimStruct *S, const engine_t *m)
+{
+    int_T *iw = ssGetIWork(S);
+    uint64_t enter[TREND_DFA_NUM_STATES + 1] = { 0 };
+    uint64_t anomaly = 0;
+    int_T t;
+    int s;
+
+    for (t = 0; t < m->num_tracks; t++) {
+        int32_T state = m->prev_state[t];
+
+        if (state != iw[IWORK_REPORTED + t] && state >= 1 && state <= TREND_DFA_NUM_STATES) {
+            enter[state]++;
+        }
+        anomaly += state == STATE_ANOMALY;
+        iw[IWORK_REPORTED + t] = state;
+    }
+
+    for (s = 1; s <= TREND_DFA_NUM_STATES; s++) {
+        if (enter[s] != 0) {
+            arinc429_stats_count(iw[IWORK_STATS_ID], ARINC429_STATS_ENTER(s), enter[s]);
+        }
+    }
+    if (anomaly != 0) {
+        arinc429_stats_count(iw[IWORK_STATS_ID], ARINC429_STATS_ANOMALY, anomaly);
     }
-    
-    /* Reset DFA state */
-    prev_state = STATE_STABLE;
-    state_counter = 0;
 }
 #endif
 
 static void mdlOutputs(SimStruct *S, int_T tid)
 {
-    /* Get inputs - flight data parameters */
-    double *vel_input     = (double*)ssGetInputPortSignal(S, 0);  /* velocity */
-    double *baroalt_input = (double*)ssGetInputPortSignal(S, 1);  /* baroaltitude */
-    double *lat_input     = (double*)ssGetInputPortSignal(S, 2);  /* latitude */
-    double *lon_input     = (double*)ssGetInputPortSignal(S, 3);  /* longitude */
-    double *vertare_input = (double*)ssGetInputPortSignal(S, 4);  /* vertare */
-    
+    /* Get inputs - flight data parameters, one element per track */
+    const port_T *input[TREND_DFA_NUM_CHANNELS];
+    input[TREND_DFA_CH_VELOCITY] = (const port_T*)ssGetInputPortSignal(S, 0);  /* velocity */
+    input[TREND_DFA_CH_BAROALT]  = (const port_T*)ssGetInputPortSignal(S, 1);  /* baroaltitude */
+    input[TREND_DFA_CH_LAT]      = (const port_T*)ssGetInputPortSignal(S, 2);  /* latitude */
+    input[TREND_DFA_CH_LON]      = (const port_T*)ssGetInputPortSignal(S, 3);  /* longitude */
+    input[TREND_DFA_CH_VERTRATE] = (const port_T*)ssGetInputPortSignal(S, 4);  /* vertare */
+
     /* Get outputs */
-    double *state_output  = (double*)ssGetOutputPortSignal(S, 0);
-    double *conf_output   = (double*)ssGetOutputPortSignal(S, 1);
-    double *trends_output = (double*)ssGetOutputPortSignal(S, 2);
-    double *name_output   = (double*)ssGetOutputPortSignal(S, 3);
-    
+    port_T *state_output  = (port_T*)ssGetOutputPortSignal(S, 0);
+    port_T *conf_output   = (port_T*)ssGetOutputPortSignal(S, 1);
+    port_T *trends_output = (port_T*)ssGetOutputPortSignal(S, 2);
+    port_T *name_output   = (port_T*)ssGetOutputPortSignal(S, 3);
+
     /* Safety checks */
-    if (!vel_input || !baroalt_input || !lat_input || !lon_input || !vertare_input ||
+    if (!input[0] || !input[1] || !input[2] || !input[3] || !input[4] ||
         !state_output || !conf_output || !trends_output || !name_output) {
         ssSetErrorStatus(S, "Null pointer detected");
         return;
     }
-    
-    real_T *rwork = ssGetRWork(S);
-    if (!rwork) {
-        ssSetErrorStatus(S, "RWork is null");
+
+    ARINC429_STATS_START(t0);
+
+    engine_t m;
+    if (!bind_dwork(S, &m)) {
+        ssSetErrorStatus(S, "DWork is null");
         return;
     }
-    
-    /* Buffer management for flight data */
-    double *vel_buffer     = &rwork[0];   /* velocity buffer */
-    double *baroalt_buffer = &rwork[10];  /* baroaltitude buffer */
-    double *lat_buffer     = &rwork[20];  /* latitude buffer */
-    double *lon_buffer     = &rwork[30];  /* longitude buffer */
-    double *vertare_buffer = &rwork[40];  /* vertare buffer */
-    
-    int buffer_idx = (int)rwork[50];
-    int i;
-    
-    /* Shift buffers */
-    for (i = 0; i < SAMPLE_SIZE - 1; i++) {
-        vel_buffer[i]     = vel_buffer[i + 1];
-        baroalt_buffer[i] = baroalt_buffer[i + 1];
-        lat_buffer[i]     = lat_buffer[i + 1];
-        lon_buffer[i]     = lon_buffer[i + 1];
-        vertare_buffer[i] = vertare_buffer[i + 1];
-    }
-    
-    /* Add new values */
-    vel_buffer[SAMPLE_SIZE - 1]     = vel_input[0];
-    baroalt_buffer[SAMPLE_SIZE - 1] = baroalt_input[0];
-    lat_buffer[SAMPLE_SIZE - 1]     = lat_input[0];
-    lon_buffer[SAMPLE_SIZE - 1]     = lon_input[0];
-    vertare_buffer[SAMPLE_SIZE - 1] = vertare_input[0];
-    
-    buffer_idx++;
-    rwork[50] = (double)buffer_idx;
-    
-    /* Process when enough samples */
-    if (buffer_idx >= SAMPLE_SIZE) {
-        int current_state;
-        double confidence;
-        double trend_values[6];
-        
-        current_state = internal_flight_trend_analysis_dfa(vel_buffer, baroalt_buffer, lat_buffer, 
-                                                          lon_buffer, vertare_buffer, 
-                                                          &confidence, trend_values);
-        
-        state_output[0] = (double)current_state;
-        conf_output[0] = confidence;
-        
-        for (i = 0; i < 6; i++) {
-            trends_output[i] = trend_values[i];
-        }
-        
-        name_output[0] = (double)current_state;
-    } else {
-        /* Initial values */
-        state_output[0] = 1.0;
-        conf_output[0] = 0.0;
-        for (i = 0; i < 6; i++) {
-            trends_output[i] = 0.0;
-        }
-        name_output[0] = 1.0;
-    }
+
+    engine_step(&m, input, state_output, conf_output, trends_output);
+
+    memcpy(name_output, state_output, (size_t)m.num_tracks * sizeof(port_T));
+
+#if ARINC429_STATS
+    count_states(S, &m);
+#endif
+    ARINC429_STATS_STOP(ssGetIWork(S)[IWORK_STATS_ID], t0, (uint64_t)m.num_tracks);
 }
 
 static void mdlTerminate(SimStruct *S)
 {
-    prev_state = STATE_STABLE;
-    state_counter = 0;
+#if ARINC429_STATS
+    char line[ARINC429_STATS_LINE_LEN];
+
+    arinc429_stats_report(ssGetIWork(S)[IWORK_STATS_ID], line, sizeof(line));
+    ssPrintf("%s\n", line);
+    arinc429_stats_unregister(ssGetIWork(S)[IWORK_STATS_ID]);
+#endif
 }
 
 #ifdef  MATLAB_MEX_FILE
 #include "simulink.c"
 #else
 #include "cg_sfun.h"
-#endif
\ No newline at end of file
+#endif